@@ -8,6 +8,9 @@
 #include "CObjectCache.h"
 #include "nbl/system/SReadWriteSpinLock.h"
 
+#include <array>
+#include <memory>
+
 namespace nbl { namespace core
 {
 
@@ -165,6 +168,102 @@ using CConcurrentMultiObjectCache =
         CMultiObjectCache<K, T, ContainerT_T, Alloc>
     >;
 
+//! Spreads the keys over `ShardCount` independently locked caches by their hash, so that concurrent inserts and lookups
+//! of different keys rarely contend on the same lock and every lookup only searches a fraction of the entries.
+// Only the subset of the interface which makes sense for a multi-cache looked up by key is exposed.
+template<
+    typename K,
+    typename T,
+    template<typename...> class ContainerT_T = std::vector,
+    size_t ShardCount = 32u,
+    typename Hash = std::hash<K>
+>
+class CShardedConcurrentMultiObjectCache
+{
+        using shard_t = CConcurrentMultiObjectCache<K,T,ContainerT_T>;
+
+    public:
+        using KeyType = typename shard_t::KeyType;
+        using CachedType = typename shard_t::CachedType;
+        using MutablePairType = typename shard_t::MutablePairType;
+
+        //! Every shard gets constructed with the same arguments (e.g. greet and dispose functions)
+        template<typename... Args>
+        inline CShardedConcurrentMultiObjectCache(const Args&... args)
+        {
+            for (auto& shard : m_shards)
+                shard = std::make_unique<shard_t>(args...);
+        }
+        CShardedConcurrentMultiObjectCache(const CShardedConcurrentMultiObjectCache&) = delete;
+        CShardedConcurrentMultiObjectCache& operator=(const CShardedConcurrentMultiObjectCache&) = delete;
+
+        inline bool insert(const K& _key, const T& _val)
+        {
+            return getShard(_key).insert(_key,_val);
+        }
+
+        inline bool removeObject(const T& _obj, const K& _key)
+        {
+            return getShard(_key).removeObject(_obj,_key);
+        }
+
+        template<typename OutT>
+        inline bool findAndStoreRange(const K& _key, size_t& _inOutStorageSize, OutT* _out) const
+        {
+            return getShard(_key).findAndStoreRange(_key,_inOutStorageSize,_out);
+        }
+
+        //! Not atomic when the key moves between shards, the object is briefly absent from the cache
+        inline bool changeObjectKey(const T& _obj, const K& _key, const K& _newKey)
+        {
+            auto& oldShard = getShard(_key);
+            auto& newShard = getShard(_newKey);
+            if (&oldShard==&newShard)
+                return oldShard.changeObjectKey(_obj,_key,_newKey);
+            // remove first, the dispose callback must not run after the greet of the re-insertion
+            if (!oldShard.removeObject(_obj,_key))
+                return false;
+            return newShard.insert(_newKey,_obj);
+        }
+
+        inline size_t getSize() const
+        {
+            size_t retval = 0u;
+            for (const auto& shard : m_shards)
+                retval += shard->getSize();
+            return retval;
+        }
+
+        inline void clear()
+        {
+            for (auto& shard : m_shards)
+                shard->clear();
+        }
+
+        inline bool outputAll(size_t& _inOutStorageSize, MutablePairType* _out) const
+        {
+            const size_t availableSize = _inOutStorageSize;
+            _inOutStorageSize = 0u;
+            bool res = true;
+            for (const auto& shard : m_shards)
+            {
+                size_t written = availableSize-_inOutStorageSize;
+                // a null `_out` is a size query, every shard gets asked with nullptr
+                res = shard->outputAll(written,_out ? (_out+_inOutStorageSize):nullptr) && res;
+                _inOutStorageSize += written;
+            }
+            return res;
+        }
+
+    private:
+        inline shard_t& getShard(const K& _key) const
+        {
+            return *m_shards[Hash{}(_key)%ShardCount];
+        }
+
+        std::array<std::unique_ptr<shard_t>,ShardCount> m_shards;
+};
+
 }}
 
 #endif
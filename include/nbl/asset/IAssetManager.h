@@ -6,7 +6,10 @@
 #define __NBL_ASSET_I_ASSET_MANAGER_H_INCLUDED__
 
 #include <array>
+#include <condition_variable>
+#include <mutex>
 #include <ostream>
+#include <thread>
 
 #include "nbl/core/declarations.h"
 #include "nbl/system/path.h"
@@ -36,8 +39,8 @@ std::function<void(SAssetBundle&)> makeAssetDisposeFunc(const IAssetManager* con
 //! Class responsible for handling loading of assets from file system or other resources
 /**
 	It provides a loading, writing and creation functionality that is almost thread-safe.
-	There is one issue with threading, starting loading the same asset at the exact same time 
-	may end up with two copies in the cache.
+	Loads of the same cacheable asset which overlap in time get coalesced, later ones wait for
+	the first one to finish and then pick its result up from the cache.
 
 	IAssetManager performs caching of CPU assets associated with resource handles such as names, 
 	filenames, UUIDs. However there are separate caches for each asset type.
@@ -45,7 +48,7 @@ std::function<void(SAssetBundle&)> makeAssetDisposeFunc(const IAssetManager* con
 	@see IAsset
 
 */
-class NBL_API2 IAssetManager : public core::IReferenceCounted
+class NBL_API2 IAssetManager : public core::IReferenceCounted, private system::ISystem::IFutureManipulator
 {
         // the point of those functions is that lambdas returned by them "inherits" friendship
         friend std::function<void(SAssetBundle&)> makeAssetGreetFunc(const IAssetManager* const _mgr);
@@ -53,7 +56,8 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
 
     public:
 #ifdef USE_MAPS_FOR_PATH_BASED_CACHE
-        using AssetCacheType = core::CConcurrentMultiObjectCache<std::string, SAssetBundle, std::multimap>;
+        // sharded by path hash, many loader threads hammer these at once
+        using AssetCacheType = core::CShardedConcurrentMultiObjectCache<std::string, SAssetBundle, std::multimap>;
 #else
         using AssetCacheType = core::CConcurrentMultiObjectCache<std::string, IAssetBundle, std::vector>;
 #endif //USE_MAPS_FOR_PATH_BASED_CACHE
@@ -93,6 +97,8 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
             core::vector<core::smart_refctd_ptr<IAssetLoader> > vector;
             //! The key is file extension
             core::CMultiObjectCache<std::string, IAssetLoader*, std::vector> perFileExt;
+            //! Dispatch table matched against the header of a file before looking at its extension, only a handful of entries so a flat vector
+            core::vector<std::pair<IAssetLoader::SFileMagic, IAssetLoader*>> perMagic;
 
             void pushToVector(core::smart_refctd_ptr<IAssetLoader>&& _loader)
 			{
@@ -120,6 +126,45 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
         // called as a part of constructor only
         void initializeMeshTools();
 
+        //! A cacheable load which is running right now, anyone else wanting the same key waits for it instead of loading again
+        struct SInFlightLoad
+        {
+            std::mutex mutex;
+            std::condition_variable cvar;
+            // a loader which recursively asks for its own key must not wait on itself
+            const std::thread::id loader = std::this_thread::get_id();
+            bool done = false;
+            SAssetBundle result;
+        };
+        std::mutex m_inFlightLoadsMutex;
+        core::unordered_map<std::string,std::shared_ptr<SInFlightLoad>> m_inFlightLoads;
+
+        struct SAsyncLoadRequest
+        {
+            std::string filename;
+            IAssetLoader::SAssetLoadParams params;
+            uint32_t hierarchyLevel = 0u;
+            IAssetLoader::IAssetLoaderOverride* override = nullptr;
+        };
+        class CAsyncLoadQueue final : public system::IAsyncQueueDispatcher<CAsyncLoadQueue,SAsyncLoadRequest>
+        {
+                using base_t = system::IAsyncQueueDispatcher<CAsyncLoadQueue,SAsyncLoadRequest>;
+
+                IAssetManager* const m_manager;
+
+            public:
+                inline CAsyncLoadQueue(IAssetManager* manager) : base_t(base_t::start_on_construction), m_manager(manager) {}
+
+                void process_request(base_t::future_base_t* _future_base, SAsyncLoadRequest& req);
+
+                // remembers which worker the thread is, loaders running on a worker must never block on a queue only a worker can drain
+                void init();
+        };
+        // loads get round-robined over the workers, which only get spawned on first use of the async API
+        std::once_flag m_loadWorkersCreated;
+        core::vector<std::unique_ptr<CAsyncLoadQueue>> m_loadWorkers;
+        std::atomic_uint32_t m_nextLoadWorker = 0u;
+
     public:
         //! Constructor
         explicit IAssetManager(core::smart_refctd_ptr<system::ISystem>&& system, core::smart_refctd_ptr<CCompilerSet>&& compilerSet = nullptr) :
@@ -146,6 +191,8 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
     protected:
 		virtual ~IAssetManager()
 		{
+			// workers may still be loading into the caches
+			m_loadWorkers.clear();
 			for (size_t i = 0u; i < m_assetCache.size(); ++i)
 				if (m_assetCache[i])
 					delete m_assetCache[i];
@@ -193,10 +240,14 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
                 _override->getLoadFilename(filePath, m_system.get(), ctx, _hierarchyLevel);
             }
             
-            system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
-            m_system->createFile(future, filePath, system::IFile::ECF_READ);
-            if (auto file=future.acquire())
-                return getAssetInHierarchy_impl(file->get(), filePath.string(), ctx.params, _hierarchyLevel, _override);
+            // prefer a (read-only) mapping so reads turn into memcpy's, but not every file can be mapped (e.g. empty ones)
+            for (const auto flags : {core::bitflag(system::IFile::ECF_READ)|system::IFile::ECF_MAPPABLE,core::bitflag(system::IFile::ECF_READ)})
+            {
+                system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
+                m_system->createFile(future, filePath, flags);
+                if (auto file=future.acquire(); file && file->get())
+                    return getAssetInHierarchy_impl(file->get(), filePath.string(), ctx.params, _hierarchyLevel, _override);
+            }
             return SAssetBundle(0);
         }
 
@@ -214,6 +265,12 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
             return getAssetInHierarchy_impl(_filePath, _params, _hierarchyLevel, _override);
         }
 
+        //! Hands every `_filePaths[i]` to the loading workers, `_bundles[i]` receives the result
+        void getAssetsInHierarchyAsync(std::span<system::ISystem::future_t<SAssetBundle>> _bundles, std::span<const std::string> _filePaths, const IAssetLoader::SAssetLoadParams& _params, uint32_t _hierarchyLevel, IAssetLoader::IAssetLoaderOverride* _override);
+        //! Waits for a load started with `getAssetsInHierarchyAsync`, if no worker has picked it up yet it gets cancelled and runs on the calling thread instead.
+        //! This is what lets a loader running on a worker fan out sub-asset loads without starving the workers, arguments must match the ones the load was started with.
+        SAssetBundle waitForAssetInHierarchy(system::ISystem::future_t<SAssetBundle>& _bundle, const std::string& _filePath, const IAssetLoader::SAssetLoadParams& _params, uint32_t _hierarchyLevel, IAssetLoader::IAssetLoaderOverride* _override);
+
     public:
         //! These can be grabbed and dropped, but you must not use drop() to try to unload/release memory of a cached IAsset (which is cached if IAsset::isInAResourceCache() returns true). See IAsset::E_CACHING_FLAGS
         /** Instead for a cached asset you call IAsset::removeSelfFromCache() instead of IAsset::drop() as the cache has an internal grab of the IAsset and it will drop it on removal from cache, which will result in deletion if nothing else is holding onto the IAsset through grabs (in that sense the last drop will delete the object). */
@@ -227,6 +284,10 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
         {
             return getAssetInHierarchy(_file, _supposedFilename, _params,  0u, _override);
         }
+        //! Starts loading all `_filePaths` on the asset loading workers, `_bundles[i]` becomes ready once `_filePaths[i]` is loaded.
+        /** Concurrent requests for the same cacheable asset, whether they come from here or from `getAsset`, only run the loaders once.
+        The override, if any, needs to outlive the loads. */
+        void getAssetsAsync(std::span<system::ISystem::future_t<SAssetBundle>> _bundles, std::span<const system::path> _filePaths, const IAssetLoader::SAssetLoadParams& _params, IAssetLoader::IAssetLoaderOverride* _override=nullptr);
 
         //TODO change name
 		//! Check whether Assets exist in cache using a key and optionally their types
@@ -396,11 +457,14 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
             size_t extIx = 0u;
             while (const char* ext = exts[extIx++])
                 m_loaders.perFileExt.insert(ext, _loader.get());
+            for (const auto& magic : _loader->getFileMagics())
+                m_loaders.perMagic.emplace_back(magic, _loader.get());
             m_loaders.pushToVector(std::move(_loader));
             return static_cast<uint32_t>(m_loaders.vector.size())-1u;
         }
         void removeAssetLoader(IAssetLoader* _loader)
         {
+            std::erase_if(m_loaders.perMagic, [_loader](const auto& magic)->bool { return magic.second == _loader; });
             m_loaders.eraseFromVector(
                 std::find_if(std::begin(m_loaders.vector), std::end(m_loaders.vector), [_loader](const core::smart_refctd_ptr<IAssetLoader>& a)->bool { return a.get()==_loader; })
             );
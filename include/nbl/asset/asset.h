@@ -35,6 +35,7 @@
 #include "nbl/asset/filters/CFlattenRegionsImageFilter.h"
 #include "nbl/asset/filters/CMipMapGenerationImageFilter.h"
 #include "nbl/asset/filters/CSummedAreaTableImageFilter.h"
+#include "nbl/asset/filters/CBlockCompressImageFilter.h"
 
 // acceleration structure
 #include "nbl/asset/ICPUAccelerationStructure.h"
@@ -37,6 +37,10 @@ disable this feature, the engine can still read archives, but only uncompressed
 ones. */
 #define _NBL_COMPILE_WITH_ZLIB_
 
+//! Define _NBL_COMPILE_WITH_LIBDEFLATE_ to inflate archive entries of known size and PNG image data with libdeflate instead of zlib.
+/** libdeflate only does whole-buffer decompression, zlib is still used for streaming. */
+#define _NBL_COMPILE_WITH_LIBDEFLATE_
+
 //! Define _NBL_COMPILE_WITH_ZIP_ENCRYPTION_ if you want to read AES-encrypted ZIP archives
 #define _NBL_COMPILE_WITH_ZIP_ENCRYPTION_
 
@@ -0,0 +1,211 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_C_BLOCK_COMPRESS_IMAGE_FILTER_H_INCLUDED_
+#define _NBL_ASSET_C_BLOCK_COMPRESS_IMAGE_FILTER_H_INCLUDED_
+
+#include "nbl/core/declarations.h"
+
+#include "nbl/asset/filters/CMatchedSizeInOutImageFilterCommon.h"
+#include "nbl/asset/format/decodePixels.h"
+
+namespace nbl::asset
+{
+
+//! Block Compression Filter
+/*
+	Encodes an uncompressed input image into a block compressed output image, so textures can be baked without external tools.
+	The input has to be \bEF_R8G8B8A8_UNORM\b, \bEF_R8G8B8A8_SRGB\b or \bEF_R16G16B16A16_SFLOAT\b, the output
+	BC1, BC3, BC4 or BC5 (UNORM or SRGB), BC6H or BC7. There's no color space conversion, an sRGB input needs an sRGB output and vice versa.
+	LDR outputs clamp float inputs to [0,1], BC4 takes the red channel and BC5 the red and green ones.
+
+	Every output block gets encoded on its own, so blocks are spread over the threads of the \bExecutionPolicy\b.
+	Texels of a block which lie past the end of the mip level get replaced by the nearest one inside it.
+
+	BC7 is only encoded with the single subset mode 6 and BC6H with the single region mode 11 (10 bit endpoints),
+	the \bquality\b preset decides how much work goes into finding the endpoints.
+
+	@see IImageFilter
+	@see CMatchedSizeInOutImageFilterCommon
+*/
+class CBlockCompressImageFilter : public CImageFilter<CBlockCompressImageFilter>, public CMatchedSizeInOutImageFilterCommon
+{
+	public:
+		virtual ~CBlockCompressImageFilter() {}
+
+		enum E_QUALITY : uint8_t
+		{
+			//! endpoints straight from the principal axis of the block's colors
+			EQ_FAST,
+			//! one least squares refit of the endpoints to the chosen indices, both BC4 interpolation modes get tried
+			EQ_NORMAL,
+			//! a few refits, all BC7 parity bit combinations and the BC1 3 color mode for opaque blocks get tried
+			EQ_HIGH
+		};
+
+		class CState : public CMatchedSizeInOutImageFilterCommon::CState
+		{
+			public:
+				virtual ~CState() {}
+
+				E_QUALITY quality = EQ_NORMAL;
+		};
+		using state_type = CState;
+
+		//! 4x4 texels in row major order stored channel by channel, UNORM inputs are normalized to [0,1]
+		struct SInputBlock
+		{
+			float channels[4][16];
+		};
+
+		static inline bool isSupportedInputFormat(const E_FORMAT format)
+		{
+			switch (format)
+			{
+				case EF_R8G8B8A8_UNORM:
+				case EF_R8G8B8A8_SRGB:
+				case EF_R16G16B16A16_SFLOAT:
+					return true;
+				default:
+					return false;
+			}
+		}
+		static inline bool isSupportedOutputFormat(const E_FORMAT format)
+		{
+			switch (format)
+			{
+				case EF_BC1_RGB_UNORM_BLOCK:
+				case EF_BC1_RGB_SRGB_BLOCK:
+				case EF_BC1_RGBA_UNORM_BLOCK:
+				case EF_BC1_RGBA_SRGB_BLOCK:
+				case EF_BC3_UNORM_BLOCK:
+				case EF_BC3_SRGB_BLOCK:
+				case EF_BC4_UNORM_BLOCK:
+				case EF_BC5_UNORM_BLOCK:
+				case EF_BC6H_UFLOAT_BLOCK:
+				case EF_BC6H_SFLOAT_BLOCK:
+				case EF_BC7_UNORM_BLOCK:
+				case EF_BC7_SRGB_BLOCK:
+					return true;
+				default:
+					return false;
+			}
+		}
+
+		static inline bool validate(state_type* state)
+		{
+			if (!CMatchedSizeInOutImageFilterCommon::validate(state))
+				return false;
+
+			const E_FORMAT inFormat = state->inImage->getCreationParameters().format;
+			const E_FORMAT outFormat = state->outImage->getCreationParameters().format;
+			if (!isSupportedInputFormat(inFormat) || !isSupportedOutputFormat(outFormat))
+				return false;
+			if (isSRGBFormat(inFormat)!=isSRGBFormat(outFormat))
+				return false;
+
+			// a block only partially covered by the extent would overwrite texels outside of it, unless they're past the end of the mip level
+			const core::vectorSIMDu32 blockDims = asset::getBlockDimensions(outFormat);
+			const core::vectorSIMDu32 outOffset(state->outOffset.x,state->outOffset.y,state->outOffset.z,0u);
+			const core::vectorSIMDu32 outLimit = outOffset+core::vectorSIMDu32(state->extent.width,state->extent.height,state->extent.depth,0u);
+			const core::vectorSIMDu32 mipSize = state->outImage->getMipSize(state->outMipLevel);
+			for (uint32_t i=0u; i<3u; i++)
+			if (outOffset[i]%blockDims[i] || (outLimit[i]%blockDims[i] && outLimit[i]!=mipSize[i]))
+				return false;
+
+			return true;
+		}
+
+		template<class ExecutionPolicy>
+		static inline bool execute(ExecutionPolicy&& policy, state_type* state)
+		{
+			if (!validate(state))
+				return false;
+
+			const auto* const inImg = state->inImage;
+			auto* const outImg = state->outImage;
+			const E_FORMAT inFormat = inImg->getCreationParameters().format;
+			const E_FORMAT outFormat = outImg->getCreationParameters().format;
+			const uint8_t* const inData = reinterpret_cast<const uint8_t*>(inImg->getBuffer()->getPointer());
+			uint8_t* const outData = reinterpret_cast<uint8_t*>(outImg->getBuffer()->getPointer());
+			const std::span<const IImage::SBufferCopy> inRegions = inImg->getRegions(state->inMipLevel);
+			const TexelBlockInfo inBlockInfo(inFormat);
+			const core::vectorSIMDu32 blockDims = asset::getBlockDimensions(outFormat);
+
+			// texels past the last one of the extent get clamped to it
+			const core::vectorSIMDu32 inLast = state->inOffsetBaseLayer+state->extentLayerCount-core::vectorSIMDu32(1u,1u,1u,1u);
+			// offset types are uint but the two's complement wraparound makes this work
+			const core::vectorSIMDu32 outToIn = state->inOffsetBaseLayer-state->outOffsetBaseLayer;
+			const E_QUALITY quality = state->quality;
+			auto encode = [&](const uint64_t writeBlockByteOffset, const core::vectorSIMDu32& writeBlockPos) -> void
+			{
+				core::vectorSIMDu32 firstTexel = writeBlockPos*blockDims;
+				firstTexel.w = writeBlockPos.w;
+				firstTexel += outToIn;
+
+				SInputBlock block;
+				// texels of a block almost always come from the same region
+				const IImage::SBufferCopy* region = nullptr;
+				core::vectorSIMDu32 regionOffset, regionLimit, regionByteStrides;
+				for (uint32_t y=0u; y<4u; y++)
+				for (uint32_t x=0u; x<4u; x++)
+				{
+					const core::vectorSIMDu32 texel = core::min<core::vectorSIMDu32>(firstTexel+core::vectorSIMDu32(x,y,0u,0u),inLast);
+					if (!region || (texel<regionOffset).any() || (texel>=regionLimit).any())
+					{
+						region = nullptr;
+						for (const auto& candidate : inRegions)
+						{
+							regionOffset = core::vectorSIMDu32(candidate.imageOffset.x,candidate.imageOffset.y,candidate.imageOffset.z,candidate.imageSubresource.baseArrayLayer);
+							regionLimit = regionOffset+core::vectorSIMDu32(candidate.imageExtent.width,candidate.imageExtent.height,candidate.imageExtent.depth,candidate.imageSubresource.layerCount);
+							if ((texel>=regionOffset).all() && (texel<regionLimit).all())
+							{
+								region = &candidate;
+								regionByteStrides = candidate.getByteStrides(inBlockInfo);
+								break;
+							}
+						}
+					}
+
+					const uint32_t texelIx = y*4u+x;
+					if (!region)
+					{
+						for (uint32_t c=0u; c<4u; c++)
+							block.channels[c][texelIx] = 0.f;
+						continue;
+					}
+					const uint8_t* const src = inData+region->getByteOffset(texel-regionOffset,regionByteStrides);
+					if (inFormat==EF_R16G16B16A16_SFLOAT)
+					{
+						float decoded[4];
+						impl::decodef16<float,4u>(src,decoded);
+						for (uint32_t c=0u; c<4u; c++)
+							block.channels[c][texelIx] = decoded[c];
+					}
+					else
+					for (uint32_t c=0u; c<4u; c++)
+						block.channels[c][texelIx] = float(src[c])/255.f;
+				}
+
+				encodeBlock(outFormat,quality,block,outData+writeBlockByteOffset);
+			};
+
+			IImage::SSubresourceLayers subresource = {static_cast<IImage::E_ASPECT_FLAGS>(0u),state->outMipLevel,state->outBaseLayer,state->layerCount};
+			state_type::TexelRange range = {state->outOffset,state->extent};
+			CBasicImageFilterCommon::clip_region_functor_t clip(subresource,range,outFormat);
+			CBasicImageFilterCommon::executePerRegion(policy,outImg,encode,outImg->getRegions(state->outMipLevel),clip);
+
+			return true;
+		}
+		static inline bool execute(state_type* state)
+		{
+			return execute(core::execution::seq,state);
+		}
+
+		//! Encodes a single block of any of the supported output formats, LDR formats clamp the input to [0,1]
+		static NBL_API2 void encodeBlock(const E_FORMAT format, const E_QUALITY quality, const SInputBlock& block, uint8_t* out);
+};
+
+} // end namespace nbl::asset
+
+#endif
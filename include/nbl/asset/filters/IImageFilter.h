@@ -29,6 +29,7 @@ namespace asset
 	- Swizzle && Convert Filter
 	- Blit Filter
 	- Generate Mip Maps Filter
+	- Block Compress Filter
 
 	If you don't know what filter you'll be executing at runtime, 
 	you can use the \ipolymorphic interface\i and operate on 
@@ -109,7 +109,9 @@ class NBL_API2 IAssetLoader : public virtual core::IReferenceCounted
 				loaderFlags(rhs.loaderFlags),
 				meshManipulatorOverride(rhs.meshManipulatorOverride),
 				logger(rhs.logger),
-				workingDirectory(rhs.workingDirectory)
+				workingDirectory(rhs.workingDirectory),
+				maxSubAssetLoadConcurrency(rhs.maxSubAssetLoadConcurrency),
+				userData(rhs.userData)
 			{
 			}
 
@@ -120,6 +122,11 @@ class NBL_API2 IAssetLoader : public virtual core::IReferenceCounted
 			IMeshManipulator* meshManipulatorOverride = nullptr;    //!< pointer used for specifying custom mesh manipulator to use, if nullptr - default mesh manipulator will be used
 			std::filesystem::path workingDirectory = "";
 			system::logger_opt_ptr logger;
+			//! How many sub-assets (e.g. a scene's textures) a loader may have loading at once on the asset manager's workers, 0 means a few per hardware thread, 1 loads them one by one on the calling thread
+			uint32_t maxSubAssetLoadConcurrency = 0u;
+			//! Stores loader-dependent parameters, it is usually a struct provided by a loader author (see `SAssetWriteParams::userData`).
+			//! Loaders only read it for the asset requested at the top of the hierarchy, never for the sub-assets they load.
+			const void* userData = nullptr;
 		};
 
 		//! Struct for keeping the state of the current loadoperation for safe threading
@@ -280,9 +287,36 @@ class NBL_API2 IAssetLoader : public virtual core::IReferenceCounted
 		\return True if file seems to be loadable. */
 		virtual bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger = nullptr) const = 0;
 
+		//! How many bytes from the start of a file `IAssetManager` reads once and hands to every loader it probes
+		static inline constexpr size_t ProbeHeaderSize = 4096ull;
+		//! Same as above, but `_header` already holds the first `min(ProbeHeaderSize,_file->getSize())` bytes of the file.
+		/** Override this if the check can be made from the header alone, then probing costs no I/O.
+		The default implementation falls back to the overload above. */
+		virtual bool isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger = nullptr) const
+		{
+			return isALoadableFileFormat(_file,logger);
+		}
+
+		//! Bytes found at a fixed offset in every file of a format
+		struct SFileMagic
+		{
+			uint32_t offset = 0u;
+			std::span<const uint8_t> bytes;
+
+			inline bool matches(const std::span<const uint8_t> _header) const
+			{
+				return offset+bytes.size()<=_header.size() && memcmp(_header.data()+offset,bytes.data(),bytes.size())==0;
+			}
+		};
+		//! Loaders whose magic matches a file's header get tried first, regardless of the file's extension
+		virtual std::span<const SFileMagic> getFileMagics() const { return {}; }
+
 		//! Returns an array of string literals terminated by nullptr
 		virtual const char** getAssociatedFileExtensions() const = 0;
 
+		//! Loaders which adopt regions of the file's mapping as asset storage (see `system::CMappedFileMemoryResource`) get handed a copy-on-write mapping
+		virtual bool adoptsMappedMemory() const { return false; }
+
 		//! Returns the assets loaded by the loader
 		/** Bits of the returned value correspond to each IAsset::E_TYPE
 		enumeration member, and the return value cannot be 0. */
@@ -297,6 +331,16 @@ class NBL_API2 IAssetLoader : public virtual core::IReferenceCounted
 		// accessors for loaders
 		SAssetBundle interm_getAssetInHierarchy(IAssetManager* _mgr, system::IFile* _file, const std::string& _supposedFilename, const IAssetLoader::SAssetLoadParams& _params, uint32_t _hierarchyLevel, IAssetLoader::IAssetLoaderOverride* _override);
 		SAssetBundle interm_getAssetInHierarchy(IAssetManager* _mgr, const std::string& _filename, const IAssetLoader::SAssetLoadParams& _params, uint32_t _hierarchyLevel, IAssetLoader::IAssetLoaderOverride* _override);
+		// sub-asset loads get started on the asset manager's workers, waiting runs any which didn't start yet on the calling thread
+		void interm_getAssetsInHierarchyAsync(IAssetManager* _mgr, std::span<system::ISystem::future_t<SAssetBundle>> _bundles, std::span<const std::string> _filenames, const IAssetLoader::SAssetLoadParams& _params, uint32_t _hierarchyLevel, IAssetLoader::IAssetLoaderOverride* _override);
+		SAssetBundle interm_waitForAssetInHierarchy(IAssetManager* _mgr, system::ISystem::future_t<SAssetBundle>& _bundle, const std::string& _filename, const IAssetLoader::SAssetLoadParams& _params, uint32_t _hierarchyLevel, IAssetLoader::IAssetLoaderOverride* _override);
+		// loads a batch of sub-assets with at most `_params.maxSubAssetLoadConcurrency` in flight, bundles come back in the order of `_loads`
+		struct SSubAssetLoad
+		{
+			std::string filename;
+			uint32_t hierarchyLevel;
+		};
+		core::vector<SAssetBundle> interm_getAssetsInHierarchy(IAssetManager* _mgr, std::span<const SSubAssetLoad> _loads, const IAssetLoader::SAssetLoadParams& _params, IAssetLoader::IAssetLoaderOverride* _override);
 		// only the overload we use for now
 		SAssetBundle interm_getAssetInHierarchyWithAllContent(IAssetManager* _mgr, const std::string& _filename, const IAssetLoader::SAssetLoadParams& _params, uint32_t _hierarchyLevel, IAssetLoader::IAssetLoaderOverride* _override);
 
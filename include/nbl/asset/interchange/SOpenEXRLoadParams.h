@@ -0,0 +1,35 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_S_OPENEXR_LOAD_PARAMS_H_INCLUDED_
+#define _NBL_ASSET_S_OPENEXR_LOAD_PARAMS_H_INCLUDED_
+
+#include "nbl/core/declarations.h"
+
+namespace nbl::asset
+{
+
+//! Pass through `IAssetLoader::SAssetLoadParams::userData` to load only part of an .exr
+/*
+	Only the chunks (scanline blocks or tiles) overlapping the window get read and decompressed.
+	A partial load gets cached under the file's name like a full one would, so load with `ECF_DONT_CACHE_TOP_LEVEL` if the same file is loaded differently elsewhere.
+*/
+struct SOpenEXRLoadParams
+{
+	//! Layers to load, named by their channels' prefix (`"albedo"` for `albedo.R`, `""` for plain `R`), empty loads all of them
+	core::vector<std::string> layers = {};
+	//! Channels of each layer that become the components of the image, in order, so 1 to 4 of them.
+	//! Channels missing from the file get filled with 0, or 1 for `"A"`.
+	core::vector<std::string> channels = {"R","G","B","A"};
+	//! Pixel window relative to the chosen level's data window, an extent of 0 reaches the end of the data window
+	uint32_t windowOffset[2] = {0u,0u};
+	uint32_t windowExtent[2] = {0u,0u};
+	//! Level of a tiled, mipmapped file, scanline files only have level 0
+	uint32_t mipLevel = 0u;
+	//! Threads OpenEXR may decompress this file with, 0 means as many as there are hardware threads
+	uint32_t threadCount = 0u;
+};
+
+}
+
+#endif
@@ -0,0 +1,35 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_S_PNG_WRITE_PARAMS_H_INCLUDED_
+#define _NBL_ASSET_S_PNG_WRITE_PARAMS_H_INCLUDED_
+
+#include "nbl/core/declarations.h"
+
+namespace nbl::asset
+{
+
+//! Pass through `IAssetWriter::SAssetWriteParams::userData` to pick how PNG rows get filtered
+/*
+	How hard the rows get compressed afterwards comes from `EWF_COMPRESSED` and the compression level, like for every other writer.
+*/
+struct SPNGWriteParams
+{
+	//! Filters predict each byte from its neighbours, so that deflate sees smaller numbers
+	enum class E_FILTER_STRATEGY : uint8_t
+	{
+		NONE,
+		SUB,
+		UP,
+		AVERAGE,
+		PAETH,
+		//! per row, the filter leaving the smallest sum of absolute (signed) bytes, like libpng does
+		ADAPTIVE
+	};
+
+	E_FILTER_STRATEGY filter = E_FILTER_STRATEGY::ADAPTIVE;
+};
+
+}
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef _NBL_SYSTEM_C_BUFFERED_FILE_STREAM_H_INCLUDED_
+#define _NBL_SYSTEM_C_BUFFERED_FILE_STREAM_H_INCLUDED_
+
+
+#include "nbl/system/IFile.h"
+
+
+namespace nbl::system
+{
+
+//! Sequential reader for parsers, the next chunk is always being read in the background while the current window gets consumed.
+// The window is mutable and always followed by a null byte, so text parsers can tokenize in place.
+// Unconsumed bytes carry over in front of the next chunk on `refill()`, so a token never straddles two buffers.
+class CBufferedFileStream final
+{
+	public:
+		constexpr static inline size_t DefaultChunkSize = 64ull<<10ull;
+
+		//! `file` must outlive the stream
+		inline CBufferedFileStream(IFile* file, const size_t offset=0ull, const size_t chunkSize=DefaultChunkSize)
+			: m_file(file), m_chunkSize(chunkSize), m_headroom(chunkSize), m_nextReadOffset(offset), m_windowEndOffset(offset)
+		{
+			m_front.resize(m_headroom+m_chunkSize+1ull,std::byte(0));
+			m_begin = m_end = m_headroom;
+			readAhead();
+		}
+		// future is the last member, so any in-flight read completes before the buffers go away
+		~CBufferedFileStream() = default;
+
+		//! Current window of unconsumed bytes
+		inline std::byte* data() {return m_front.data()+m_begin;}
+		inline const std::byte* data() const {return m_front.data()+m_begin;}
+		inline size_t size() const {return m_end-m_begin;}
+
+		//! Offset in the file of `data()`
+		inline size_t tell() const {return m_windowEndOffset-size();}
+
+		//! Nothing left to fetch, the current window is all there is
+		inline bool eof() const {return !m_pending;}
+
+		//!
+		inline void consume(const size_t bytes)
+		{
+			m_begin += std::min(bytes,size());
+		}
+
+		//! Appends the prefetched chunk to the unconsumed bytes and kicks off the next read-ahead, returns false if no new bytes arrived.
+		inline bool refill()
+		{
+			if (!m_pending)
+				return false;
+			m_pending = false;
+
+			size_t received = 0ull;
+			if (auto lock=m_readAhead.acquire())
+			{
+				received = *lock;
+				lock.discard();
+			}
+
+			const size_t leftover = size();
+			size_t newBegin;
+			if (leftover>m_headroom)
+			{
+				// caller is holding onto more than a chunk, so we need to grow the headroom
+				core::vector<std::byte> merged(leftover+m_chunkSize+1ull);
+				memcpy(merged.data(),data(),leftover);
+				memcpy(merged.data()+leftover,m_back.data()+m_headroom,received);
+				m_back = std::move(merged);
+				m_headroom = leftover;
+				newBegin = 0ull;
+			}
+			else
+			{
+				newBegin = m_headroom-leftover;
+				memcpy(m_back.data()+newBegin,data(),leftover);
+			}
+			std::swap(m_front,m_back);
+			m_begin = newBegin;
+			m_end = m_headroom+received;
+			m_front[m_end] = std::byte(0);
+			m_windowEndOffset += received;
+
+			// a short read means we hit the end of the file
+			if (received==m_requested)
+				readAhead();
+			return received!=0ull;
+		}
+
+		//! Copies out `bytes` refilling as needed, returns how many bytes could actually be read
+		inline size_t read(void* dst, size_t bytes)
+		{
+			auto* out = reinterpret_cast<std::byte*>(dst);
+			size_t bytesRead = 0ull;
+			while (bytesRead<bytes)
+			{
+				if (size()==0ull && !refill())
+					break;
+				const size_t toCopy = std::min(bytes-bytesRead,size());
+				memcpy(out+bytesRead,data(),toCopy);
+				consume(toCopy);
+				bytesRead += toCopy;
+			}
+			return bytesRead;
+		}
+
+	private:
+		inline void readAhead()
+		{
+			const size_t fileSize = m_file->getSize();
+			m_requested = m_nextReadOffset<fileSize ? std::min(m_chunkSize,fileSize-m_nextReadOffset):0ull;
+			if (m_requested==0ull)
+				return;
+			m_back.resize(m_headroom+m_chunkSize+1ull);
+			m_file->read(m_readAhead,m_back.data()+m_headroom,m_nextReadOffset,m_requested);
+			m_nextReadOffset += m_requested;
+			m_pending = true;
+		}
+
+		IFile* const m_file;
+		const size_t m_chunkSize;
+		// bytes reserved in front of every chunk for carrying over the unconsumed tail of the previous window
+		size_t m_headroom;
+		size_t m_nextReadOffset;
+		size_t m_windowEndOffset;
+		size_t m_requested = 0ull;
+		size_t m_begin = 0ull, m_end = 0ull;
+		bool m_pending = false;
+		core::vector<std::byte> m_front, m_back;
+		ISystem::future_t<size_t> m_readAhead;
+};
+
+}
+
+#endif
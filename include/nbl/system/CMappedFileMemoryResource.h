@@ -0,0 +1,63 @@
+#ifndef _NBL_SYSTEM_C_MAPPED_FILE_MEMORY_RESOURCE_H_INCLUDED_
+#define _NBL_SYSTEM_C_MAPPED_FILE_MEMORY_RESOURCE_H_INCLUDED_
+
+
+#include "nbl/core/alloc/refctd_memory_resource.h"
+
+#include "nbl/system/IFile.h"
+
+
+namespace nbl::system
+{
+
+//! Lets regions of a mapped `IFile` serve as adopted storage (e.g. of an `asset::ICPUBuffer`) without any copies.
+// The file and therefore its mapping are kept alive for as long as anything holds onto the resource.
+// Only writable mappings qualify, so a read-only file has to be opened with `IFile::ECF_COPY_ON_WRITE` for its regions to back mutable objects.
+class NBL_API2 CMappedFileMemoryResource final : public core::refctd_memory_resource
+{
+	public:
+		enum class E_ACCESS_PATTERN : uint8_t
+		{
+			NORMAL,
+			SEQUENTIAL,
+			RANDOM,
+			//! start paging the region in right away
+			WILL_NEED
+		};
+
+		//! returns nullptr if the file is not mapped, or mapped read-only without `IFile::ECF_COPY_ON_WRITE`
+		static core::smart_refctd_ptr<CMappedFileMemoryResource> create(core::smart_refctd_ptr<IFile>&& file);
+
+		//! Pointer to `size` bytes at `offset` in the mapping (nullptr if out of bounds), `pattern` is forwarded to the OS as a paging hint
+		void* getRegion(const size_t offset, const size_t size, const E_ACCESS_PATTERN pattern=E_ACCESS_PATTERN::NORMAL) const;
+
+		//! Alignment to claim for storage adopted from `getRegion(offset,...)`, the largest power of two its address is a multiple of, capped at `_NBL_SIMD_ALIGNMENT`
+		inline size_t getAlignment(const size_t offset) const
+		{
+			const uintptr_t address = reinterpret_cast<uintptr_t>(m_mapping+offset);
+			return std::min<size_t>(address&(~address+1ull),_NBL_SIMD_ALIGNMENT);
+		}
+
+		//!
+		inline const IFile* getFile() const {return m_file.get();}
+
+	private:
+		// there's nothing to allocate from, regions get adopted and the mapping goes away with the file
+		class CPMR final : public std::pmr::memory_resource
+		{
+			protected:
+				inline void* do_allocate(size_t bytes, size_t alignment) override {return nullptr;}
+				inline void do_deallocate(void* p, size_t bytes, size_t alignment) override {}
+				inline bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {return this==&other;}
+		};
+
+		inline CMappedFileMemoryResource(core::smart_refctd_ptr<IFile>&& file, std::byte* mapping) : core::refctd_memory_resource(&m_pmr), m_file(std::move(file)), m_mapping(mapping) {}
+
+		CPMR m_pmr;
+		const core::smart_refctd_ptr<IFile> m_file;
+		std::byte* const m_mapping;
+};
+
+}
+
+#endif
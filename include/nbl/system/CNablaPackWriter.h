@@ -0,0 +1,38 @@
+#ifndef _NBL_SYSTEM_C_NABLA_PACK_WRITER_H_INCLUDED_
+#define _NBL_SYSTEM_C_NABLA_PACK_WRITER_H_INCLUDED_
+
+
+#include "nbl/system/IFile.h"
+#include "nbl/system/SNablaPackFormat.h"
+
+
+namespace nbl::system
+{
+
+//! Builds a Nabla pack out of a set of files, see `SNablaPackFormat` for the layout.
+class NBL_API2 CNablaPackWriter final
+{
+	public:
+		using E_CODEC = SNablaPackFormat::E_CODEC;
+
+		//! `file` needs to be readable and stay unchanged until `write` returns, returns false if the path is already in the pack
+		bool addEntry(const path& pathRelativeToPack, core::smart_refctd_ptr<IFile>&& file, const E_CODEC codec=E_CODEC::LZ4);
+
+		//! Entries get hashed and compressed in parallel, those which don't shrink get stored instead
+		bool write(IFile* output, const system::logger_opt_ptr logger=nullptr) const;
+
+		inline size_t getEntryCount() const {return m_entries.size();}
+
+	private:
+		struct SEntry
+		{
+			std::string genericPath;
+			core::smart_refctd_ptr<IFile> file;
+			E_CODEC codec;
+		};
+		core::vector<SEntry> m_entries;
+};
+
+}
+
+#endif
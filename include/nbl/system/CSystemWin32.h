@@ -20,6 +20,11 @@ class NBL_API2 CSystemWin32 : public ISystem
                 CCaller(ISystem* _system) : ICaller(_system) {}
 
                 core::smart_refctd_ptr<ISystemFile> createFile(const std::filesystem::path& filename, const core::bitflag<IFile::E_CREATE_FLAGS> flags) override final;
+
+                // `CFileWin32` passes offsets via OVERLAPPED, so it never races on the file pointer
+                inline uint32_t getIOWorkerCount() const override {return defaultIOWorkerCount();}
+
+                size_t prefetch(const std::filesystem::path& filename, const size_t size) override final;
         };
         
     public:
@@ -486,6 +486,29 @@ class IAsyncQueueDispatcher : public IThreadHandler<CRTP,InternalStateType>, pro
                 base_t::m_cvar.notify_one();
             }
         }
+        //! Same as `request` but returns false instead of waiting when the circular buffer is full, for callers which the worker itself could be waiting on.
+        template<typename T, typename... Args>
+        bool try_request(future_t<T>* _future, Args&&... args)
+        {
+            // only claim an output index if its slot has already been consumed
+            counter_t virtualIx = cb_end.load();
+            do
+            {
+                if (virtualIx-cb_begin.load()>=MaxRequestCount)
+                    return false;
+            } while (!cb_end.compare_exchange_weak(virtualIx,virtualIx+1u));
+
+            request_t& req = request_pool[wrapAround(virtualIx)];
+            req.start();
+            req.m_metadata = request_metadata_t(std::forward<Args>(args)...);
+            req.finalize(_future);
+
+            {
+                auto global_lk = base_t::createLock();
+                base_t::m_cvar.notify_one();
+            }
+            return true;
+        }
 
     protected:
         inline ~IAsyncQueueDispatcher() {}
@@ -43,6 +43,41 @@ class IFile : public IFileBase, private ISystem::IFutureManipulator
 			setLastWriteTime();
 		}
 
+		//! Vectored positional read, all `ranges` get serviced by a single request (in any order) and `fut` receives the total bytes read.
+		// Both the `ranges` array and the buffers it points to need to stay alive until the future is ready.
+		inline void readv(ISystem::future_t<size_t>& fut, const std::span<const SReadRange> ranges)
+		{
+			const IFileBase* constThis = this;
+			const auto* ptr = reinterpret_cast<const std::byte*>(constThis->getMappedPointer());
+			if (ptr || ranges.empty())
+			{
+				const size_t size = getSize();
+				size_t bytesRead = 0ull;
+				for (const auto& range : ranges)
+				if (range.offset<size)
+				{
+					const size_t sizeToRead = std::min(range.size,size-range.offset);
+					memcpy(range.buffer,ptr+range.offset,sizeToRead);
+					bytesRead += sizeToRead;
+				}
+				set_result(fut,bytesRead);
+			}
+			else
+				unmappedReadv(fut,ranges);
+		}
+
+		//! Scatter-read meant for lots of tiny ranges, same lifetime rules and result as `readv`.
+		// Ranges may be unsorted and may overlap, ones close enough to each other get coalesced into a single large read before being scattered,
+		// so metadata-heavy parsing costs a handful of syscalls and a single future instead of a round-trip per field.
+		inline void readBatch(ISystem::future_t<size_t>& fut, const std::span<const SReadRange> ranges)
+		{
+			const IFileBase* constThis = this;
+			if (constThis->getMappedPointer() || ranges.empty())
+				readv(fut,ranges);
+			else
+				unmappedReadBatch(fut,ranges);
+		}
+
 		//! Less verbose future handling
 		struct success_t
 		{
@@ -89,10 +124,26 @@ class IFile : public IFileBase, private ISystem::IFutureManipulator
 			write(fut.m_internalFuture,buffer,offset,sizeToWrite);
 			fut.sizeToProcess = sizeToWrite;
 		}
+		void readv(success_t& fut, const std::span<const SReadRange> ranges)
+		{
+			readv(fut.m_internalFuture,ranges);
+			fut.sizeToProcess = 0ull;
+			for (const auto& range : ranges)
+				fut.sizeToProcess += range.size;
+		}
+		void readBatch(success_t& fut, const std::span<const SReadRange> ranges)
+		{
+			readBatch(fut.m_internalFuture,ranges);
+			fut.sizeToProcess = 0ull;
+			for (const auto& range : ranges)
+				fut.sizeToProcess += range.size;
+		}
 
 	protected:
 		// this is an abstract interface class so this stays protected
 		using IFileBase::IFileBase;
+		// so that files which service unmapped I/O themselves can complete the futures
+		using ISystem::IFutureManipulator::set_result;
 
 		//
 		virtual void unmappedRead(ISystem::future_t<size_t>& fut, void* buffer, size_t offset, size_t sizeToRead)
@@ -103,6 +154,23 @@ class IFile : public IFileBase, private ISystem::IFutureManipulator
 		{
 			set_result(fut,0ull);
 		}
+		// fallback for files which can't batch, blocks till every range is read
+		virtual void unmappedReadv(ISystem::future_t<size_t>& fut, const std::span<const SReadRange> ranges)
+		{
+			size_t bytesRead = 0ull;
+			for (const auto& range : ranges)
+			{
+				ISystem::future_t<size_t> rangeFut;
+				unmappedRead(rangeFut,range.buffer,range.offset,range.size);
+				if (rangeFut.wait())
+					bytesRead += *rangeFut.get();
+			}
+			set_result(fut,bytesRead);
+		}
+		virtual void unmappedReadBatch(ISystem::future_t<size_t>& fut, const std::span<const SReadRange> ranges)
+		{
+			unmappedReadv(fut,ranges);
+		}
 };
 
 }
@@ -114,6 +114,12 @@ class IFileArchive : public core::IReferenceCounted
 		// List all files and directories in a specific dir of the archive
 		NBL_API2 SFileList listAssets(path pathRelativeToArchive) const;
 
+		//
+		inline bool exists(const path& pathRelativeToArchive) const
+		{
+			return bool(getItemFromPath(pathRelativeToArchive));
+		}
+
 		//
 		inline core::smart_refctd_ptr<IFile> getFile(const path& pathRelativeToArchive, const core::bitflag<IFileBase::E_CREATE_FLAGS> flags, const std::string_view& password)
 		{
@@ -129,6 +135,11 @@ class IFileArchive : public core::IReferenceCounted
 			return getFile_impl(item,flags,password);
 		}
 
+		//! Opens (and therefore decompresses) many entries at once across all cores, keep the returned files alive for as long as they should stay resident.
+		// Comes back in the same order as `pathsRelativeToArchive` with `nullptr` for anything which could not be opened.
+		// Note that entries which get streamed (large deflated ZIP entries) still only decompress as they're read.
+		NBL_API2 core::vector<core::smart_refctd_ptr<IFile>> prefetchEntries(const std::span<const path> pathsRelativeToArchive, const std::string_view& password="");
+
 		//
 		inline const path& getDefaultAbsolutePath() const {return m_defaultAbsolutePath;}
 
@@ -140,7 +151,8 @@ class IFileArchive : public core::IReferenceCounted
 		//
 		virtual core::smart_refctd_ptr<IFile> getFile_impl(const SFileList::found_t& found, const core::bitflag<IFileBase::E_CREATE_FLAGS> flags, const std::string_view& password) = 0;
 
-		inline const SFileList::found_t getItemFromPath(const system::path& pathRelativeToArchive) const
+		// archives with their own lookup structure can override this to avoid needing the sorted list
+		virtual inline const SFileList::found_t getItemFromPath(const system::path& pathRelativeToArchive) const
 		{
             const SFileList::SEntry itemToFind = { pathRelativeToArchive };
 			// calling `listAssets` makes sure any "update list" overload can kick in
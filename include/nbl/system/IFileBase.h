@@ -25,7 +25,17 @@ class IFileBase : public core::IReferenceCounted
 			ECF_READ_WRITE = 0b0011,
 			ECF_MAPPABLE = 0b0100,
 			//! Implies ECF_MAPPABLE
-			ECF_COHERENT = 0b1100
+			ECF_COHERENT = 0b1100,
+			//! Implies ECF_MAPPABLE, a read-only mapping becomes private and writable, writes through it never reach the file
+			ECF_COPY_ON_WRITE = 0b10100
+		};
+
+		//! One element of a vectored read, lives here so that `ISystem` requests can refer to it
+		struct SReadRange
+		{
+			void* buffer;
+			size_t offset;
+			size_t size;
 		};
 
 		//! Get size of file.
@@ -6,6 +6,7 @@
 #include "nbl/core/util/bitflag.h"
 
 #include <variant>
+#include <thread>
 
 #include "nbl/system/IFileArchive.h"
 #include "nbl/system/IAsyncQueueDispatcher.h"
@@ -46,6 +47,11 @@ class NBL_API2 ISystem : public core::IReferenceCounted
                 {
                     future.set_result(value);
                 }
+                template<typename T>
+                inline void set_result(future_t<T>& future, T&& value) const
+                {
+                    future.set_result(std::move(value));
+                }
         };
 		
 		#ifndef NBL_EMBED_BUILTIN_RESOURCES
@@ -116,6 +122,12 @@ class NBL_API2 ISystem : public core::IReferenceCounted
             const std::string_view& accessToken="" // usually password for archives, but should be SSH key for URL downloads
         );
         
+        //! Warms up the OS page cache for files you're about to open (e.g. the whole asset set of a level) on the I/O workers.
+        // Files are taken in order until their cumulative size would exceed `byteBudget`, the rest are skipped.
+        // Each `readiness[i]` receives the number of bytes of `files[i]` which got prefetched, 0 when skipped, missing or inside an archive.
+        // On Windows that means the bytes are resident, on POSIX that the kernel was only asked to read them ahead (it may still be doing so, or drop the hint).
+        void prefetch(std::span<future_t<size_t>> readiness, std::span<const path> files, const size_t byteBudget=~0ull);
+
         // Create a IFileArchive from a IFile
         core::smart_refctd_ptr<IFileArchive> openFileArchive(core::smart_refctd_ptr<IFile>&& file, const std::string_view& password="");
         //! A utility method. Warning: blocking call
@@ -169,13 +181,21 @@ class NBL_API2 ISystem : public core::IReferenceCounted
         
 
     protected:
-        // all file operations take place serially on a dedicated thread (to make fibers possible in the future)
+        // file creation takes place serially on a dedicated thread (to make fibers possible in the future),
+        // reads and writes can be spread over a pool of additional I/O threads if the backend's files do positional I/O
         class ICaller : public core::IReferenceCounted
         {
             public:
                 // each per-platform backend must override this function
                 virtual core::smart_refctd_ptr<ISystemFile> createFile(const std::filesystem::path& filename, const core::bitflag<IFileBase::E_CREATE_FLAGS> flags) = 0;
 
+                // How many extra threads should service `ISystemFile::asyncRead` and `asyncWrite`, zero means they run on the same thread as `createFile`.
+                // Only return non-zero if your files' `asyncRead` and `asyncWrite` don't share a seek pointer (i.e. use `pread`/`pwrite` or OVERLAPPED offsets)
+                virtual inline uint32_t getIOWorkerCount() const {return 0u;}
+
+                // pull (or schedule pulling) the first `size` bytes of a file into the OS page cache, return how many bytes got prefetched (0 if unsupported)
+                virtual inline size_t prefetch(const std::filesystem::path& filename, const size_t size) {return 0ull;}
+
                 // these contain some hoisted common sense checks
                 bool invalidateMapping(IFile* file, size_t offset, size_t size);
                 bool flushMapping(IFile* file, size_t offset, size_t size);
@@ -184,6 +204,12 @@ class NBL_API2 ISystem : public core::IReferenceCounted
                 ICaller(ISystem* _system) : m_system(_system) {}
                 virtual ~ICaller() = default;
 
+                // for backends with positional I/O, past this many threads we're just contending on the block layer
+                static inline uint32_t defaultIOWorkerCount()
+                {
+                    return std::clamp(std::thread::hardware_concurrency(),2u,16u);
+                }
+
                 // TODO: maybe change the file type to `ISystemFile` ?
                 virtual bool invalidateMapping_impl(IFile* file, size_t offset, size_t size) { assert(false); return false; } // TODO
                 virtual bool flushMapping_impl(IFile* file, size_t offset, size_t size) { assert(false); return false; } // TODO
@@ -228,6 +254,14 @@ class NBL_API2 ISystem : public core::IReferenceCounted
             char filename[MAX_FILENAME_LENGTH] {};
             IFileBase::E_CREATE_FLAGS flags;
         };
+        struct SRequestParams_PREFETCH
+        {
+            using retval_t = size_t;
+            void operator()(core::StorageTrivializer<retval_t>* retval, ICaller* _caller);
+
+            char filename[MAX_FILENAME_LENGTH] {};
+            size_t size;
+        };
         struct SRequestParams_READ
         {
             using retval_t = size_t;
@@ -238,6 +272,27 @@ class NBL_API2 ISystem : public core::IReferenceCounted
             size_t offset;
             size_t size;
         };
+        struct SRequestParams_READV
+        {
+            using retval_t = size_t;
+            void operator()(core::StorageTrivializer<retval_t>* retval, ICaller* _caller);
+
+            ISystemFile* file;
+            const IFileBase::SReadRange* ranges;
+            size_t count;
+        };
+        struct SRequestParams_READ_BATCH
+        {
+            // ranges whose gap is at most this get serviced by one read, reading the gap is cheaper than another syscall
+            constexpr static inline size_t MaxCoalescingGap = 4096ull;
+
+            using retval_t = size_t;
+            void operator()(core::StorageTrivializer<retval_t>* retval, ICaller* _caller);
+
+            ISystemFile* file;
+            const IFileBase::SReadRange* ranges;
+            size_t count;
+        };
         struct SRequestParams_WRITE
         {
             using retval_t = size_t;
@@ -253,7 +308,10 @@ class NBL_API2 ISystem : public core::IReferenceCounted
             std::variant<
                 SRequestParams_NOOP,
                 SRequestParams_CREATE_FILE,
+                SRequestParams_PREFETCH,
                 SRequestParams_READ,
+                SRequestParams_READV,
+                SRequestParams_READ_BATCH,
                 SRequestParams_WRITE
             > params = SRequestParams_NOOP();
         };
@@ -277,7 +335,19 @@ class NBL_API2 ISystem : public core::IReferenceCounted
         // friendship needed to be able to know about the request types
         friend class ISystemFile;
 
+        // reads and writes get round-robined over the I/O workers, so many can be in flight and complete out of order
+        template<typename Request>
+        inline void requestIO(future_t<size_t>* future, const Request& params)
+        {
+            if (m_ioWorkers.empty())
+                m_dispatcher.request(future,params);
+            else
+                m_ioWorkers[m_nextIOWorker.fetch_add(1u,std::memory_order_relaxed)%m_ioWorkers.size()]->request(future,params);
+        }
+
         CAsyncQueue m_dispatcher;
+        core::vector<std::unique_ptr<CAsyncQueue>> m_ioWorkers;
+        std::atomic_uint32_t m_nextIOWorker = 0u;
 };
 
 }
@@ -31,7 +31,7 @@ class ISystemFile : public IFile
 			params.file = this;
 			params.offset = offset;
 			params.size = sizeToRead;
-			m_system->m_dispatcher.request(&fut,params);
+			m_system->requestIO(&fut,params);
 		}
 		inline void unmappedWrite(ISystem::future_t<size_t>& fut, const void* buffer, size_t offset, size_t sizeToWrite) override final
 		{
@@ -40,14 +40,40 @@ class ISystemFile : public IFile
 			params.file = this;
 			params.offset = offset;
 			params.size = sizeToWrite;
-			m_system->m_dispatcher.request(&fut,params);
+			m_system->requestIO(&fut,params);
+		}
+		inline void unmappedReadv(ISystem::future_t<size_t>& fut, const std::span<const SReadRange> ranges) override final
+		{
+			ISystem::SRequestParams_READV params;
+			params.file = this;
+			params.ranges = ranges.data();
+			params.count = ranges.size();
+			m_system->requestIO(&fut,params);
+		}
+		inline void unmappedReadBatch(ISystem::future_t<size_t>& fut, const std::span<const SReadRange> ranges) override final
+		{
+			ISystem::SRequestParams_READ_BATCH params;
+			params.file = this;
+			params.ranges = ranges.data();
+			params.count = ranges.size();
+			m_system->requestIO(&fut,params);
 		}
 
 		//
 		friend struct ISystem::SRequestParams_READ;
+		friend struct ISystem::SRequestParams_READ_BATCH;
 		virtual size_t asyncRead(void* buffer, size_t offset, size_t sizeToRead) = 0;
 		friend struct ISystem::SRequestParams_WRITE;
 		virtual size_t asyncWrite(const void* buffer, size_t offset, size_t sizeToWrite) = 0;
+		// override if the platform has something better than a loop of positional reads
+		friend struct ISystem::SRequestParams_READV;
+		virtual inline size_t asyncReadv(const std::span<const SReadRange> ranges)
+		{
+			size_t bytesRead = 0ull;
+			for (const auto& range : ranges)
+				bytesRead += asyncRead(range.buffer,range.offset,range.size);
+			return bytesRead;
+		}
 
 
 		core::smart_refctd_ptr<ISystem> m_system;
@@ -19,6 +19,11 @@ class ISystemPOSIX : public ISystem
                 inline CCaller(ISystemPOSIX* _system) : ICaller(_system) {}
 
                 NBL_API2 core::smart_refctd_ptr<ISystemFile> createFile(const std::filesystem::path& filename, const core::bitflag<IFile::E_CREATE_FLAGS> flags) override;
+
+                // `CFilePOSIX` uses `pread`/`pwrite` so any number of threads can service the same file
+                inline uint32_t getIOWorkerCount() const override {return defaultIOWorkerCount();}
+
+                NBL_API2 size_t prefetch(const std::filesystem::path& filename, const size_t size) override;
         };
 
         inline ISystemPOSIX() : ISystem(core::make_smart_refctd_ptr<CCaller>(this)) {}
@@ -0,0 +1,74 @@
+#ifndef _NBL_SYSTEM_S_NABLA_PACK_FORMAT_H_INCLUDED_
+#define _NBL_SYSTEM_S_NABLA_PACK_FORMAT_H_INCLUDED_
+
+
+#include <cstdint>
+#include <string_view>
+
+
+namespace nbl::system
+{
+
+//! On-disk layout of a Nabla pack (`.npk`), everything is little endian.
+// [SHeader][SIndexEntry x entryCount, sorted by `pathHash` then name][names blob][entry data, every entry starts 4kb aligned]
+// The index is meant to be used straight out of the mapped file, opening a pack never walks the entries.
+struct SNablaPackFormat
+{
+	constexpr static inline uint32_t Magic = 0x4b50424eu; // "NBPK"
+	constexpr static inline uint32_t Version = 1u;
+	// so that stored entries can be mapped (and handed out) without a copy
+	constexpr static inline uint64_t EntryAlignment = 4096ull;
+
+	enum class E_CODEC : uint8_t
+	{
+		NONE = 0,
+		LZ4 = 1,
+		DEFLATE = 2,
+		// reserved, Zstd is not vendored yet so neither the loader nor the writer support it
+		ZSTD = 3
+	};
+
+	struct SHeader
+	{
+		uint32_t magic = Magic;
+		uint32_t version = Version;
+		uint32_t entryCount = 0u;
+		uint32_t reserved = 0u;
+		uint64_t indexOffset = 0ull;
+		uint64_t namesOffset = 0ull;
+		uint64_t namesSize = 0ull;
+	};
+	static_assert(sizeof(SHeader)==40u);
+
+	struct SIndexEntry
+	{
+		uint64_t pathHash;
+		uint64_t offset;
+		uint64_t compressedSize;
+		uint64_t size;
+		// xxHash256 of the uncompressed contents, same as `IFileBase::getPrecomputedHash`
+		uint64_t contentHash[4];
+		// into the names blob, not null terminated
+		uint32_t nameOffset;
+		uint16_t nameLength;
+		E_CODEC codec;
+		uint8_t reserved;
+	};
+	static_assert(sizeof(SIndexEntry)==72u);
+
+	//! FNV-1a of the generic (forward slash separated) path relative to the pack root
+	static inline constexpr uint64_t hashPath(const std::string_view genericPath)
+	{
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (const char c : genericPath)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+};
+
+}
+
+#endif
@@ -47,6 +47,14 @@
 #include "nbl/asset/interchange/CImageLoaderOpenEXR.h"
 #endif
 
+#ifdef _NBL_COMPILE_WITH_KTX2_LOADER_
+#include "nbl/asset/interchange/CImageLoaderKTX2.h"
+#endif
+
+#ifdef _NBL_COMPILE_WITH_DDS_LOADER_
+#include "nbl/asset/interchange/CImageLoaderDDS.h"
+#endif
+
 #ifdef _NBL_COMPILE_WITH_GLI_LOADER_
 #include "nbl/asset/interchange/CGLILoader.h"
 #endif
@@ -157,6 +165,12 @@ void IAssetManager::addLoadersAndWriters()
 #ifdef _NBL_COMPILE_WITH_OPENEXR_LOADER_
 	addAssetLoader(core::make_smart_refctd_ptr<asset::CImageLoaderOpenEXR>(this));
 #endif
+#ifdef _NBL_COMPILE_WITH_KTX2_LOADER_
+	addAssetLoader(core::make_smart_refctd_ptr<asset::CImageLoaderKTX2>());
+#endif
+#ifdef _NBL_COMPILE_WITH_DDS_LOADER_
+	addAssetLoader(core::make_smart_refctd_ptr<asset::CImageLoaderDDS>());
+#endif
 #ifdef  _NBL_COMPILE_WITH_GLI_LOADER_
 	addAssetLoader(core::make_smart_refctd_ptr<asset::CGLILoader>());
 #endif 
@@ -230,17 +244,119 @@ SAssetBundle IAssetManager::getAssetInHierarchy_impl(system::IFile* _file, const
     if (!file)
         return {};//return empty bundle
 
-    auto ext = system::extension_wo_dot(filename);
-    auto capableLoadersRng = m_loaders.perFileExt.findRange(ext);
-    // loaders associated with the file's extension tryout
-    for (auto& loader : capableLoadersRng)
+    // only loads which will end up in the cache can be shared, everyone else asked for their own copy
+    std::shared_ptr<SInFlightLoad> inFlight;
+    bool ownsLoad = false;
+    if (((levelFlags & IAssetLoader::ECF_DONT_CACHE_TOP_LEVEL) != IAssetLoader::ECF_DONT_CACHE_TOP_LEVEL) &&
+        ((levelFlags & IAssetLoader::ECF_DUPLICATE_TOP_LEVEL) != IAssetLoader::ECF_DUPLICATE_TOP_LEVEL))
+    {
+        std::unique_lock lock(m_inFlightLoadsMutex);
+        auto found = m_inFlightLoads.find(filename.string());
+        if (found == m_inFlightLoads.end())
+        {
+            inFlight = std::make_shared<SInFlightLoad>();
+            m_inFlightLoads.emplace(filename.string(), inFlight);
+            ownsLoad = true;
+        }
+        else
+            inFlight = found->second;
+    }
+    // whichever way we leave (including a throwing loader), waiters must not be left hanging on an entry nobody will ever finish
+    auto finishInFlight = core::makeRAIIExiter([&]() -> void
+    {
+        if (!ownsLoad)
+            return;
+        {
+            std::unique_lock lock(m_inFlightLoadsMutex);
+            m_inFlightLoads.erase(filename.string());
+        }
+        {
+            std::unique_lock lock(inFlight->mutex);
+            inFlight->done = true;
+        }
+        inFlight->cvar.notify_all();
+    });
+    if (ownsLoad)
+    {
+        // someone could have finished loading and retired their entry between our cache lookup and registering ours
+        auto found = findAssets(filename.string());
+        if (found->size())
+            return _override->chooseRelevantFromFound(found->begin(), found->end(), ctx, _hierarchyLevel);
+    }
+    else if (inFlight && inFlight->loader != std::this_thread::get_id())
+    {
+        {
+            std::unique_lock lock(inFlight->mutex);
+            inFlight->cvar.wait(lock, [&inFlight]()->bool { return inFlight->done; });
+        }
+        // pick the result up the same way a cache hit would
+        auto found = findAssets(filename.string());
+        if (found->size())
+            return _override->chooseRelevantFromFound(found->begin(), found->end(), ctx, _hierarchyLevel);
+        return inFlight->result;
+    }
+
+    // read the start of the file once, every loader gets probed with it instead of issuing its own reads
+    std::array<uint8_t, IAssetLoader::ProbeHeaderSize> headerStorage;
+    std::span<const uint8_t> header;
+    {
+        const size_t headerSize = std::min<size_t>(file->getSize(), IAssetLoader::ProbeHeaderSize);
+        if (const auto* mapped = reinterpret_cast<const uint8_t*>(file->getMappedPointer()))
+            header = {mapped, headerSize};
+        else
+        {
+            system::IFile::success_t success;
+            file->read(success, headerStorage.data(), 0ull, headerSize);
+            if (success)
+                header = {headerStorage.data(), success.getBytesProcessed()};
+        }
+    }
+
+    // loaders adopting the mapping get the file reopened with a copy-on-write mapping, everyone else keeps the read-only one
+    core::smart_refctd_ptr<system::IFile> copyOnWriteFile;
+    auto getFileFor = [&](const IAssetLoader* loader) -> system::IFile*
+    {
+        if (!loader->adoptsMappedMemory() || !file->getMappedPointer() || core::bitflag(file->getFlags()).hasFlags(system::IFile::ECF_COPY_ON_WRITE))
+            return file.get();
+        if (!copyOnWriteFile)
+        {
+            system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
+            m_system->createFile(future, file->getFileName(), core::bitflag(file->getFlags())|system::IFile::ECF_COPY_ON_WRITE);
+            if (auto reopened = future.acquire(); reopened && reopened->get())
+                copyOnWriteFile = std::move(*reopened);
+            else // the loader falls back to reading
+                return file.get();
+        }
+        return copyOnWriteFile.get();
+    };
+    core::vector<IAssetLoader*> triedLoaders;
+    auto tryLoader = [&](IAssetLoader* loader) -> bool
+    {
+        if (std::find(triedLoaders.begin(), triedLoaders.end(), loader) != triedLoaders.end())
+            return false;
+        triedLoaders.push_back(loader);
+        return loader->isALoadableFileFormat(header, file.get()) && !(bundle = loader->loadAsset(getFileFor(loader), params, _override, _hierarchyLevel)).getContents().empty();
+    };
+    // loaders recognizing the file's magic number tryout
+    for (const auto& magic : m_loaders.perMagic)
     {
-        if (loader.second->isALoadableFileFormat(file.get()) && !(bundle = loader.second->loadAsset(file.get(), params, _override, _hierarchyLevel)).getContents().empty())
+        if (magic.first.matches(header) && tryLoader(magic.second))
             break;
     }
+    // loaders associated with the file's extension tryout
+    if (bundle.getContents().empty())
+    {
+        auto ext = system::extension_wo_dot(filename);
+        auto capableLoadersRng = m_loaders.perFileExt.findRange(ext);
+        for (auto& loader : capableLoadersRng)
+        {
+            if (tryLoader(loader.second))
+                break;
+        }
+    }
     for (auto loaderItr = std::begin(m_loaders.vector); bundle.getContents().empty() && loaderItr != std::end(m_loaders.vector); ++loaderItr) // all loaders tryout
     {
-        if ((*loaderItr)->isALoadableFileFormat(file.get()) && !(bundle = (*loaderItr)->loadAsset(file.get(), params, _override, _hierarchyLevel)).getContents().empty())
+        if (tryLoader(loaderItr->get()))
             break;
     }
 
@@ -256,10 +372,89 @@ SAssetBundle IAssetManager::getAssetInHierarchy_impl(system::IFile* _file, const
         bundle = _override->handleLoadFail(addToCache, file.get(), filename.string(), filename.string(), ctx, _hierarchyLevel);
         if (!bundle.getContents().empty() && addToCache)
             _override->insertAssetIntoCache(bundle, filename.string(), ctx, _hierarchyLevel);
-    }            
+    }
+
+    // by now the bundle is in the cache, so anyone coming later won't need to wait, `finishInFlight` retires the entry on the way out
+    if (ownsLoad)
+    {
+        std::unique_lock lock(inFlight->mutex);
+        inFlight->result = bundle;
+    }
     return bundle;
 }
 
+// the `CAsyncLoadQueue` whose thread this is, if any
+static thread_local const void* currentLoadWorker = nullptr;
+
+void IAssetManager::getAssetsAsync(std::span<system::ISystem::future_t<SAssetBundle>> _bundles, std::span<const system::path> _filePaths, const IAssetLoader::SAssetLoadParams& _params, IAssetLoader::IAssetLoaderOverride* _override)
+{
+    core::vector<std::string> filePaths(_filePaths.size());
+    for (size_t i = 0ull; i < _filePaths.size(); i++)
+        filePaths[i] = _filePaths[i].string();
+    getAssetsInHierarchyAsync(_bundles, filePaths, _params, 0u, _override);
+}
+
+void IAssetManager::getAssetsInHierarchyAsync(std::span<system::ISystem::future_t<SAssetBundle>> _bundles, std::span<const std::string> _filePaths, const IAssetLoader::SAssetLoadParams& _params, uint32_t _hierarchyLevel, IAssetLoader::IAssetLoaderOverride* _override)
+{
+    assert(_bundles.size() >= _filePaths.size());
+    std::call_once(m_loadWorkersCreated, [this]()->void
+        {
+            const uint32_t workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+            m_loadWorkers.reserve(workerCount);
+            for (uint32_t i = 0u; i < workerCount; i++)
+                m_loadWorkers.push_back(std::make_unique<CAsyncLoadQueue>(this));
+        }
+    );
+
+    SAsyncLoadRequest request;
+    request.params = _params;
+    request.hierarchyLevel = _hierarchyLevel;
+    request.override = _override;
+    // a loader already running on one of our workers (e.g. a glTF's images) would deadlock blocking on a full queue,
+    // since its own worker is the one who'd drain it and the other workers might be waiting on its queue too,
+    // so it skips its own queue, never waits for space and does the load itself when every other queue is full
+    const bool onLoadWorker = std::any_of(m_loadWorkers.begin(), m_loadWorkers.end(), [](const auto& worker)->bool { return worker.get() == currentLoadWorker; });
+    for (size_t i = 0ull; i < _filePaths.size(); i++)
+    {
+        request.filename = _filePaths[i];
+        const uint32_t first = m_nextLoadWorker.fetch_add(1u, std::memory_order_relaxed);
+        if (!onLoadWorker)
+        {
+            m_loadWorkers[first % m_loadWorkers.size()]->request(&_bundles[i], request);
+            continue;
+        }
+        bool requested = false;
+        for (uint32_t j = 0u; !requested && j < m_loadWorkers.size(); j++)
+        {
+            auto* const worker = m_loadWorkers[(first + j) % m_loadWorkers.size()].get();
+            requested = worker != currentLoadWorker && worker->try_request(&_bundles[i], request);
+        }
+        if (!requested)
+            set_result(_bundles[i], getAssetInHierarchy(request.filename, request.params, request.hierarchyLevel, request.override));
+    }
+}
+
+SAssetBundle IAssetManager::waitForAssetInHierarchy(system::ISystem::future_t<SAssetBundle>& _bundle, const std::string& _filePath, const IAssetLoader::SAssetLoadParams& _params, uint32_t _hierarchyLevel, IAssetLoader::IAssetLoaderOverride* _override)
+{
+    // nothing has started it yet, so do it ourselves rather than block a thread which could be doing it
+    if (_bundle.cancel())
+        return getAssetInHierarchy(_filePath, _params, _hierarchyLevel, _override);
+    SAssetBundle retval;
+    if (auto lock = _bundle.acquire())
+        lock.move_into(retval);
+    return retval;
+}
+
+void IAssetManager::CAsyncLoadQueue::init()
+{
+    currentLoadWorker = this;
+}
+
+void IAssetManager::CAsyncLoadQueue::process_request(base_t::future_base_t* _future_base, SAsyncLoadRequest& req)
+{
+    base_t::future_storage_cast<SAssetBundle>(_future_base)->construct(m_manager->getAssetInHierarchy(req.filename, req.params, req.hierarchyLevel, req.override));
+}
+
 void IAssetManager::insertBuiltinAssets()
 {
 	auto addBuiltInToCaches = [&](auto&& asset, const char* path) -> void
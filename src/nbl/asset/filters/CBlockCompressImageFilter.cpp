@@ -0,0 +1,787 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/asset/filters/CBlockCompressImageFilter.h"
+#include "nbl/asset/format/encodePixels.h"
+
+#include <bit>
+#include <cfloat>
+
+using namespace nbl;
+using namespace nbl::asset;
+
+namespace
+{
+
+using SInputBlock = CBlockCompressImageFilter::SInputBlock;
+using E_QUALITY = CBlockCompressImageFilter::E_QUALITY;
+
+constexpr uint32_t TexelCount = 16u;
+constexpr uint16_t AllTexels = 0xffffu;
+
+//! Weights of the 4 bit indices of BC6H and BC7, out of 64
+constexpr uint32_t Weights4Bit[16] = {0u,4u,9u,13u,17u,21u,26u,30u,34u,38u,43u,47u,51u,55u,60u,64u};
+
+//! Picks the closest palette entry for every texel by weighted squared distance, returns the summed error of the texels in `texelMask`
+float selectIndices(const SInputBlock& block, const float (*palette)[4], const uint32_t paletteSize, const float weights[4], uint8_t* indices, const uint16_t texelMask)
+{
+	float error = 0.f;
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+	const __m128 channelWeights[4] = {_mm_set1_ps(weights[0]),_mm_set1_ps(weights[1]),_mm_set1_ps(weights[2]),_mm_set1_ps(weights[3])};
+	// 4 texels at a time, the palette gets broadcast
+	for (uint32_t first=0u; first<TexelCount; first+=4u)
+	{
+		__m128 texels[4];
+		for (uint32_t c=0u; c<4u; c++)
+			texels[c] = _mm_loadu_ps(block.channels[c]+first);
+		__m128 bestError = _mm_set1_ps(FLT_MAX);
+		__m128 bestIndex = _mm_setzero_ps();
+		for (uint32_t i=0u; i<paletteSize; i++)
+		{
+			__m128 entryError = _mm_setzero_ps();
+			for (uint32_t c=0u; c<4u; c++)
+			{
+				const __m128 diff = _mm_sub_ps(texels[c],_mm_set1_ps(palette[i][c]));
+				entryError = _mm_add_ps(entryError,_mm_mul_ps(_mm_mul_ps(diff,diff),channelWeights[c]));
+			}
+			const __m128 better = _mm_cmplt_ps(entryError,bestError);
+			bestError = _mm_min_ps(entryError,bestError);
+			bestIndex = _mm_or_ps(_mm_and_ps(better,_mm_set1_ps(float(i))),_mm_andnot_ps(better,bestIndex));
+		}
+		alignas(16) float errors[4];
+		alignas(16) int32_t bestIndices[4];
+		_mm_store_ps(errors,bestError);
+		_mm_store_si128(reinterpret_cast<__m128i*>(bestIndices),_mm_cvttps_epi32(bestIndex));
+		for (uint32_t j=0u; j<4u; j++)
+		{
+			indices[first+j] = static_cast<uint8_t>(bestIndices[j]);
+			if (texelMask&(1u<<(first+j)))
+				error += errors[j];
+		}
+	}
+#else
+	for (uint32_t t=0u; t<TexelCount; t++)
+	{
+		float bestError = FLT_MAX;
+		for (uint32_t i=0u; i<paletteSize; i++)
+		{
+			float entryError = 0.f;
+			for (uint32_t c=0u; c<4u; c++)
+			{
+				const float diff = block.channels[c][t]-palette[i][c];
+				entryError += diff*diff*weights[c];
+			}
+			if (entryError<bestError)
+			{
+				bestError = entryError;
+				indices[t] = static_cast<uint8_t>(i);
+			}
+		}
+		if (texelMask&(1u<<t))
+			error += bestError;
+	}
+#endif // __NBL_COMPILE_WITH_X86_SIMD_
+	return error;
+}
+
+struct SEndpoints
+{
+	float a[4];
+	float b[4];
+};
+
+//! Endpoints spanning the texels in `texelMask` along the principal axis of their colors, only the channels with a non zero weight count
+SEndpoints principalAxisEndpoints(const SInputBlock& block, const float weights[4], const uint16_t texelMask)
+{
+	const float texelCount = float(std::popcount(texelMask));
+	float mean[4] = {};
+	for (uint32_t t=0u; t<TexelCount; t++)
+	if (texelMask&(1u<<t))
+	for (uint32_t c=0u; c<4u; c++)
+		mean[c] += block.channels[c][t];
+	for (uint32_t c=0u; c<4u; c++)
+		mean[c] /= texelCount;
+
+	float covariance[4][4] = {};
+	for (uint32_t t=0u; t<TexelCount; t++)
+	if (texelMask&(1u<<t))
+	{
+		float diff[4];
+		for (uint32_t c=0u; c<4u; c++)
+			diff[c] = weights[c]!=0.f ? (block.channels[c][t]-mean[c]):0.f;
+		for (uint32_t c=0u; c<4u; c++)
+		for (uint32_t d=c; d<4u; d++)
+			covariance[c][d] += diff[c]*diff[d];
+	}
+	for (uint32_t c=1u; c<4u; c++)
+	for (uint32_t d=0u; d<c; d++)
+		covariance[c][d] = covariance[d][c];
+
+	// power iteration from the row of the channel that varies the most
+	uint32_t widest = 0u;
+	for (uint32_t c=1u; c<4u; c++)
+	if (covariance[c][c]>covariance[widest][widest])
+		widest = c;
+	float axis[4];
+	std::copy_n(covariance[widest],4u,axis);
+	for (uint32_t iteration=0u; iteration<8u; iteration++)
+	{
+		float next[4] = {};
+		float largest = 0.f;
+		for (uint32_t c=0u; c<4u; c++)
+		{
+			for (uint32_t d=0u; d<4u; d++)
+				next[c] += covariance[c][d]*axis[d];
+			largest = std::max(largest,std::abs(next[c]));
+		}
+		if (largest==0.f)
+			break;
+		for (uint32_t c=0u; c<4u; c++)
+			axis[c] = next[c]/largest;
+	}
+
+	float axisLengthSquared = 0.f;
+	for (uint32_t c=0u; c<4u; c++)
+		axisLengthSquared += axis[c]*axis[c];
+	SEndpoints retval;
+	std::copy_n(mean,4u,retval.a);
+	std::copy_n(mean,4u,retval.b);
+	if (axisLengthSquared<=FLT_MIN)
+		return retval;
+
+	float minProjection = FLT_MAX, maxProjection = -FLT_MAX;
+	for (uint32_t t=0u; t<TexelCount; t++)
+	if (texelMask&(1u<<t))
+	{
+		float projection = 0.f;
+		for (uint32_t c=0u; c<4u; c++)
+			projection += (block.channels[c][t]-mean[c])*axis[c];
+		minProjection = std::min(minProjection,projection);
+		maxProjection = std::max(maxProjection,projection);
+	}
+	for (uint32_t c=0u; c<4u; c++)
+	{
+		retval.a[c] += axis[c]*minProjection/axisLengthSquared;
+		retval.b[c] += axis[c]*maxProjection/axisLengthSquared;
+	}
+	return retval;
+}
+
+//! Least squares endpoints for the texels in `texelMask` sitting at the fixed fractions `alphas` of the way between them
+bool refitEndpoints(const SInputBlock& block, const float* alphas, const uint16_t texelMask, SEndpoints& endpoints)
+{
+	float aa = 0.f, ab = 0.f, bb = 0.f;
+	float ax[4] = {}, bx[4] = {};
+	for (uint32_t t=0u; t<TexelCount; t++)
+	if (texelMask&(1u<<t))
+	{
+		const float beta = alphas[t];
+		const float alpha = 1.f-beta;
+		aa += alpha*alpha;
+		ab += alpha*beta;
+		bb += beta*beta;
+		for (uint32_t c=0u; c<4u; c++)
+		{
+			ax[c] += alpha*block.channels[c][t];
+			bx[c] += beta*block.channels[c][t];
+		}
+	}
+	const float determinant = aa*bb-ab*ab;
+	// all texels at the same fraction, can't tell the endpoints apart
+	if (determinant<=FLT_EPSILON*aa*bb)
+		return false;
+	for (uint32_t c=0u; c<4u; c++)
+	{
+		endpoints.a[c] = (ax[c]*bb-bx[c]*ab)/determinant;
+		endpoints.b[c] = (bx[c]*aa-ax[c]*ab)/determinant;
+	}
+	return true;
+}
+
+inline uint32_t getRefitCount(const E_QUALITY quality)
+{
+	switch (quality)
+	{
+		case CBlockCompressImageFilter::EQ_FAST:
+			return 0u;
+		case CBlockCompressImageFilter::EQ_NORMAL:
+			return 1u;
+		default:
+			return 4u;
+	}
+}
+
+//! Writes little endian bit fields of up to 32 bits into a zeroed block
+struct SBitWriter
+{
+	inline void write(const uint32_t value, const uint32_t bitCount)
+	{
+		for (uint32_t i=0u; i<bitCount; i++,position++)
+			out[position>>3u] |= uint8_t(((value>>i)&0x1u)<<(position&0x7u));
+	}
+
+	uint8_t* out;
+	uint32_t position = 0u;
+};
+
+inline uint8_t quantizeUNORM8(const float value)
+{
+	return static_cast<uint8_t>(std::clamp(value,0.f,1.f)*255.f+0.5f);
+}
+
+//
+namespace bc1
+{
+inline uint16_t pack565(const float color[4])
+{
+	const auto quantize = [](const float value, const float maxValue) -> uint16_t
+	{
+		return static_cast<uint16_t>(std::clamp(value,0.f,1.f)*maxValue+0.5f);
+	};
+	return (quantize(color[0],31.f)<<11u)|(quantize(color[1],63.f)<<5u)|quantize(color[2],31.f);
+}
+// same integer math as `decodeBC1`
+inline void unpack565(const uint16_t color, uint32_t rgb[3])
+{
+	const uint32_t r = color>>11u;
+	const uint32_t g = (color>>5u)&0x3fu;
+	const uint32_t b = color&0x1fu;
+	rgb[0] = (r<<3u)|(r>>2u);
+	rgb[1] = (g<<2u)|(g>>4u);
+	rgb[2] = (b<<3u)|(b>>2u);
+}
+
+struct SCandidate
+{
+	uint16_t color0, color1;
+	uint8_t indices[TexelCount];
+	float error;
+};
+
+/*
+	With `threeColor` the endpoints get ordered to signal the mode with a midpoint and black (or transparent black) as the 4th color,
+	which texels only get to pick when `black` is allowed. Texels outside `fitMask` are transparent and always get the 4th color.
+*/
+SCandidate tryEndpoints(const SInputBlock& block, const SEndpoints& endpoints, const bool threeColor, const bool black, const uint16_t fitMask)
+{
+	SCandidate retval;
+	retval.color0 = pack565(endpoints.a);
+	retval.color1 = pack565(endpoints.b);
+	if (threeColor ? (retval.color0>retval.color1):(retval.color0<retval.color1))
+		std::swap(retval.color0,retval.color1);
+
+	uint32_t c0[3], c1[3];
+	unpack565(retval.color0,c0);
+	unpack565(retval.color1,c1);
+	float palette[4][4] = {};
+	for (uint32_t c=0u; c<3u; c++)
+	{
+		palette[0][c] = float(c0[c])/255.f;
+		palette[1][c] = float(c1[c])/255.f;
+		if (threeColor)
+			palette[2][c] = float((c0[c]+c1[c])/2u)/255.f;
+		else
+		{
+			palette[2][c] = float((2u*c0[c]+c1[c])/3u)/255.f;
+			palette[3][c] = float((c0[c]+2u*c1[c])/3u)/255.f;
+		}
+	}
+
+	constexpr float Weights[4] = {1.f,1.f,1.f,0.f};
+	retval.error = selectIndices(block,palette,threeColor&&!black ? 3u:4u,Weights,retval.indices,fitMask);
+	// equal endpoints always decode in the 3 color mode, but every entry but the last is the same color
+	if (!threeColor && retval.color0==retval.color1)
+	for (uint32_t t=0u; t<TexelCount; t++)
+		retval.indices[t] = 0u;
+	for (uint32_t t=0u; t<TexelCount; t++)
+	if (!(fitMask&(1u<<t)))
+		retval.indices[t] = 3u;
+	return retval;
+}
+
+//! Refits until the error stops going down, texels which picked black don't pull on the endpoints
+void refit(const SInputBlock& block, const E_QUALITY quality, const bool threeColor, const bool black, const uint16_t fitMask, SCandidate& best)
+{
+	constexpr float FourColorAlphas[4] = {0.f,1.f,1.f/3.f,2.f/3.f};
+	constexpr float ThreeColorAlphas[4] = {0.f,1.f,0.5f,0.f};
+	for (uint32_t iteration=getRefitCount(quality); iteration; iteration--)
+	{
+		float alphas[TexelCount];
+		uint16_t refitMask = fitMask;
+		for (uint32_t t=0u; t<TexelCount; t++)
+		{
+			alphas[t] = (threeColor ? ThreeColorAlphas:FourColorAlphas)[best.indices[t]];
+			if (threeColor && best.indices[t]==3u)
+				refitMask &= ~uint16_t(1u<<t);
+		}
+		SEndpoints endpoints;
+		if (!refitEndpoints(block,alphas,refitMask,endpoints))
+			return;
+		const auto candidate = tryEndpoints(block,endpoints,threeColor,black,fitMask);
+		if (candidate.error>=best.error)
+			return;
+		best = candidate;
+	}
+}
+
+/*
+	`transparency` is for BC1 RGBA, where texels with alpha below a half become transparent black and force the 3 color mode.
+	`threeColor` allows the 3 color mode for opaque blocks, which is only correct for BC1 RGB as BC1 RGBA decodes black as transparent
+	and BC3 always decodes the color block in the 4 color mode.
+*/
+void encode(const SInputBlock& block, const E_QUALITY quality, const bool transparency, const bool threeColor, uint8_t* out)
+{
+	uint16_t fitMask = AllTexels;
+	if (transparency)
+	for (uint32_t t=0u; t<TexelCount; t++)
+	if (block.channels[3][t]<0.5f)
+		fitMask &= ~uint16_t(1u<<t);
+
+	SCandidate best;
+	if (fitMask)
+	{
+		constexpr float Weights[4] = {1.f,1.f,1.f,0.f};
+		const auto endpoints = principalAxisEndpoints(block,Weights,fitMask);
+		const bool forceThreeColor = fitMask!=AllTexels;
+		best = tryEndpoints(block,endpoints,forceThreeColor,false,fitMask);
+		refit(block,quality,forceThreeColor,false,fitMask,best);
+		if (quality==CBlockCompressImageFilter::EQ_HIGH && !forceThreeColor && threeColor)
+		{
+			auto candidate = tryEndpoints(block,endpoints,true,true,fitMask);
+			refit(block,quality,true,true,fitMask,candidate);
+			if (candidate.error<best.error)
+				best = candidate;
+		}
+	}
+	else
+	{
+		// everything transparent
+		best.color0 = best.color1 = 0u;
+		std::fill_n(best.indices,TexelCount,3u);
+	}
+
+	memset(out,0,8u);
+	SBitWriter writer = {out};
+	writer.write(best.color0,16u);
+	writer.write(best.color1,16u);
+	for (uint32_t t=0u; t<TexelCount; t++)
+		writer.write(best.indices[t],2u);
+}
+}
+
+//
+namespace bc4
+{
+struct SCandidate
+{
+	uint8_t value0, value1;
+	uint8_t indices[TexelCount];
+	float error;
+};
+
+//! The decoder picks the 8 value mode when `value0>value1`, otherwise 6 values plus 0 and 1
+SCandidate tryEndpoints(const SInputBlock& block, const uint32_t channel, const uint8_t value0, const uint8_t value1)
+{
+	SCandidate retval;
+	retval.value0 = value0;
+	retval.value1 = value1;
+
+	// same integer math as `decodeBC4`
+	const uint32_t a0 = value0, a1 = value1;
+	uint32_t values[8] = {a0,a1};
+	if (a0>a1)
+	{
+		for (uint32_t i=1u; i<7u; i++)
+			values[i+1u] = ((7u-i)*a0+i*a1)/7u;
+	}
+	else
+	{
+		for (uint32_t i=1u; i<5u; i++)
+			values[i+1u] = ((5u-i)*a0+i*a1)/5u;
+		values[6] = 0u;
+		values[7] = 0xffu;
+	}
+
+	float palette[8][4] = {};
+	for (uint32_t i=0u; i<8u; i++)
+		palette[i][channel] = float(values[i])/255.f;
+	float weights[4] = {};
+	weights[channel] = 1.f;
+	retval.error = selectIndices(block,palette,8u,weights,retval.indices,AllTexels);
+	return retval;
+}
+
+void refit(const SInputBlock& block, const E_QUALITY quality, const uint32_t channel, SCandidate& best)
+{
+	for (uint32_t iteration=getRefitCount(quality); iteration; iteration--)
+	{
+		const bool eightValues = best.value0>best.value1;
+		float alphas[TexelCount];
+		uint16_t refitMask = AllTexels;
+		for (uint32_t t=0u; t<TexelCount; t++)
+		{
+			const uint32_t index = best.indices[t];
+			if (index<2u)
+				alphas[t] = float(index);
+			else if (eightValues)
+				alphas[t] = float(index-1u)/7.f;
+			else if (index<6u)
+				alphas[t] = float(index-1u)/5.f;
+			else // the constant 0 and 1
+				refitMask &= ~uint16_t(1u<<t);
+		}
+		SEndpoints endpoints;
+		if (!refitEndpoints(block,alphas,refitMask,endpoints))
+			return;
+		uint8_t value0 = quantizeUNORM8(endpoints.a[channel]);
+		uint8_t value1 = quantizeUNORM8(endpoints.b[channel]);
+		if (eightValues!=(value0>value1))
+			std::swap(value0,value1);
+		const auto candidate = tryEndpoints(block,channel,value0,value1);
+		if (candidate.error>=best.error)
+			return;
+		best = candidate;
+	}
+}
+
+void encode(const SInputBlock& block, const E_QUALITY quality, const uint32_t channel, uint8_t* out)
+{
+	const float* const values = block.channels[channel];
+	const auto [minIt,maxIt] = std::minmax_element(values,values+TexelCount);
+	auto best = tryEndpoints(block,channel,quantizeUNORM8(*maxIt),quantizeUNORM8(*minIt));
+	refit(block,quality,channel,best);
+	if (quality!=CBlockCompressImageFilter::EQ_FAST)
+	{
+		// the 6 value mode only needs to span the values which aren't already 0 or 1
+		float innerMin = 1.f, innerMax = 0.f;
+		for (uint32_t t=0u; t<TexelCount; t++)
+		if (values[t]>0.5f/255.f && values[t]<254.5f/255.f)
+		{
+			innerMin = std::min(innerMin,values[t]);
+			innerMax = std::max(innerMax,values[t]);
+		}
+		if (innerMin<=innerMax)
+		{
+			auto candidate = tryEndpoints(block,channel,quantizeUNORM8(innerMin),quantizeUNORM8(innerMax));
+			refit(block,quality,channel,candidate);
+			if (candidate.error<best.error)
+				best = candidate;
+		}
+	}
+
+	memset(out,0,8u);
+	SBitWriter writer = {out};
+	writer.write(best.value0,8u);
+	writer.write(best.value1,8u);
+	for (uint32_t t=0u; t<TexelCount; t++)
+		writer.write(best.indices[t],3u);
+}
+}
+
+//! Mode 6, a single subset of 7 bit RGBA endpoints with a parity bit each and 4 bit indices
+namespace bc7
+{
+struct SCandidate
+{
+	uint8_t endpoints[2][4];
+	uint8_t parity[2];
+	uint8_t indices[TexelCount];
+	float error;
+};
+
+//! A negative `parity` picks whichever parity bit gets the endpoint closer
+void quantizeEndpoint(const float color[4], const int32_t parity, uint8_t endpoint[4], uint8_t& chosenParity)
+{
+	float bestError = FLT_MAX;
+	for (uint32_t p=0u; p<2u; p++)
+	{
+		if (parity>=0 && uint32_t(parity)!=p)
+			continue;
+		uint8_t quantized[4];
+		float error = 0.f;
+		for (uint32_t c=0u; c<4u; c++)
+		{
+			const float target = std::clamp(color[c],0.f,1.f)*255.f;
+			quantized[c] = static_cast<uint8_t>(std::clamp((target-float(p))*0.5f+0.5f,0.f,127.f));
+			const float diff = float((quantized[c]<<1u)|p)-target;
+			error += diff*diff;
+		}
+		if (error<bestError)
+		{
+			bestError = error;
+			std::copy_n(quantized,4u,endpoint);
+			chosenParity = p;
+		}
+	}
+}
+
+SCandidate tryEndpoints(const SInputBlock& block, const SEndpoints& endpoints, const int32_t parity0, const int32_t parity1)
+{
+	SCandidate retval;
+	quantizeEndpoint(endpoints.a,parity0,retval.endpoints[0],retval.parity[0]);
+	quantizeEndpoint(endpoints.b,parity1,retval.endpoints[1],retval.parity[1]);
+
+	float palette[16][4];
+	for (uint32_t c=0u; c<4u; c++)
+	{
+		const uint32_t e0 = (retval.endpoints[0][c]<<1u)|retval.parity[0];
+		const uint32_t e1 = (retval.endpoints[1][c]<<1u)|retval.parity[1];
+		for (uint32_t i=0u; i<16u; i++)
+			palette[i][c] = float(((64u-Weights4Bit[i])*e0+Weights4Bit[i]*e1+32u)>>6u)/255.f;
+	}
+	constexpr float Weights[4] = {1.f,1.f,1.f,1.f};
+	retval.error = selectIndices(block,palette,16u,Weights,retval.indices,AllTexels);
+	return retval;
+}
+
+SCandidate tryAndRefit(const SInputBlock& block, const E_QUALITY quality, const SEndpoints& endpoints, const int32_t parity0, const int32_t parity1)
+{
+	auto best = tryEndpoints(block,endpoints,parity0,parity1);
+	for (uint32_t iteration=getRefitCount(quality); iteration; iteration--)
+	{
+		float alphas[TexelCount];
+		for (uint32_t t=0u; t<TexelCount; t++)
+			alphas[t] = float(Weights4Bit[best.indices[t]])/64.f;
+		SEndpoints refitted;
+		if (!refitEndpoints(block,alphas,AllTexels,refitted))
+			break;
+		const auto candidate = tryEndpoints(block,refitted,parity0,parity1);
+		if (candidate.error>=best.error)
+			break;
+		best = candidate;
+	}
+	return best;
+}
+
+void encode(const SInputBlock& block, const E_QUALITY quality, uint8_t* out)
+{
+	constexpr float Weights[4] = {1.f,1.f,1.f,1.f};
+	const auto endpoints = principalAxisEndpoints(block,Weights,AllTexels);
+	auto best = tryAndRefit(block,quality,endpoints,-1,-1);
+	if (quality==CBlockCompressImageFilter::EQ_HIGH)
+	for (int32_t parities=0; parities<4; parities++)
+	{
+		const auto candidate = tryAndRefit(block,quality,endpoints,parities&0x1,parities>>1);
+		if (candidate.error<best.error)
+			best = candidate;
+	}
+
+	// the most significant bit of the first index is implied to be 0
+	if (best.indices[0]&0x8u)
+	{
+		std::swap(best.endpoints[0],best.endpoints[1]);
+		std::swap(best.parity[0],best.parity[1]);
+		for (uint32_t t=0u; t<TexelCount; t++)
+			best.indices[t] = 15u-best.indices[t];
+	}
+
+	memset(out,0,16u);
+	SBitWriter writer = {out};
+	writer.write(0x1u<<6u,7u);
+	for (uint32_t c=0u; c<4u; c++)
+	{
+		writer.write(best.endpoints[0][c],7u);
+		writer.write(best.endpoints[1][c],7u);
+	}
+	writer.write(best.parity[0],1u);
+	writer.write(best.parity[1],1u);
+	writer.write(best.indices[0],3u);
+	for (uint32_t t=1u; t<TexelCount; t++)
+		writer.write(best.indices[t],4u);
+}
+}
+
+/*
+	Mode 11, a single region of untransformed 10 bit endpoints and 4 bit indices.
+	Everything happens on half float bit patterns read as integers, negative for the signed format, which is how the decoder
+	interpolates, so they get treated as (roughly logarithmic) colors.
+*/
+namespace bc6h
+{
+constexpr int32_t MaxHalf = 0x7bff;
+
+inline int32_t unquantize(const int32_t value, const bool isSigned)
+{
+	if (isSigned)
+	{
+		const int32_t magnitude = std::abs(value);
+		int32_t retval;
+		if (magnitude==0)
+			retval = 0;
+		else if (magnitude>=(0x1<<9)-1)
+			retval = 0x7fff;
+		else
+			retval = ((magnitude<<15)+0x4000)>>9;
+		return value<0 ? -retval:retval;
+	}
+	if (value==0)
+		return 0;
+	if (value==(0x1<<10)-1)
+		return 0xffff;
+	return ((value<<16)+0x8000)>>10;
+}
+
+inline int32_t finishUnquantize(const int32_t value, const bool isSigned)
+{
+	if (isSigned)
+		return value<0 ? -(((-value)*31)>>5):((value*31)>>5);
+	return (value*31)>>6;
+}
+
+inline int32_t interpolate(const int32_t unquantized0, const int32_t unquantized1, const uint32_t index)
+{
+	return (unquantized0*int32_t(64u-Weights4Bit[index])+unquantized1*int32_t(Weights4Bit[index])+32)>>6;
+}
+
+//! Endpoint whose unquantized and finished value lands the closest to `target`
+inline int32_t quantize(const float target, const bool isSigned)
+{
+	const int32_t minValue = isSigned ? -((0x1<<9)-1):0;
+	const int32_t maxValue = isSigned ? ((0x1<<9)-1):((0x1<<10)-1);
+	// finishing scales the 6 fractional bits the quantized value gets moved up by by 31/64 or 31/32
+	const float scale = isSigned ? 62.f:31.f;
+	const int32_t estimate = static_cast<int32_t>(std::round((std::abs(target)-scale*0.5f)/scale))*(target<0.f ? -1:1);
+	int32_t best = 0;
+	float bestError = FLT_MAX;
+	for (int32_t candidate=estimate-1; candidate<=estimate+1; candidate++)
+	{
+		const int32_t clamped = std::clamp(candidate,minValue,maxValue);
+		const float error = std::abs(float(finishUnquantize(unquantize(clamped,isSigned),isSigned))-target);
+		if (error<bestError)
+		{
+			bestError = error;
+			best = clamped;
+		}
+	}
+	return best;
+}
+
+struct SCandidate
+{
+	int32_t endpoints[2][3];
+	uint8_t indices[TexelCount];
+	float error;
+};
+
+SCandidate tryEndpoints(const SInputBlock& halfBlock, const SEndpoints& endpoints, const bool isSigned)
+{
+	SCandidate retval;
+	float palette[16][4] = {};
+	for (uint32_t c=0u; c<3u; c++)
+	{
+		retval.endpoints[0][c] = quantize(endpoints.a[c],isSigned);
+		retval.endpoints[1][c] = quantize(endpoints.b[c],isSigned);
+		const int32_t unquantized0 = unquantize(retval.endpoints[0][c],isSigned);
+		const int32_t unquantized1 = unquantize(retval.endpoints[1][c],isSigned);
+		for (uint32_t i=0u; i<16u; i++)
+			palette[i][c] = float(finishUnquantize(interpolate(unquantized0,unquantized1,i),isSigned));
+	}
+	constexpr float Weights[4] = {1.f,1.f,1.f,0.f};
+	retval.error = selectIndices(halfBlock,palette,16u,Weights,retval.indices,AllTexels);
+	return retval;
+}
+
+void encode(const SInputBlock& block, const E_QUALITY quality, const bool isSigned, uint8_t* out)
+{
+	SInputBlock halfBlock = {};
+	for (uint32_t t=0u; t<TexelCount; t++)
+	{
+		float rgb[3];
+		for (uint32_t c=0u; c<3u; c++)
+			rgb[c] = std::isnan(block.channels[c][t]) ? 0.f:block.channels[c][t];
+		uint16_t halves[3];
+		impl::encodef16<float,3u>(halves,rgb);
+		for (uint32_t c=0u; c<3u; c++)
+		{
+			const int32_t magnitude = std::min<int32_t>(halves[c]&0x7fffu,MaxHalf);
+			const bool negative = halves[c]&0x8000u;
+			halfBlock.channels[c][t] = float(negative ? (isSigned ? -magnitude:0):magnitude);
+		}
+	}
+
+	constexpr float Weights[4] = {1.f,1.f,1.f,0.f};
+	auto best = tryEndpoints(halfBlock,principalAxisEndpoints(halfBlock,Weights,AllTexels),isSigned);
+	for (uint32_t iteration=getRefitCount(quality); iteration; iteration--)
+	{
+		float alphas[TexelCount];
+		for (uint32_t t=0u; t<TexelCount; t++)
+			alphas[t] = float(Weights4Bit[best.indices[t]])/64.f;
+		SEndpoints refitted;
+		if (!refitEndpoints(halfBlock,alphas,AllTexels,refitted))
+			break;
+		const auto candidate = tryEndpoints(halfBlock,refitted,isSigned);
+		if (candidate.error>=best.error)
+			break;
+		best = candidate;
+	}
+
+	// the most significant bit of the first index is implied to be 0, the weights are symmetric so swapping is exact
+	if (best.indices[0]&0x8u)
+	{
+		std::swap(best.endpoints[0],best.endpoints[1]);
+		for (uint32_t t=0u; t<TexelCount; t++)
+			best.indices[t] = 15u-best.indices[t];
+	}
+
+	memset(out,0,16u);
+	SBitWriter writer = {out};
+	writer.write(0x03u,5u);
+	for (uint32_t e=0u; e<2u; e++)
+	for (uint32_t c=0u; c<3u; c++)
+		writer.write(uint32_t(best.endpoints[e][c])&0x3ffu,10u);
+	writer.write(best.indices[0],3u);
+	for (uint32_t t=1u; t<TexelCount; t++)
+		writer.write(best.indices[t],4u);
+}
+}
+
+}
+
+void CBlockCompressImageFilter::encodeBlock(const E_FORMAT format, const E_QUALITY quality, const SInputBlock& block, uint8_t* out)
+{
+	if (format==EF_BC6H_UFLOAT_BLOCK || format==EF_BC6H_SFLOAT_BLOCK)
+	{
+		bc6h::encode(block,quality,format==EF_BC6H_SFLOAT_BLOCK,out);
+		return;
+	}
+
+	// NaN goes to 0 as well
+	SInputBlock clamped;
+	for (uint32_t c=0u; c<4u; c++)
+	for (uint32_t t=0u; t<TexelCount; t++)
+	{
+		const float value = block.channels[c][t];
+		clamped.channels[c][t] = value>0.f ? std::min(value,1.f):0.f;
+	}
+	switch (format)
+	{
+		case EF_BC1_RGB_UNORM_BLOCK:
+		case EF_BC1_RGB_SRGB_BLOCK:
+			bc1::encode(clamped,quality,false,true,out);
+			break;
+		case EF_BC1_RGBA_UNORM_BLOCK:
+		case EF_BC1_RGBA_SRGB_BLOCK:
+			bc1::encode(clamped,quality,true,false,out);
+			break;
+		case EF_BC3_UNORM_BLOCK:
+		case EF_BC3_SRGB_BLOCK:
+			bc4::encode(clamped,quality,3u,out);
+			bc1::encode(clamped,quality,false,false,out+8u);
+			break;
+		case EF_BC4_UNORM_BLOCK:
+			bc4::encode(clamped,quality,0u,out);
+			break;
+		case EF_BC5_UNORM_BLOCK:
+			bc4::encode(clamped,quality,0u,out);
+			bc4::encode(clamped,quality,1u,out+8u);
+			break;
+		case EF_BC7_UNORM_BLOCK:
+		case EF_BC7_SRGB_BLOCK:
+			bc7::encode(clamped,quality,out);
+			break;
+		default:
+			assert(false);
+			break;
+	}
+}
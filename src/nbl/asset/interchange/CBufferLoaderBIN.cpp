@@ -11,6 +11,19 @@ asset::SAssetBundle CBufferLoaderBIN::loadAsset(system::IFile* _file, const asse
 	if (!_file)
 		return {};
 
+	// if the file is mapped, the buffer can just alias the mapping
+	if (auto memoryResource=system::CMappedFileMemoryResource::create(core::smart_refctd_ptr<system::IFile>(_file)))
+	if (void* data=memoryResource->getRegion(0ull,_file->getSize(),system::CMappedFileMemoryResource::E_ACCESS_PATTERN::SEQUENTIAL))
+	{
+		const size_t alignment = memoryResource->getAlignment(0ull);
+		auto buffer = ICPUBuffer::create({{_file->getSize()},data,std::move(memoryResource),alignment},core::adopt_memory);
+		if (buffer)
+		{
+			buffer->setContentHash(buffer->computeContentHash());
+			return SAssetBundle(nullptr,{std::move(buffer)});
+		}
+	}
+
 	SContext ctx(_file->getSize());
 	ctx.file = _file;
 
@@ -7,6 +7,7 @@
 
 #include "nbl/asset/interchange/IAssetLoader.h"
 #include "nbl/asset/ICPUMeshBuffer.h"
+#include "nbl/system/CMappedFileMemoryResource.h"
 
 namespace nbl
 {
@@ -30,6 +31,7 @@ class CBufferLoaderBIN final : public asset::IAssetLoader
 		}
 
 		uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_BUFFER; } 
+		bool adoptsMappedMemory() const override { return true; }
 
 		asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
 
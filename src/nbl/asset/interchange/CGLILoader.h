@@ -18,6 +18,7 @@ namespace asset
 {
 
 //! Texture loader capable of loading in .ktx, .dds and .kmg file extensions
+/** DDS files get tried with `CImageLoaderDDS` first, which doesn't copy them, so this only gets them when that one fails (e.g. on legacy formats). */
 class CGLILoader final : public asset::IAssetLoader
 {
 	protected:
@@ -27,6 +28,7 @@ class CGLILoader final : public asset::IAssetLoader
 		explicit CGLILoader() = default;
 
 		bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const override;
+		bool isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger) const override;
 
 		const char** getAssociatedFileExtensions() const override
 		{
@@ -8,6 +8,7 @@
 
 #include "nbl/asset/IAssetManager.h"
 #include "nbl/asset/utils/CDerivativeMapCreator.h"
+#include "nbl/system/CMappedFileMemoryResource.h"
 #include "nbl/asset/utils/IMeshManipulator.h"
 
 #include "simdjson/singleheader/simdjson.h"
@@ -113,6 +114,11 @@ using namespace nbl::asset;
 		
 		bool CGLTFLoader::isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const
 		{
+			// the JSON of a .glb doesn't need to be parsed to know it's one
+			SGLBFormat::SLayout glbLayout;
+			if (SGLBFormat::readLayout(_file,glbLayout))
+				return true;
+
 			simdjson::dom::parser parser;
 
 			auto jsonBuffer = ICPUBuffer::create({ _file->getSize() });
@@ -140,6 +146,141 @@ using namespace nbl::asset;
 			return false;
 		}
 
+		bool CGLTFLoader::isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger) const
+		{
+			if (getFileMagics()[0].matches(_header))
+			{
+				SGLBFormat::SLayout glbLayout;
+				return SGLBFormat::readLayout(_file,glbLayout);
+			}
+			// JSON needs parsing in full
+			return isALoadableFileFormat(_file,logger);
+		}
+
+		core::smart_refctd_ptr<ICPUBuffer> CGLTFLoader::getGLBBinChunk(const SGLTF::SGLTFBuffer& glTFBuffer, const SContext& context) const
+		{
+			const auto& layout = context.glbLayout;
+			if (layout.binSize==0ull)
+			{
+				context.loadContext.params.logger.log("GLTF: A BUFFER HAS NO URI AND THERE'S NO GLB BIN CHUNK!",system::ILogger::ELL_ERROR);
+				return nullptr;
+			}
+			// the chunk may be padded past the end of the buffer, but never be shorter than it
+			if (glTFBuffer.byteLength.has_value() && glTFBuffer.byteLength.value()>layout.binSize)
+			{
+				context.loadContext.params.logger.log("GLTF: THE GLB BUFFER IS LONGER THAN THE BIN CHUNK!",system::ILogger::ELL_ERROR);
+				return nullptr;
+			}
+			const size_t size = glTFBuffer.byteLength.value_or(layout.binSize);
+
+			auto* file = context.loadContext.mainFile;
+			if (auto memoryResource=system::CMappedFileMemoryResource::create(core::smart_refctd_ptr<system::IFile>(file)))
+			if (void* data=memoryResource->getRegion(layout.binOffset,size,system::CMappedFileMemoryResource::E_ACCESS_PATTERN::SEQUENTIAL))
+			{
+				// the chunk is only guaranteed to be 4 byte aligned within the file
+				const size_t alignment = memoryResource->getAlignment(layout.binOffset);
+				auto buffer = ICPUBuffer::create({{size},data,std::move(memoryResource),alignment},core::adopt_memory);
+				if (buffer)
+				{
+					buffer->setContentHash(buffer->computeContentHash());
+					return buffer;
+				}
+			}
+
+			auto buffer = ICPUBuffer::create({size});
+			system::IFile::success_t success;
+			file->read(success,buffer->getPointer(),layout.binOffset,size);
+			if (!success)
+				return nullptr;
+			buffer->setContentHash(buffer->computeContentHash());
+			return buffer;
+		}
+
+		bool CGLTFLoader::decodeMeshoptBufferViews(const SGLTF& glTF, const core::vector<core::smart_refctd_ptr<ICPUBuffer>>& cpuBuffers, const SContext& context) const
+		{
+			core::vector<const SGLTF::SGLTFBufferView*> compressedViews;
+			for (const auto& glTFBufferView : glTF.bufferViews)
+			if (glTFBufferView.meshoptCompression.has_value())
+				compressedViews.push_back(&glTFBufferView);
+			if (compressedViews.empty())
+				return true;
+
+			// validate everything up front, the parallel decode below relies on every view writing its own in-bounds range
+			struct SDstRange
+			{
+				ICPUBuffer* buffer;
+				size_t begin;
+				size_t end;
+			};
+			core::vector<SDstRange> dstRanges;
+			dstRanges.reserve(compressedViews.size());
+			for (const auto* glTFBufferView : compressedViews)
+			{
+				const auto& compression = glTFBufferView->meshoptCompression.value();
+				const auto& dstIx = glTFBufferView->buffer;
+				// only decode into the placeholder buffers marked as `fallback`, never into the compressed data or a regular buffer
+				if (!dstIx.has_value() || dstIx.value()>=cpuBuffers.size() || !glTF.buffers[dstIx.value()].meshoptFallback ||
+					compression.buffer>=cpuBuffers.size() || glTF.buffers[compression.buffer].meshoptFallback)
+				{
+					context.loadContext.params.logger.log("GLTF: EXT_meshopt_compression BUFFER VIEW REFERS TO AN INVALID BUFFER!",system::ILogger::ELL_ERROR);
+					return false;
+				}
+
+				auto* dst = cpuBuffers[dstIx.value()].get();
+				const auto* src = cpuBuffers[compression.buffer].get();
+				const size_t dstOffset = glTFBufferView->byteOffset.value_or(0ull);
+				// both factors are 32bit, the product can't overflow
+				const size_t dstSize = size_t(compression.count)*compression.byteStride;
+				if (!dst || !src || dstOffset>dst->getSize() || dstSize>dst->getSize()-dstOffset ||
+					compression.byteOffset>src->getSize() || compression.byteLength>src->getSize()-compression.byteOffset)
+				{
+					context.loadContext.params.logger.log("GLTF: EXT_meshopt_compression BUFFER VIEW IS OUT OF BOUNDS!",system::ILogger::ELL_ERROR);
+					return false;
+				}
+				dstRanges.push_back({dst,dstOffset,dstOffset+dstSize});
+			}
+
+			std::sort(dstRanges.begin(),dstRanges.end(),[](const SDstRange& lhs, const SDstRange& rhs) -> bool
+				{
+					if (lhs.buffer!=rhs.buffer)
+						return lhs.buffer<rhs.buffer;
+					return lhs.begin<rhs.begin;
+				}
+			);
+			for (size_t i=1ull; i<dstRanges.size(); i++)
+			if (dstRanges[i-1ull].buffer==dstRanges[i].buffer && dstRanges[i-1ull].end>dstRanges[i].begin)
+			{
+				context.loadContext.params.logger.log("GLTF: EXT_meshopt_compression BUFFER VIEWS OVERLAP!",system::ILogger::ELL_ERROR);
+				return false;
+			}
+
+			// every view decodes into its own range, so they can all go at once
+			std::atomic_bool failed = false;
+			core::for_each(core::execution::par,compressedViews.begin(),compressedViews.end(),[&](const SGLTF::SGLTFBufferView* glTFBufferView) -> void
+				{
+					const auto& compression = glTFBufferView->meshoptCompression.value();
+					const uint8_t* srcData = reinterpret_cast<const uint8_t*>(cpuBuffers[compression.buffer]->getPointer())+compression.byteOffset;
+					uint8_t* dstData = reinterpret_cast<uint8_t*>(cpuBuffers[glTFBufferView->buffer.value()]->getPointer())+glTFBufferView->byteOffset.value_or(0ull);
+					if (!CMeshoptDecoder::decode(dstData,compression.count,compression.byteStride,srcData,compression.byteLength,compression.mode,compression.filter))
+						failed = true;
+				}
+			);
+			if (failed)
+			{
+				context.loadContext.params.logger.log("GLTF: COULD NOT DECODE EXT_meshopt_compression BUFFER VIEW!",system::ILogger::ELL_ERROR);
+				return false;
+			}
+
+			// many views usually decode into the same buffer, hash each one only once its fully decoded
+			core::vector<ICPUBuffer*> dstBuffers;
+			dstBuffers.reserve(dstRanges.size());
+			for (const auto& range : dstRanges)
+			if (dstBuffers.empty() || dstBuffers.back()!=range.buffer)
+				dstBuffers.push_back(range.buffer);
+			core::for_each(core::execution::par,dstBuffers.begin(),dstBuffers.end(),[](ICPUBuffer* dst) -> void {dst->setContentHash(dst->computeContentHash());});
+			return true;
+		}
+
 		asset::SAssetBundle CGLTFLoader::loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
 		{
 			auto overrideAssetLoadParams = _params;
@@ -155,84 +296,124 @@ using namespace nbl::asset;
 			if(!loadAndGetGLTF(glTF, context))
 				return {};
 
-			core::vector<core::smart_refctd_ptr<ICPUBuffer>> cpuBuffers;
-			for (auto& glTFBuffer : glTF.buffers)
+			const auto bufferHierarchyLevel = _hierarchyLevel+ICPUMesh::BUFFER_HIERARCHYLEVELS_BELOW;
+			const auto imageViewHierarchyLevel = _hierarchyLevel+ICPUMesh::IMAGEVIEW_HIERARCHYLEVELS_BELOW;
+			// all external buffers and uncached images get loaded as one batch, so they can decode in parallel
+			core::vector<SSubAssetLoad> subAssetLoads;
+			subAssetLoads.reserve(glTF.buffers.size()+glTF.images.size());
+			core::vector<core::smart_refctd_ptr<ICPUBuffer>> cpuBuffers(glTF.buffers.size());
+			core::vector<uint32_t> buffersToLoad;
+			for (uint32_t i=0u; i<glTF.buffers.size(); i++)
 			{
-				// FarFuture TODO: handle buffer embedded in glTF
-				auto buffer_bundle = interm_getAssetInHierarchy(assetManager,glTFBuffer.uri.value(),context.loadContext.params,_hierarchyLevel+ICPUMesh::BUFFER_HIERARCHYLEVELS_BELOW,_override);
-				if (buffer_bundle.getContents().empty())
+				const auto& glTFBuffer = glTF.buffers[i];
+				// gets filled by decoding, even if there's an uncompressed copy to load
+				if (glTFBuffer.meshoptFallback)
+				{
+					if (!glTFBuffer.byteLength.has_value())
+						return {};
+					cpuBuffers[i] = ICPUBuffer::create({glTFBuffer.byteLength.value()});
+				}
+				else if (glTFBuffer.uri.has_value())
+				{
+					buffersToLoad.push_back(i);
+					subAssetLoads.push_back({glTFBuffer.uri.value(),bufferHierarchyLevel});
+				}
+				// only the first buffer may refer to the GLB's BIN chunk
+				else if (i==0u)
+				{
+					if (!(cpuBuffers[i]=getGLBBinChunk(glTFBuffer,context)))
+						return {};
+				}
+				// FarFuture TODO: handle buffer embedded in glTF as a data URI
+				else
+				{
+					context.loadContext.params.logger.log("GLTF: ONLY THE FIRST BUFFER CAN GO WITHOUT A URI!",system::ILogger::ELL_ERROR);
 					return {};
-
-				auto cpuBuffer = core::smart_refctd_ptr_static_cast<ICPUBuffer>(buffer_bundle.getContents().begin()[0]);
-				cpuBuffers.emplace_back() = core::smart_refctd_ptr<ICPUBuffer>(cpuBuffer);
+				}
 			}
 
-			const auto imageViewHierarchyLevel = _hierarchyLevel+ICPUMesh::IMAGEVIEW_HIERARCHYLEVELS_BELOW;
-			core::vector<core::smart_refctd_ptr<ICPUImageView>> cpuImageViews;
+			core::vector<core::smart_refctd_ptr<ICPUImageView>> cpuImageViews(glTF.images.size());
+			core::vector<uint32_t> imagesToLoad;
+			for (uint32_t i=0u; i<glTF.images.size(); i++)
 			{
-				for (auto& glTFImage : glTF.images)
+				const auto& glTFImage = glTF.images[i];
+				// FarFuture TODO: handle image embedded in glTF 
+				// TODO: factor this out to be common for all PipelineLoaders https://github.com/Devsh-Graphics-Programming/Nabla/issues/270
+				if (glTFImage.uri.has_value())
 				{
-					auto& cpuImageView = cpuImageViews.emplace_back();
-
-					// FarFuture TODO: handle image embedded in glTF 
-					// TODO: factor this out to be common for all PipelineLoaders https://github.com/Devsh-Graphics-Programming/Nabla/issues/270
-					if (glTFImage.uri.has_value())
+					// TODO: THIS IS AN ABSOLUTELY WRONG CACHE PRE-PATH KEY TO USE!
+					cpuImageViews[i] = _override->findDefaultAsset<ICPUImageView>(getImageViewCacheKey(glTFImage.uri.value()),context.loadContext,imageViewHierarchyLevel).first;
+					if (!cpuImageViews[i])
 					{
-						// TODO: THIS IS AN ABSOLUTELY WRONG CACHE PRE-PATH KEY TO USE!
-						const std::string cpuImageViewCacheKey = getImageViewCacheKey(glTFImage.uri.value());
+						imagesToLoad.push_back(i);
+						subAssetLoads.push_back({glTFImage.uri.value(),imageViewHierarchyLevel});
+					}
+				}
+				else
+				{
+					if (!glTFImage.mimeType.has_value() || !glTFImage.bufferView.has_value())
+						return {};
+						
+					_NBL_DEBUG_BREAK_IF(true);
+					return {}; // TODO FUTURE: load image where it's data is embeded in memory
+				}
+			}
 
-						cpuImageView = _override->findDefaultAsset<ICPUImageView>(cpuImageViewCacheKey,context.loadContext,imageViewHierarchyLevel).first;
-						if (!cpuImageView)
-						{
-							auto image_bundle = interm_getAssetInHierarchy(assetManager,glTFImage.uri.value(),context.loadContext.params,imageViewHierarchyLevel,_override);
-							if (image_bundle.getContents().empty())
-								return {};
+			// joins all the loads before anything gets built out of them
+			const auto subAssetBundles = interm_getAssetsInHierarchy(assetManager,subAssetLoads,context.loadContext.params,_override);
 
-							auto cpuAsset = image_bundle.getContents().begin()[0];
+			for (size_t i=0ull; i<buffersToLoad.size(); i++)
+			{
+				const auto& buffer_bundle = subAssetBundles[i];
+				if (buffer_bundle.getContents().empty())
+					return {};
 
-							switch (cpuAsset->getAssetType())
-							{
-								case IAsset::ET_IMAGE:
-								{
-									ICPUImageView::SCreationParams viewParams;
-									viewParams.flags = static_cast<ICPUImageView::E_CREATE_FLAGS>(0u);
-									viewParams.image = core::smart_refctd_ptr_static_cast<asset::ICPUImage>(cpuAsset);
-									viewParams.format = viewParams.image->getCreationParameters().format;
-									viewParams.viewType = IImageView<ICPUImage>::ET_2D;
-									viewParams.subresourceRange.baseArrayLayer = 0u;
-									viewParams.subresourceRange.layerCount = 1u;
-									viewParams.subresourceRange.baseMipLevel = 0u;
-									viewParams.subresourceRange.levelCount = 1u;
-
-									cpuImageView = ICPUImageView::create(std::move(viewParams));
-								} break;
+				cpuBuffers[buffersToLoad[i]] = core::smart_refctd_ptr_static_cast<ICPUBuffer>(buffer_bundle.getContents().begin()[0]);
+			}
+			if (!decodeMeshoptBufferViews(glTF,cpuBuffers,context))
+				return {};
 
-								case IAsset::ET_IMAGE_VIEW:
-								{
-									cpuImageView = core::smart_refctd_ptr_static_cast<asset::ICPUImageView>(cpuAsset);
-								} break;
+			for (size_t i=0ull; i<imagesToLoad.size(); i++)
+			{
+				auto& cpuImageView = cpuImageViews[imagesToLoad[i]];
+				const auto& image_bundle = subAssetBundles[buffersToLoad.size()+i];
+				if (image_bundle.getContents().empty())
+					return {};
 
-								default:
-								{
-									context.loadContext.params.logger.log("GLTF: EXPECTED IMAGE ASSET TYPE!",system::ILogger::ELL_ERROR);
-									return {};
-								}
-							}
+				auto cpuAsset = image_bundle.getContents().begin()[0];
 
-							// TODO: this is wrong, it adds a loaded image view (the second switch case) to the cache again, move this insertion to the first switch case
-							SAssetBundle samplerBundle = SAssetBundle(nullptr, { core::smart_refctd_ptr(cpuImageView) });
-							_override->insertAssetIntoCache(samplerBundle,cpuImageViewCacheKey,context.loadContext,imageViewHierarchyLevel);
-						}	
-					}
-					else
+				switch (cpuAsset->getAssetType())
+				{
+					case IAsset::ET_IMAGE:
 					{
-						if (!glTFImage.mimeType.has_value() || !glTFImage.bufferView.has_value())
-							return {};
-						
-						_NBL_DEBUG_BREAK_IF(true);
-						return {}; // TODO FUTURE: load image where it's data is embeded in memory
+						ICPUImageView::SCreationParams viewParams;
+						viewParams.flags = static_cast<ICPUImageView::E_CREATE_FLAGS>(0u);
+						viewParams.image = core::smart_refctd_ptr_static_cast<asset::ICPUImage>(cpuAsset);
+						viewParams.format = viewParams.image->getCreationParameters().format;
+						viewParams.viewType = IImageView<ICPUImage>::ET_2D;
+						viewParams.subresourceRange.baseArrayLayer = 0u;
+						viewParams.subresourceRange.layerCount = 1u;
+						viewParams.subresourceRange.baseMipLevel = 0u;
+						viewParams.subresourceRange.levelCount = 1u;
+
+						cpuImageView = ICPUImageView::create(std::move(viewParams));
+					} break;
+
+					case IAsset::ET_IMAGE_VIEW:
+					{
+						cpuImageView = core::smart_refctd_ptr_static_cast<asset::ICPUImageView>(cpuAsset);
+					} break;
+
+					default:
+					{
+						context.loadContext.params.logger.log("GLTF: EXPECTED IMAGE ASSET TYPE!",system::ILogger::ELL_ERROR);
+						return {};
 					}
 				}
+
+				// TODO: this is wrong, it adds a loaded image view (the second switch case) to the cache again, move this insertion to the first switch case
+				SAssetBundle samplerBundle = SAssetBundle(nullptr, { core::smart_refctd_ptr(cpuImageView) });
+				_override->insertAssetIntoCache(samplerBundle,getImageViewCacheKey(glTF.images[imagesToLoad[i]].uri.value()),context.loadContext,imageViewHierarchyLevel);
 			}
 			
 			core::vector<std::pair<core::smart_refctd_ptr<ICPUImageView>,core::smart_refctd_ptr<ICPUSampler>>> cpuTextures;
@@ -710,7 +891,8 @@ using namespace nbl::asset;
 
 							auto handleAccessor = [&](SGLTF::SGLTFAccessor& glTFAccessor, const std::optional<uint32_t> queryAttributeId = {}) -> bool
 							{
-								const E_FORMAT format = SGLTF::SGLTFAccessor::getFormat(glTFAccessor.componentType.value(), glTFAccessor.type.value());
+								// vertex attributes are always read as floats, quantized ones stay in their compact format
+								const E_FORMAT format = SGLTF::SGLTFAccessor::getFormat(glTFAccessor.componentType.value(), glTFAccessor.type.value(), glTFAccessor.normalized.value_or(false), queryAttributeId.has_value());
 								if (format == EF_UNKNOWN)
 								{
 									context.loadContext.params.logger.log("GLTF: COULD NOT SPECIFY NABLA FORMAT!",system::ILogger::ELL_ERROR);
@@ -1658,15 +1840,31 @@ using namespace nbl::asset;
 			simdjson::dom::parser parser;
 			auto* _file = context.loadContext.mainFile;
 
-			auto jsonBuffer = ICPUBuffer::create({ _file->getSize() });
+			// a .glb only has its JSON in the first chunk
+			uint64_t jsonOffset = 0ull;
+			uint64_t jsonSize = _file->getSize();
+			if (SGLBFormat::readLayout(_file,context.glbLayout))
 			{
+				jsonOffset = context.glbLayout.jsonOffset;
+				jsonSize = context.glbLayout.jsonSize;
+			}
+
+			// simdjson copies into its own padded buffer anyway, so parse straight out of a mapping when we can
+			const uint8_t* json = reinterpret_cast<const uint8_t*>(_file->getMappedPointer());
+			core::smart_refctd_ptr<ICPUBuffer> jsonBuffer;
+			if (json)
+				json += jsonOffset;
+			else
+			{
+				jsonBuffer = ICPUBuffer::create({ jsonSize });
 				system::IFile::success_t success;
-				_file->read(success, jsonBuffer->getPointer(), 0u, jsonBuffer->getSize());
+				_file->read(success, jsonBuffer->getPointer(), jsonOffset, jsonBuffer->getSize());
 				if (!success)
 					return false;
+				json = reinterpret_cast<const uint8_t*>(jsonBuffer->getPointer());
 			}
 
-			simdjson::dom::object tweets = parser.parse(reinterpret_cast<uint8_t*>(jsonBuffer->getPointer()), jsonBuffer->getSize());
+			simdjson::dom::object tweets = parser.parse(json, jsonSize);
 			simdjson::dom::element element;
 
 			//std::filesystem::path filePath(_file->getFileName().c_str());
@@ -1717,6 +1915,7 @@ using namespace nbl::asset;
 					auto& glTFBuffer = glTF.buffers.emplace_back();
 
 					const auto& uri = jsonBuffer.at_key("uri");
+					const auto& byteLength = jsonBuffer.at_key("byteLength");
 					const auto& name = jsonBuffer.at_key("name");
 					const auto& extensions = jsonBuffer.at_key("extensions");
 					const auto& extras = jsonBuffer.at_key("extras");
@@ -1724,8 +1923,21 @@ using namespace nbl::asset;
 					if (uri.error() != simdjson::error_code::NO_SUCH_FIELD)
 						glTFBuffer.uri = uri.get_string().value().data();
 
+					if (byteLength.error() != simdjson::error_code::NO_SUCH_FIELD)
+						glTFBuffer.byteLength = static_cast<uint32_t>(byteLength.get_uint64().value());
+
 					if (name.error() != simdjson::error_code::NO_SUCH_FIELD)
 						glTFBuffer.name = name.get_string().value();
+
+					if (extensions.error() != simdjson::error_code::NO_SUCH_FIELD)
+					{
+						const auto& meshopt = extensions.at_key("EXT_meshopt_compression");
+						if (meshopt.error() != simdjson::error_code::NO_SUCH_FIELD)
+						{
+							const auto& fallback = meshopt.at_key("fallback");
+							glTFBuffer.meshoptFallback = fallback.error() != simdjson::error_code::NO_SUCH_FIELD && fallback.get_bool().value();
+						}
+					}
 				}
 			}
 
@@ -1762,6 +1974,70 @@ using namespace nbl::asset;
 
 					if (name.error() != simdjson::error_code::NO_SUCH_FIELD)
 						glTFBufferView.name = name.get_string().value();
+
+					if (extensions.error() != simdjson::error_code::NO_SUCH_FIELD)
+					{
+						const auto& meshopt = extensions.at_key("EXT_meshopt_compression");
+						if (meshopt.error() != simdjson::error_code::NO_SUCH_FIELD)
+						{
+							const auto& compressionBuffer = meshopt.at_key("buffer");
+							const auto& compressionByteLength = meshopt.at_key("byteLength");
+							const auto& compressionByteStride = meshopt.at_key("byteStride");
+							const auto& compressionCount = meshopt.at_key("count");
+							const auto& compressionMode = meshopt.at_key("mode");
+
+							auto isUint = [](const auto& field) -> bool
+							{
+								return field.error() != simdjson::error_code::NO_SUCH_FIELD && field.get_uint64().error() == simdjson::error_code::SUCCESS;
+							};
+							if (!isUint(compressionBuffer) || !isUint(compressionByteLength) || !isUint(compressionByteStride) || !isUint(compressionCount) ||
+								compressionMode.error() == simdjson::error_code::NO_SUCH_FIELD || compressionMode.get_string().error() != simdjson::error_code::SUCCESS)
+							{
+								context.loadContext.params.logger.log("GLTF: EXT_meshopt_compression IS MISSING A REQUIRED FIELD!",system::ILogger::ELL_ERROR);
+								return false;
+							}
+
+							auto& compression = glTFBufferView.meshoptCompression.emplace();
+							compression.buffer = static_cast<uint32_t>(compressionBuffer.get_uint64().value());
+							compression.byteLength = compressionByteLength.get_uint64().value();
+							compression.byteStride = static_cast<uint32_t>(compressionByteStride.get_uint64().value());
+							compression.count = static_cast<uint32_t>(compressionCount.get_uint64().value());
+
+							const auto& byteOffset = meshopt.at_key("byteOffset");
+							if (byteOffset.error() != simdjson::error_code::NO_SUCH_FIELD)
+								compression.byteOffset = byteOffset.get_uint64().value();
+
+							const std::string_view mode = compressionMode.get_string().value();
+							if (mode == "ATTRIBUTES")
+								compression.mode = CMeshoptDecoder::E_MODE::ATTRIBUTES;
+							else if (mode == "TRIANGLES")
+								compression.mode = CMeshoptDecoder::E_MODE::TRIANGLES;
+							else if (mode == "INDICES")
+								compression.mode = CMeshoptDecoder::E_MODE::INDICES;
+							else
+							{
+								context.loadContext.params.logger.log("GLTF: UNKNOWN EXT_meshopt_compression MODE!",system::ILogger::ELL_ERROR);
+								return false;
+							}
+
+							const auto& filter = meshopt.at_key("filter");
+							if (filter.error() != simdjson::error_code::NO_SUCH_FIELD)
+							{
+								const std::string_view filterName = filter.get_string().value();
+								if (filterName == "OCTAHEDRAL")
+									compression.filter = CMeshoptDecoder::E_FILTER::OCTAHEDRAL;
+								else if (filterName == "QUATERNION")
+									compression.filter = CMeshoptDecoder::E_FILTER::QUATERNION;
+								else if (filterName == "EXPONENTIAL")
+									compression.filter = CMeshoptDecoder::E_FILTER::EXPONENTIAL;
+								else if (filterName != "NONE")
+								{
+									context.loadContext.params.logger.log("GLTF: UNKNOWN EXT_meshopt_compression FILTER!",system::ILogger::ELL_ERROR);
+									return false;
+								}
+							}
+						}
+					}
 				}
 			}
 
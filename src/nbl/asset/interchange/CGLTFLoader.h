@@ -15,10 +15,13 @@
 #include "nbl/asset/interchange/IRenderpassIndependentPipelineLoader.h"
 #include "nbl/asset/metadata/CGLTFMetadata.h"
 
+#include "SGLBFormat.h"
+#include "CMeshoptDecoder.h"
+
 namespace nbl::asset
 {
 
-//! glTF Loader capable of loading .gltf files
+//! glTF Loader capable of loading .gltf and .glb files
 /*
 	glTF bridges the gap between 3D content creation tools and modern 3D applications 
 	by providing an efficient, extensible, interoperable format for the transmission and loading of 3D content.
@@ -29,14 +32,24 @@ class CGLTFLoader final : public IRenderpassIndependentPipelineLoader
 		CGLTFLoader(asset::IAssetManager* _m_assetMgr);
 
 		bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const override;
+		bool isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger) const override;
 
 		const char** getAssociatedFileExtensions() const override
 		{
-			static const char* extensions[]{ "gltf", nullptr };
+			static const char* extensions[]{ "gltf", "glb", nullptr };
 			return extensions;
 		}
 
+		//! only .glb files have one, plain JSON gets probed by parsing
+		std::span<const SFileMagic> getFileMagics() const override
+		{
+			static constexpr uint8_t glb[] = { 'g', 'l', 'T', 'F' };
+			static constexpr SFileMagic magics[] = { {0u,glb} };
+			return magics;
+		}
+
 		uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_MESH; }
+		bool adoptsMappedMemory() const override { return true; }
 
 		asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
 
@@ -57,6 +70,8 @@ class CGLTFLoader final : public IRenderpassIndependentPipelineLoader
 			SAssetLoadContext loadContext;
 			asset::IAssetLoader::IAssetLoaderOverride* loaderOverride;
 			uint32_t hierarchyLevel;
+			//! only filled for .glb files
+			SGLBFormat::SLayout glbLayout;
 		};
 
 	private:
@@ -393,93 +408,77 @@ class CGLTFLoader final : public IRenderpassIndependentPipelineLoader
 					return true;
 				}
 
-				static inline E_FORMAT getFormat(SCompomentType componentType, SGLTFType type)
+				//! Integer attributes read as floats in the shaders get `normalized` or `scaled` formats, which keeps KHR_mesh_quantization data compact
+				static inline E_FORMAT getFormat(SCompomentType componentType, SGLTFType type, const bool normalized=false, const bool asFloat=false)
 				{
+					uint32_t channels;
+					switch (type)
+					{
+						case SGLTF::SGLTFAccessor::SGLTFT_SCALAR: channels = 1u; break;
+						case SGLTF::SGLTFAccessor::SGLTFT_VEC2: channels = 2u; break;
+						case SGLTF::SGLTFAccessor::SGLTFT_VEC3: channels = 3u; break;
+						case SGLTF::SGLTFAccessor::SGLTFT_VEC4: [[fallthrough]];
+						case SGLTF::SGLTFAccessor::SGLTFT_MAT2: channels = 4u; break;
+						default: return EF_UNKNOWN;
+					}
+
+					// rows are integer, normalized, scaled
+					using formats_t = E_FORMAT[3][4];
+					auto pick = [&](const formats_t& formats) -> E_FORMAT
+					{
+						return formats[normalized ? 1u:(asFloat ? 2u:0u)][channels-1u];
+					};
 					switch (componentType)
 					{
 						case SGLTF::SGLTFAccessor::SCT_BYTE:
 						{
-							if (type == SGLTF::SGLTFAccessor::SGLTFT_SCALAR)
-								return EF_R8_SINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_VEC2)
-								return EF_R8G8_SINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_VEC3)
-								return EF_R8G8B8_SINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_VEC4)
-								return EF_R8G8B8A8_SINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_MAT2)
-								return EF_R8G8B8A8_SINT;
-						} break;
-
-						case SGLTF::SGLTFAccessor::SCT_FLOAT:
+							constexpr formats_t formats = {
+								{EF_R8_SINT,EF_R8G8_SINT,EF_R8G8B8_SINT,EF_R8G8B8A8_SINT},
+								{EF_R8_SNORM,EF_R8G8_SNORM,EF_R8G8B8_SNORM,EF_R8G8B8A8_SNORM},
+								{EF_R8_SSCALED,EF_R8G8_SSCALED,EF_R8G8B8_SSCALED,EF_R8G8B8A8_SSCALED}
+							};
+							return pick(formats);
+						}
+						case SGLTF::SGLTFAccessor::SCT_UNSIGNED_BYTE:
 						{
-							if (type == SGLTF::SGLTFAccessor::SGLTFT_SCALAR)
-								return EF_R32_SFLOAT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_VEC2)
-								return EF_R32G32_SFLOAT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_VEC3)
-								return EF_R32G32B32_SFLOAT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_VEC4)
-								return EF_R32G32B32A32_SFLOAT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_MAT2)
-								return EF_R32G32B32A32_SFLOAT;
-						} break;
-
+							constexpr formats_t formats = {
+								{EF_R8_UINT,EF_R8G8_UINT,EF_R8G8B8_UINT,EF_R8G8B8A8_UINT},
+								{EF_R8_UNORM,EF_R8G8_UNORM,EF_R8G8B8_UNORM,EF_R8G8B8A8_UNORM},
+								{EF_R8_USCALED,EF_R8G8_USCALED,EF_R8G8B8_USCALED,EF_R8G8B8A8_USCALED}
+							};
+							return pick(formats);
+						}
 						case SGLTF::SGLTFAccessor::SCT_SHORT:
 						{
-							if (type == SGLTF::SGLTFAccessor::SGLTFT_SCALAR)
-								return EF_R16_SINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_VEC2)
-								return EF_R16G16_SINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_VEC3)
-								return EF_R16G16B16_SINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_VEC4)
-								return EF_R16G16B16A16_SINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_MAT2)
-								return EF_R16G16B16A16_SINT;
-						} break;
-
-						case SGLTF::SGLTFAccessor::SCT_UNSIGNED_BYTE:
+							constexpr formats_t formats = {
+								{EF_R16_SINT,EF_R16G16_SINT,EF_R16G16B16_SINT,EF_R16G16B16A16_SINT},
+								{EF_R16_SNORM,EF_R16G16_SNORM,EF_R16G16B16_SNORM,EF_R16G16B16A16_SNORM},
+								{EF_R16_SSCALED,EF_R16G16_SSCALED,EF_R16G16B16_SSCALED,EF_R16G16B16A16_SSCALED}
+							};
+							return pick(formats);
+						}
+						case SGLTF::SGLTFAccessor::SCT_UNSIGNED_SHORT:
 						{
-							if (type == SGLTF::SGLTFAccessor::SGLTFT_SCALAR)
-								return EF_R8_UINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_VEC2)
-								return EF_R8G8_UINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_VEC3)
-								return EF_R8G8B8_UINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_VEC4)
-								return EF_R8G8B8A8_UINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_MAT2)
-								return EF_R8G8B8A8_UINT;
-						} break;
-
+							constexpr formats_t formats = {
+								{EF_R16_UINT,EF_R16G16_UINT,EF_R16G16B16_UINT,EF_R16G16B16A16_UINT},
+								{EF_R16_UNORM,EF_R16G16_UNORM,EF_R16G16B16_UNORM,EF_R16G16B16A16_UNORM},
+								{EF_R16_USCALED,EF_R16G16_USCALED,EF_R16G16B16_USCALED,EF_R16G16B16A16_USCALED}
+							};
+							return pick(formats);
+						}
 						case SGLTF::SGLTFAccessor::SCT_UNSIGNED_INT:
 						{
-							if (type == SGLTF::SGLTFAccessor::SGLTFT_SCALAR)
-								return EF_R32_UINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_VEC2)
-								return EF_R32G32_UINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_VEC3)
-								return EF_R32G32B32_UINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_VEC4)
-								return EF_R32G32B32A32_UINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_MAT2)
-								return EF_R32G32B32A32_UINT;
-						} break;
-
-						case SGLTF::SGLTFAccessor::SCT_UNSIGNED_SHORT:
+							// there's no normalized or scaled 32bit format, glTF doesn't allow them for attributes either
+							if (normalized || asFloat)
+								return EF_UNKNOWN;
+							constexpr E_FORMAT formats[4] = {EF_R32_UINT,EF_R32G32_UINT,EF_R32G32B32_UINT,EF_R32G32B32A32_UINT};
+							return formats[channels-1u];
+						}
+						case SGLTF::SGLTFAccessor::SCT_FLOAT:
 						{
-							if (type == SGLTF::SGLTFAccessor::SGLTFT_SCALAR)
-								return EF_R16_UINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_VEC2)
-								return EF_R16G16_UINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_VEC3)
-								return EF_R16G16B16_UINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_VEC4)
-								return EF_R16G16B16A16_UINT;
-							else if (type == SGLTF::SGLTFAccessor::SGLTFT_MAT2)
-								return EF_R16G16B16A16_UINT;
-						} break;
+							constexpr E_FORMAT formats[4] = {EF_R32_SFLOAT,EF_R32G32_SFLOAT,EF_R32G32B32_SFLOAT,EF_R32G32B32A32_SFLOAT};
+							return formats[channels-1u];
+						}
 					}
 					return EF_UNKNOWN;
 				}
@@ -490,6 +489,8 @@ class CGLTFLoader final : public IRenderpassIndependentPipelineLoader
 				std::optional<std::string> uri;
 				std::optional<uint32_t> byteLength;
 				std::optional<std::string> name;
+				//! EXT_meshopt_compression, contents come from decoding the compressed bufferViews instead
+				bool meshoptFallback = false;
 
 				bool validate()
 				{
@@ -515,6 +516,19 @@ class CGLTFLoader final : public IRenderpassIndependentPipelineLoader
 				std::optional<uint32_t> target;
 				std::optional<std::string> name;
 
+				//! EXT_meshopt_compression, the view's own range gets filled by decoding this one
+				struct SMeshoptCompression
+				{
+					uint32_t buffer;
+					size_t byteOffset = 0ull;
+					size_t byteLength;
+					uint32_t byteStride;
+					uint32_t count;
+					CMeshoptDecoder::E_MODE mode;
+					CMeshoptDecoder::E_FILTER filter = CMeshoptDecoder::E_FILTER::NONE;
+				};
+				std::optional<SMeshoptCompression> meshoptCompression;
+
 				enum SGLTFTarget
 				{
 					SGLTFT_ARRAY_BUFFER = 34962,
@@ -813,6 +827,9 @@ class CGLTFLoader final : public IRenderpassIndependentPipelineLoader
 		};
 
 		bool loadAndGetGLTF(SGLTF& glTF, SContext& context);
+		//! The BIN chunk of a .glb, aliases the mapping of the file if it has one
+		core::smart_refctd_ptr<ICPUBuffer> getGLBBinChunk(const SGLTF::SGLTFBuffer& glTFBuffer, const SContext& context) const;
+		bool decodeMeshoptBufferViews(const SGLTF& glTF, const core::vector<core::smart_refctd_ptr<ICPUBuffer>>& cpuBuffers, const SContext& context) const;
 
 		asset::IAssetManager* const assetManager;
 };
@@ -3,17 +3,336 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "CGLTFWriter.h"
-	 
+
 #ifdef _NBL_COMPILE_WITH_GLTF_WRITER_
 
+#include "nbl/asset/ICPUMesh.h"
+#include "SGLBFormat.h"
+
+#include "nlohmann/json.hpp"
+
 namespace nbl
 {
 	namespace asset
 	{
+		namespace
+		{
+			// same as the loader's
+			constexpr uint32_t POSITION_ATTRIBUTE_LAYOUT_ID = 0;
+			constexpr uint32_t UV_ATTRIBUTE_LAYOUT_ID = 1;
+			constexpr uint32_t COLOR_ATTRIBUTE_LAYOUT_ID = 2;
+			constexpr uint32_t NORMAL_ATTRIBUTE_LAYOUT_ID = 3;
+			constexpr uint32_t JOINTS_ATTRIBUTE_LAYOUT_ID = 4;
+			constexpr uint32_t WEIGHTS_ATTRIBUTE_LAYOUT_ID = 5;
+
+			enum E_COMPONENT_TYPE : uint32_t
+			{
+				ECT_BYTE = 5120u,
+				ECT_UNSIGNED_BYTE = 5121u,
+				ECT_SHORT = 5122u,
+				ECT_UNSIGNED_SHORT = 5123u,
+				ECT_UNSIGNED_INT = 5125u,
+				ECT_FLOAT = 5126u
+			};
+
+			struct SAccessorFormat
+			{
+				E_COMPONENT_TYPE componentType;
+				uint32_t componentSize;
+				uint32_t components;
+				bool normalized;
+
+				inline uint32_t getElementSize() const {return componentSize*components;}
+			};
+
+			//! formats which glTF can take as they are, anything else gets converted
+			std::optional<SAccessorFormat> getAccessorFormat(const E_FORMAT format)
+			{
+				switch (format)
+				{
+					case EF_R32_SFLOAT: return SAccessorFormat{ECT_FLOAT,4u,1u,false};
+					case EF_R32G32_SFLOAT: return SAccessorFormat{ECT_FLOAT,4u,2u,false};
+					case EF_R32G32B32_SFLOAT: return SAccessorFormat{ECT_FLOAT,4u,3u,false};
+					case EF_R32G32B32A32_SFLOAT: return SAccessorFormat{ECT_FLOAT,4u,4u,false};
+					case EF_R8G8_UNORM: return SAccessorFormat{ECT_UNSIGNED_BYTE,1u,2u,true};
+					case EF_R8G8B8A8_UNORM: return SAccessorFormat{ECT_UNSIGNED_BYTE,1u,4u,true};
+					case EF_R8G8B8A8_UINT: return SAccessorFormat{ECT_UNSIGNED_BYTE,1u,4u,false};
+					case EF_R8G8_SNORM: return SAccessorFormat{ECT_BYTE,1u,2u,true};
+					case EF_R8G8B8A8_SNORM: return SAccessorFormat{ECT_BYTE,1u,4u,true};
+					case EF_R16G16_UNORM: return SAccessorFormat{ECT_UNSIGNED_SHORT,2u,2u,true};
+					case EF_R16G16B16A16_UNORM: return SAccessorFormat{ECT_UNSIGNED_SHORT,2u,4u,true};
+					case EF_R16G16B16A16_UINT: return SAccessorFormat{ECT_UNSIGNED_SHORT,2u,4u,false};
+					case EF_R16G16_SNORM: return SAccessorFormat{ECT_SHORT,2u,2u,true};
+					case EF_R16G16B16A16_SNORM: return SAccessorFormat{ECT_SHORT,2u,4u,true};
+					default:
+						break;
+				}
+				return std::nullopt;
+			}
+
+			//! the accessor types and component types the glTF spec allows for each vertex attribute semantic we emit
+			bool isValidForSemantic(const uint32_t attrId, const SAccessorFormat& accessorFormat)
+			{
+				const bool unsignedNormalized = accessorFormat.normalized && (accessorFormat.componentType==ECT_UNSIGNED_BYTE || accessorFormat.componentType==ECT_UNSIGNED_SHORT);
+				const bool floatOrUnorm = accessorFormat.componentType==ECT_FLOAT || unsignedNormalized;
+				switch (attrId)
+				{
+					case POSITION_ATTRIBUTE_LAYOUT_ID:
+					case NORMAL_ATTRIBUTE_LAYOUT_ID:
+						return accessorFormat.componentType==ECT_FLOAT && accessorFormat.components==3u;
+					case UV_ATTRIBUTE_LAYOUT_ID:
+						return floatOrUnorm && accessorFormat.components==2u;
+					case COLOR_ATTRIBUTE_LAYOUT_ID:
+						return floatOrUnorm && (accessorFormat.components==3u || accessorFormat.components==4u);
+					case JOINTS_ATTRIBUTE_LAYOUT_ID:
+						return !accessorFormat.normalized && (accessorFormat.componentType==ECT_UNSIGNED_BYTE || accessorFormat.componentType==ECT_UNSIGNED_SHORT) && accessorFormat.components==4u;
+					case WEIGHTS_ATTRIBUTE_LAYOUT_ID:
+						return floatOrUnorm && accessorFormat.components==4u;
+					default:
+						break;
+				}
+				return false;
+			}
+
+			const char* getAccessorType(const uint32_t components)
+			{
+				constexpr const char* types[] = {"SCALAR","VEC2","VEC3","VEC4"};
+				return types[components-1u];
+			}
+
+			std::optional<uint32_t> getPrimitiveMode(const E_PRIMITIVE_TOPOLOGY topology)
+			{
+				switch (topology)
+				{
+					case EPT_POINT_LIST: return 0u;
+					case EPT_LINE_LIST: return 1u;
+					case EPT_LINE_STRIP: return 3u;
+					case EPT_TRIANGLE_LIST: return 4u;
+					case EPT_TRIANGLE_STRIP: return 5u;
+					case EPT_TRIANGLE_FAN: return 6u;
+					default:
+						break;
+				}
+				return std::nullopt;
+			}
+		}
+
 		bool CGLTFWriter::writeAsset(system::IFile* _file, const SAssetWriteParams& _params, IAssetWriterOverride* _override)
 		{
-			// TODO: implementation
-			return false;
+			if (!_override)
+				getDefaultOverride(_override);
+
+			SAssetWriteContext inCtx{_params, _file};
+
+			const asset::ICPUMesh* mesh = IAsset::castDown<const ICPUMesh>(_params.rootAsset);
+			if (!mesh)
+				return false;
+
+			system::IFile* file = _override->getOutputFile(_file, inCtx, {mesh, 0u});
+			if (!file)
+				return false;
+
+			_params.logger.log("WRITING GLB: writing the file %s", system::ILogger::ELL_INFO, file->getFileName().string().c_str());
+
+			// everything gets appended to the BIN chunk, each bufferView starting 4 byte aligned
+			core::vector<uint8_t> bin;
+			nlohmann::json bufferViews = nlohmann::json::array();
+			nlohmann::json accessors = nlohmann::json::array();
+			auto allocateBufferView = [&](const size_t size, const uint32_t byteStride, const bool indices) -> std::pair<uint8_t*,uint32_t>
+			{
+				const size_t offset = bin.size();
+				bin.resize(core::roundUp<size_t>(offset+size,SGLBFormat::ChunkAlignment),0u);
+
+				nlohmann::json bufferView = {{"buffer",0u},{"byteOffset",offset},{"byteLength",size},{"target",indices ? 34963u:34962u}};
+				if (byteStride)
+					bufferView["byteStride"] = byteStride;
+				bufferViews.push_back(std::move(bufferView));
+				return {bin.data()+offset,static_cast<uint32_t>(bufferViews.size()-1u)};
+			};
+
+			nlohmann::json primitives = nlohmann::json::array();
+			for (const auto* meshBuffer : mesh->getMeshBuffers())
+			{
+				const auto* pipeline = meshBuffer->getPipeline();
+				if (!pipeline || !meshBuffer->isAttributeEnabled(POSITION_ATTRIBUTE_LAYOUT_ID))
+				{
+					_params.logger.log("WRITING GLB: skipping a meshbuffer without a pipeline or positions", system::ILogger::ELL_WARNING);
+					continue;
+				}
+				const auto mode = getPrimitiveMode(pipeline->getCachedCreationParams().primitiveAssembly.primitiveType);
+				if (!mode.has_value())
+				{
+					_params.logger.log("WRITING GLB: skipping a meshbuffer with a primitive topology glTF can't express", system::ILogger::ELL_WARNING);
+					continue;
+				}
+
+				const uint32_t indexCount = meshBuffer->getIndexCount();
+				const bool indexed = meshBuffer->getIndexBufferBinding().buffer && meshBuffer->getIndexType()!=EIT_UNKNOWN;
+				uint32_t vertexCount = indexCount;
+				if (indexed)
+				{
+					vertexCount = 0u;
+					for (uint32_t i=0u; i<indexCount; i++)
+						vertexCount = std::max(vertexCount,meshBuffer->getIndexValue(i)+1u);
+				}
+				if (vertexCount==0u)
+					continue;
+
+				nlohmann::json attributes = nlohmann::json::object();
+				auto writeAttribute = [&](const uint32_t attrId, const char* semantic) -> void
+				{
+					if (!meshBuffer->isAttributeEnabled(attrId))
+						return;
+					const E_FORMAT format = meshBuffer->getAttribFormat(attrId);
+					const bool needsVec3Float = attrId==POSITION_ATTRIBUTE_LAYOUT_ID || attrId==NORMAL_ATTRIBUTE_LAYOUT_ID;
+
+					auto accessorFormat = getAccessorFormat(format);
+					if (accessorFormat.has_value() && !isValidForSemantic(attrId,accessorFormat.value()))
+						accessorFormat = std::nullopt;
+					const bool convert = !accessorFormat.has_value();
+					if (convert)
+					{
+						const uint32_t channels = getFormatChannelCount(format);
+						if (channels==0u)
+						{
+							_params.logger.log("WRITING GLB: skipping %s with unsupported format", system::ILogger::ELL_WARNING, semantic);
+							return;
+						}
+						if (attrId==JOINTS_ATTRIBUTE_LAYOUT_ID)
+							accessorFormat = SAccessorFormat{ECT_UNSIGNED_SHORT,2u,4u,false};
+						else
+							accessorFormat = SAccessorFormat{ECT_FLOAT,4u,needsVec3Float ? 3u:std::min(channels,4u),false};
+						// converting only fixes the component type, the channel count still has to be one the semantic allows (e.g. no VEC3 texcoords)
+						if (!isValidForSemantic(attrId,accessorFormat.value()))
+						{
+							_params.logger.log("WRITING GLB: skipping %s, glTF doesn't allow %s accessors for it", system::ILogger::ELL_WARNING, semantic, getAccessorType(accessorFormat->components));
+							return;
+						}
+					}
+
+					// vertex attribute elements need to be 4 byte aligned
+					const uint32_t elementSize = accessorFormat->getElementSize();
+					const uint32_t byteStride = core::roundUp(elementSize,SGLBFormat::ChunkAlignment);
+					auto [out,bufferViewID] = allocateBufferView(size_t(byteStride)*vertexCount,byteStride!=elementSize ? byteStride:0u,false);
+
+					const uint8_t* src = meshBuffer->getAttribPointer(attrId);
+					const uint32_t srcStride = meshBuffer->getAttribStride(attrId);
+					for (uint32_t i=0u; i<vertexCount; i++,out+=byteStride)
+					{
+						if (!convert)
+							memcpy(out,src+size_t(i)*srcStride,elementSize);
+						else if (accessorFormat->componentType==ECT_UNSIGNED_SHORT)
+						{
+							uint32_t joints[4] = {};
+							meshBuffer->getAttribute(joints,attrId,i);
+							for (uint32_t c=0u; c<4u; c++)
+								reinterpret_cast<uint16_t*>(out)[c] = static_cast<uint16_t>(joints[c]);
+						}
+						else
+						{
+							core::vectorSIMDf value;
+							meshBuffer->getAttribute(value,attrId,i);
+							memcpy(out,value.pointer,elementSize);
+						}
+					}
+
+					nlohmann::json accessor = {
+						{"bufferView",bufferViewID},
+						{"componentType",accessorFormat->componentType},
+						{"count",vertexCount},
+						{"type",getAccessorType(accessorFormat->components)}
+					};
+					if (accessorFormat->normalized)
+						accessor["normalized"] = true;
+					// required for positions
+					if (attrId==POSITION_ATTRIBUTE_LAYOUT_ID)
+					{
+						core::vectorSIMDf minimum(std::numeric_limits<float>::max()), maximum(-std::numeric_limits<float>::max());
+						for (uint32_t i=0u; i<vertexCount; i++)
+						{
+							core::vectorSIMDf position;
+							meshBuffer->getAttribute(position,attrId,i);
+							minimum = core::min(minimum,position);
+							maximum = core::max(maximum,position);
+						}
+						accessor["min"] = {minimum.x,minimum.y,minimum.z};
+						accessor["max"] = {maximum.x,maximum.y,maximum.z};
+					}
+					accessors.push_back(std::move(accessor));
+					attributes[semantic] = accessors.size()-1u;
+				};
+				writeAttribute(POSITION_ATTRIBUTE_LAYOUT_ID,"POSITION");
+				writeAttribute(UV_ATTRIBUTE_LAYOUT_ID,"TEXCOORD_0");
+				writeAttribute(COLOR_ATTRIBUTE_LAYOUT_ID,"COLOR_0");
+				writeAttribute(NORMAL_ATTRIBUTE_LAYOUT_ID,"NORMAL");
+				writeAttribute(JOINTS_ATTRIBUTE_LAYOUT_ID,"JOINTS_0");
+				writeAttribute(WEIGHTS_ATTRIBUTE_LAYOUT_ID,"WEIGHTS_0");
+
+				nlohmann::json primitive = {{"attributes",std::move(attributes)},{"mode",mode.value()}};
+				if (indexed)
+				{
+					const bool is16Bit = meshBuffer->getIndexType()==EIT_16BIT;
+					const size_t size = size_t(indexCount)*(is16Bit ? sizeof(uint16_t):sizeof(uint32_t));
+					auto [out,bufferViewID] = allocateBufferView(size,0u,true);
+					memcpy(out,meshBuffer->getIndices(),size);
+
+					accessors.push_back({
+						{"bufferView",bufferViewID},
+						{"componentType",is16Bit ? ECT_UNSIGNED_SHORT:ECT_UNSIGNED_INT},
+						{"count",indexCount},
+						{"type","SCALAR"}
+					});
+					primitive["indices"] = accessors.size()-1u;
+				}
+				primitives.push_back(std::move(primitive));
+			}
+			if (primitives.empty())
+			{
+				_params.logger.log("WRITING GLB: the mesh has no meshbuffers that can be written", system::ILogger::ELL_ERROR);
+				return false;
+			}
+
+			nlohmann::json glTF = {
+				{"asset",{{"version","2.0"},{"generator","Nabla"}}},
+				{"scene",0u},
+				{"scenes",{{{"nodes",{0u}}}}},
+				{"nodes",{{{"mesh",0u}}}},
+				{"meshes",{{{"primitives",std::move(primitives)}}}},
+				{"accessors",std::move(accessors)},
+				{"bufferViews",std::move(bufferViews)},
+				{"buffers",{{{"byteLength",bin.size()}}}}
+			};
+			std::string json = glTF.dump();
+			json.resize(core::roundUp<size_t>(json.size(),SGLBFormat::ChunkAlignment),' ');
+
+			// header and both chunks go out in a single write
+			const size_t fileSize = sizeof(SGLBFormat::SHeader)+2ull*sizeof(SGLBFormat::SChunkHeader)+json.size()+bin.size();
+			if (fileSize>std::numeric_limits<uint32_t>::max())
+			{
+				_params.logger.log("WRITING GLB: the mesh is too big for a single .glb", system::ILogger::ELL_ERROR);
+				return false;
+			}
+			core::vector<uint8_t> glb(fileSize);
+			{
+				uint8_t* out = glb.data();
+				auto append = [&out](const void* data, const size_t size) -> void
+				{
+					memcpy(out,data,size);
+					out += size;
+				};
+				const SGLBFormat::SHeader header = {SGLBFormat::Magic,SGLBFormat::Version,static_cast<uint32_t>(fileSize)};
+				append(&header,sizeof(header));
+				const SGLBFormat::SChunkHeader jsonChunk = {static_cast<uint32_t>(json.size()),SGLBFormat::ECT_JSON};
+				append(&jsonChunk,sizeof(jsonChunk));
+				append(json.data(),json.size());
+				const SGLBFormat::SChunkHeader binChunk = {static_cast<uint32_t>(bin.size()),SGLBFormat::ECT_BIN};
+				append(&binChunk,sizeof(binChunk));
+				append(bin.data(),bin.size());
+			}
+
+			system::IFile::success_t success;
+			file->write(success, glb.data(), 0u, glb.size());
+			return bool(success);
 		}
 	}
 }
@@ -18,10 +18,13 @@ namespace nbl
 {
 	namespace asset
 	{
-		//! glTF Writer capable of writing .gltf files
+		//! glTF Writer capable of writing binary .glb files
 		/*
 			glTF bridges the gap between 3D content creation tools and modern 3D applications
 			by providing an efficient, extensible, interoperable format for the transmission and loading of 3D content.
+
+			Every meshbuffer becomes a primitive of a single mesh, attributes are looked up with the same layout ids the loader uses.
+			All vertex and index data goes into the BIN chunk, so the whole file is assembled in memory and written at once.
 		*/
 
 		class CGLTFWriter final : public asset::IAssetWriter
@@ -34,7 +37,7 @@ namespace nbl
 
 				virtual const char** getAssociatedFileExtensions() const override
 				{
-					static const char* extensions[]{ "gltf", nullptr };
+					static const char* extensions[]{ "glb", nullptr };
 					return extensions;
 				}
 
@@ -136,6 +136,17 @@ bool CGraphicsPipelineLoaderMTL::isALoadableFileFormat(system::IFile* _file, con
     return success && mtl.find("newmtl")!=std::string::npos;
 }
 
+bool CGraphicsPipelineLoaderMTL::isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger) const
+{
+    const std::string_view mtl(reinterpret_cast<const char*>(_header.data()), _header.size());
+    if (mtl.find("newmtl")!=std::string_view::npos)
+        return true;
+    // only scan the rest of the file if the header didn't cover all of it
+    if (!_file || _header.size()>=_file->getSize())
+        return false;
+    return isALoadableFileFormat(_file, logger);
+}
+
 SAssetBundle CGraphicsPipelineLoaderMTL::loadAsset(system::IFile* _file, const IAssetLoader::SAssetLoadParams& _params, IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
 {
     SContext ctx(
@@ -550,15 +561,21 @@ CGraphicsPipelineLoaderMTL::image_views_set_t CGraphicsPipelineLoaderMTL::loadIm
     images_set_t images;
     image_views_set_t views;
 
+    const SAssetLoadParams& lp = _ctx.inner.params;
+    const uint32_t hierarchyLevel = _ctx.topHierarchyLevel + ICPURenderpassIndependentPipeline::IMAGE_HIERARCHYLEVELS_BELOW; // this is weird actually, we're not sure if we're loading image or image view
+    // all maps but the bump map (which may need reloading with its content restored) get loaded in parallel
+    std::array<system::ISystem::future_t<SAssetBundle>, CMTLMetadata::CRenderpassIndependentPipeline::EMP_COUNT> pending;
+    for (uint32_t i = 0u; i < images.size(); ++i)
+    if (_mtl.maps[i].size() && i != CMTLMetadata::CRenderpassIndependentPipeline::EMP_BUMP)
+        interm_getAssetsInHierarchyAsync(m_assetMgr, {&pending[i],1}, {&_mtl.maps[i],1}, lp, hierarchyLevel, _ctx.loaderOverride);
+
     for (uint32_t i = 0u; i < images.size(); ++i)
     {
-        SAssetLoadParams lp = _ctx.inner.params;
         if (_mtl.maps[i].size() )
         {
-            const uint32_t hierarchyLevel = _ctx.topHierarchyLevel + ICPURenderpassIndependentPipeline::IMAGE_HIERARCHYLEVELS_BELOW; // this is weird actually, we're not sure if we're loading image or image view
             SAssetBundle bundle;
             if (i != CMTLMetadata::CRenderpassIndependentPipeline::EMP_BUMP)
-                bundle = interm_getAssetInHierarchy(m_assetMgr, _mtl.maps[i], lp, hierarchyLevel, _ctx.loaderOverride);
+                bundle = interm_waitForAssetInHierarchy(m_assetMgr, pending[i], _mtl.maps[i], lp, hierarchyLevel, _ctx.loaderOverride);
             else // TODO: you should attempt to get derivative map FIRST, then restore and regenerate! (right now you're always restoring!)
             {
                 // we need bumpmap restored to create derivative map from it
@@ -42,6 +42,7 @@ class CGraphicsPipelineLoaderMTL final : public asset::IRenderpassIndependentPip
         void initialize() override;
 
 		bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger=nullptr) const override;
+		bool isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger=nullptr) const override;
 
 		const char** getAssociatedFileExtensions() const override
 		{
@@ -0,0 +1,218 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "CImageLoaderDDS.h"
+
+#ifdef _NBL_COMPILE_WITH_DDS_LOADER_
+
+#include "SDDSFormat.h"
+#include "STextureContainerCommon.h"
+
+#include <bit>
+
+namespace nbl::asset
+{
+
+bool CImageLoaderDDS::isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const
+{
+	uint8_t magic[sizeof(SDDSFormat::Magic)];
+	system::IFile::success_t success;
+	_file->read(success, magic, 0, std::min<size_t>(sizeof(magic), _file->getSize()));
+	if (!success)
+		return false;
+	return isALoadableFileFormat({magic,success.getBytesProcessed()}, _file, logger);
+}
+
+bool CImageLoaderDDS::isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger) const
+{
+	return getFileMagics()[0].matches(_header);
+}
+
+std::span<const IAssetLoader::SFileMagic> CImageLoaderDDS::getFileMagics() const
+{
+	static constexpr SFileMagic magics[] = { {0u,SDDSFormat::Magic} };
+	return magics;
+}
+
+SAssetBundle CImageLoaderDDS::loadAsset(system::IFile* _file, const IAssetLoader::SAssetLoadParams& _params, IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
+{
+	if (!_file)
+		return {};
+
+	const auto fileName = _file->getFileName().string();
+	const size_t fileSize = _file->getSize();
+
+	// magic, header and possibly the DX10 header, read before committing to a read of the whole file
+	constexpr size_t HeaderOffset = sizeof(SDDSFormat::Magic);
+	constexpr size_t HeaderDXT10Offset = HeaderOffset+sizeof(SDDSFormat::SHeader);
+	uint8_t headers[HeaderDXT10Offset+sizeof(SDDSFormat::SHeaderDXT10)] = {};
+	{
+		system::IFile::success_t success;
+		_file->read(success, headers, 0, std::min<size_t>(sizeof(headers), fileSize));
+		if (!success || fileSize<HeaderDXT10Offset || memcmp(headers,SDDSFormat::Magic,sizeof(SDDSFormat::Magic))!=0)
+		{
+			_params.logger.log("LOAD DDS: %s is not a DDS file", system::ILogger::ELL_ERROR, fileName.c_str());
+			return {};
+		}
+	}
+	SDDSFormat::SHeader header;
+	memcpy(&header, headers+HeaderOffset, sizeof(header));
+
+	const bool hasDXT10Header = (header.pixelFormat.flags&SDDSFormat::EPFF_FOURCC) && header.pixelFormat.fourCC==SDDSFormat::makeFourCC('D','X','1','0');
+	SDDSFormat::SHeaderDXT10 headerDXT10 = {};
+	if (hasDXT10Header)
+	{
+		if (fileSize<sizeof(headers))
+		{
+			_params.logger.log("LOAD DDS: %s is truncated", system::ILogger::ELL_ERROR, fileName.c_str());
+			return {};
+		}
+		memcpy(&headerDXT10, headers+HeaderDXT10Offset, sizeof(headerDXT10));
+	}
+	const size_t dataOffset = hasDXT10Header ? sizeof(headers):HeaderDXT10Offset;
+
+	const auto format = hasDXT10Header ? SDDSFormat::getFormat(headerDXT10.dxgiFormat):SDDSFormat::getFormat(header.pixelFormat);
+	if (format.first==EF_UNKNOWN)
+	{
+		if (hasDXT10Header)
+			_params.logger.log("LOAD DDS: %s has the unsupported DXGI format %d", system::ILogger::ELL_ERROR, fileName.c_str(), headerDXT10.dxgiFormat);
+		else // legacy formats we can't alias are left to `CGLILoader`, so this isn't an error yet
+			_params.logger.log("LOAD DDS: %s has a legacy pixel format without a native equivalent", system::ILogger::ELL_DEBUG, fileName.c_str());
+		return {};
+	}
+
+	ICPUImage::SCreationParams imageInfo = {};
+	imageInfo.samples = ICPUImage::E_SAMPLE_COUNT_FLAGS::ESCF_1_BIT;
+	imageInfo.format = format.first;
+	imageInfo.extent.width = header.width;
+	imageInfo.extent.height = std::max(header.height,1u);
+	imageInfo.extent.depth = 1u;
+	imageInfo.usage = IImage::EUF_SAMPLED_BIT;
+
+	bool isCube;
+	uint32_t arrayElements = 1u;
+	if (hasDXT10Header)
+	{
+		switch (headerDXT10.resourceDimension)
+		{
+			case SDDSFormat::ERD_TEXTURE1D:
+				imageInfo.type = IImage::ET_1D;
+				imageInfo.extent.height = 1u;
+				break;
+			case SDDSFormat::ERD_TEXTURE2D:
+				imageInfo.type = IImage::ET_2D;
+				break;
+			case SDDSFormat::ERD_TEXTURE3D:
+				imageInfo.type = IImage::ET_3D;
+				imageInfo.extent.depth = std::max(header.depth,1u);
+				break;
+			default:
+				_params.logger.log("LOAD DDS: %s has an invalid resource dimension", system::ILogger::ELL_ERROR, fileName.c_str());
+				return {};
+		}
+		isCube = imageInfo.type==IImage::ET_2D && (headerDXT10.miscFlag&SDDSFormat::MiscTextureCube);
+		arrayElements = headerDXT10.arraySize;
+	}
+	else if ((header.caps2&SDDSFormat::EC2_VOLUME) && (header.flags&SDDSFormat::EHF_DEPTH))
+	{
+		imageInfo.type = IImage::ET_3D;
+		imageInfo.extent.depth = std::max(header.depth,1u);
+		isCube = false;
+	}
+	else
+	{
+		imageInfo.type = IImage::ET_2D;
+		isCube = header.caps2&SDDSFormat::EC2_CUBEMAP;
+		if (isCube && (header.caps2&SDDSFormat::EC2_CUBEMAP_ALLFACES)!=SDDSFormat::EC2_CUBEMAP_ALLFACES)
+		{
+			_params.logger.log("LOAD DDS: %s is a cubemap with missing faces, which is not supported", system::ILogger::ELL_ERROR, fileName.c_str());
+			return {};
+		}
+	}
+
+	// a mip count of 0 is written by some tools for a single level
+	imageInfo.mipLevels = (header.flags&SDDSFormat::EHF_MIPMAPCOUNT) ? std::max(header.mipMapCount,1u):1u;
+	const uint32_t maxMipLevels = std::bit_width(std::max({imageInfo.extent.width,imageInfo.extent.height,imageInfo.extent.depth}));
+	// every layer takes at least a byte, which bounds the region count for a corrupt array size
+	if (imageInfo.extent.width==0u || arrayElements==0u || arrayElements>fileSize || imageInfo.mipLevels>maxMipLevels || (imageInfo.type==IImage::ET_3D && arrayElements!=1u) ||
+		(isCube && imageInfo.extent.width!=imageInfo.extent.height))
+	{
+		_params.logger.log("LOAD DDS: %s has a malformed header", system::ILogger::ELL_ERROR, fileName.c_str());
+		return {};
+	}
+	imageInfo.arrayLayers = arrayElements*(isCube ? 6u:1u);
+	imageInfo.flags = isCube ? ICPUImage::E_CREATE_FLAGS::ECF_CUBE_COMPATIBLE_BIT:static_cast<ICPUImage::E_CREATE_FLAGS>(0u);
+
+	IImageView<ICPUImage>::E_TYPE viewType;
+	const bool isArray = arrayElements>1u;
+	switch (imageInfo.type)
+	{
+		case IImage::ET_1D:
+			viewType = isArray ? ICPUImageView::ET_1D_ARRAY:ICPUImageView::ET_1D;
+			break;
+		case IImage::ET_2D:
+			if (isCube)
+				viewType = isArray ? ICPUImageView::ET_CUBE_MAP_ARRAY:ICPUImageView::ET_CUBE_MAP;
+			else
+				viewType = isArray ? ICPUImageView::ET_2D_ARRAY:ICPUImageView::ET_2D;
+			break;
+		default:
+			viewType = ICPUImageView::ET_3D;
+			break;
+	}
+
+	// every layer holds its own mip chain, so there's a region per layer per mip
+	auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(size_t(imageInfo.arrayLayers)*imageInfo.mipLevels);
+	{
+		auto region = regions->begin();
+		size_t offset = dataOffset;
+		for (uint32_t layer=0u; layer<imageInfo.arrayLayers; layer++)
+		for (uint32_t mipLevel=0u; mipLevel<imageInfo.mipLevels; mipLevel++,region++)
+		{
+			region->imageExtent.width = std::max(imageInfo.extent.width>>mipLevel,1u);
+			region->imageExtent.height = std::max(imageInfo.extent.height>>mipLevel,1u);
+			region->imageExtent.depth = std::max(imageInfo.extent.depth>>mipLevel,1u);
+			region->bufferRowLength = region->imageExtent.width;
+			region->bufferImageHeight = 0u;
+			region->imageSubresource.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT;
+			region->imageSubresource.mipLevel = mipLevel;
+			region->imageSubresource.baseArrayLayer = layer;
+			region->imageSubresource.layerCount = 1u;
+			region->bufferOffset = offset;
+
+			size_t layerSize;
+			if (!STextureContainerCommon::getByteSize(format.first,region->imageExtent,1u,layerSize) || !STextureContainerCommon::checkedAdd(offset,offset,layerSize))
+			{
+				_params.logger.log("LOAD DDS: %s has a malformed header", system::ILogger::ELL_ERROR, fileName.c_str());
+				return {};
+			}
+		}
+		if (!STextureContainerCommon::regionsFitBuffer(format.first,fileSize,{regions->begin(),regions->end()}))
+		{
+			_params.logger.log("LOAD DDS: %s is truncated", system::ILogger::ELL_ERROR, fileName.c_str());
+			return {};
+		}
+	}
+
+	auto fileBuffer = STextureContainerCommon::getWholeFileBuffer(_file);
+	if (!fileBuffer)
+	{
+		_params.logger.log("LOAD DDS: can't read %s", system::ILogger::ELL_ERROR, fileName.c_str());
+		return {};
+	}
+
+	auto image = ICPUImage::create(std::move(imageInfo));
+	if (!image || !image->setBufferAndRegions(std::move(fileBuffer),regions))
+	{
+		_params.logger.log("LOAD DDS: %s describes an invalid image", system::ILogger::ELL_ERROR, fileName.c_str());
+		return {};
+	}
+	STextureContainerCommon::setContentHash(image.get());
+
+	return SAssetBundle(nullptr,{STextureContainerCommon::createImageView(std::move(image),viewType,format.second)});
+}
+
+}
+
+#endif // _NBL_COMPILE_WITH_DDS_LOADER_
@@ -0,0 +1,43 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_C_IMAGE_LOADER_DDS_H_INCLUDED_
+#define _NBL_ASSET_C_IMAGE_LOADER_DDS_H_INCLUDED_
+
+#include "BuildConfigOptions.h"
+
+#ifdef _NBL_COMPILE_WITH_DDS_LOADER_
+
+#include "nbl/asset/ICPUImageView.h"
+#include "nbl/asset/interchange/IAssetLoader.h"
+
+namespace nbl::asset
+{
+
+//! Loader for DirectDraw Surface textures, with or without the DX10 header, without going through an intermediate texture object
+/*
+	Nothing gets copied, the image's regions (one per mip of every array layer) point straight into the (mapped) file.
+*/
+class CImageLoaderDDS final : public IAssetLoader
+{
+	public:
+		bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const override;
+		bool isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger) const override;
+		std::span<const SFileMagic> getFileMagics() const override;
+
+		const char** getAssociatedFileExtensions() const override
+		{
+			static const char* extensions[]{ "dds", nullptr };
+			return extensions;
+		}
+
+		uint64_t getSupportedAssetTypesBitfield() const override { return IAsset::ET_IMAGE_VIEW; }
+		bool adoptsMappedMemory() const override { return true; }
+
+		SAssetBundle loadAsset(system::IFile* _file, const IAssetLoader::SAssetLoadParams& _params, IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
+};
+
+}
+
+#endif // _NBL_COMPILE_WITH_DDS_LOADER_
+#endif
@@ -11,20 +11,19 @@
 
 #include "nbl/system/IFile.h"
 
+#include "nbl/core/execution.h"
+
 #include "nbl/asset/ICPUBuffer.h"
 #include "nbl/asset/ICPUImageView.h"
 
 #include "nbl/asset/interchange/CImageHasher.h"
 #include "nbl/asset/interchange/IImageAssetHandlerBase.h"
 
+#include <numeric>
 #include <string>
 
-#include <stdio.h> // required for jpeglib.h
 #ifdef _NBL_COMPILE_WITH_LIBJPEG_
-extern "C" {
-#include "jpeglib.h"
-#include <setjmp.h>
-}
+#include "turbojpeg.h"
 #endif // _NBL_COMPILE_WITH_LIBJPEG_
 
 namespace nbl
@@ -51,100 +50,209 @@ CImageLoaderJPG::~CImageLoaderJPG()
 #ifdef _NBL_COMPILE_WITH_LIBJPEG_
 namespace jpeg
 {
-	// struct for handling jpeg errors
-	struct irr_jpeg_error_mgr
-	{
-		// public jpeg error fields
-		struct jpeg_error_mgr pub;
-
-		// for longjmp, to return to caller on a fatal error
-		jmp_buf setjmp_buffer;
-	};
-
-	/* 	Receives control for a fatal error.  Information sufficient to
-	generate the error message has been stored in cinfo->err; call
-	output_message to display it.  Control must NOT return to the caller;
-	generally this routine will exit() or longjmp() somewhere.
-	Typically you would override this routine to get rid of the exit()
-	default behavior.  Note that if you continue processing, you should
-	clean up the JPEG object with jpeg_abort() or jpeg_destroy().
+	//! Where the restart intervals of a sequential JPEG's only scan are
+	/*
+		When every interval covers whole MCU rows, a run of intervals together with all the markers before
+		the scan is a valid JPEG of its own once the height in the SOF gets patched. Runs have to start
+		at a multiple of 8 intervals, so that the RSTn markers inside them count up from RST0 again.
 	*/
-	void error_exit(j_common_ptr cinfo)
-	{
-		// unfortunately we need to use a goto rather than throwing an exception
-		// as gcc crashes under linux crashes when using throw from within
-		// extern c code
-
-		// Always display the message
-		(*cinfo->err->output_message) (cinfo);
-
-		// cinfo->err really points to a irr_error_mgr struct
-		irr_jpeg_error_mgr* myerr = (irr_jpeg_error_mgr*)cinfo->err;
-
-		longjmp(myerr->setjmp_buffer, 1);
-	}
-
-	/* output error messages via Irrlicht logger. */
-	void output_message(j_common_ptr cinfo)
-	{
-		// display the error message.
-		char temp1[JMSG_LENGTH_MAX];
-		(*cinfo->err->format_message)(cinfo, temp1);
-		std::string errMsg("JPEG FATAL ERROR in ");
-		auto ctx = reinterpret_cast<CImageLoaderJPG::SContext*>(cinfo->client_data);
-		errMsg += ctx->filename;
-		ctx->logger.log(errMsg + temp1, system::ILogger::ELL_ERROR);
-	}
-
-	/*	Initialize source.  This is called by jpeg_read_header() before any
-	data is actually read.  Unlike init_destination(), it may leave
-	bytes_in_buffer set to 0 (in which case a fill_input_buffer() call
-	will occur immediately). */
-	void init_source(j_decompress_ptr cinfo)
+	struct SRestartLayout
 	{
-		// DO NOTHING
-	}
+		//! everything before this gets copied into each slice
+		uint32_t scanDataOffset = 0u;
+		uint32_t sofHeightOffset = 0u;
+		uint32_t height = 0u;
+		uint32_t rowsPerInterval = 0u;
+		//! chroma planes upsampled vertically need a neighbouring MCU row on each side to match a whole image decode
+		bool verticalUpsampling = false;
+		//! `intervalBegins[i]` is where the entropy coded data of the i-th interval starts, `intervalEnds[i]` the marker after it
+		core::vector<uint32_t> intervalBegins;
+		core::vector<uint32_t> intervalEnds;
+	};
 
-	/*	This is called whenever bytes_in_buffer has reached zero and more
-	data is wanted.  In typical applications, it should read fresh data
-	into the buffer (ignoring the current state of next_input_byte and
-	bytes_in_buffer), reset the pointer & count to the start of the
-	buffer, and return TRUE indicating that the buffer has been reloaded.
-	It is not necessary to fill the buffer entirely, only to obtain at
-	least one more byte.  bytes_in_buffer MUST be set to a positive value
-	if TRUE is returned.  A FALSE return should only be used when I/O
-	suspension is desired (this mode is discussed in the next section). */
-	boolean fill_input_buffer(j_decompress_ptr cinfo)
+	//! Returns false for anything that can't be split along restart markers (progressive, arithmetic coded, multiple scans, ...)
+	bool parseRestartLayout(const uint8_t* data, const size_t size, SRestartLayout& layout)
 	{
-		// DO NOTHING
-		return TRUE;
-	}
+		if (size<4u || data[0]!=0xFFu || data[1]!=0xD8u)
+			return false;
+
+		uint32_t width = 0u;
+		uint32_t componentCount = 0u;
+		uint32_t maxH = 1u, maxV = 1u;
+		uint8_t verticalFactors[4] = {};
+		uint32_t restartInterval = 0u;
+		size_t pos = 2u;
+		for (bool inHeader=true; inHeader; )
+		{
+			if (pos+2u>size || data[pos]!=0xFFu)
+				return false;
+			const uint8_t marker = data[pos+1u];
+			// fill bytes and markers without a length
+			if (marker==0xFFu)
+			{
+				pos++;
+				continue;
+			}
+			if (marker==0x01u || (marker>=0xD0u && marker<=0xD7u))
+			{
+				pos += 2u;
+				continue;
+			}
+			if (pos+4u>size)
+				return false;
+			const uint32_t length = (uint32_t(data[pos+2u])<<8u)|data[pos+3u];
+			if (length<2u || pos+2u+length>size)
+				return false;
+			const uint8_t* segment = data+pos+4u;
+			const uint32_t segmentSize = length-2u;
+			switch (marker)
+			{
+				case 0xC0u: [[fallthrough]]; // baseline
+				case 0xC1u: // extended sequential, Huffman coded
+				{
+					if (componentCount || segmentSize<6u || segment[0]!=8u)
+						return false;
+					layout.sofHeightOffset = pos+5u;
+					layout.height = (uint32_t(segment[1])<<8u)|segment[2];
+					width = (uint32_t(segment[3])<<8u)|segment[4];
+					componentCount = segment[5];
+					if ((componentCount!=1u && componentCount!=3u) || segmentSize<6u+3u*componentCount || !layout.height || !width)
+						return false;
+					// a single component scan isn't interleaved, its MCU is one block whatever the sampling factors
+					if (componentCount>1u)
+					{
+						for (uint32_t c=0u; c<componentCount; c++)
+						{
+							const uint8_t factors = segment[7u+3u*c];
+							verticalFactors[c] = factors&0xFu;
+							maxH = std::max<uint32_t>(maxH,factors>>4u);
+							maxV = std::max<uint32_t>(maxV,verticalFactors[c]);
+						}
+					}
+					break;
+				}
+				case 0xDDu: // DRI
+					if (segmentSize<2u)
+						return false;
+					restartInterval = (uint32_t(segment[0])<<8u)|segment[1];
+					break;
+				case 0xDAu: // SOS
+					// the scan needs to hold all components, otherwise more scans follow
+					if (!componentCount || segmentSize<1u || segment[0]!=componentCount)
+						return false;
+					layout.scanDataOffset = pos+2u+length;
+					inHeader = false;
+					break;
+				case 0xD9u: // EOI
+					return false;
+				default:
+					// progressive, lossless, hierarchical and arithmetic coded frames, DHT and JPG aren't frames
+					if (marker>=0xC2u && marker<=0xCFu && marker!=0xC4u && marker!=0xC8u)
+						return false;
+					break;
+			}
+			pos += 2u+length;
+		}
 
-	/* Skip num_bytes worth of data.  The buffer pointer and count should
-	be advanced over num_bytes input bytes, refilling the buffer as
-	needed.  This is used to skip over a potentially large amount of
-	uninteresting data (such as an APPn marker).  In some applications
-	it may be possible to optimize away the reading of the skipped data,
-	but it's not clear that being smart is worth much trouble; large
-	skips are uncommon.  bytes_in_buffer may be zero on return.
-	A zero or negative skip count should be treated as a no-op. */
-	void skip_input_data(j_decompress_ptr cinfo, long num_bytes)
-	{
-		jpeg_source_mgr* src = cinfo->src;
-		if (num_bytes > 0)
+		const uint32_t mcuWidth = 8u*maxH;
+		const uint32_t mcuHeight = 8u*maxV;
+		const uint32_t mcusPerRow = (width+mcuWidth-1u)/mcuWidth;
+		if (!restartInterval || restartInterval%mcusPerRow)
+			return false;
+		layout.rowsPerInterval = restartInterval/mcusPerRow*mcuHeight;
+		layout.verticalUpsampling = false;
+		for (uint32_t c=0u; c<componentCount && componentCount>1u; c++)
+			layout.verticalUpsampling = layout.verticalUpsampling || verticalFactors[c]!=maxV;
+
+		layout.intervalBegins.clear();
+		layout.intervalEnds.clear();
+		layout.intervalBegins.push_back(layout.scanDataOffset);
+		for (pos=layout.scanDataOffset; pos+1u<size; pos++)
 		{
-			src->bytes_in_buffer -= num_bytes;
-			src->next_input_byte += num_bytes;
+			const void* found = memchr(data+pos,0xFF,size-pos-1u);
+			if (!found)
+				return false;
+			pos = reinterpret_cast<const uint8_t*>(found)-data;
+			const uint8_t marker = data[pos+1u];
+			// stuffed zero or fill byte
+			if (marker==0x00u || marker==0xFFu)
+				continue;
+			if (marker>=0xD0u && marker<=0xD7u)
+			{
+				if (marker-0xD0u!=layout.intervalEnds.size()%8u)
+					return false;
+				layout.intervalEnds.push_back(pos);
+				layout.intervalBegins.push_back(pos+2u);
+				pos++;
+				continue;
+			}
+			// a DNL or another scan can't be sliced
+			if (marker!=0xD9u)
+				return false;
+			layout.intervalEnds.push_back(pos);
+			break;
 		}
+		const uint32_t expectedIntervals = (layout.height+layout.rowsPerInterval-1u)/layout.rowsPerInterval;
+		return layout.intervalEnds.size()==layout.intervalBegins.size() && layout.intervalEnds.size()==expectedIntervals;
 	}
 
-	/* Terminate source --- called by jpeg_finish_decompress() after all
-	data has been read.  Often a no-op. */
-	void term_source(j_decompress_ptr cinfo)
+	//! Fails only on fatal errors, warnings about corrupt data still leave a decoded image behind
+	bool decompress(tjhandle handle, const uint8_t* src, const size_t srcSize, uint8_t* dst, const uint32_t width, const uint32_t pitch, const uint32_t height, const int pixelFormat)
 	{
-		// DO NOTHING
+		const int result = tjDecompress2(handle,src,srcSize,dst,width,pitch,height,pixelFormat,0);
+		return result==0 || tjGetErrorCode(handle)!=TJERR_FATAL;
 	}
 
+	//! Decodes runs of restart intervals as separate images on all threads, straight into `dst` unless vertical upsampling needs extra rows around a run
+	bool decompressSlices(const uint8_t* src, const SRestartLayout& layout, uint8_t* dst, const uint32_t width, const uint32_t pitch, const int pixelFormat)
+	{
+		constexpr uint32_t MinRowsPerSlice = 256u;
+		const uint32_t intervalCount = layout.intervalBegins.size();
+		const uint32_t intervalsPerSlice = 8u*std::max((MinRowsPerSlice+8u*layout.rowsPerInterval-1u)/(8u*layout.rowsPerInterval),1u);
+		const uint32_t sliceCount = (intervalCount+intervalsPerSlice-1u)/intervalsPerSlice;
+		if (sliceCount<2u)
+			return false;
+
+		core::vector<uint32_t> slices(sliceCount);
+		std::iota(slices.begin(),slices.end(),0u);
+		core::vector<uint8_t> succeeded(sliceCount,0u);
+		core::for_each(core::execution::par,slices.begin(),slices.end(),[&](const uint32_t slice) -> void
+			{
+				const uint32_t first = slice*intervalsPerSlice;
+				const uint32_t last = std::min(first+intervalsPerSlice,intervalCount);
+				const uint32_t contextFirst = layout.verticalUpsampling && first ? first-8u:first;
+				const uint32_t contextLast = layout.verticalUpsampling ? std::min(last+8u,intervalCount):last;
+				const uint32_t rowBegin = contextFirst*layout.rowsPerInterval;
+				const uint32_t rowEnd = std::min(contextLast*layout.rowsPerInterval,layout.height);
+				const uint32_t keptBegin = first*layout.rowsPerInterval;
+				const uint32_t keptEnd = std::min(last*layout.rowsPerInterval,layout.height);
+
+				core::vector<uint8_t> jpeg(layout.scanDataOffset+layout.intervalEnds[contextLast-1u]-layout.intervalBegins[contextFirst]+2u);
+				uint8_t* out = jpeg.data();
+				memcpy(out,src,layout.scanDataOffset);
+				out[layout.sofHeightOffset] = (rowEnd-rowBegin)>>8u;
+				out[layout.sofHeightOffset+1u] = (rowEnd-rowBegin)&0xFFu;
+				out += layout.scanDataOffset;
+				memcpy(out,src+layout.intervalBegins[contextFirst],layout.intervalEnds[contextLast-1u]-layout.intervalBegins[contextFirst]);
+				jpeg.end()[-2] = 0xFFu;
+				jpeg.end()[-1] = 0xD9u;
+
+				tjhandle handle = tjInitDecompress();
+				if (!handle)
+					return;
+				auto exiter = core::makeRAIIExiter([handle]() -> void {tjDestroy(handle);});
+				if (rowBegin==keptBegin && rowEnd==keptEnd)
+					succeeded[slice] = decompress(handle,jpeg.data(),jpeg.size(),dst+size_t(keptBegin)*pitch,width,pitch,rowEnd-rowBegin,pixelFormat);
+				else
+				{
+					core::vector<uint8_t> rows(size_t(rowEnd-rowBegin)*pitch);
+					succeeded[slice] = decompress(handle,jpeg.data(),jpeg.size(),rows.data(),width,pitch,rowEnd-rowBegin,pixelFormat);
+					memcpy(dst+size_t(keptBegin)*pitch,rows.data()+size_t(keptBegin-rowBegin)*pitch,size_t(keptEnd-keptBegin)*pitch);
+				}
+			}
+		);
+		return std::find(succeeded.begin(),succeeded.end(),0u)==succeeded.end();
+	}
 }
 #endif // _NBL_COMPILE_WITH_LIBJPEG_
 
@@ -164,6 +272,27 @@ bool CImageLoaderJPG::isALoadableFileFormat(system::IFile* _file, const system::
 #endif
 }
 
+bool CImageLoaderJPG::isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr) const
+{
+#ifndef _NBL_COMPILE_WITH_LIBJPEG_
+	return false;
+#else
+	uint32_t header = 0;
+	if (_header.size()<6+sizeof(uint32_t))
+		return false;
+	memcpy(&header, _header.data()+6, sizeof(uint32_t));
+	return ((header&0x00FFD8FFu)==0x00FFD8FFu || header == 0x4a464946 || header == 0x4649464a || header == 0x66697845u || header == 0x70747468u); // maybe 0x4a464946 can go
+#endif
+}
+
+std::span<const IAssetLoader::SFileMagic> CImageLoaderJPG::getFileMagics() const
+{
+	// SOI marker followed by the start of any other marker
+	static constexpr uint8_t soi[] = { 0xFF, 0xD8, 0xFF };
+	static constexpr SFileMagic magics[] = { {0u,soi} };
+	return magics;
+}
+
 //! creates a surface from the file
 asset::SAssetBundle CImageLoaderJPG::loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
 {
@@ -174,75 +303,34 @@ asset::SAssetBundle CImageLoaderJPG::loadAsset(system::IFile* _file, const asset
 	if (!_file || _file->getSize()>0xffffffffull)
         return {};
 
-	const std::filesystem::path& Filename = _file->getFileName();
-
-	uint8_t* input = new uint8_t[_file->getSize()];
+	// decode straight out of the mapping when there is one
+	const size_t fileSize = _file->getSize();
+	const uint8_t* input = reinterpret_cast<const uint8_t*>(static_cast<const system::IFile*>(_file)->getMappedPointer());
+	core::vector<uint8_t> fileContents;
+	if (!input)
+	{
+		fileContents.resize(fileSize);
+		system::IFile::success_t success;
+		_file->read(success, fileContents.data(), 0, fileSize);
+		if (!success)
+			return {};
+		input = fileContents.data();
+	}
 
-	system::IFile::success_t success;
-	_file->read(success, input, 0, _file->getSize());
-	if (!success)
+	tjhandle handle = tjInitDecompress();
+	if (!handle)
 		return {};
+	auto exiter = core::makeRAIIExiter([handle]() -> void {tjDestroy(handle);});
 
-	// allocate and initialize JPEG decompression object
-	struct jpeg_decompress_struct cinfo;
-	struct jpeg::irr_jpeg_error_mgr jerr;
-
-	//We have to set up the error handler first, in case the initialization
-	//step fails.  (Unlikely, but it could happen if you are out of memory.)
-	//This routine fills in the contents of struct jerr, and returns jerr's
-	//address which we place into the link field in cinfo.
-	SContext ctx;
-	ctx.filename = const_cast<char*>(Filename.string().c_str());
-	ctx.logger = _params.logger;
-	cinfo.err = jpeg_std_error(&jerr.pub);
-	cinfo.err->error_exit = jpeg::error_exit;
-	cinfo.err->output_message = jpeg::output_message;
-	cinfo.client_data = &ctx;
-
-
-	auto exitRoutine = [&] {
-		jpeg_destroy_decompress(&cinfo);
-		delete[] input;
-	};
-	auto exiter = core::makeRAIIExiter(exitRoutine);
-	// compatibility fudge:
-	// we need to use setjmp/longjmp for error handling as gcc-linux
-	// crashes when throwing within external c code
-	if (setjmp(jerr.setjmp_buffer))
+	int imageWidth, imageHeight, subsampling, colorspace;
+	if (tjDecompressHeader3(handle, input, fileSize, &imageWidth, &imageHeight, &subsampling, &colorspace))
 	{
-		_params.logger.log("Can't load libjpeg threw an error:", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
-		// RAIIExiter takes care of cleanup
-        return {};
+		_params.logger.log("Can't load libjpeg threw an error: %s %s", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str(), tjGetErrorStr2(handle));
+		return {};
 	}
 
-	// Now we can initialize the JPEG decompression object.
-	jpeg_create_decompress(&cinfo);
-
-	// specify data source
-	jpeg_source_mgr jsrc;
-
-	// Set up data pointer
-	jsrc.bytes_in_buffer = _file->getSize();
-	jsrc.next_input_byte = (JOCTET*)input;
-	cinfo.src = &jsrc;
-
-	jsrc.init_source = jpeg::init_source;
-	jsrc.fill_input_buffer = jpeg::fill_input_buffer;
-	jsrc.skip_input_data = jpeg::skip_input_data;
-	jsrc.resync_to_restart = jpeg_resync_to_restart;
-	jsrc.term_source = jpeg::term_source;
-
-	// Decodes JPG input from whatever source
-	// Does everything AFTER jpeg_create_decompress
-	// and BEFORE jpeg_destroy_decompress
-	// Caller is responsible for arranging these + setting up cinfo
-
-	// read _file parameters with jpeg_read_header()
-	jpeg_read_header(&cinfo, TRUE);
-
-    uint32_t imageSize[3] = { cinfo.image_width,cinfo.image_height,1 };
-    const uint32_t& width = imageSize[0];
-    const uint32_t& height = imageSize[1];
+    const uint32_t width = imageWidth;
+    const uint32_t height = imageHeight;
 
     ICPUImage::SCreationParams imgInfo;
     imgInfo.type = ICPUImage::ET_2D;
@@ -254,31 +342,29 @@ asset::SAssetBundle CImageLoaderJPG::loadAsset(system::IFile* _file, const asset
     imgInfo.samples = ICPUImage::E_SAMPLE_COUNT_FLAGS::ESCF_1_BIT;
     imgInfo.flags = static_cast<IImage::E_CREATE_FLAGS>(0u);
 
-	switch (cinfo.jpeg_color_space)
+	int pixelFormat;
+	switch (colorspace)
 	{
-		case JCS_GRAYSCALE:
-			cinfo.out_color_components = 1;
-			cinfo.output_gamma = 1.0; // output_gamma is a dead variable in libjpegturbo and jpeglib
+		case TJCS_GRAY:
+			pixelFormat = TJPF_GRAY;
             imgInfo.format = EF_R8_SRGB;
 			break;
-		case JCS_RGB:
-			cinfo.out_color_components = 3;
-			cinfo.output_gamma = 2.2333333; // output_gamma is a dead variable in libjpegturbo and jpeglib
+		case TJCS_RGB:
+			pixelFormat = TJPF_RGB;
             imgInfo.format = EF_R8G8B8_SRGB;
 			break;
-		case JCS_YCbCr:
-			cinfo.out_color_components = 3;
-			cinfo.output_gamma = 2.2333333; // output_gamma is a dead variable in libjpegturbo and jpeglib
+		case TJCS_YCbCr:
+			pixelFormat = TJPF_RGB;
             imgInfo.format = EF_R8G8B8_SRGB;
-			// it seems that libjpeg does Y'UV to R'G'B'conversion automagically
+			// libjpeg does Y'UV to R'G'B'conversion automagically
 			// however be prepared that the colors might be a bit "off"
 			// https://en.wikipedia.org/wiki/YCbCr#JPEG_conversion
 			break;
-		case JCS_CMYK:
-			_params.logger.log("CMYK color space is unsupported:", system::ILogger::ELL_ERROR, _file->getFileName().string());
+		case TJCS_CMYK:
+			_params.logger.log("CMYK color space is unsupported: %s", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
 			return {};
 			break;
-		case JCS_YCCK: // this I have no resources on
+		case TJCS_YCCK: // this I have no resources on
 			_params.logger.log("YCCK color space is unsupported: %s", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
 			return {};
 			break;
@@ -287,12 +373,6 @@ asset::SAssetBundle CImageLoaderJPG::loadAsset(system::IFile* _file, const asset
 			return {};
 			break;
 	}
-	cinfo.do_fancy_upsampling = TRUE;
-	
-	CImageHasher contentHasher(imgInfo);
-
-	// Start decompressor
-	jpeg_start_decompress(&cinfo);
 
 	auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(1u);
 	ICPUImage::SBufferCopy& region = regions->front();
@@ -305,36 +385,32 @@ asset::SAssetBundle CImageLoaderJPG::loadAsset(system::IFile* _file, const asset
 	region.bufferImageHeight = 0u; //tightly packed
 	region.imageOffset = { 0u, 0u, 0u };
 	region.imageExtent = imgInfo.extent;
-	
-	// Get image data
-	uint32_t rowspan = region.bufferRowLength * cinfo.out_color_components;
-
-	// Allocate memory for buffer
-	auto buffer = asset::ICPUBuffer::create({ rowspan*height });
-
-	// Here we use the library's state variable cinfo.output_scanline as the
-	// loop counter, so that we don't have to keep track ourselves.
-	// Create array of row pointers for lib
-	constexpr uint32_t MaxJPEGResolution = 65535u;
-	uint8_t* rowPtr[MaxJPEGResolution];
-	for (uint32_t i = 0; i < height; ++i)
-		rowPtr[i] = &reinterpret_cast<uint8_t*>(buffer->getPointer())[i*rowspan];
-
-	// Read rows from bottom order to match OpenGL coords
-	uint32_t rowsRead = 0;
-	uint32_t nRead;
-	while (cinfo.output_scanline < cinfo.output_height) {
-		nRead = jpeg_read_scanlines(&cinfo, &rowPtr[rowsRead], 1);
-		//since blake3 implementation greedily fills previous chunks, we can pass data row-wise
-		if (nRead) {
-			contentHasher.partialHash(0, 0, rowPtr[rowsRead], rowspan);
-		}
-		rowsRead += nRead;
+
+	const uint32_t texelSize = tjPixelSize[pixelFormat];
+	const uint32_t rowspan = region.bufferRowLength * texelSize;
+
+	// TurboJPEG decodes straight into the image's buffer
+	auto buffer = asset::ICPUBuffer::create({ size_t(rowspan)*height });
+	uint8_t* const texels = reinterpret_cast<uint8_t*>(buffer->getPointer());
+
+	// restart markers splitting the scan at MCU row boundaries let big images be decoded by all threads
+	jpeg::SRestartLayout restartLayout;
+	bool decoded = jpeg::parseRestartLayout(input, fileSize, restartLayout) && jpeg::decompressSlices(input, restartLayout, texels, width, rowspan, pixelFormat);
+	if (!decoded)
+		decoded = jpeg::decompress(handle, input, fileSize, texels, width, rowspan, height, pixelFormat);
+	if (!decoded)
+	{
+		_params.logger.log("Can't load libjpeg threw an error: %s %s", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str(), tjGetErrorStr2(handle));
+		return {};
 	}
-	
-	// Finish decompression
-	contentHasher.hashSeq(0, 0);
-	jpeg_finish_decompress(&cinfo);
+
+	// row padding doesn't get written by the decoder, keep it deterministic for the content hash
+	if (const uint32_t rowSize = width*texelSize; rowspan != rowSize)
+		for (uint32_t y = 0u; y < height; ++y)
+			memset(texels + size_t(y)*rowspan + rowSize, 0, rowspan - rowSize);
+
+	CImageHasher contentHasher(imgInfo);
+	contentHasher.hashSeq(0, 0, texels, buffer->getSize());
 
 	core::smart_refctd_ptr<ICPUImage> image = ICPUImage::create(std::move(imgInfo));
 	image->setBufferAndRegions(std::move(buffer), regions);
@@ -21,13 +21,6 @@ namespace asset
 //! Surface Loader for JPG images
 class CImageLoaderJPG : public asset::IAssetLoader
 {
-public:
-    struct SContext
-    {
-        char* filename = nullptr;
-        system::logger_opt_ptr logger = nullptr;
-    };
-private:
     protected:
 	    //! destructor
 	    virtual ~CImageLoaderJPG();
@@ -37,6 +30,8 @@ private:
 	    CImageLoaderJPG();
 
         virtual bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const override;
+        virtual bool isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger) const override;
+        virtual std::span<const SFileMagic> getFileMagics() const override;
 
         virtual const char** getAssociatedFileExtensions() const override
         {
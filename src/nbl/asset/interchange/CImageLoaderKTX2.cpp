@@ -0,0 +1,314 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "CImageLoaderKTX2.h"
+
+#ifdef _NBL_COMPILE_WITH_KTX2_LOADER_
+
+#include "nbl/asset/compile_config.h"
+
+#include "SKTX2Format.h"
+#include "STextureContainerCommon.h"
+
+#include <atomic>
+#include <bit>
+#include <numeric>
+
+#include "nbl/system/threadLocalDecompressor.h"
+
+namespace nbl::asset
+{
+
+namespace ktx2
+{
+	//! The `KTXswizzle` entry of the key/value data if there is one, as 4 characters out of "rgba01"
+	ICPUImageView::SComponentMapping getComponentMapping(const uint8_t* kvd, const size_t kvdSize)
+	{
+		constexpr std::string_view SwizzleKey = "KTXswizzle";
+
+		ICPUImageView::SComponentMapping mapping = {};
+		size_t pos = 0ull;
+		while (pos+sizeof(uint32_t)<=kvdSize)
+		{
+			uint32_t length;
+			memcpy(&length,kvd+pos,sizeof(length));
+			pos += sizeof(length);
+			if (length>kvdSize-pos)
+				break;
+
+			const char* entry = reinterpret_cast<const char*>(kvd+pos);
+			if (length>=SwizzleKey.size()+1u+4u && std::string_view(entry,SwizzleKey.size()+1u)==std::string_view(SwizzleKey.data(),SwizzleKey.size()+1u))
+			for (uint32_t c=0u; c<4u; c++)
+			switch (entry[SwizzleKey.size()+1u+c])
+			{
+				case 'r': mapping[c] = ICPUImageView::SComponentMapping::ES_R; break;
+				case 'g': mapping[c] = ICPUImageView::SComponentMapping::ES_G; break;
+				case 'b': mapping[c] = ICPUImageView::SComponentMapping::ES_B; break;
+				case 'a': mapping[c] = ICPUImageView::SComponentMapping::ES_A; break;
+				case '0': mapping[c] = ICPUImageView::SComponentMapping::ES_ZERO; break;
+				case '1': mapping[c] = ICPUImageView::SComponentMapping::ES_ONE; break;
+				default: break;
+			}
+			// every entry is padded to a multiple of 4 bytes
+			pos += (size_t(length)+3ull)&~3ull;
+		}
+		return mapping;
+	}
+}
+
+bool CImageLoaderKTX2::isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const
+{
+	uint8_t identifier[sizeof(SKTX2Format::Identifier)];
+	system::IFile::success_t success;
+	_file->read(success, identifier, 0, std::min<size_t>(sizeof(identifier), _file->getSize()));
+	if (!success)
+		return false;
+	return isALoadableFileFormat({identifier,success.getBytesProcessed()}, _file, logger);
+}
+
+bool CImageLoaderKTX2::isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger) const
+{
+	return getFileMagics()[0].matches(_header);
+}
+
+std::span<const IAssetLoader::SFileMagic> CImageLoaderKTX2::getFileMagics() const
+{
+	static constexpr SFileMagic magics[] = { {0u,SKTX2Format::Identifier} };
+	return magics;
+}
+
+SAssetBundle CImageLoaderKTX2::loadAsset(system::IFile* _file, const IAssetLoader::SAssetLoadParams& _params, IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
+{
+	if (!_file)
+		return {};
+
+	const auto fileName = _file->getFileName().string();
+	const size_t fileSize = _file->getSize();
+
+	SKTX2Format::SHeader header;
+	{
+		system::IFile::success_t success;
+		if (fileSize>=sizeof(header))
+			_file->read(success, &header, 0, sizeof(header));
+		if (fileSize<sizeof(header) || !success || memcmp(header.identifier,SKTX2Format::Identifier,sizeof(SKTX2Format::Identifier))!=0)
+		{
+			_params.logger.log("LOAD KTX2: %s is not a KTX 2.0 file", system::ILogger::ELL_ERROR, fileName.c_str());
+			return {};
+		}
+	}
+
+	switch (header.supercompressionScheme)
+	{
+		case SKTX2Format::ESS_NONE:
+			break;
+#ifdef _NBL_COMPILE_WITH_LIBDEFLATE_
+		case SKTX2Format::ESS_ZLIB:
+			break;
+#endif
+		case SKTX2Format::ESS_BASIS_LZ:
+			_params.logger.log("LOAD KTX2: %s is BasisLZ supercompressed, it needs transcoding which is not supported", system::ILogger::ELL_ERROR, fileName.c_str());
+			return {};
+		case SKTX2Format::ESS_ZSTD:
+			_params.logger.log("LOAD KTX2: %s is Zstandard supercompressed, which the engine is built without, re-encode it with zlib or without supercompression", system::ILogger::ELL_ERROR, fileName.c_str());
+			return {};
+		default:
+			_params.logger.log("LOAD KTX2: %s uses the unsupported supercompression scheme %d", system::ILogger::ELL_ERROR, fileName.c_str(), header.supercompressionScheme);
+			return {};
+	}
+
+	const E_FORMAT format = SKTX2Format::getFormat(header.vkFormat);
+	if (format==EF_UNKNOWN)
+	{
+		_params.logger.log("LOAD KTX2: %s has the unsupported VkFormat %d", system::ILogger::ELL_ERROR, fileName.c_str(), header.vkFormat);
+		return {};
+	}
+
+	// a level count of 0 asks for the mip chain to be generated, only the base level is stored
+	const uint32_t levelCount = std::max(header.levelCount,1u);
+	const size_t levelIndexEnd = sizeof(header)+size_t(levelCount)*sizeof(SKTX2Format::SLevelIndexEntry);
+	const uint32_t maxLevelCount = std::bit_width(std::max({header.pixelWidth,header.pixelHeight,header.pixelDepth}));
+	if (header.pixelWidth==0u || levelCount>maxLevelCount || (header.faceCount!=1u && header.faceCount!=6u) || levelIndexEnd>fileSize ||
+		size_t(header.kvdByteOffset)+header.kvdByteLength>fileSize || header.layerCount>fileSize || (header.pixelDepth && header.layerCount) ||
+		(header.faceCount==6u && (header.pixelDepth || header.pixelWidth!=header.pixelHeight)))
+	{
+		_params.logger.log("LOAD KTX2: %s has a malformed header", system::ILogger::ELL_ERROR, fileName.c_str());
+		return {};
+	}
+
+	// Without supercompression the file itself becomes the image's buffer, otherwise the compressed levels only need to be readable
+	core::smart_refctd_ptr<ICPUBuffer> fileBuffer;
+	const uint8_t* fileData = nullptr;
+	core::vector<uint8_t> fileContents;
+	if (header.supercompressionScheme==SKTX2Format::ESS_NONE)
+	{
+		fileBuffer = STextureContainerCommon::getWholeFileBuffer(_file);
+		if (fileBuffer)
+			fileData = reinterpret_cast<const uint8_t*>(fileBuffer->getPointer());
+	}
+	else if (!(fileData=reinterpret_cast<const uint8_t*>(static_cast<const system::IFile*>(_file)->getMappedPointer())))
+	{
+		fileContents.resize(fileSize);
+		system::IFile::success_t success;
+		_file->read(success, fileContents.data(), 0, fileSize);
+		if (success)
+			fileData = fileContents.data();
+	}
+	if (!fileData)
+	{
+		_params.logger.log("LOAD KTX2: can't read %s", system::ILogger::ELL_ERROR, fileName.c_str());
+		return {};
+	}
+
+	core::vector<SKTX2Format::SLevelIndexEntry> levelIndex(levelCount);
+	memcpy(levelIndex.data(), fileData+sizeof(header), levelCount*sizeof(SKTX2Format::SLevelIndexEntry));
+
+	ICPUImage::SCreationParams imageInfo = {};
+	imageInfo.type = header.pixelDepth ? IImage::ET_3D:(header.pixelHeight ? IImage::ET_2D:IImage::ET_1D);
+	imageInfo.samples = ICPUImage::E_SAMPLE_COUNT_FLAGS::ESCF_1_BIT;
+	imageInfo.format = format;
+	imageInfo.extent.width = header.pixelWidth;
+	imageInfo.extent.height = std::max(header.pixelHeight,1u);
+	imageInfo.extent.depth = std::max(header.pixelDepth,1u);
+	imageInfo.mipLevels = levelCount;
+	imageInfo.arrayLayers = std::max(header.layerCount,1u)*header.faceCount;
+	imageInfo.flags = header.faceCount==6u ? ICPUImage::E_CREATE_FLAGS::ECF_CUBE_COMPATIBLE_BIT:static_cast<ICPUImage::E_CREATE_FLAGS>(0u);
+	imageInfo.usage = IImage::EUF_SAMPLED_BIT;
+
+	IImageView<ICPUImage>::E_TYPE viewType;
+	switch (imageInfo.type)
+	{
+		case IImage::ET_1D:
+			viewType = header.layerCount ? ICPUImageView::ET_1D_ARRAY:ICPUImageView::ET_1D;
+			break;
+		case IImage::ET_2D:
+			if (header.faceCount==6u)
+				viewType = header.layerCount ? ICPUImageView::ET_CUBE_MAP_ARRAY:ICPUImageView::ET_CUBE_MAP;
+			else
+				viewType = header.layerCount ? ICPUImageView::ET_2D_ARRAY:ICPUImageView::ET_2D;
+			break;
+		default:
+			viewType = ICPUImageView::ET_3D;
+			break;
+	}
+
+	// Supercompressed levels get inflated back to back into one buffer
+	core::vector<size_t> levelOffsets(levelCount);
+	if (fileBuffer)
+	{
+		for (uint32_t level=0u; level<levelCount; level++)
+			levelOffsets[level] = levelIndex[level].byteOffset;
+	}
+	else
+	{
+		size_t bufferSize = 0ull;
+		for (uint32_t level=0u; level<levelCount; level++)
+		{
+			if (levelIndex[level].byteOffset>fileSize || levelIndex[level].byteLength>fileSize-levelIndex[level].byteOffset)
+			{
+				_params.logger.log("LOAD KTX2: %s has a level out of the file's bounds", system::ILogger::ELL_ERROR, fileName.c_str());
+				return {};
+			}
+			// the inflated level gets aliased by the region, so it has to be exactly as large as the extent says
+			const VkExtent3D levelExtent = {std::max(imageInfo.extent.width>>level,1u),std::max(imageInfo.extent.height>>level,1u),std::max(imageInfo.extent.depth>>level,1u)};
+			size_t levelSize;
+			if (!STextureContainerCommon::getByteSize(format,levelExtent,imageInfo.arrayLayers,levelSize) || levelSize!=levelIndex[level].uncompressedByteLength)
+			{
+				_params.logger.log("LOAD KTX2: %s has level %d whose uncompressed size doesn't match its extent", system::ILogger::ELL_ERROR, fileName.c_str(), level);
+				return {};
+			}
+			// keeps every level as aligned as the buffer itself
+			if (!STextureContainerCommon::checkedAdd(bufferSize,bufferSize,_NBL_SIMD_ALIGNMENT-1u))
+			{
+				_params.logger.log("LOAD KTX2: %s has a malformed level index", system::ILogger::ELL_ERROR, fileName.c_str());
+				return {};
+			}
+			bufferSize &= ~size_t(_NBL_SIMD_ALIGNMENT-1u);
+			levelOffsets[level] = bufferSize;
+			if (!STextureContainerCommon::checkedAdd(bufferSize,bufferSize,levelSize))
+			{
+				_params.logger.log("LOAD KTX2: %s has a malformed level index", system::ILogger::ELL_ERROR, fileName.c_str());
+				return {};
+			}
+		}
+		// deflate can't do better than about 1032:1, don't allocate for a level index lying about the sizes
+		if (bufferSize/1032u>fileSize+1024u)
+		{
+			_params.logger.log("LOAD KTX2: %s has a malformed level index", system::ILogger::ELL_ERROR, fileName.c_str());
+			return {};
+		}
+		fileBuffer = ICPUBuffer::create({bufferSize});
+		if (!fileBuffer)
+			return {};
+	}
+
+	auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(levelCount);
+	for (uint32_t level=0u; level<levelCount; level++)
+	{
+		auto& region = regions->operator[](level);
+		region.imageExtent.width = std::max(imageInfo.extent.width>>level,1u);
+		region.imageExtent.height = std::max(imageInfo.extent.height>>level,1u);
+		region.imageExtent.depth = std::max(imageInfo.extent.depth>>level,1u);
+		region.bufferRowLength = region.imageExtent.width;
+		region.bufferImageHeight = 0u;
+		region.imageSubresource.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT;
+		region.imageSubresource.mipLevel = level;
+		region.imageSubresource.baseArrayLayer = 0u;
+		region.imageSubresource.layerCount = imageInfo.arrayLayers;
+		region.bufferOffset = levelOffsets[level];
+
+		const size_t levelSize = header.supercompressionScheme==SKTX2Format::ESS_NONE ? levelIndex[level].byteLength:levelIndex[level].uncompressedByteLength;
+		size_t requiredSize;
+		if (!STextureContainerCommon::getByteSize(format,region.imageExtent,imageInfo.arrayLayers,requiredSize) || requiredSize>levelSize)
+		{
+			_params.logger.log("LOAD KTX2: %s has level %d too small for its extent", system::ILogger::ELL_ERROR, fileName.c_str(), level);
+			return {};
+		}
+	}
+	if (!STextureContainerCommon::regionsFitBuffer(format,fileBuffer->getSize(),{regions->begin(),regions->end()}))
+	{
+		_params.logger.log("LOAD KTX2: %s has a level out of the file's bounds", system::ILogger::ELL_ERROR, fileName.c_str());
+		return {};
+	}
+
+#ifdef _NBL_COMPILE_WITH_LIBDEFLATE_
+	if (header.supercompressionScheme==SKTX2Format::ESS_ZLIB)
+	{
+		// every level is a separate zlib stream, the largest come first so they start first
+		auto* const dst = reinterpret_cast<uint8_t*>(fileBuffer->getPointer());
+		core::vector<uint32_t> levels(levelCount);
+		std::iota(levels.begin(),levels.end(),0u);
+		std::atomic_bool failed = false;
+		core::for_each(core::execution::par,levels.begin(),levels.end(),[&](const uint32_t level) -> void
+			{
+				const auto& entry = levelIndex[level];
+				size_t inflatedSize = 0ull;
+				auto* const decompressor = system::impl::getThreadLocalDecompressor();
+				if (!decompressor || libdeflate_zlib_decompress(decompressor,fileData+entry.byteOffset,entry.byteLength,dst+levelOffsets[level],entry.uncompressedByteLength,&inflatedSize)!=LIBDEFLATE_SUCCESS || inflatedSize!=entry.uncompressedByteLength)
+					failed = true;
+			}
+		);
+		if (failed)
+		{
+			_params.logger.log("LOAD KTX2: %s has a corrupt zlib supercompressed level", system::ILogger::ELL_ERROR, fileName.c_str());
+			return {};
+		}
+	}
+#endif
+
+	const auto components = ktx2::getComponentMapping(fileData+header.kvdByteOffset,header.kvdByteLength);
+
+	auto image = ICPUImage::create(std::move(imageInfo));
+	if (!image || !image->setBufferAndRegions(std::move(fileBuffer),regions))
+	{
+		_params.logger.log("LOAD KTX2: %s describes an invalid image", system::ILogger::ELL_ERROR, fileName.c_str());
+		return {};
+	}
+	STextureContainerCommon::setContentHash(image.get());
+
+	return SAssetBundle(nullptr,{STextureContainerCommon::createImageView(std::move(image),viewType,components)});
+}
+
+}
+
+#endif // _NBL_COMPILE_WITH_KTX2_LOADER_
@@ -0,0 +1,44 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_C_IMAGE_LOADER_KTX2_H_INCLUDED_
+#define _NBL_ASSET_C_IMAGE_LOADER_KTX2_H_INCLUDED_
+
+#include "BuildConfigOptions.h"
+
+#ifdef _NBL_COMPILE_WITH_KTX2_LOADER_
+
+#include "nbl/asset/ICPUImageView.h"
+#include "nbl/asset/interchange/IAssetLoader.h"
+
+namespace nbl::asset
+{
+
+//! Loader for KTX 2.0 textures, without going through an intermediate texture object
+/*
+	Uncompressed levels are not copied at all, the image's regions point straight into the (mapped) file.
+	Levels supercompressed with zlib get inflated in parallel into one buffer, Zstandard and BasisLZ are not supported.
+*/
+class CImageLoaderKTX2 final : public IAssetLoader
+{
+	public:
+		bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const override;
+		bool isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger) const override;
+		std::span<const SFileMagic> getFileMagics() const override;
+
+		const char** getAssociatedFileExtensions() const override
+		{
+			static const char* extensions[]{ "ktx2", nullptr };
+			return extensions;
+		}
+
+		uint64_t getSupportedAssetTypesBitfield() const override { return IAsset::ET_IMAGE_VIEW; }
+		bool adoptsMappedMemory() const override { return true; }
+
+		SAssetBundle loadAsset(system::IFile* _file, const IAssetLoader::SAssetLoadParams& _params, IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
+};
+
+}
+
+#endif // _NBL_COMPILE_WITH_KTX2_LOADER_
+#endif
@@ -6,25 +6,29 @@
 #include <algorithm>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
 #include "nbl/asset/IAssetManager.h"
 
 #ifdef _NBL_COMPILE_WITH_OPENEXR_LOADER_
 
-#include "nbl/asset/filters/CRegionBlockFunctorFilter.h"
 #include "nbl/asset/interchange/CImageHasher.h"
 #include "nbl/asset/metadata/COpenEXRMetadata.h"
 
 #include "CImageLoaderOpenEXR.h"
 
+#include "nbl/asset/interchange/SOpenEXRLoadParams.h"
+
+#include "Iex.h"
 #include "ImfRgbaFile.h"
 #include "ImfInputFile.h"
+#include "ImfTiledInputFile.h"
+#include "ImfThreading.h"
 #include "ImfChannelList.h"
 #include "ImfChannelListAttribute.h"
 #include "ImfStringAttribute.h"
 #include "ImfMatrixAttribute.h"
-#include "ImfArray.h"
 
 #include "ImfNamespace.h"
 namespace IMF = Imf;
@@ -38,11 +42,14 @@ using namespace IMATH;
 namespace impl
 {
 
+//! Serves OpenEXR's reads straight out of the mapping when there is one, so it can decompress without copying the chunks first
 class nblIStream : public IMF::IStream
 {
 	public:
 		nblIStream(system::IFile* _nblFile)
-			: IMF::IStream(getFileName(_nblFile).c_str()), nblFile(_nblFile) {}
+			: IMF::IStream(getFileName(_nblFile).c_str()), nblFile(_nblFile),
+			mapped(reinterpret_cast<char*>(const_cast<void*>(static_cast<const system::IFile*>(_nblFile)->getMappedPointer())))
+		{}
 		virtual ~nblIStream() {}
 
 		//------------------------------------------------------
@@ -57,11 +64,36 @@ class nblIStream : public IMF::IStream
 
 		virtual bool read(char c[/*n*/], int n) override
 		{
-			system::IFile::success_t success;
-			nblFile->read(success, c, fileOffset, n);
-			fileOffset += success.getBytesProcessed();
-						
-			return bool(success);
+			if (mapped)
+				memcpy(c, readMemoryMapped(n), n);
+			else
+			{
+				system::IFile::success_t success;
+				nblFile->read(success, c, fileOffset, n);
+				fileOffset += success.getBytesProcessed();
+				if (!success)
+					throw IEX_NAMESPACE::InputExc("Unexpected end of file.");
+			}
+			return fileOffset < nblFile->getSize();
+		}
+
+		virtual bool isMemoryMapped() const override
+		{
+			return mapped;
+		}
+
+		//------------------------------------------------------
+		// Returns a pointer to the next n bytes of the mapping
+		// and moves the reading position past them.
+		//------------------------------------------------------
+
+		virtual char* readMemoryMapped(int n) override
+		{
+			if (!mapped || n < 0 || fileOffset + n > nblFile->getSize())
+				throw IEX_NAMESPACE::InputExc("Unexpected end of file.");
+			char* retval = mapped + fileOffset;
+			fileOffset += n;
+			return retval;
 		}
 
 		//--------------------------------------------------------
@@ -98,11 +130,6 @@ class nblIStream : public IMF::IStream
 			*/
 		}
 
-		void resetFileOffset()
-		{
-			fileOffset = 0u;
-		}
-
 	private:
 
 		const std::string getFileName(system::IFile* _nblFile)
@@ -113,6 +140,8 @@ class nblIStream : public IMF::IStream
 		}
 
 		system::IFile* nblFile;
+		// OpenEXR wants mutable pointers, but never writes through them
+		char* const mapped;
 		size_t fileOffset = {};
 };
 
@@ -124,10 +153,7 @@ using channelName = std::string;	     									// sytnax if as follows
 using mapOfChannels = std::unordered_map<channelName, Channel>;				// suffix.channel, where channel are "R", "G", "B", "A"
 
 class SContext;
-bool readVersionField(IMF::IStream* nblIStream, SContext& ctx, const system::logger_opt_ptr);
-bool readHeader(IMF::IStream* nblIStream, SContext& ctx);
-template<typename rgbaFormat>
-void readRgba(InputFile& file, std::array<Array2D<rgbaFormat>, 4>& pixelRgbaMapArray, int& width, int& height, E_FORMAT& format, const suffixOfChannelBundle suffixOfChannels);
+bool readVersionField(const int version, const char* fileName, SContext& ctx, const system::logger_opt_ptr);
 E_FORMAT specifyIrrlichtEndFormat(const mapOfChannels& mapOfChannels, const suffixOfChannelBundle suffixName, const std::string fileName, const system::logger_opt_ptr logger);
 
 //! A helpful struct for handling OpenEXR layout
@@ -212,47 +238,11 @@ struct SContext
 	// scan line blocks
 };
 
-constexpr uint8_t availableChannels = 4;
-struct PerImageData
-{
-	ICPUImage::SCreationParams params;
-	std::array<Array2D<half>, availableChannels> halfPixelMapArray;
-	std::array<Array2D<float>, availableChannels> fullFloatPixelMapArray;
-	std::array<Array2D<uint32_t>, availableChannels> uint32_tPixelMapArray;
-};
-template<typename IlmType>
-struct ReadTexels
-{
-		ReadTexels(ICPUImage* image, const std::array<Array2D<IlmType>, availableChannels>& _pixelMapArray) :
-			data(reinterpret_cast<uint8_t*>(image->getBuffer()->getPointer())), pixelMapArray(_pixelMapArray)
-		{
-			using StreamFromEXR = CRegionBlockFunctorFilter<ReadTexels<IlmType>,false>;
-			typename StreamFromEXR::state_type state(*this,image,image->getRegions().data());
-			StreamFromEXR::execute(core::execution::par_unseq,&state);
-		}
-
-		inline void operator()(uint32_t ptrOffset, const core::vectorSIMDu32& texelCoord)
-		{
-			assert(texelCoord.w==0u && texelCoord.z==0u);
-
-			uint8_t* texelPtr = data+ptrOffset;
-			for (auto channelIndex=0; channelIndex<availableChannels; channelIndex++)
-			{
-				const auto& element = pixelMapArray[channelIndex][texelCoord.y][texelCoord.x];
-				reinterpret_cast<typename std::decay<decltype(element)>::type*>(texelPtr)[channelIndex] = element;
-			}
-		}
-
-	private:
-		uint8_t* const data;
-		const std::array<Array2D<IlmType>, availableChannels>& pixelMapArray;
-};
-
-auto getChannels(const InputFile& file)
+auto getChannels(const Header& header)
 {
 	std::unordered_map<suffixOfChannelBundle, mapOfChannels> irrChannels;		    // example: G, albedo.R, color.space.B
 	{
-		auto channels = file.header().channels();
+		auto channels = header.channels();
 		for (auto mapItr = channels.begin(); mapItr != channels.end(); ++mapItr)
 		{
 			std::string fetchedChannelName = mapItr.name();
@@ -283,83 +273,172 @@ auto doesTheChannelExist(const std::string channelName, const mapOfChannels& map
 		return false;
 }
 
+CImageLoaderOpenEXR::CImageLoaderOpenEXR(IAssetManager* _manager) : m_manager(_manager)
+{
+	// OpenEXR only decompresses in parallel if its global thread pool has been given threads
+	if (IMF::globalThreadCount() == 0)
+		IMF::setGlobalThreadCount(std::thread::hardware_concurrency());
+}
+
 SAssetBundle CImageLoaderOpenEXR::loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
 {
 	if (!_file)
 		return {};
 
-	SContext ctx;
-
-	IMF::IStream* nblIStream = _NBL_NEW(impl::nblIStream, _file); // TODO: THIS NEEDS TESTING
-	InputFile file(*nblIStream);
-
-	if (file.isComplete())
-		static_cast<impl::nblIStream*>(nblIStream)->resetFileOffset();
-	else
+	const SOpenEXRLoadParams defaultParams;
+	const auto& exrParams = _hierarchyLevel == 0u && _params.userData ? *reinterpret_cast<const SOpenEXRLoadParams*>(_params.userData) : defaultParams;
+	const auto& channelNames = exrParams.channels;
+	if (channelNames.empty() || channelNames.size() > 4u)
 	{
-		_NBL_DELETE(nblIStream);
+		_params.logger.log("LOAD EXR: between 1 and 4 channels need to be requested for %s", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
 		return {};
 	}
+	const int threadCount = exrParams.threadCount ? exrParams.threadCount : IMF::globalThreadCount();
 
-	if (readVersionField(nblIStream, ctx, _params.logger))
-		static_cast<impl::nblIStream*>(nblIStream)->resetFileOffset();
-	else
+	SContext ctx;
+	impl::nblIStream nblIStream(_file);
+	try
 	{
-		_NBL_DELETE(nblIStream);
-		return {};
-	}
+		// tiled files need the tiled interface to get at their levels, OpenEXR reads level 0 of them as scanlines otherwise
+		std::unique_ptr<InputFile> scanlineFile;
+		std::unique_ptr<TiledInputFile> tiledFile;
+		{
+			InputFile file(nblIStream, threadCount);
+			if (!file.isComplete() || !readVersionField(file.version(), file.fileName(), ctx, _params.logger))
+				return {};
 
-	if (readHeader(nblIStream, ctx))
-		static_cast<impl::nblIStream*>(nblIStream)->resetFileOffset();
-	else
-	{
-		_NBL_DELETE(nblIStream);
-		return {};
-	}
+			nblIStream.seekg(0u);
+			if (ctx.versionField.Compoment.singlePartFileCompomentSubTypes == SContext::VersionField::Compoment::TILES)
+				tiledFile = std::make_unique<TiledInputFile>(nblIStream, threadCount);
+			else
+				scanlineFile = std::make_unique<InputFile>(nblIStream, threadCount);
+		}
+		const Header& header = tiledFile ? tiledFile->header() : scanlineFile->header();
+		const char* const fileName = tiledFile ? tiledFile->fileName() : scanlineFile->fileName();
 
-	core::vector<core::smart_refctd_ptr<ICPUImage>> images;
-	const auto channelsData = getChannels(file);
-	auto meta = core::make_smart_refctd_ptr<COpenEXRMetadata>(channelsData.size());
-	{
-		uint32_t metaOffset = 0u;
-		for (const auto& data : channelsData)
+		const int mipLevel = exrParams.mipLevel;
+		if (tiledFile ? !tiledFile->isValidLevel(mipLevel, mipLevel) : mipLevel != 0)
+		{
+			_params.logger.log("LOAD EXR: level %d doesn't exist in %s", system::ILogger::ELL_ERROR, mipLevel, fileName);
+			return {};
+		}
+		const Box2i dataWindow = tiledFile ? tiledFile->dataWindowForLevel(mipLevel, mipLevel) : header.dataWindow();
+
+		// the window gets clipped to the data window
+		Box2i window;
+		{
+			const int dataExtent[2] = { dataWindow.max.x - dataWindow.min.x + 1, dataWindow.max.y - dataWindow.min.y + 1 };
+			int windowMin[2], windowMax[2];
+			for (uint32_t i = 0u; i < 2u; ++i)
+			{
+				windowMin[i] = std::min<int64_t>(exrParams.windowOffset[i], dataExtent[i]);
+				const int64_t extent = exrParams.windowExtent[i] ? exrParams.windowExtent[i] : dataExtent[i];
+				windowMax[i] = std::min<int64_t>(windowMin[i] + extent, dataExtent[i]) - 1;
+			}
+			window.min = V2i(dataWindow.min.x + windowMin[0], dataWindow.min.y + windowMin[1]);
+			window.max = V2i(dataWindow.min.x + windowMax[0], dataWindow.min.y + windowMax[1]);
+		}
+		if (window.isEmpty())
 		{
-			const auto suffixOfChannels = data.first;
-			const auto mapOfChannels = data.second;
-			PerImageData perImageData;
+			_params.logger.log("LOAD EXR: the requested window is outside of the data window of %s", system::ILogger::ELL_ERROR, fileName);
+			return {};
+		}
 
-			int width;
-			int height;
+		// OpenEXR writes whole scanlines or tiles into the frame buffer, so that's what needs to be backed by memory
+		Box2i readWindow = window;
+		int tileRange[4] = {};
+		if (tiledFile)
+		{
+			const int tileSize[2] = { int(tiledFile->tileXSize()), int(tiledFile->tileYSize()) };
+			tileRange[0] = (window.min.x - dataWindow.min.x) / tileSize[0];
+			tileRange[1] = (window.max.x - dataWindow.min.x) / tileSize[0];
+			tileRange[2] = (window.min.y - dataWindow.min.y) / tileSize[1];
+			tileRange[3] = (window.max.y - dataWindow.min.y) / tileSize[1];
+			readWindow.min = V2i(dataWindow.min.x + tileRange[0] * tileSize[0], dataWindow.min.y + tileRange[2] * tileSize[1]);
+			readWindow.max = V2i(std::min(dataWindow.min.x + (tileRange[1] + 1) * tileSize[0] - 1, dataWindow.max.x), std::min(dataWindow.min.y + (tileRange[3] + 1) * tileSize[1] - 1, dataWindow.max.y));
+		}
+		else
+		{
+			readWindow.min.x = dataWindow.min.x;
+			readWindow.max.x = dataWindow.max.x;
+		}
+		const uint32_t width = window.max.x - window.min.x + 1;
+		const uint32_t height = window.max.y - window.min.y + 1;
+		const uint32_t readWidth = readWindow.max.x - readWindow.min.x + 1;
+		const uint32_t readHeight = readWindow.max.y - readWindow.min.y + 1;
+		const bool directRead = readWindow.min == window.min && readWindow.max == window.max;
 
-			auto params = perImageData.params;
-			params.format = specifyIrrlichtEndFormat(mapOfChannels, suffixOfChannels, file.fileName(), _params.logger);
+		struct SLayer
+		{
+			std::string name;
+			core::smart_refctd_ptr<ICPUImage> image;
+			uint32_t texelSize;
+			uint32_t rowPitch;
+			// only needed when more than the window gets read
+			core::vector<uint8_t> readBuffer;
+		};
+		core::vector<SLayer> layers;
+
+		// every selected layer goes into one frame buffer, so the chunks get decompressed once for all of them
+		FrameBuffer frameBuffer;
+		for (const auto& data : getChannels(header))
+		{
+			const auto& suffixOfChannels = data.first;
+			const auto& mapOfChannels = data.second;
+			if (!exrParams.layers.empty() && std::find(exrParams.layers.begin(), exrParams.layers.end(), suffixOfChannels) == exrParams.layers.end())
+				continue;
+
+			const E_FORMAT rgbaFormat = specifyIrrlichtEndFormat(mapOfChannels, suffixOfChannels, fileName, _params.logger);
+			PixelType pixelType;
+			E_FORMAT format;
+			{
+				const uint32_t channelCount = channelNames.size();
+				switch (rgbaFormat)
+				{
+					case EF_R16G16B16A16_SFLOAT:
+					{
+						constexpr E_FORMAT formats[] = { EF_R16_SFLOAT,EF_R16G16_SFLOAT,EF_R16G16B16_SFLOAT,EF_R16G16B16A16_SFLOAT };
+						pixelType = PixelType::HALF;
+						format = formats[channelCount - 1u];
+						break;
+					}
+					case EF_R32G32B32A32_SFLOAT:
+					{
+						constexpr E_FORMAT formats[] = { EF_R32_SFLOAT,EF_R32G32_SFLOAT,EF_R32G32B32_SFLOAT,EF_R32G32B32A32_SFLOAT };
+						pixelType = PixelType::FLOAT;
+						format = formats[channelCount - 1u];
+						break;
+					}
+					case EF_R32G32B32A32_UINT:
+					{
+						constexpr E_FORMAT formats[] = { EF_R32_UINT,EF_R32G32_UINT,EF_R32G32B32_UINT,EF_R32G32B32A32_UINT };
+						pixelType = PixelType::UINT;
+						format = formats[channelCount - 1u];
+						break;
+					}
+					default:
+						_params.logger.log("LOAD EXR: incorrect format specified for " + suffixOfChannels + " channels - skipping the file %s", system::ILogger::ELL_INFO, fileName);
+						continue;
+				}
+			}
+
+			ICPUImage::SCreationParams params = {};
+			params.format = format;
 			params.type = ICPUImage::ET_2D;
 			params.flags = static_cast<ICPUImage::E_CREATE_FLAGS>(0u);
 			params.samples = ICPUImage::E_SAMPLE_COUNT_FLAGS::ESCF_1_BIT;
-			params.extent.depth = 1u;
+			params.extent = { width, height, 1u };
 			params.mipLevels = 1u;
 			params.arrayLayers = 1u;
 
-			if (params.format == EF_UNKNOWN)
-			{
-				_params.logger.log("LOAD EXR: incorrect format specified for " + suffixOfChannels + " channels - skipping the file %s", system::ILogger::ELL_INFO, file.fileName());
-				continue;
-			}
-
-			if (params.format == EF_R16G16B16A16_SFLOAT)
-				readRgba(file, perImageData.halfPixelMapArray, width, height, params.format, suffixOfChannels);
-			else if (params.format == EF_R32G32B32A32_SFLOAT)
-				readRgba(file, perImageData.fullFloatPixelMapArray, width, height, params.format, suffixOfChannels);
-			else if (params.format == EF_R32G32B32A32_UINT)
-				readRgba(file, perImageData.uint32_tPixelMapArray, width, height, params.format, suffixOfChannels);
-
-			params.extent.width = width;
-			params.extent.height = height;
-
-			auto image = ICPUImage::create(std::move(params));
+			auto& layer = layers.emplace_back();
+			layer.name = suffixOfChannels;
+			layer.image = ICPUImage::create(std::move(params));
+			layer.texelSize = getTexelOrBlockBytesize(format);
+			const uint32_t bufferRowLength = calcPitchInBlocks(width, layer.texelSize);
+			layer.rowPitch = bufferRowLength * layer.texelSize;
 			{ // create image and buffer that backs it
-				const uint32_t texelFormatByteSize = getTexelOrBlockBytesize(image->getCreationParameters().format);
-				auto texelBuffer = ICPUBuffer::create({ image->getImageDataSizeInBytes() });
+				auto texelBuffer = ICPUBuffer::create({ size_t(layer.rowPitch) * height });
 				auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(1u);
 				ICPUImage::SBufferCopy& region = regions->front();
 				region.imageSubresource.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT;
@@ -367,32 +446,86 @@ SAssetBundle CImageLoaderOpenEXR::loadAsset(system::IFile* _file, const asset::I
 				region.imageSubresource.baseArrayLayer = 0u;
 				region.imageSubresource.layerCount = 1u;
 				region.bufferOffset = 0u;
-				region.bufferRowLength = calcPitchInBlocks(width, texelFormatByteSize);
+				region.bufferRowLength = bufferRowLength;
 				region.bufferImageHeight = 0u;
 				region.imageOffset = { 0u, 0u, 0u };
-				region.imageExtent = image->getCreationParameters().extent;
+				region.imageExtent = layer.image->getCreationParameters().extent;
 
-				image->setBufferAndRegions(std::move(texelBuffer), regions);
+				layer.image->setBufferAndRegions(std::move(texelBuffer), regions);
 			}
 
-			if (params.format == EF_R16G16B16A16_SFLOAT)
-				ReadTexels(image.get(),perImageData.halfPixelMapArray);
-			else if (params.format == EF_R32G32B32A32_SFLOAT)
-				ReadTexels(image.get(), perImageData.fullFloatPixelMapArray);
-			else if (params.format == EF_R32G32B32A32_UINT)
-				ReadTexels(image.get(), perImageData.uint32_tPixelMapArray);
-
-			CImageHasher contentHasher(params);
-			contentHasher.hashSeq(0, 0, image->getBuffer()->getPointer(), image->getImageDataSizeInBytes());
-			auto contentHash = contentHasher.finalizeSeq();
-			image->setContentHash(contentHash);
-			
-			meta->placeMeta(metaOffset++,image.get(),std::string(suffixOfChannels),IImageMetadata::ColorSemantic{ ECP_SRGB,EOTF_IDENTITY });
-			images.push_back(std::move(image));
+			// decompress straight into the image when only the window gets read
+			char* dst = reinterpret_cast<char*>(layer.image->getBuffer()->getPointer());
+			size_t yStride = layer.rowPitch;
+			if (!directRead)
+			{
+				yStride = size_t(readWidth) * layer.texelSize;
+				layer.readBuffer.resize(yStride * readHeight);
+				dst = reinterpret_cast<char*>(layer.readBuffer.data());
+			}
+			const uint32_t channelSize = layer.texelSize / channelNames.size();
+			for (uint32_t i = 0u; i < channelNames.size(); ++i)
+			{
+				const std::string name = suffixOfChannels.empty() ? channelNames[i] : suffixOfChannels + "." + channelNames[i];
+				frameBuffer.insert
+				(
+					name.c_str(),																// name
+					Slice(pixelType,															// type
+						dst + i * channelSize - readWindow.min.x * ptrdiff_t(layer.texelSize) - readWindow.min.y * ptrdiff_t(yStride), // base
+						layer.texelSize,														// xStride
+						yStride,																// yStride
+						1, 1,																	// x/y sampling
+						channelNames[i] == "A" ? 1 : 0											// default fillValue for channels that aren't present in file - 1 for alpha, otherwise 0
+					));
+			}
+		}
+
+		if (tiledFile)
+		{
+			tiledFile->setFrameBuffer(frameBuffer);
+			tiledFile->readTiles(tileRange[0], tileRange[1], tileRange[2], tileRange[3], mipLevel, mipLevel);
+		}
+		else
+		{
+			scanlineFile->setFrameBuffer(frameBuffer);
+			scanlineFile->readPixels(readWindow.min.y, readWindow.max.y);
+		}
+
+		core::vector<core::smart_refctd_ptr<ICPUImage>> images;
+		auto meta = core::make_smart_refctd_ptr<COpenEXRMetadata>(layers.size());
+		uint32_t metaOffset = 0u;
+		for (auto& layer : layers)
+		{
+			auto* const image = layer.image.get();
+			uint8_t* const texels = reinterpret_cast<uint8_t*>(image->getBuffer()->getPointer());
+			const size_t rowSize = size_t(width) * layer.texelSize;
+			// keep the row padding deterministic for the content hash
+			if (layer.rowPitch != rowSize)
+				for (uint32_t y = 0u; y < height; ++y)
+					memset(texels + y * layer.rowPitch + rowSize, 0, layer.rowPitch - rowSize);
+			if (!directRead)
+			{
+				const size_t readRowSize = size_t(readWidth) * layer.texelSize;
+				const uint8_t* src = layer.readBuffer.data() + (window.min.y - readWindow.min.y) * readRowSize + (window.min.x - readWindow.min.x) * layer.texelSize;
+				for (uint32_t y = 0u; y < height; ++y)
+					memcpy(texels + y * layer.rowPitch, src + y * readRowSize, rowSize);
+				layer.readBuffer = {};
+			}
+
+			CImageHasher contentHasher(image->getCreationParameters());
+			contentHasher.hashSeq(0, 0, texels, image->getBuffer()->getSize());
+			image->setContentHash(contentHasher.finalizeSeq());
+
+			meta->placeMeta(metaOffset++, image, std::move(layer.name), IImageMetadata::ColorSemantic{ ECP_SRGB,EOTF_IDENTITY });
+			images.push_back(std::move(layer.image));
 		}
-	}	
-	_NBL_DELETE(nblIStream);
-	return SAssetBundle(std::move(meta),std::move(images));
+		return SAssetBundle(std::move(meta), std::move(images));
+	}
+	catch (const std::exception& e)
+	{
+		_params.logger.log("LOAD EXR: failed to read %s: %s", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str(), e.what());
+	}
+	return {};
 }
 
 bool isImfMagic(char* b)
@@ -408,44 +541,16 @@ bool CImageLoaderOpenEXR::isALoadableFileFormat(system::IFile* _file, const syst
 	return success && isImfMagic(magicNumberBuffer);
 }
 
-template<typename rgbaFormat>
-void readRgba(InputFile& file, std::array<Array2D<rgbaFormat>, 4>& pixelRgbaMapArray, int& width, int& height, E_FORMAT& format, const suffixOfChannelBundle suffixOfChannels)
+bool CImageLoaderOpenEXR::isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger) const
 {
-	Box2i dw = file.header().dataWindow();
-	width = dw.max.x - dw.min.x + 1;
-	height = dw.max.y - dw.min.y + 1;
-
-	constexpr const char* rgbaSignatureAsText[] = {"R", "G", "B", "A"};
-	for (auto& pixelChannelBuffer : pixelRgbaMapArray)
-		pixelChannelBuffer.resizeErase(height, width);
-
-	FrameBuffer frameBuffer;
-	PixelType pixelType;
-
-	if (format == EF_R16G16B16A16_SFLOAT)
-		pixelType = PixelType::HALF;
-	else if (format == EF_R32G32B32A32_SFLOAT)
-		pixelType = PixelType::FLOAT;
-	else if (format == EF_R32G32B32A32_UINT)
-		pixelType = PixelType::UINT;
-
-	for (uint8_t rgbaChannelIndex = 0; rgbaChannelIndex < availableChannels; ++rgbaChannelIndex)
-	{
-		std::string name = suffixOfChannels.empty() ? rgbaSignatureAsText[rgbaChannelIndex] : suffixOfChannels + "." + rgbaSignatureAsText[rgbaChannelIndex];
-		frameBuffer.insert
-		(
-			name.c_str(),																					// name
-			Slice(pixelType,																				// type
-			(char*)(&(pixelRgbaMapArray[rgbaChannelIndex])[0][0] - dw.min.x - dw.min.y * width),			// base
-				sizeof((pixelRgbaMapArray[rgbaChannelIndex])[0][0]) * 1,                                    // xStride
-				sizeof((pixelRgbaMapArray[rgbaChannelIndex])[0][0]) * width,                                // yStride
-				1, 1,                                                                                       // x/y sampling
-				rgbaChannelIndex == 3 ? 1 : 0                                                               // default fillValue for channels that aren't present in file - 1 for alpha, otherwise 0
-			));
-	}
+	return getFileMagics()[0].matches(_header);
+}
 
-	file.setFrameBuffer(frameBuffer);
-	file.readPixels(dw.min.y, dw.max.y);
+std::span<const IAssetLoader::SFileMagic> CImageLoaderOpenEXR::getFileMagics() const
+{
+	static constexpr uint8_t imfMagic[] = { 0x76, 0x2f, 0x31, 0x01 };
+	static constexpr SFileMagic magics[] = { {0u,imfMagic} };
+	return magics;
 }
 
 E_FORMAT specifyIrrlichtEndFormat(const mapOfChannels& mapOfChannels, const suffixOfChannelBundle suffixName, const std::string fileName, const system::logger_opt_ptr logger)
@@ -490,21 +595,14 @@ E_FORMAT specifyIrrlichtEndFormat(const mapOfChannels& mapOfChannels, const suff
 	return retVal;
 }
 
-bool readVersionField(IMF::IStream* nblIStream, SContext& ctx, const system::logger_opt_ptr logger)
+bool readVersionField(const int version, const char* fileName, SContext& ctx, const system::logger_opt_ptr logger)
 {
-	RgbaInputFile file(*nblIStream);
-
-	if (!file.isComplete())
-		return false;
-
 	auto& versionField = ctx.versionField;
 			
-	versionField.mainDataRegisterField = file.version();
+	versionField.mainDataRegisterField = version;
 
 	auto isTheBitActive = [&](uint16_t bitToCheck)
 	{		
-		bool readVersionField(IMF::IStream* nblIStream, SContext& ctx);
-		bool readHeader(IMF::IStream* nblIStream, SContext& ctx);
 		return (versionField.mainDataRegisterField & (1 << (bitToCheck - 1)));
 	};
 
@@ -515,13 +613,7 @@ bool readVersionField(IMF::IStream* nblIStream, SContext& ctx, const system::log
 		versionField.Compoment.type = SContext::VersionField::Compoment::SINGLE_PART_FILE;
 
 		if (isTheBitActive(9))
-		{
 			versionField.Compoment.singlePartFileCompomentSubTypes = SContext::VersionField::Compoment::TILES;
-			#ifndef _NBL_PLATFORM_ANDROID_
-			logger.log("LOAD EXR: the file consist of not supported tiles %s", system::ILogger::ELL_ERROR, file.fileName());
-			#endif // !_NBL_PLATFORM_ANDROID_
-			return false;
-		}
 		else
 			versionField.Compoment.singlePartFileCompomentSubTypes = SContext::VersionField::Compoment::SCAN_LINES;
 	}
@@ -530,7 +622,7 @@ bool readVersionField(IMF::IStream* nblIStream, SContext& ctx, const system::log
 		versionField.Compoment.type = SContext::VersionField::Compoment::MULTI_PART_FILE;
 		versionField.Compoment.singlePartFileCompomentSubTypes = SContext::VersionField::Compoment::SCAN_LINES_OR_TILES;
 		#ifndef  _NBL_PLATFORM_ANDROID_
-		logger.log("LOAD EXR: the file is a not supported multi part file %s", system::ILogger::ELL_ERROR, file.fileName());
+		logger.log("LOAD EXR: the file is a not supported multi part file %s", system::ILogger::ELL_ERROR, fileName);
 		#endif // ! _NBL_PLATFORM_ANDROID_
 		return false;
 	}
@@ -539,7 +631,7 @@ bool readVersionField(IMF::IStream* nblIStream, SContext& ctx, const system::log
 	{
 		versionField.doesItSupportDeepData = true;
 		#ifndef  _NBL_PLATFORM_ANDROID_
-		logger.log("LOAD EXR: the file consist of not supported deep data%s", system::ILogger::ELL_ERROR, file.fileName());
+		logger.log("LOAD EXR: the file consist of not supported deep data%s", system::ILogger::ELL_ERROR, fileName);
 		#endif // ! _NBL_PLATFORM_ANDROID_
 		return false;
 	}
@@ -554,49 +646,6 @@ bool readVersionField(IMF::IStream* nblIStream, SContext& ctx, const system::log
 	return true;
 }
 
-bool readHeader(IMF::IStream* nblIStream, SContext& ctx)
-{
-	RgbaInputFile file(*nblIStream);
-
-	if (!file.isComplete())
-		return false;
-
-	auto& attribs = ctx.attributes;
-	auto& versionField = ctx.versionField;
-
-	/*
-
-	// There is an OpenEXR library implementation error associated with dynamic_cast<> probably
-	// Since OpenEXR loader only cares about RGB and RGBA, there is no need for bellow at the moment
-
-	attribs.channels = file.header().findTypedAttribute<Channel>("channels");
-	attribs.compression = file.header().findTypedAttribute<Compression>("compression");
-	attribs.dataWindow = file.header().findTypedAttribute<Box2i>("dataWindow");
-	attribs.displayWindow = file.header().findTypedAttribute<Box2i>("displayWindow");
-	attribs.lineOrder = file.header().findTypedAttribute<LineOrder>("lineOrder");
-	attribs.pixelAspectRatio = file.header().findTypedAttribute<float>("pixelAspectRatio");
-	attribs.screenWindowCenter = file.header().findTypedAttribute<V2f>("screenWindowCenter");
-	attribs.screenWindowWidth = file.header().findTypedAttribute<float>("screenWindowWidth");
-
-	if (versionField.Compoment.singlePartFileCompomentSubTypes == SContext::VersionField::Compoment::TILES)
-		attribs.tiles = file.header().findTypedAttribute<TileDescription>("tiles");
-
-	if (versionField.Compoment.type == SContext::VersionField::Compoment::MULTI_PART_FILE)
-		attribs.view = file.header().findTypedAttribute<std::string>("view");
-
-	if (versionField.Compoment.type == SContext::VersionField::Compoment::MULTI_PART_FILE || versionField.doesItSupportDeepData)
-	{
-		attribs.name = file.header().findTypedAttribute<std::string>("name");
-		attribs.type = file.header().findTypedAttribute<std::string>("type");
-		attribs.version = file.header().findTypedAttribute<int>("version");
-		attribs.chunkCount = file.header().findTypedAttribute<int>("chunkCount");
-		attribs.maxSamplesPerPixel = file.header().findTypedAttribute<int>("maxSamplesPerPixel");
-	}
-
-	*/
-
-	return true;
-}
 }
 
 
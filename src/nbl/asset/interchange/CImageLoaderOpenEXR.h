@@ -23,9 +23,12 @@ class CImageLoaderOpenEXR final : public IImageLoader
 		~CImageLoaderOpenEXR(){}
 
 	public:
-		CImageLoaderOpenEXR(IAssetManager* _manager) : m_manager(_manager) {}
+		//! Gives OpenEXR's global thread pool one thread per hardware thread, unless the application already sized it
+		CImageLoaderOpenEXR(IAssetManager* _manager);
 
 		bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const override;
+		bool isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger) const override;
+		std::span<const SFileMagic> getFileMagics() const override;
 
 		const char** getAssociatedFileExtensions() const override
 		{
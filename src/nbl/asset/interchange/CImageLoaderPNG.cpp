@@ -22,6 +22,10 @@ using namespace core;
 
 #include "nbl/system/IFile.h"
 
+#include "SPNGFormat.h"
+
+#include "nbl/system/threadLocalDecompressor.h"
+
 namespace nbl
 {
 namespace asset
@@ -30,13 +34,6 @@ namespace asset
 
 #ifdef _NBL_COMPILE_WITH_LIBPNG_
 // PNG function for error handling
-
-void updateFilePos(png_structp png_pt, size_t new_file_pos)
-{
-	auto ptr = (CImageLoaderPng::SContext*)png_get_user_chunk_ptr(png_pt);
-	ptr->file_pos = new_file_pos;
-	png_set_read_user_chunk_fn(png_pt, ptr, nullptr);
-}
 static void png_cpexcept_error(png_structp png_ptr, png_const_charp msg)
 {
 	auto ctx = (CImageLoaderPng::SContext*)png_get_user_chunk_ptr(png_ptr);
@@ -51,26 +48,366 @@ static void png_cpexcept_warn(png_structp png_ptr, png_const_charp msg)
 	ctx->logger.log("PNG warning", system::ILogger::ELL_WARNING); // png loader prints stuff that android fails to process 
 }
 
-// PNG function for file reading
+// PNG function for file reading, the file's contents are already in memory
 void PNGAPI user_read_data_fcn(png_structp png_pt, png_bytep data, png_size_t length)
 {
-	png_size_t check;
+	auto* userData = (CImageLoaderPng::SContext*)png_get_io_ptr(png_pt);
+	if (length > userData->size - userData->file_pos)
+		png_error(png_pt, "Read Error");
 
-	auto* userData = (CImageLoaderPng::SContext*)png_get_user_chunk_ptr(png_pt);
-	size_t file_pos = userData->file_pos;
+	memcpy(data, userData->data + userData->file_pos, length);
+	userData->file_pos += length;
+}
+#endif // _NBL_COMPILE_WITH_LIBPNG_
 
-	system::IFile* file=(system::IFile*)png_get_io_ptr(png_pt);
+#ifdef _NBL_COMPILE_WITH_LIBDEFLATE_
+namespace png
+{
+	using E_FILTER = SPNGFormat::E_FILTER;
 
-	system::IFile::success_t success;
-	file->read(success, data, file_pos, length);
-	check = success.getBytesProcessed();
-	file_pos += length;
-	updateFilePos(png_pt, file_pos);
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+	//! The bytes of a pixel don't depend on each other, so for RGB(A) a whole pixel gets reconstructed at once and only the pixels of a row run serially
+	template<uint32_t bpp>
+	void unfilterPixels(const E_FILTER filter, const uint8_t* src, uint8_t* dst, const uint8_t* prev, const size_t rowBytes)
+	{
+		auto load = [](const uint8_t* ptr) -> __m128i
+		{
+			int32_t value = 0;
+			memcpy(&value,ptr,bpp);
+			return _mm_cvtsi32_si128(value);
+		};
+		auto store = [](uint8_t* ptr, const __m128i value) -> void
+		{
+			const int32_t lanes = _mm_cvtsi128_si32(value);
+			memcpy(ptr,&lanes,bpp);
+		};
 
-	if (check != length)
-		png_error(png_pt, "Read Error");
+		const __m128i zero = _mm_setzero_si128();
+		__m128i a = zero;
+		switch (filter)
+		{
+			case E_FILTER::SUB:
+				for (size_t i=0u; i<rowBytes; i+=bpp)
+				{
+					a = _mm_add_epi8(load(src+i),a);
+					store(dst+i,a);
+				}
+				break;
+			case E_FILTER::AVERAGE:
+			{
+				const __m128i one = _mm_set1_epi8(1);
+				for (size_t i=0u; i<rowBytes; i+=bpp)
+				{
+					const __m128i b = load(prev+i);
+					// `_mm_avg_epu8` rounds up, PNG rounds down
+					const __m128i average = _mm_sub_epi8(_mm_avg_epu8(a,b),_mm_and_si128(_mm_xor_si128(a,b),one));
+					a = _mm_add_epi8(load(src+i),average);
+					store(dst+i,a);
+				}
+				break;
+			}
+			case E_FILTER::PAETH:
+			{
+				auto select = [](const __m128i mask, const __m128i ifTrue, const __m128i ifFalse) -> __m128i
+				{
+					return _mm_or_si128(_mm_and_si128(mask,ifTrue),_mm_andnot_si128(mask,ifFalse));
+				};
+				__m128i c = zero;
+				for (size_t i=0u; i<rowBytes; i+=bpp)
+				{
+					// in 16 bit lanes, `a+b-2c` doesn't fit 8 bits
+					const __m128i b = _mm_unpacklo_epi8(load(prev+i),zero);
+					const __m128i a16 = _mm_unpacklo_epi8(a,zero);
+					const __m128i bMinusC = _mm_sub_epi16(b,c);
+					const __m128i aMinusC = _mm_sub_epi16(a16,c);
+					const __m128i pa = _mm_abs_epi16(bMinusC);
+					const __m128i pb = _mm_abs_epi16(aMinusC);
+					const __m128i pc = _mm_abs_epi16(_mm_add_epi16(bMinusC,aMinusC));
+					const __m128i smallest = _mm_min_epi16(pc,_mm_min_epi16(pa,pb));
+					const __m128i nearest = select(_mm_cmpeq_epi16(smallest,pa),a16,select(_mm_cmpeq_epi16(smallest,pb),b,c));
+					a = _mm_add_epi8(load(src+i),_mm_packus_epi16(nearest,nearest));
+					store(dst+i,a);
+					c = b;
+				}
+				break;
+			}
+			default:
+				assert(false);
+				break;
+		}
+	}
+#endif // __NBL_COMPILE_WITH_X86_SIMD_
+
+	//! Reconstructs a row, `dst` may alias `src`, `prev` is the reconstructed row above (all zeroes for the first row)
+	void unfilterRow(const E_FILTER filter, const uint8_t* src, uint8_t* dst, const uint8_t* prev, const size_t rowBytes, const uint32_t bpp)
+	{
+		switch (filter)
+		{
+			case E_FILTER::NONE:
+				if (dst!=src)
+					memcpy(dst,src,rowBytes);
+				return;
+			case E_FILTER::UP:
+			{
+				size_t i = 0u;
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+				for (; i+16u<=rowBytes; i+=16u)
+				{
+					const __m128i sum = _mm_add_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i)),_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev+i)));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst+i),sum);
+				}
+#endif // __NBL_COMPILE_WITH_X86_SIMD_
+				for (; i<rowBytes; i++)
+					dst[i] = src[i]+prev[i];
+				return;
+			}
+			default:
+				break;
+		}
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+		if (bpp==4u)
+			return unfilterPixels<4u>(filter,src,dst,prev,rowBytes);
+		if (bpp==3u)
+			return unfilterPixels<3u>(filter,src,dst,prev,rowBytes);
+#endif // __NBL_COMPILE_WITH_X86_SIMD_
+		for (size_t i=0u; i<rowBytes; i++)
+		{
+			const uint8_t a = i>=bpp ? dst[i-bpp]:0u;
+			const uint8_t b = prev[i];
+			switch (filter)
+			{
+				case E_FILTER::SUB:
+					dst[i] = src[i]+a;
+					break;
+				case E_FILTER::AVERAGE:
+					dst[i] = src[i]+((uint32_t(a)+b)>>1u);
+					break;
+				default:
+					dst[i] = src[i]+SPNGFormat::paethPredictor(a,b,i>=bpp ? prev[i-bpp]:0u);
+					break;
+			}
+		}
+	}
+
+	//! Decodes 8 bit non-interlaced PNGs without libpng, inflating the IDAT stream at once and unfiltering it straight into the image's buffer
+	/*
+		Returns nullptr for anything that needs more of libpng's transforms (other bit depths, interlacing, gamma correction,
+		color keys of gray or RGB images, unknown critical chunks) or doesn't decode cleanly, libpng then gets to deal with it and report the errors.
+	*/
+	core::smart_refctd_ptr<ICPUImage> decodeDirect(const uint8_t* data, const size_t size)
+	{
+		if (size<sizeof(SPNGFormat::Signature)+SPNGFormat::ChunkOverhead+SPNGFormat::IHDRSize || memcmp(data,SPNGFormat::Signature,sizeof(SPNGFormat::Signature)))
+			return nullptr;
+
+		uint32_t width = 0u, height = 0u;
+		uint8_t bitDepth = 0u, interlace = 0u;
+		auto colorType = SPNGFormat::E_COLOR_TYPE::GRAY;
+		const uint8_t* palette = nullptr;
+		uint32_t paletteSize = 0u;
+		const uint8_t* transparency = nullptr;
+		uint32_t transparencySize = 0u;
+		bool hasSRGB = false;
+		uint32_t gamma = 0u;
+		core::vector<std::pair<const uint8_t*,uint32_t>> idats;
+		for (size_t pos=sizeof(SPNGFormat::Signature); ; )
+		{
+			if (size-pos<SPNGFormat::ChunkOverhead)
+				return nullptr;
+			const uint32_t length = SPNGFormat::readBE(data+pos);
+			const uint32_t type = SPNGFormat::readBE(data+pos+4u);
+			if (length>size-pos-SPNGFormat::ChunkOverhead)
+				return nullptr;
+			const uint8_t* chunk = data+pos+8u;
+			if (libdeflate_crc32(0u,data+pos+4u,length+4u)!=SPNGFormat::readBE(chunk+length))
+				return nullptr;
+			if ((type==SPNGFormat::ECT_IHDR)!=(pos==sizeof(SPNGFormat::Signature)))
+				return nullptr;
+			pos += SPNGFormat::ChunkOverhead+length;
+
+			if (type==SPNGFormat::ECT_IEND)
+				break;
+			if (type==SPNGFormat::ECT_IHDR)
+			{
+				// only the standard compression and filter methods exist
+				if (length!=SPNGFormat::IHDRSize || chunk[10] || chunk[11])
+					return nullptr;
+				width = SPNGFormat::readBE(chunk);
+				height = SPNGFormat::readBE(chunk+4u);
+				bitDepth = chunk[8];
+				colorType = SPNGFormat::E_COLOR_TYPE(chunk[9]);
+				interlace = chunk[12];
+			}
+			else if (type==SPNGFormat::ECT_PLTE)
+			{
+				if (length%3u || length>256u*3u)
+					return nullptr;
+				palette = chunk;
+				paletteSize = length/3u;
+			}
+			else if (type==SPNGFormat::ECT_tRNS)
+			{
+				transparency = chunk;
+				transparencySize = length;
+			}
+			else if (type==SPNGFormat::ECT_gAMA)
+				gamma = length==4u ? SPNGFormat::readBE(chunk):0u;
+			else if (type==SPNGFormat::ECT_sRGB)
+				hasSRGB = true;
+			else if (type==SPNGFormat::ECT_IDAT)
+				idats.emplace_back(chunk,length);
+			else if (SPNGFormat::isCritical(type))
+				return nullptr;
+		}
+		if (!width || !height || bitDepth!=8u || interlace || idats.empty())
+			return nullptr;
+		// PNG caps dimensions at 2^31-1 and libpng's default user limits at a million, anything bigger is for libpng to reject
+		constexpr uint32_t MaxSpecDimension = 0x7fffffffu;
+		constexpr uint32_t MaxLibPNGUserDimension = 1000000u;
+		if (width>std::min(MaxSpecDimension,MaxLibPNGUserDimension) || height>std::min(MaxSpecDimension,MaxLibPNGUserDimension))
+			return nullptr;
+		// the libpng path asks for a screen gamma of 2.2, which only changes the texels if the file's gamma is far from 1/2.2
+		if (!hasSRGB && gamma && std::abs(double(gamma)*2.2/100000.0-1.0)>=0.05)
+			return nullptr;
+		// turning a color key into alpha is left to libpng
+		if (transparency && colorType!=SPNGFormat::E_COLOR_TYPE::PALETTE)
+			return nullptr;
+
+		uint32_t bpp;
+		E_FORMAT format;
+		switch (colorType)
+		{
+			case SPNGFormat::E_COLOR_TYPE::GRAY:
+				bpp = 1u;
+				format = EF_R8_SRGB;
+				break;
+			case SPNGFormat::E_COLOR_TYPE::RGB:
+				bpp = 3u;
+				format = EF_R8G8B8_SRGB;
+				break;
+			case SPNGFormat::E_COLOR_TYPE::PALETTE:
+				if (!palette)
+					return nullptr;
+				bpp = 1u;
+				format = transparency ? EF_R8G8B8A8_SRGB:EF_R8G8B8_SRGB;
+				break;
+			case SPNGFormat::E_COLOR_TYPE::GRAY_ALPHA:
+				bpp = 2u;
+				format = EF_R8G8B8A8_SRGB;
+				break;
+			case SPNGFormat::E_COLOR_TYPE::RGBA:
+				bpp = 4u;
+				format = EF_R8G8B8A8_SRGB;
+				break;
+			default:
+				return nullptr;
+		}
+
+		size_t compressedSize = 0u;
+		for (const auto& idat : idats)
+			compressedSize += idat.second;
+		const size_t rowBytes = size_t(width)*bpp;
+		if (rowBytes+1u>std::numeric_limits<size_t>::max()/height)
+			return nullptr;
+		const size_t filteredSize = (rowBytes+1u)*height;
+		// deflate can't do better than about 1032:1, don't allocate for headers lying about the size
+		if (filteredSize/1032u>compressedSize+1024u)
+			return nullptr;
+
+		// a single IDAT gets inflated straight out of the file's contents
+		const uint8_t* compressed = idats.front().first;
+		core::vector<uint8_t> joined;
+		if (idats.size()>1u)
+		{
+			joined.reserve(compressedSize);
+			for (const auto& idat : idats)
+				joined.insert(joined.end(),idat.first,idat.first+idat.second);
+			compressed = joined.data();
+		}
+		auto* const decompressor = system::impl::getThreadLocalDecompressor();
+		core::vector<uint8_t> filtered(filteredSize);
+		if (!decompressor || libdeflate_zlib_decompress(decompressor,compressed,compressedSize,filtered.data(),filteredSize,nullptr)!=LIBDEFLATE_SUCCESS)
+			return nullptr;
+
+		ICPUImage::SCreationParams imgInfo;
+		imgInfo.type = ICPUImage::ET_2D;
+		imgInfo.format = format;
+		imgInfo.extent = { width, height, 1u };
+		imgInfo.mipLevels = 1u;
+		imgInfo.arrayLayers = 1u;
+		imgInfo.samples = ICPUImage::E_SAMPLE_COUNT_FLAGS::ESCF_1_BIT;
+		imgInfo.flags = static_cast<IImage::E_CREATE_FLAGS>(0u);
+
+		const uint32_t texelSize = getTexelOrBlockBytesize(format);
+		auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(1u);
+		ICPUImage::SBufferCopy& region = regions->front();
+		region.imageSubresource.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT;
+		region.imageSubresource.mipLevel = 0u;
+		region.imageSubresource.baseArrayLayer = 0u;
+		region.imageSubresource.layerCount = 1u;
+		region.bufferOffset = 0u;
+		region.bufferRowLength = asset::IImageAssetHandlerBase::calcPitchInBlocks(width, texelSize);
+		region.bufferImageHeight = 0u; //tightly packed
+		region.imageOffset = { 0u, 0u, 0u };
+		region.imageExtent = imgInfo.extent;
+
+		const size_t pitch = size_t(region.bufferRowLength)*texelSize;
+		if (pitch>std::numeric_limits<size_t>::max()/height)
+			return nullptr;
+		auto texelBuffer = ICPUBuffer::create({ pitch*height });
+		uint8_t* const texels = reinterpret_cast<uint8_t*>(texelBuffer->getPointer());
+
+		// palette indices past the end of PLTE decode as opaque black, like libpng does
+		uint8_t paletteLUT[256][4] = {};
+		for (uint32_t i=0u; i<256u; i++)
+		{
+			if (i<paletteSize)
+				memcpy(paletteLUT[i],palette+i*3u,3u);
+			paletteLUT[i][3] = i<transparencySize ? transparency[i]:0xFFu;
+		}
+
+		// gray, RGB and RGBA rows already have the layout of the image, the rest gets unfiltered in place and expanded
+		const bool direct = texelSize==bpp;
+		const core::vector<uint8_t> zeroRow(rowBytes,0u);
+		const uint8_t* prev = zeroRow.data();
+		for (uint32_t y=0u; y<height; y++)
+		{
+			uint8_t* const src = filtered.data()+y*(rowBytes+1u);
+			if (src[0]>=uint8_t(E_FILTER::COUNT))
+				return nullptr;
+			uint8_t* const row = texels+y*pitch;
+			uint8_t* const dst = direct ? row:(src+1u);
+			unfilterRow(E_FILTER(src[0]),src+1u,dst,prev,rowBytes,bpp);
+			prev = dst;
+			if (direct)
+				continue;
+
+			if (colorType==SPNGFormat::E_COLOR_TYPE::GRAY_ALPHA)
+			{
+				for (uint32_t x=0u; x<width; x++)
+				{
+					const uint8_t luma = dst[x*2u];
+					row[x*4u+0u] = luma;
+					row[x*4u+1u] = luma;
+					row[x*4u+2u] = luma;
+					row[x*4u+3u] = dst[x*2u+1u];
+				}
+			}
+			else
+			{
+				for (uint32_t x=0u; x<width; x++)
+					memcpy(row+x*texelSize,paletteLUT[dst[x]],texelSize);
+			}
+		}
+
+		auto image = ICPUImage::create(std::move(imgInfo));
+		if (!image)
+			return nullptr;
+		image->setBufferAndRegions(std::move(texelBuffer), regions);
+		image->setContentHash(image->computeContentHash());
+		return image;
+	}
 }
-#endif // _NBL_COMPILE_WITH_LIBPNG_
+#endif // _NBL_COMPILE_WITH_LIBDEFLATE_
 
 
 //! returns true if the file maybe is able to be loaded by this class
@@ -97,6 +434,22 @@ bool CImageLoaderPng::isALoadableFileFormat(system::IFile* _file, const system::
 }
 
 
+bool CImageLoaderPng::isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger) const
+{
+#ifdef _NBL_COMPILE_WITH_LIBPNG_
+	return _header.size()>=8 && !png_sig_cmp(_header.data(), 0, 8);
+#else
+	return false;
+#endif // _NBL_COMPILE_WITH_LIBPNG_
+}
+
+std::span<const IAssetLoader::SFileMagic> CImageLoaderPng::getFileMagics() const
+{
+	static constexpr uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+	static constexpr SFileMagic magics[] = { {0u,signature} };
+	return magics;
+}
+
 // load in the image data
 asset::SAssetBundle CImageLoaderPng::loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
 {
@@ -110,24 +463,35 @@ asset::SAssetBundle CImageLoaderPng::loadAsset(system::IFile* _file, const asset
 	//Used to point to image rows
 	uint8_t** RowPointers = 0;
 
-	png_byte buffer[8];
-	// Read the first few bytes of the PNG _file
-
-	system::IFile::success_t success;
-	_file->read(success, buffer, 0, sizeof(buffer));
-	if (!success)
+	// the file is read once (or not at all when it's mapped) instead of a read per libpng callback
+	const size_t fileSize = _file->getSize();
+	const uint8_t* fileData = reinterpret_cast<const uint8_t*>(static_cast<const system::IFile*>(_file)->getMappedPointer());
+	core::vector<uint8_t> fileContents;
+	if (!fileData)
 	{
-		_params.logger.log("LOAD PNG: can't read _file\n", system::ILogger::ELL_ERROR, _file->getFileName().string());
-        return {};
+		fileContents.resize(fileSize);
+		system::IFile::success_t success;
+		_file->read(success, fileContents.data(), 0, fileSize);
+		if (!success)
+		{
+			_params.logger.log("LOAD PNG: can't read _file %s\n", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
+			return {};
+		}
+		fileData = fileContents.data();
 	}
 
 	// Check if it really is a PNG _file
-	if( png_sig_cmp(buffer, 0, 8) )
+	if (fileSize < 8 || png_sig_cmp(fileData, 0, 8))
 	{
 		_params.logger.log("LOAD PNG: not really a png\n", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
         return {};
 	}
 
+#ifdef _NBL_COMPILE_WITH_LIBDEFLATE_
+	if (auto image = png::decodeDirect(fileData, fileSize))
+		return SAssetBundle(nullptr,{std::move(image)});
+#endif // _NBL_COMPILE_WITH_LIBDEFLATE_
+
 	// Allocate the png read struct
 	png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING,
 		nullptr, (png_error_ptr)png_cpexcept_error, (png_error_ptr)png_cpexcept_warn);
@@ -154,10 +518,10 @@ asset::SAssetBundle CImageLoaderPng::loadAsset(system::IFile* _file, const asset
 			_NBL_DELETE_ARRAY(RowPointers, Height);
         return {};
 	}
-	SContext usrData(_params.logger);
+	SContext usrData(_params.logger, fileData, fileSize);
 	png_set_read_user_chunk_fn(png_ptr, &usrData, nullptr);
 
-	png_set_read_fn(png_ptr, _file, user_read_data_fcn);
+	png_set_read_fn(png_ptr, &usrData, user_read_data_fcn);
 
 	png_set_sig_bytes(png_ptr, 8); // Tell png that we read the signature
 
@@ -26,14 +26,18 @@ class CImageLoaderPng : public asset::IAssetLoader
 public:
     struct SContext
     {
-        SContext(const system::logger_opt_ptr _logger) :  logger(_logger) {}
-        // Made file_pos initial value 8 cause it's first set to 8 in CImageLoaderPng::loadAsset
-        // and set to 8 but you cannot access this struct from there
+        SContext(const system::logger_opt_ptr _logger, const uint8_t* _data, const size_t _size) : logger(_logger), data(_data), size(_size) {}
+        // Made file_pos initial value 8 cause the signature is checked before libpng gets to read
         size_t file_pos = 8;
         system::logger_opt_ptr logger;
+        //! whole file, mapped or read at once
+        const uint8_t* data;
+        size_t size;
     };
     explicit CImageLoaderPng() {}
     virtual bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const override;
+    virtual bool isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger) const override;
+    virtual std::span<const SFileMagic> getFileMagics() const override;
 
     virtual const char** getAssociatedFileExtensions() const override
     {
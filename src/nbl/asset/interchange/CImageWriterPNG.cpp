@@ -15,52 +15,265 @@
 #include "nbl/asset/ICPUImageView.h"
 #include "nbl/asset/interchange/IImageAssetHandlerBase.h"
 
+#include "nbl/asset/interchange/SPNGWriteParams.h"
+#include "nbl/core/execution.h"
+
 #include "CImageLoaderPNG.h"
+#include "SPNGFormat.h"
+
+#ifdef _NBL_COMPILE_WITH_LIBDEFLATE_
+	#include <libdeflate.h>
+#endif // _NBL_COMPILE_WITH_LIBDEFLATE_
 
-#ifdef _NBL_COMPILE_WITH_LIBPNG_
-	#include "libpng/png.h"
-#endif // _NBL_COMPILE_WITH_LIBPNG_
+#include <numeric>
 
 namespace nbl::asset
 {
 
-#ifdef _NBL_COMPILE_WITH_LIBPNG_
-
-const system::logger_opt_ptr getLogger(png_structp png_ptr)
-{
-	return ((CImageWriterPNG::SContext*)png_get_user_chunk_ptr(png_ptr))->logger;
-}
-// PNG function for error handling
-static void png_cpexcept_error(png_structp png_ptr, png_const_charp msg)
+#ifdef _NBL_COMPILE_WITH_LIBDEFLATE_
+namespace png
 {
-	getLogger(png_ptr).log("PNG fatal error %s", system::ILogger::ELL_ERROR, msg);
-	longjmp(png_jmpbuf(png_ptr), 1);
-}
+	using E_FILTER = SPNGFormat::E_FILTER;
 
-// PNG function for warning handling
-static void png_cpexcept_warning(png_structp png_ptr, png_const_charp msg)
-{
-	getLogger(png_ptr).log("PNG warning %s", system::ILogger::ELL_WARNING, msg);
-}
+	enum class E_PRESET : uint8_t
+	{
+		//! libdeflate level 1, for screenshots and intermediate outputs
+		FAST,
+		//! libdeflate level 6, about zlib's default ratio at a fraction of its time
+		DEFAULT,
+		//! libdeflate level 12, for assets that get written once and loaded many times
+		MAX
+	};
+	//! Without `EWF_COMPRESSED` disk space isn't a concern so the fastest level gets used, otherwise the compression level picks between the other two
+	E_PRESET getPreset(const E_WRITER_FLAGS flags, const float compressionLevel)
+	{
+		if (!(flags&EWF_COMPRESSED))
+			return E_PRESET::FAST;
+		return compressionLevel<0.5f ? E_PRESET::DEFAULT:E_PRESET::MAX;
+	}
 
-// PNG function for file writing
-void PNGAPI user_write_data_fcn(png_structp png_ptr, png_bytep data, png_size_t length)
-{
-	png_size_t check;
+	// compressors of the higher levels allocate megabytes, so every thread keeps one per preset around
+	libdeflate_compressor* getThreadLocalCompressor(const E_PRESET preset)
+	{
+		constexpr int Levels[] = { 1, 6, 12 };
+		using compressor_ptr = std::unique_ptr<libdeflate_compressor,decltype(&libdeflate_free_compressor)>;
+		thread_local compressor_ptr compressors[] = {
+			compressor_ptr(nullptr,&libdeflate_free_compressor),
+			compressor_ptr(nullptr,&libdeflate_free_compressor),
+			compressor_ptr(nullptr,&libdeflate_free_compressor)
+		};
+		const auto index = static_cast<uint8_t>(preset);
+		if (!compressors[index])
+			compressors[index].reset(libdeflate_alloc_compressor(Levels[index]));
+		return compressors[index].get();
+	}
 
-	system::IFile* file=(system::IFile*)png_get_io_ptr(png_ptr);
-	//check=(png_size_t) file->write((const void*)data,(uint32_t)length);
-	auto usrData = (CImageWriterPNG::SContext*)png_get_user_chunk_ptr(png_ptr);
-	
-	system::IFile::success_t success;
-	file->write(success, data, usrData->file_pos, length);
-	if (!success)
-		png_error(png_ptr, "Write Error");
+	//! Filters a row into `out`, `prev` is the unfiltered row above (all zeroes for the first row)
+	/*
+		Unlike reconstruction, filtering only reads the original texels, so every filter vectorizes across the whole row.
+	*/
+	void filterRow(const E_FILTER filter, const uint8_t* row, const uint8_t* prev, uint8_t* out, const size_t rowBytes, const uint32_t bpp)
+	{
+		size_t i = 0u;
+		if (filter==E_FILTER::NONE)
+		{
+			memcpy(out,row,rowBytes);
+			return;
+		}
+		// the first pixel has nothing to its left
+		for (; i<std::min<size_t>(bpp,rowBytes); i++)
+		switch (filter)
+		{
+			case E_FILTER::SUB:
+				out[i] = row[i];
+				break;
+			case E_FILTER::AVERAGE:
+				out[i] = row[i]-(prev[i]>>1u);
+				break;
+			default: // UP, and PAETH predicts with the byte above when there's nothing to the left
+				out[i] = row[i]-prev[i];
+				break;
+		}
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+		auto loadu = [](const uint8_t* ptr) -> __m128i {return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));};
+		switch (filter)
+		{
+			case E_FILTER::SUB:
+				for (; i+16u<=rowBytes; i+=16u)
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out+i),_mm_sub_epi8(loadu(row+i),loadu(row+i-bpp)));
+				break;
+			case E_FILTER::UP:
+				for (; i+16u<=rowBytes; i+=16u)
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out+i),_mm_sub_epi8(loadu(row+i),loadu(prev+i)));
+				break;
+			case E_FILTER::AVERAGE:
+			{
+				const __m128i one = _mm_set1_epi8(1);
+				for (; i+16u<=rowBytes; i+=16u)
+				{
+					const __m128i a = loadu(row+i-bpp);
+					const __m128i b = loadu(prev+i);
+					// `_mm_avg_epu8` rounds up, PNG rounds down
+					const __m128i average = _mm_sub_epi8(_mm_avg_epu8(a,b),_mm_and_si128(_mm_xor_si128(a,b),one));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out+i),_mm_sub_epi8(loadu(row+i),average));
+				}
+				break;
+			}
+			case E_FILTER::PAETH:
+			{
+				auto select = [](const __m128i mask, const __m128i ifTrue, const __m128i ifFalse) -> __m128i
+				{
+					return _mm_or_si128(_mm_and_si128(mask,ifTrue),_mm_andnot_si128(mask,ifFalse));
+				};
+				auto load8 = [](const uint8_t* ptr) -> __m128i {return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr)),_mm_setzero_si128());};
+				// in 16 bit lanes, `a+b-2c` doesn't fit 8 bits
+				for (; i+8u<=rowBytes; i+=8u)
+				{
+					const __m128i a = load8(row+i-bpp);
+					const __m128i b = load8(prev+i);
+					const __m128i c = load8(prev+i-bpp);
+					const __m128i bMinusC = _mm_sub_epi16(b,c);
+					const __m128i aMinusC = _mm_sub_epi16(a,c);
+					const __m128i pa = _mm_abs_epi16(bMinusC);
+					const __m128i pb = _mm_abs_epi16(aMinusC);
+					const __m128i pc = _mm_abs_epi16(_mm_add_epi16(bMinusC,aMinusC));
+					const __m128i smallest = _mm_min_epi16(pc,_mm_min_epi16(pa,pb));
+					const __m128i nearest = select(_mm_cmpeq_epi16(smallest,pa),a,select(_mm_cmpeq_epi16(smallest,pb),b,c));
+					const __m128i filtered = _mm_sub_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row+i)),_mm_packus_epi16(nearest,nearest));
+					_mm_storel_epi64(reinterpret_cast<__m128i*>(out+i),filtered);
+				}
+				break;
+			}
+			default:
+				break;
+		}
+#endif // __NBL_COMPILE_WITH_X86_SIMD_
+		for (; i<rowBytes; i++)
+		switch (filter)
+		{
+			case E_FILTER::SUB:
+				out[i] = row[i]-row[i-bpp];
+				break;
+			case E_FILTER::UP:
+				out[i] = row[i]-prev[i];
+				break;
+			case E_FILTER::AVERAGE:
+				out[i] = row[i]-((uint32_t(row[i-bpp])+prev[i])>>1u);
+				break;
+			default:
+				out[i] = row[i]-SPNGFormat::paethPredictor(row[i-bpp],prev[i],prev[i-bpp]);
+				break;
+		}
+	}
+
+	//! Sum of the filtered bytes read as signed, the smaller it is the better deflate tends to do
+	uint64_t filterCost(const uint8_t* filtered, const size_t rowBytes)
+	{
+		uint64_t cost = 0u;
+		size_t i = 0u;
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+		__m128i sums = _mm_setzero_si128();
+		for (; i+16u<=rowBytes; i+=16u)
+			sums = _mm_add_epi64(sums,_mm_sad_epu8(_mm_abs_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(filtered+i))),_mm_setzero_si128()));
+		cost = uint64_t(_mm_cvtsi128_si64(sums))+uint64_t(_mm_cvtsi128_si64(_mm_unpackhi_epi64(sums,sums)));
+#endif // __NBL_COMPILE_WITH_X86_SIMD_
+		for (; i<rowBytes; i++)
+			cost += std::abs(int32_t(int8_t(filtered[i])));
+		return cost;
+	}
+
+	void appendChunk(core::vector<uint8_t>& out, const SPNGFormat::E_CHUNK_TYPE type, const uint8_t* data, const uint32_t size)
+	{
+		const size_t offset = out.size();
+		out.resize(offset+SPNGFormat::ChunkOverhead+size);
+		uint8_t* const chunk = out.data()+offset;
+		SPNGFormat::writeBE(chunk,size);
+		SPNGFormat::writeBE(chunk+4u,type);
+		if (size)
+			memcpy(chunk+8u,data,size);
+		SPNGFormat::writeBE(chunk+8u+size,libdeflate_crc32(0u,chunk+4u,size+4u));
+	}
 
-	usrData->file_pos += success.getBytesToProcess();
-	png_set_read_user_chunk_fn(png_ptr, usrData, nullptr);
+	//! Filters rows in parallel, deflates them in one go and writes the whole file with a single write
+	bool write(system::IFile* file, const uint8_t* texels, const uint32_t width, const uint32_t height, const uint32_t bpp, const SPNGFormat::E_COLOR_TYPE colorType, const E_PRESET preset, const SPNGWriteParams::E_FILTER_STRATEGY filterStrategy)
+	{
+		const size_t rowBytes = size_t(width)*bpp;
+		core::vector<uint8_t> filtered((rowBytes+1u)*height);
+		{
+			constexpr uint32_t RowsPerBlock = 64u;
+			core::vector<uint32_t> blocks((height+RowsPerBlock-1u)/RowsPerBlock);
+			std::iota(blocks.begin(),blocks.end(),0u);
+			const core::vector<uint8_t> zeroRow(rowBytes,0u);
+			core::for_each(core::execution::par,blocks.begin(),blocks.end(),[&](const uint32_t block) -> void
+				{
+					const bool adaptive = filterStrategy==SPNGWriteParams::E_FILTER_STRATEGY::ADAPTIVE;
+					core::vector<uint8_t> candidates(adaptive ? rowBytes*size_t(E_FILTER::COUNT):0u);
+					for (uint32_t y=block*RowsPerBlock; y<std::min(block*RowsPerBlock+RowsPerBlock,height); y++)
+					{
+						const uint8_t* row = texels+y*rowBytes;
+						const uint8_t* prev = y ? (row-rowBytes):zeroRow.data();
+						uint8_t* out = filtered.data()+y*(rowBytes+1u);
+						if (!adaptive)
+						{
+							const auto filter = static_cast<E_FILTER>(filterStrategy);
+							out[0] = static_cast<uint8_t>(filter);
+							filterRow(filter,row,prev,out+1u,rowBytes,bpp);
+							continue;
+						}
+
+						auto best = E_FILTER::NONE;
+						uint64_t bestCost = ~0ull;
+						for (uint8_t f=0u; f<uint8_t(E_FILTER::COUNT); f++)
+						{
+							uint8_t* candidate = candidates.data()+f*rowBytes;
+							filterRow(E_FILTER(f),row,prev,candidate,rowBytes,bpp);
+							const uint64_t cost = filterCost(candidate,rowBytes);
+							if (cost<bestCost)
+							{
+								bestCost = cost;
+								best = E_FILTER(f);
+							}
+						}
+						out[0] = static_cast<uint8_t>(best);
+						memcpy(out+1u,candidates.data()+uint8_t(best)*rowBytes,rowBytes);
+					}
+				}
+			);
+		}
+
+		auto* const compressor = getThreadLocalCompressor(preset);
+		if (!compressor)
+			return false;
+		core::vector<uint8_t> compressed(libdeflate_zlib_compress_bound(compressor,filtered.size()));
+		const size_t compressedSize = libdeflate_zlib_compress(compressor,filtered.data(),filtered.size(),compressed.data(),compressed.size());
+		if (!compressedSize)
+			return false;
+		filtered = {};
+
+		// chunks can't be longer than 2^31-1 bytes
+		constexpr size_t MaxIDATSize = 0x1ull<<30ull;
+		core::vector<uint8_t> out;
+		out.reserve(sizeof(SPNGFormat::Signature)+SPNGFormat::ChunkOverhead*3u+SPNGFormat::IHDRSize+compressedSize+(compressedSize/MaxIDATSize)*SPNGFormat::ChunkOverhead);
+		out.insert(out.end(),std::begin(SPNGFormat::Signature),std::end(SPNGFormat::Signature));
+		{
+			uint8_t ihdr[SPNGFormat::IHDRSize] = {};
+			SPNGFormat::writeBE(ihdr,width);
+			SPNGFormat::writeBE(ihdr+4u,height);
+			ihdr[8] = 8u; // bit depth
+			ihdr[9] = static_cast<uint8_t>(colorType);
+			// compression, filter and interlace methods stay 0
+			appendChunk(out,SPNGFormat::ECT_IHDR,ihdr,sizeof(ihdr));
+		}
+		for (size_t offset=0u; offset<compressedSize; offset+=MaxIDATSize)
+			appendChunk(out,SPNGFormat::ECT_IDAT,compressed.data()+offset,std::min(MaxIDATSize,compressedSize-offset));
+		appendChunk(out,SPNGFormat::ECT_IEND,nullptr,0u);
+
+		system::IFile::success_t success;
+		file->write(success,out.data(),0u,out.size());
+		return bool(success);
+	}
 }
-#endif // _NBL_COMPILE_WITH_LIBPNG_
+#endif // _NBL_COMPILE_WITH_LIBDEFLATE_
 
 CImageWriterPNG::CImageWriterPNG(core::smart_refctd_ptr<system::ISystem>&& sys) : m_system(std::move(sys))
 {
@@ -74,8 +287,7 @@ bool CImageWriterPNG::writeAsset(system::IFile* _file, const SAssetWriteParams&
     if (!_override)
         getDefaultOverride(_override);
 
-#if defined(_NBL_COMPILE_WITH_LIBPNG_)
-
+#ifdef _NBL_COMPILE_WITH_LIBDEFLATE_
 	SAssetWriteContext ctx{ _params, _file };
 
 	auto imageView = IAsset::castDown<const ICPUImageView>(_params.rootAsset);
@@ -85,31 +297,6 @@ bool CImageWriterPNG::writeAsset(system::IFile* _file, const SAssetWriteParams&
 	if (!file || !imageView)
 		return false;
 
-	// Allocate the png write struct
-	png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING,
-		nullptr, (png_error_ptr)png_cpexcept_error, (png_error_ptr)png_cpexcept_warning);
-	if (!png_ptr)
-	{
-		_params.logger.log("PNGWriter: Internal PNG create write struct failure\n%s", system::ILogger::ELL_ERROR, file->getFileName().string().c_str());
-		return false;
-	}
-
-	// Allocate the png info struct
-	png_infop info_ptr = png_create_info_struct(png_ptr);
-	if (!info_ptr)
-	{
-		_params.logger.log("PNGWriter: Internal PNG create info struct failure\n%s", system::ILogger::ELL_ERROR, file->getFileName().string().c_str());
-		png_destroy_write_struct(&png_ptr, nullptr);
-		return false;
-	}
-
-	// for proper error handling
-	if (setjmp(png_jmpbuf(png_ptr)))
-	{
-		png_destroy_write_struct(&png_ptr, &info_ptr);
-		return false;
-	}
-
 	core::smart_refctd_ptr<ICPUImage> convertedImage;
 	{
 		const auto channelCount = asset::getFormatChannelCount(imageView->getCreationParameters().format);
@@ -127,94 +314,41 @@ bool CImageWriterPNG::writeAsset(system::IFile* _file, const SAssetWriteParams&
 
 	assert(convertedRegion->bufferRowLength && convertedRegion->bufferImageHeight); //Detected changes in createImageDataForCommonWriting!
 	auto trueExtent = core::vector3du32_SIMD(convertedRegion->bufferRowLength, convertedRegion->bufferImageHeight, convertedRegion->imageExtent.depth);
-	
-	png_set_write_fn(png_ptr, file, user_write_data_fcn, nullptr);
-	
-	// Set info
-	switch (convertedFormat)
-	{
-		case asset::EF_R8G8B8_SRGB:
-			png_set_IHDR(png_ptr, info_ptr,
-				trueExtent.X, trueExtent.Y,
-				8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
-				PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
-			break;
-		case asset::EF_R8G8B8A8_SRGB:
-			png_set_IHDR(png_ptr, info_ptr,
-				trueExtent.X, trueExtent.Y,
-				8, PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE,
-				PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
-		break;
-		case asset::EF_R8_SRGB:
-			png_set_IHDR(png_ptr, info_ptr,
-				trueExtent.X, trueExtent.Y,
-				8, PNG_COLOR_TYPE_GRAY, PNG_INTERLACE_NONE,
-				PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
-		break;
-		default:
-			{
-				_params.logger.log("Unsupported color format, operation aborted.", system::ILogger::ELL_ERROR);
-				return false;
-			}
-	}
 
-	int32_t lineWidth = trueExtent.X;
+	const SPNGWriteParams defaultParams;
+	const auto& pngParams = _params.userData ? *reinterpret_cast<const SPNGWriteParams*>(_params.userData) : defaultParams;
+	// like the other writers, how hard to compress comes from the flags and compression level
+	const asset::E_WRITER_FLAGS flags = _override->getAssetWritingFlags(ctx, imageView, 0u);
+	const float comprLvl = _override->getAssetCompressionLevel(ctx, imageView, 0u);
+	const auto preset = png::getPreset(flags, comprLvl);
+
+	SPNGFormat::E_COLOR_TYPE colorType;
 	switch (convertedFormat)
 	{
 		case asset::EF_R8_SRGB:
-			lineWidth *= 1;
+			colorType = SPNGFormat::E_COLOR_TYPE::GRAY;
 			break;
 		case asset::EF_R8G8B8_SRGB:
-			lineWidth *= 3;
+			colorType = SPNGFormat::E_COLOR_TYPE::RGB;
 			break;
 		case asset::EF_R8G8B8A8_SRGB:
-			lineWidth *= 4;
+			colorType = SPNGFormat::E_COLOR_TYPE::RGBA;
 			break;
 		default:
-			{
-				_params.logger.log("Unsupported color format, operation aborted.", system::ILogger::ELL_ERROR);
-				return false;
-			}
+			_params.logger.log("Unsupported color format, operation aborted.", system::ILogger::ELL_ERROR);
+			return false;
 	}
-	
-	uint8_t* data = reinterpret_cast<uint8_t*>(convertedImage->getBuffer()->getPointer());
-
-	constexpr uint32_t maxPNGFileHeight = 16u * 1024u; // arbitrary limit
-	if (trueExtent.Y>maxPNGFileHeight)
+	const uint8_t* texels = reinterpret_cast<const uint8_t*>(convertedImage->getBuffer()->getPointer());
+	if (!png::write(file, texels, trueExtent.X, trueExtent.Y, getTexelOrBlockBytesize(convertedFormat), colorType, preset, pngParams.filter))
 	{
-		_params.logger.log("PNGWriter: Image dimensions too big!\n %s", system::ILogger::ELL_ERROR, file->getFileName().string().c_str());
-		png_destroy_write_struct(&png_ptr, &info_ptr);
+		_params.logger.log("PNGWriter: failed to compress or write %s", system::ILogger::ELL_ERROR, file->getFileName().string().c_str());
 		return false;
 	}
-	
-	// Create array of pointers to rows in image data
-	png_bytep RowPointers[maxPNGFileHeight];
-
-	// Fill array of pointers to rows in image data
-	for (uint32_t i = 0; i < trueExtent.Y; ++i)
-	{
-		RowPointers[i] = reinterpret_cast<png_bytep>(data);
-		data += lineWidth;
-	}
-	
-	// for proper error handling
-	if (setjmp(png_jmpbuf(png_ptr)))
-	{
-		png_destroy_write_struct(&png_ptr, &info_ptr);
-		return false;
-	}
-
-	SContext usrData(m_system.get(), _params.logger);
-	png_set_read_user_chunk_fn(png_ptr, &usrData, nullptr);
-	png_set_rows(png_ptr, info_ptr, RowPointers);
-	png_write_png(png_ptr, info_ptr, PNG_TRANSFORM_IDENTITY, nullptr);
-
-	png_destroy_write_struct(&png_ptr, &info_ptr);
 	return true;
 #else
 	_NBL_DEBUG_BREAK_IF(true);
 	return false;
-#endif//defined(_NBL_COMPILE_WITH_LIBPNG_)
+#endif // _NBL_COMPILE_WITH_LIBDEFLATE_
 }
 
 } // namespace nbl::video
@@ -21,13 +21,6 @@ class CImageWriterPNG : public asset::IAssetWriter
 {
     core::smart_refctd_ptr<system::ISystem> m_system;
 public:
-    struct SContext
-    {
-        SContext(system::ISystem* sys, const system::logger_opt_ptr log) : system(sys), logger(log) {}
-        system::ISystem* system;
-        size_t file_pos = 0;
-        system::logger_opt_ptr logger;
-    };
     //! constructor
     explicit CImageWriterPNG(core::smart_refctd_ptr<system::ISystem>&& sys);
     
@@ -39,7 +32,7 @@ public:
     
     virtual uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_IMAGE_VIEW; }
     
-    virtual uint32_t getSupportedFlags() override { return 0u; }
+    virtual uint32_t getSupportedFlags() override { return asset::EWF_COMPRESSED; }
     
     virtual uint32_t getForcedFlags() { return asset::EWF_BINARY; }
     
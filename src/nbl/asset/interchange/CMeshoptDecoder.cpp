@@ -0,0 +1,410 @@
+#include "CMeshoptDecoder.h"
+
+#include <bit>
+#include <cmath>
+
+using namespace nbl;
+using namespace nbl::asset;
+
+namespace
+{
+	constexpr uint8_t VertexHeader = 0xA0u;
+	constexpr uint8_t IndexHeader = 0xE0u;
+	constexpr uint8_t SequenceHeader = 0xD0u;
+
+	constexpr size_t ByteGroupSize = 16ull;
+	//! worst case size of a byte group, 4 bits per value plus every value escaped
+	constexpr size_t ByteGroupMaxSize = 24ull;
+	constexpr size_t VertexBlockSizeBytes = 8192ull;
+	constexpr size_t VertexBlockMaxSize = 256ull;
+	constexpr size_t VertexTailMinSize = 32ull;
+
+	inline size_t getVertexBlockSize(const size_t byteStride)
+	{
+		// blocks are a whole number of byte groups which fit in the scratch
+		const size_t result = (VertexBlockSizeBytes/byteStride)&~(ByteGroupSize-1ull);
+		return std::min(result,VertexBlockMaxSize);
+	}
+
+	inline uint8_t unzigzag8(const uint8_t v)
+	{
+		return static_cast<uint8_t>(-(v&1)^(v>>1));
+	}
+
+	//! packed values equal to all ones are escapes, the actual byte follows the packed ones
+	template<uint32_t Bits>
+	inline const uint8_t* decodeBytesGroupPacked(const uint8_t* data, uint8_t* out)
+	{
+		constexpr uint32_t PerByte = 8u/Bits;
+		constexpr uint8_t Escape = (1u<<Bits)-1u;
+		const uint8_t* escaped = data+ByteGroupSize/PerByte;
+		for (size_t i=0ull; i<ByteGroupSize/PerByte; i++)
+		{
+			uint8_t byte = data[i];
+			for (uint32_t j=0u; j<PerByte; j++)
+			{
+				const uint8_t enc = byte>>(8u-Bits);
+				byte <<= Bits;
+				*(out++) = enc==Escape ? *(escaped++):enc;
+			}
+		}
+		return escaped;
+	}
+
+	const uint8_t* decodeBytes(const uint8_t* data, const uint8_t* const dataEnd, uint8_t* out, const size_t count)
+	{
+		// 2 bits of mode per group of 16 bytes
+		const uint8_t* header = data;
+		const size_t headerSize = (count/ByteGroupSize+3ull)/4ull;
+		if (size_t(dataEnd-data)<headerSize)
+			return nullptr;
+		data += headerSize;
+
+		for (size_t i=0ull; i<count; i+=ByteGroupSize)
+		{
+			if (size_t(dataEnd-data)<ByteGroupMaxSize)
+				return nullptr;
+			const size_t group = i/ByteGroupSize;
+			switch ((header[group/4ull]>>((group%4ull)*2ull))&0x3u)
+			{
+				case 0u:
+					std::fill_n(out+i,ByteGroupSize,0u);
+					break;
+				case 1u:
+					data = decodeBytesGroupPacked<2u>(data,out+i);
+					break;
+				case 2u:
+					data = decodeBytesGroupPacked<4u>(data,out+i);
+					break;
+				default:
+					memcpy(out+i,data,ByteGroupSize);
+					data += ByteGroupSize;
+					break;
+			}
+		}
+		return data;
+	}
+
+	//! every byte of the vertex is its own stream of deltas against the previous vertex
+	const uint8_t* decodeVertexBlock(const uint8_t* data, const uint8_t* const dataEnd, uint8_t* out, const size_t count, const size_t byteStride, uint8_t (&lastVertex)[VertexBlockMaxSize])
+	{
+		uint8_t deltas[VertexBlockMaxSize];
+		const size_t countAligned = core::roundUp(count,ByteGroupSize);
+		for (size_t k=0ull; k<byteStride; k++)
+		{
+			data = decodeBytes(data,dataEnd,deltas,countAligned);
+			if (!data)
+				return nullptr;
+
+			uint8_t prev = lastVertex[k];
+			uint8_t* dst = out+k;
+			for (size_t i=0ull; i<count; i++,dst+=byteStride)
+				*dst = prev = static_cast<uint8_t>(prev+unzigzag8(deltas[i]));
+		}
+		memcpy(lastVertex,out+byteStride*(count-1ull),byteStride);
+		return data;
+	}
+
+	inline uint32_t decodeVByte(const uint8_t*& data)
+	{
+		const uint8_t lead = *(data++);
+		if (lead<128u)
+			return lead;
+		// at most 4 extra bytes, so malformed data still terminates
+		uint32_t result = lead&127u;
+		uint32_t shift = 7u;
+		for (uint32_t i=0u; i<4u; i++)
+		{
+			const uint8_t group = *(data++);
+			result |= uint32_t(group&127u)<<shift;
+			shift += 7u;
+			if (group<128u)
+				break;
+		}
+		return result;
+	}
+
+	inline uint32_t decodeIndex(const uint8_t*& data, const uint32_t last)
+	{
+		const uint32_t v = decodeVByte(data);
+		return last+((v>>1)^-int32_t(v&1u));
+	}
+
+	inline void writeIndex(void* dst, const size_t i, const size_t indexSize, const uint32_t value)
+	{
+		if (indexSize==2ull)
+			reinterpret_cast<uint16_t*>(dst)[i] = static_cast<uint16_t>(value);
+		else
+			reinterpret_cast<uint32_t*>(dst)[i] = value;
+	}
+
+	inline int32_t roundToInt(const float x)
+	{
+		return static_cast<int32_t>(x+(x>=0.f ? 0.5f:-0.5f));
+	}
+
+	template<typename T>
+	void decodeFilterOctahedral(T* data, const size_t count)
+	{
+		constexpr float Max = float((1<<(sizeof(T)*8-1))-1);
+		for (size_t i=0ull; i<count; i++,data+=4)
+		{
+			// z is encoded at the same scale as 1.f
+			float x = float(data[0]);
+			float y = float(data[1]);
+			const float z = float(data[2])-std::abs(x)-std::abs(y);
+			// fold the lower hemisphere back
+			const float t = std::min(z,0.f);
+			x += x>=0.f ? t:-t;
+			y += y>=0.f ? t:-t;
+
+			const float scale = Max/std::sqrt(x*x+y*y+z*z);
+			data[0] = static_cast<T>(roundToInt(x*scale));
+			data[1] = static_cast<T>(roundToInt(y*scale));
+			data[2] = static_cast<T>(roundToInt(z*scale));
+		}
+	}
+
+	void decodeFilterQuaternion(int16_t* data, const size_t count)
+	{
+		const float scale = 1.f/std::sqrt(2.f);
+		for (size_t i=0ull; i<count; i++,data+=4)
+		{
+			// the high bits of the 4th component hold the scale of the other three
+			const float s = scale/float(data[3]|3);
+			const float x = float(data[0])*s;
+			const float y = float(data[1])*s;
+			const float z = float(data[2])*s;
+			// the largest component was dropped, it gets reconstructed
+			const float ww = 1.f-x*x-y*y-z*z;
+			const float w = std::sqrt(std::max(ww,0.f));
+
+			const int32_t maxComponent = data[3]&3;
+			const int16_t xf = static_cast<int16_t>(roundToInt(x*32767.f));
+			const int16_t yf = static_cast<int16_t>(roundToInt(y*32767.f));
+			const int16_t zf = static_cast<int16_t>(roundToInt(z*32767.f));
+			const int16_t wf = static_cast<int16_t>(roundToInt(w*32767.f));
+			data[(maxComponent+1)&3] = xf;
+			data[(maxComponent+2)&3] = yf;
+			data[(maxComponent+3)&3] = zf;
+			data[(maxComponent+0)&3] = wf;
+		}
+	}
+
+	void decodeFilterExponential(uint32_t* data, const size_t count)
+	{
+		for (size_t i=0ull; i<count; i++)
+		{
+			// 24 bit signed mantissa, 8 bit signed exponent
+			const int32_t mantissa = int32_t(data[i]<<8)>>8;
+			const int32_t exponent = int32_t(data[i])>>24;
+			// ldexp without the libcall, exponent is limited to the normal range by the encoder
+			const float value = std::bit_cast<float>(uint32_t(exponent+127)<<23)*float(mantissa);
+			data[i] = std::bit_cast<uint32_t>(value);
+		}
+	}
+}
+
+bool CMeshoptDecoder::decodeVertexBuffer(void* dst, const size_t count, const size_t byteStride, const uint8_t* src, const size_t srcSize)
+{
+	if (byteStride==0ull || byteStride>VertexBlockMaxSize || byteStride%4ull)
+		return false;
+	if (srcSize<1ull+byteStride || (src[0]&0xF0u)!=VertexHeader || (src[0]&0x0Fu)>0u)
+		return false;
+
+	// the first vertex is delta encoded against the last bytes of the tail
+	const size_t tailSize = std::max(byteStride,VertexTailMinSize);
+	if (srcSize<1ull+tailSize)
+		return false;
+	const uint8_t* const dataEnd = src+srcSize;
+	uint8_t lastVertex[VertexBlockMaxSize];
+	memcpy(lastVertex,dataEnd-byteStride,byteStride);
+
+	const size_t blockSize = getVertexBlockSize(byteStride);
+	const uint8_t* data = src+1;
+	auto* out = reinterpret_cast<uint8_t*>(dst);
+	for (size_t offset=0ull; offset<count; offset+=blockSize)
+	{
+		data = decodeVertexBlock(data,dataEnd,out+offset*byteStride,std::min(blockSize,count-offset),byteStride,lastVertex);
+		if (!data)
+			return false;
+	}
+	return size_t(dataEnd-data)==tailSize;
+}
+
+bool CMeshoptDecoder::decodeIndexBuffer(void* dst, const size_t count, const size_t indexSize, const uint8_t* src, const size_t srcSize)
+{
+	if (count%3ull || (indexSize!=2ull && indexSize!=4ull))
+		return false;
+	// header, a code per triangle and the 16 entry table of common codes
+	if (srcSize<1ull+count/3ull+16ull || (src[0]&0xF0u)!=IndexHeader)
+		return false;
+	const uint32_t version = src[0]&0x0Fu;
+	if (version>1u)
+		return false;
+
+	uint32_t edgeFifo[16][2];
+	uint32_t vertexFifo[16];
+	std::fill_n(&edgeFifo[0][0],32,~0u);
+	std::fill_n(vertexFifo,16,~0u);
+	uint32_t edgeFifoOffset = 0u;
+	uint32_t vertexFifoOffset = 0u;
+	auto pushEdge = [&](const uint32_t a, const uint32_t b) -> void
+	{
+		edgeFifo[edgeFifoOffset][0] = a;
+		edgeFifo[edgeFifoOffset][1] = b;
+		edgeFifoOffset = (edgeFifoOffset+1u)&15u;
+	};
+	auto pushVertex = [&](const uint32_t v, const bool cond=true) -> void
+	{
+		vertexFifo[vertexFifoOffset] = v;
+		vertexFifoOffset = (vertexFifoOffset+uint32_t(cond))&15u;
+	};
+
+	uint32_t next = 0u;
+	uint32_t last = 0u;
+	// version 1 uses the 2 highest vertex fifo codes for small deltas of free indices
+	const uint32_t fecMax = version>=1u ? 13u:15u;
+
+	const uint8_t* code = src+1;
+	const uint8_t* data = code+count/3ull;
+	const uint8_t* const dataSafeEnd = src+srcSize-16ull;
+	const uint8_t* const codeauxTable = dataSafeEnd;
+	for (size_t i=0ull; i<count; i+=3ull)
+	{
+		// a triangle reads at most 16 bytes, which the table at the end covers
+		if (data>dataSafeEnd)
+			return false;
+
+		uint32_t a, b, c;
+		const uint8_t codetri = *(code++);
+		if (codetri<0xF0u)
+		{
+			// the triangle shares an edge with a recent one
+			const uint32_t fe = codetri>>4;
+			a = edgeFifo[(edgeFifoOffset-1u-fe)&15u][0];
+			b = edgeFifo[(edgeFifoOffset-1u-fe)&15u][1];
+
+			const uint32_t fec = codetri&15u;
+			if (fec<fecMax)
+			{
+				const bool fec0 = fec==0u;
+				c = fec0 ? next:vertexFifo[(vertexFifoOffset-1u-fec)&15u];
+				next += fec0;
+				pushVertex(c,fec0);
+			}
+			else
+			{
+				// 13 and 14 decode to -1 and +1
+				last = c = fec!=15u ? last+(fec-(fec^3u)):decodeIndex(data,last);
+				pushVertex(c);
+			}
+			pushEdge(c,b);
+			pushEdge(a,c);
+		}
+		else
+		{
+			uint32_t feb, fec;
+			if (codetri<0xFEu)
+			{
+				// the table can't hold free indices
+				const uint8_t codeaux = codeauxTable[codetri&15u];
+				feb = codeaux>>4;
+				fec = codeaux&15u;
+
+				a = next++;
+				b = feb==0u ? next:vertexFifo[(vertexFifoOffset-feb)&15u];
+				next += feb==0u;
+				c = fec==0u ? next:vertexFifo[(vertexFifoOffset-fec)&15u];
+				next += fec==0u;
+			}
+			else
+			{
+				const uint8_t codeaux = *(data++);
+				const uint32_t fea = codetri==0xFEu ? 0u:15u;
+				feb = codeaux>>4;
+				fec = codeaux&15u;
+				// a zero codeaux outside the table marks a restart
+				if (codeaux==0u)
+					next = 0u;
+
+				a = fea==0u ? next++:0u;
+				b = feb==0u ? next++:vertexFifo[(vertexFifoOffset-feb)&15u];
+				c = fec==0u ? next++:vertexFifo[(vertexFifoOffset-fec)&15u];
+				if (fea==15u)
+					last = a = decodeIndex(data,last);
+				if (feb==15u)
+					last = b = decodeIndex(data,last);
+				if (fec==15u)
+					last = c = decodeIndex(data,last);
+			}
+			pushVertex(a);
+			pushVertex(b,feb==0u||feb==15u);
+			pushVertex(c,fec==0u||fec==15u);
+			pushEdge(b,a);
+			pushEdge(c,b);
+			pushEdge(a,c);
+		}
+		writeIndex(dst,i+0ull,indexSize,a);
+		writeIndex(dst,i+1ull,indexSize,b);
+		writeIndex(dst,i+2ull,indexSize,c);
+	}
+	// all the data must have been consumed, right up to the table
+	return data==dataSafeEnd;
+}
+
+bool CMeshoptDecoder::decodeIndexSequence(void* dst, const size_t count, const size_t indexSize, const uint8_t* src, const size_t srcSize)
+{
+	if (indexSize!=2ull && indexSize!=4ull)
+		return false;
+	// header, at least a byte per index and a 4 byte tail
+	if (srcSize<1ull+count+4ull || (src[0]&0xF0u)!=SequenceHeader || (src[0]&0x0Fu)>1u)
+		return false;
+
+	const uint8_t* data = src+1;
+	const uint8_t* const dataSafeEnd = src+srcSize-4ull;
+	// two baselines, the lowest bit of each code picks which one the delta is against
+	uint32_t last[2] = {0u,0u};
+	for (size_t i=0ull; i<count; i++)
+	{
+		// an index reads at most 5 bytes, which the tail covers
+		if (data>=dataSafeEnd)
+			return false;
+		uint32_t v = decodeVByte(data);
+		const uint32_t baseline = v&1u;
+		v >>= 1;
+		last[baseline] += (v>>1)^-int32_t(v&1u);
+		writeIndex(dst,i,indexSize,last[baseline]);
+	}
+	return data==dataSafeEnd;
+}
+
+bool CMeshoptDecoder::applyFilter(void* data, const size_t count, const size_t byteStride, const E_FILTER filter)
+{
+	switch (filter)
+	{
+		case E_FILTER::NONE:
+			return true;
+		case E_FILTER::OCTAHEDRAL:
+			if (byteStride==4ull)
+				decodeFilterOctahedral(reinterpret_cast<int8_t*>(data),count);
+			else if (byteStride==8ull)
+				decodeFilterOctahedral(reinterpret_cast<int16_t*>(data),count);
+			else
+				return false;
+			return true;
+		case E_FILTER::QUATERNION:
+			if (byteStride!=8ull)
+				return false;
+			decodeFilterQuaternion(reinterpret_cast<int16_t*>(data),count);
+			return true;
+		case E_FILTER::EXPONENTIAL:
+			if (byteStride%4ull)
+				return false;
+			decodeFilterExponential(reinterpret_cast<uint32_t*>(data),count*byteStride/4ull);
+			return true;
+		default:
+			break;
+	}
+	return false;
+}
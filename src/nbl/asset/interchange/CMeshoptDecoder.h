@@ -0,0 +1,60 @@
+#ifndef _NBL_ASSET_C_MESHOPT_DECODER_H_INCLUDED_
+#define _NBL_ASSET_C_MESHOPT_DECODER_H_INCLUDED_
+
+#include "nbl/core/declarations.h"
+
+namespace nbl::asset
+{
+
+//! Decoders for the bitstreams of glTF's `EXT_meshopt_compression`, which are the ones produced by meshoptimizer
+/*
+	All of them return false on malformed input instead of reading out of bounds, the output is left partially written then.
+	Filters get applied in-place after decoding an `ATTRIBUTES` stream.
+*/
+class CMeshoptDecoder final
+{
+	public:
+		enum class E_MODE : uint8_t
+		{
+			ATTRIBUTES,
+			TRIANGLES,
+			INDICES
+		};
+		enum class E_FILTER : uint8_t
+		{
+			NONE,
+			OCTAHEDRAL,
+			QUATERNION,
+			EXPONENTIAL
+		};
+
+		//! `byteStride` needs to be a multiple of 4 and at most 256
+		static bool decodeVertexBuffer(void* dst, const size_t count, const size_t byteStride, const uint8_t* src, const size_t srcSize);
+		//! `count` needs to be a multiple of 3, `indexSize` either 2 or 4
+		static bool decodeIndexBuffer(void* dst, const size_t count, const size_t indexSize, const uint8_t* src, const size_t srcSize);
+		//! `indexSize` either 2 or 4
+		static bool decodeIndexSequence(void* dst, const size_t count, const size_t indexSize, const uint8_t* src, const size_t srcSize);
+
+		static bool applyFilter(void* data, const size_t count, const size_t byteStride, const E_FILTER filter);
+
+		//! Dispatches to one of the above based on `mode`, the way a compressed bufferView is described
+		static inline bool decode(void* dst, const size_t count, const size_t byteStride, const uint8_t* src, const size_t srcSize, const E_MODE mode, const E_FILTER filter)
+		{
+			switch (mode)
+			{
+				case E_MODE::ATTRIBUTES:
+					return decodeVertexBuffer(dst,count,byteStride,src,srcSize) && applyFilter(dst,count,byteStride,filter);
+				case E_MODE::TRIANGLES:
+					return filter==E_FILTER::NONE && decodeIndexBuffer(dst,count,byteStride,src,srcSize);
+				case E_MODE::INDICES:
+					return filter==E_FILTER::NONE && decodeIndexSequence(dst,count,byteStride,src,srcSize);
+				default:
+					break;
+			}
+			return false;
+		}
+};
+
+}
+
+#endif
@@ -18,6 +18,11 @@
 
 #include "COBJMeshFileLoader.h"
 
+#include "nbl/core/execution.h"
+
+#include <bit>
+#include <charconv>
+#include <thread>
 #include <filesystem>
 
 namespace nbl
@@ -36,6 +41,102 @@ constexpr uint32_t UV = 2u;
 constexpr uint32_t NORMAL = 3u;
 constexpr uint32_t BND_NUM = 0u;
 
+namespace
+{
+	//! `from_chars` doesn't take a leading plus, some exporters write it
+	inline const char* skipPlusSign(const char* ptr, const char* const end)
+	{
+		return ptr!=end && *ptr=='+' ? ptr+1:ptr;
+	}
+
+	//! returns a pointer past the number, or `ptr` and 0 if there's no number there
+	template<typename T>
+	inline const char* parseNumber(const char* ptr, const char* const end, T& out)
+	{
+		const auto result = std::from_chars(skipPlusSign(ptr,end),end,out);
+		if (result.ec!=std::errc())
+		{
+			out = T(0);
+			return ptr;
+		}
+		return result.ptr;
+	}
+
+	//! Open addressing set of vertex indices, deduplicating on the vertex bytes and smoothing group
+	class CVertexDedupMap
+	{
+		public:
+			inline CVertexDedupMap(const core::vector<SObjVertex>& vertices, const core::vector<uint32_t>& smoothingGroups)
+				: m_vertices(vertices), m_smoothingGroups(smoothingGroups), m_slots(1024u,{InvalidIndex,0u}) {}
+
+			//! returns the index of an equal vertex, or `newIndex` after remembering it
+			inline uint32_t findOrInsert(const SObjVertex& vertex, const uint32_t smoothingGroup, const uint32_t newIndex)
+			{
+				// keep the load factor under a half, so probe sequences stay short
+				if ((m_size+1u)*2u>m_slots.size())
+					grow();
+
+				const uint32_t hash = hashVertex(vertex,smoothingGroup);
+				const uint32_t mask = m_slots.size()-1u;
+				for (uint32_t slot=hash&mask; ; slot=(slot+1u)&mask)
+				{
+					auto& entry = m_slots[slot];
+					if (entry.index==InvalidIndex)
+					{
+						entry = {newIndex,hash};
+						m_size++;
+						return newIndex;
+					}
+					if (entry.hash==hash && m_smoothingGroups[entry.index]==smoothingGroup && memcmp(&m_vertices[entry.index],&vertex,sizeof(SObjVertex))==0)
+						return entry.index;
+				}
+			}
+
+		private:
+			static inline constexpr uint32_t InvalidIndex = ~0u;
+			struct SSlot
+			{
+				uint32_t index;
+				uint32_t hash;
+			};
+
+			static inline uint32_t hashVertex(const SObjVertex& vertex, const uint32_t smoothingGroup)
+			{
+				// bytewise, so NaN UVs of vertices without texcoords compare equal too
+				uint64_t words[3];
+				static_assert(sizeof(words)==sizeof(SObjVertex));
+				memcpy(words,&vertex,sizeof(words));
+				uint64_t hash = smoothingGroup;
+				for (const auto word : words)
+				{
+					hash ^= word+0x9E3779B97F4A7C15ull+(hash<<6)+(hash>>2);
+					hash *= 0xBF58476D1CE4E5B9ull;
+				}
+				return static_cast<uint32_t>(hash^(hash>>32));
+			}
+
+			inline void grow()
+			{
+				core::vector<SSlot> old(m_slots.size()*2u,{InvalidIndex,0u});
+				std::swap(old,m_slots);
+				const uint32_t mask = m_slots.size()-1u;
+				for (const auto& entry : old)
+				if (entry.index!=InvalidIndex)
+				{
+					uint32_t slot = entry.hash&mask;
+					while (m_slots[slot].index!=InvalidIndex)
+						slot = (slot+1u)&mask;
+					m_slots[slot] = entry;
+				}
+			}
+
+			const core::vector<SObjVertex>& m_vertices;
+			const core::vector<uint32_t>& m_smoothingGroups;
+			core::vector<SSlot> m_slots;
+			uint32_t m_size = 0u;
+	};
+}
+
 //! Constructor
 COBJMeshFileLoader::COBJMeshFileLoader(IAssetManager* _manager) : AssetManager(_manager), System(_manager->getSystem())
 {
@@ -100,19 +201,22 @@ asset::SAssetBundle COBJMeshFileLoader::loadAsset(system::IFile* _file, const as
 	};
     core::unordered_multiset<pipeline_meta_pair_t,hash_t,key_equal_t> pipelines;
 
-	// TODO: map the file whenever possible
+	// parse straight out of the mapping whenever possible
     std::string fileContents;
-    fileContents.resize(filesize);
-	char* const buf = fileContents.data();
-
-	system::IFile::success_t success;
-	_file->read(success, buf, 0, filesize);
-	if (!success)
-		return {};
+	const char* buf = reinterpret_cast<const char*>(_file->getMappedPointer());
+	if (!buf)
+	{
+		fileContents.resize(filesize);
+		system::IFile::success_t success;
+		_file->read(success, fileContents.data(), 0, filesize);
+		if (!success)
+			return {};
+		buf = fileContents.data();
+	}
 
 	const char* const bufEnd = buf+filesize;
 	// Process obj information
-	const char* bufPtr = buf;
+	const char* bufPtr = nullptr;
 	std::string grpName, mtlName;
 
 	auto performActionBasedOnOrientationSystem = [&](auto performOnRightHanded, auto performOnLeftHanded)
@@ -137,20 +241,221 @@ asset::SAssetBundle COBJMeshFileLoader::loadAsset(system::IFile* _file, const as
     core::vector<core::smart_refctd_ptr<ICPUMeshBuffer>> submeshes;
     core::vector<core::vector<uint32_t>> indices;
     core::vector<SObjVertex> vertices;
-    core::map<SObjVertex, uint32_t> map_vtx2ix;
     core::vector<bool> recalcNormals;
     core::vector<bool> submeshWasLoadedFromCache;
     core::vector<std::string> submeshCacheKeys;
     core::vector<std::string> submeshMaterialNames;
     core::vector<uint32_t> vtxSmoothGrp;
+    CVertexDedupMap map_vtx2ix(vertices,vtxSmoothGrp);
+
+	core::vector<uint32_t> faceCorners;
+	faceCorners.reserve(32ull);
+
+	// The file gets split into chunks at line breaks, which parse their `v`,`vt`,`vn` and `f` statements in parallel.
+	// Everything else only gets recorded, to be replayed in order once the chunks are stitched together.
+	// Only the parsing is parallel, the replay (vertex deduplication, submesh and material assignment) stays serial
+	// because dedup indices depend on every face before them, so that part still scales with the face count alone.
+	struct SFaceCorner
+	{
+		// position, uv, normal
+		int32_t idx[3];
+		// set for indices which are still relative to the chunk's own attribute counts
+		uint8_t relativeMask;
+	};
+	struct SStatement
+	{
+		enum E_TYPE : uint8_t
+		{
+			ET_VERTEX_DATA,
+			ET_FACE,
+			ET_OTHER
+		} type;
+		uint32_t cornerCount = 0u;
+		// faces reference their corners, everything else just where its line starts
+		size_t firstCorner = 0ull;
+		const char* line = nullptr;
+	};
+	struct SChunk
+	{
+		const char* begin;
+		const char* end;
+		core::vector<vec3> positions;
+		core::vector<vec3> normals;
+		core::vector<vec2> uvs;
+		core::vector<SFaceCorner> corners;
+		core::vector<SStatement> statements;
+		// prefix sums of the attribute counts of all chunks before this one
+		uint32_t positionOffset = 0u;
+		uint32_t uvOffset = 0u;
+		uint32_t normalOffset = 0u;
+	};
+	core::vector<SChunk> chunks;
+	{
+		// small files aren't worth waking up the threads for
+		constexpr size_t MinChunkSize = 1ull<<20;
+		const size_t maxChunkCount = std::max(std::thread::hardware_concurrency(),1u)*4ull;
+		const size_t chunkCount = std::clamp<size_t>(filesize/MinChunkSize,1ull,maxChunkCount);
+		chunks.resize(chunkCount);
+		const char* chunkBegin = buf;
+		for (size_t i=0ull; i<chunkCount; i++)
+		{
+			auto& chunk = chunks[i];
+			chunk.begin = chunkBegin;
+			// never split a line
+			chunk.end = i+1ull<chunkCount ? findLineEnd(std::max(chunkBegin,buf+filesize/chunkCount*(i+1ull)), bufEnd):bufEnd;
+			chunkBegin = chunk.end;
+		}
+	}
+
+	core::for_each(core::execution::par,chunks.begin(),chunks.end(),[&](SChunk& chunk) -> void
+		{
+			const char* linePtr = goFirstWord(chunk.begin, chunk.end);
+			while (linePtr != chunk.end)
+			{
+				const char* const lineEnd = findLineEnd(linePtr, chunk.end);
+				switch (linePtr[0])
+				{
+				case 'v':               // v, vn, vt
+					// consecutive ones only need to reset the material flags once
+					if (chunk.statements.empty() || chunk.statements.back().type!=SStatement::ET_VERTEX_DATA)
+						chunk.statements.push_back({SStatement::ET_VERTEX_DATA});
+					// a lone `v` might be the very last byte of the mapping
+					switch (lineEnd-linePtr>1 ? linePtr[1]:'\0')
+					{
+					case ' ':          // vertex
+						{
+							vec3 vec;
+							readVec3(linePtr, vec.data, lineEnd);
+							performActionBasedOnOrientationSystem([&]() {vec.data[0] = -vec.data[0];}, [&]() {});
+							chunk.positions.push_back(vec);
+						}
+						break;
+
+					case 'n':       // normal
+						{
+							vec3 vec;
+							readVec3(linePtr, vec.data, lineEnd);
+							performActionBasedOnOrientationSystem([&]() {vec.data[0] = -vec.data[0]; }, [&]() {});
+							chunk.normals.push_back(vec);
+						}
+						break;
+
+					case 't':       // texcoord
+						{
+							vec2 vec;
+							readUV(linePtr, vec.data, lineEnd);
+							chunk.uvs.push_back(vec);
+						}
+						break;
+					}
+					break;
+
+				case 'f':               // face
+				{
+					SStatement statement = {SStatement::ET_FACE};
+					statement.firstCorner = chunk.corners.size();
+
+					const uint32_t localCounts[3] = {uint32_t(chunk.positions.size()),uint32_t(chunk.uvs.size()),uint32_t(chunk.normals.size())};
+					const char* cornerPtr = goNextWord(linePtr, lineEnd, false);
+					while (cornerPtr != lineEnd)
+					{
+						SFaceCorner corner = {{0,0,0},0u};
+						cornerPtr = readFaceCorner(cornerPtr, lineEnd, corner.idx);
+						// absolute indices are 1-based, relative ones count back from the attributes read so far
+						for (uint32_t k=0u; k<3u; k++)
+						if (corner.idx[k]<0)
+						{
+							corner.idx[k] += localCounts[k];
+							corner.relativeMask |= 0x1u<<k;
+						}
+						else
+							corner.idx[k] -= 1;
+						chunk.corners.push_back(corner);
+
+						cornerPtr = goFirstWord(cornerPtr, lineEnd, false);
+					}
+					statement.cornerCount = chunk.corners.size()-statement.firstCorner;
+					chunk.statements.push_back(statement);
+				}
+				break;
+
+				case 'm':	// mtllib (material)
+				case 'g': // group name
+				case 's': // smoothing can be a group or off (equiv. to 0)
+				case 'u': // usemtl
+				{
+					SStatement statement = {SStatement::ET_OTHER};
+					statement.line = linePtr;
+					chunk.statements.push_back(statement);
+				}
+				break;
+
+				case '#': // comment
+				default:
+					break;
+				}
+				// eat up rest of line
+				linePtr = goFirstWord(lineEnd, chunk.end);
+			}
+		}
+	);
+
+	// stitch the chunks together, with a prefix sum over their attribute counts
+	{
+		uint32_t positionCount = 0u, uvCount = 0u, normalCount = 0u;
+		for (auto& chunk : chunks)
+		{
+			chunk.positionOffset = positionCount;
+			chunk.uvOffset = uvCount;
+			chunk.normalOffset = normalCount;
+			positionCount += chunk.positions.size();
+			uvCount += chunk.uvs.size();
+			normalCount += chunk.normals.size();
+		}
+		vertexBuffer.resize(positionCount);
+		textureCoordBuffer.resize(uvCount);
+		normalsBuffer.resize(normalCount);
+	}
+	core::for_each(core::execution::par,chunks.begin(),chunks.end(),[&](SChunk& chunk) -> void
+		{
+			std::copy(chunk.positions.begin(),chunk.positions.end(),vertexBuffer.begin()+chunk.positionOffset);
+			std::copy(chunk.uvs.begin(),chunk.uvs.end(),textureCoordBuffer.begin()+chunk.uvOffset);
+			std::copy(chunk.normals.begin(),chunk.normals.end(),normalsBuffer.begin()+chunk.normalOffset);
+			chunk.positions = {};
+			chunk.uvs = {};
+			chunk.normals = {};
+
+			const int32_t offsets[3] = {int32_t(chunk.positionOffset),int32_t(chunk.uvOffset),int32_t(chunk.normalOffset)};
+			for (auto& corner : chunk.corners)
+			for (uint32_t k=0u; k<3u; k++)
+			if (corner.relativeMask&(0x1u<<k))
+				corner.idx[k] += offsets[k];
+		}
+	);
+	// anything out of range counts as missing, except for positions which are required
+	auto isValidIndex = [](const int32_t index, const size_t count) -> bool
+	{
+		return index>=0 && size_t(index)<count;
+	};
 
 	// TODO: handle failures much better!
 	constexpr const char* NO_MATERIAL_MTL_NAME = "#";
 	bool noMaterial = true;
 	bool dummyMaterialCreated = false;
-	while(bufPtr != bufEnd)
+	// replay all the statements in order, so submesh boundaries stay where `g` and `usemtl` put them
+	for (const auto& chunk : chunks)
+	for (const auto& statement : chunk.statements)
 	{
-		switch(bufPtr[0])
+		if (statement.type==SStatement::ET_VERTEX_DATA)
+		{
+			//reset flags
+			noMaterial = true;
+			dummyMaterialCreated = false;
+			continue;
+		}
+
+		bufPtr = statement.line;
+		switch(statement.type==SStatement::ET_FACE ? 'f':bufPtr[0])
 		{
 		case 'm':	// mtllib (material)
 		{
@@ -186,40 +491,6 @@ asset::SAssetBundle COBJMeshFileLoader::loadAsset(system::IFile* _file, const as
 		}
 			break;
 
-		case 'v':               // v, vn, vt
-			//reset flags
-			noMaterial = true;
-			dummyMaterialCreated = false;
-			switch(bufPtr[1])
-			{
-			case ' ':          // vertex
-				{
-					vec3 vec;
-					bufPtr = readVec3(bufPtr, vec.data, bufEnd);
-					performActionBasedOnOrientationSystem([&]() {vec.data[0] = -vec.data[0];}, [&]() {});
-					vertexBuffer.push_back(vec);
-				}
-				break;
-
-			case 'n':       // normal
-				{
-					vec3 vec;
-					bufPtr = readVec3(bufPtr, vec.data, bufEnd);
-					performActionBasedOnOrientationSystem([&]() {vec.data[0] = -vec.data[0]; }, [&]() {});
-					normalsBuffer.push_back(vec);
-				}
-				break;
-
-			case 't':       // texcoord
-				{
-					vec2 vec;
-					bufPtr = readUV(bufPtr, vec.data, bufEnd);
-					textureCoordBuffer.push_back(vec);
-				}
-				break;
-			}
-			break;
-
 		case 'g': // group name
             bufPtr = goAndCopyNextWord(tmpbuf, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
             grpName = tmpbuf;
@@ -231,7 +502,7 @@ asset::SAssetBundle COBJMeshFileLoader::loadAsset(system::IFile* _file, const as
 				if (strcmp("off", tmpbuf)==0)
 					smoothingGroup=0u;
 				else
-                    sscanf(tmpbuf,"%u",&smoothingGroup);
+					parseNumber(tmpbuf,tmpbuf+strlen(tmpbuf),smoothingGroup);
 			}
 			break;
 
@@ -278,33 +549,22 @@ asset::SAssetBundle COBJMeshFileLoader::loadAsset(system::IFile* _file, const as
 
 			SObjVertex v;
 
-			// get all vertices data in this face (current line of obj _file)
-			const std::string wordBuffer = copyLine(bufPtr, bufEnd);
-			const char* linePtr = wordBuffer.c_str();
-			const char* const endPtr = linePtr + wordBuffer.size();
-
-			core::vector<uint32_t> faceCorners;
-			faceCorners.reserve(32ull);
+			faceCorners.clear();
 
 			// read in all vertices
-			linePtr = goNextWord(linePtr, endPtr);
-			while (0 != linePtr[0])
+			for (uint32_t c=0u; c<statement.cornerCount; c++)
 			{
-				// Array to communicate with retrieveVertexIndices()
-				// sends the buffer sizes and gets the actual indices
-				// if index not set returns -1
-				int32_t Idx[3];
-				Idx[1] = Idx[2] = -1;
-
-				// read in next vertex's data
-				uint32_t wlength = copyWord(tmpbuf, linePtr, WORD_BUFFER_LENGTH, endPtr);
-				// this function will also convert obj's 1-based index to c++'s 0-based index
-				retrieveVertexIndices(tmpbuf, Idx, tmpbuf+wlength+1, vertexBuffer.size(), textureCoordBuffer.size(), normalsBuffer.size());
+				const int32_t* const Idx = chunk.corners[statement.firstCorner+c].idx;
+				if (!isValidIndex(Idx[0], vertexBuffer.size()))
+				{
+					_params.logger.log("OBJ: face references a vertex that doesn't exist in %s", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
+					return {};
+				}
 				v.pos[0] = vertexBuffer[Idx[0]].data[0];
 				v.pos[1] = vertexBuffer[Idx[0]].data[1];
 				v.pos[2] = vertexBuffer[Idx[0]].data[2];
 				//set texcoord
-				if ( -1 != Idx[1] )
+				if (isValidIndex(Idx[1], textureCoordBuffer.size()))
                 {
 					v.uv[0] = textureCoordBuffer[Idx[1]].data[0];
 					v.uv[1] = textureCoordBuffer[Idx[1]].data[1];
@@ -315,7 +575,7 @@ asset::SAssetBundle COBJMeshFileLoader::loadAsset(system::IFile* _file, const as
 					v.uv[1] = core::nan<float>();
                 }
                 //set normal
-				if ( -1 != Idx[2] )
+				if (isValidIndex(Idx[2], normalsBuffer.size()))
                 {
 					core::vectorSIMDf simdNormal;
 					simdNormal.set(normalsBuffer[Idx[2]].data);
@@ -328,26 +588,18 @@ asset::SAssetBundle COBJMeshFileLoader::loadAsset(system::IFile* _file, const as
                     recalcNormals.back() = true;
 				}
 
-				uint32_t ix;
-				auto vtx_ix = map_vtx2ix.find(v);
-				if (vtx_ix != map_vtx2ix.end() && smoothingGroup==vtxSmoothGrp[vtx_ix->second])
-					ix = vtx_ix->second;
-				else
+				const uint32_t ix = map_vtx2ix.findOrInsert(v, smoothingGroup, vertices.size());
+				if (ix == vertices.size())
 				{
-					ix = vertices.size();
 					vertices.push_back(v);
                     vtxSmoothGrp.push_back(smoothingGroup);
-					map_vtx2ix.insert({v, ix});
 				}
 
 				faceCorners.push_back(ix);
-
-				// go to next vertex
-				linePtr = goNextWord(linePtr, endPtr);
 			}
 
             // triangulate the face
-            for (uint32_t i = 1u; i < faceCorners.size()-1u; ++i)
+            for (uint32_t i = 1u; i+1u < faceCorners.size(); ++i)
             {
                 // Add a triangle
                 performActionBasedOnOrientationSystem
@@ -372,10 +624,8 @@ asset::SAssetBundle COBJMeshFileLoader::loadAsset(system::IFile* _file, const as
 		case '#': // comment
 		default:
 			break;
-		}	// end switch(bufPtr[0])
-		// eat up rest of line
-		bufPtr = goNextLine(bufPtr, bufEnd);
-	}	// end while(bufPtr && (bufPtr-buf<filesize))
+		}	// end switch
+	}
 
 	// prune out invalid empty shape groups (TODO: convert to AoS and use an erase_if)
 	for (size_t i = 0ull; i < submeshes.size(); ++i)
@@ -531,15 +781,9 @@ asset::SAssetBundle COBJMeshFileLoader::loadAsset(system::IFile* _file, const as
 //! Read 3d vector of floats
 const char* COBJMeshFileLoader::readVec3(const char* bufPtr, float vec[3], const char* const bufEnd)
 {
-	const uint32_t WORD_BUFFER_LENGTH = 256;
-	char wordBuffer[WORD_BUFFER_LENGTH];
-
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	sscanf(wordBuffer,"%f",vec);
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	sscanf(wordBuffer,"%f",vec+1);
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	sscanf(wordBuffer,"%f",vec+2);
+	// numbers get parsed in-place, `goNextWord` then skips anything trailing them
+	for (uint32_t i=0u; i<3u; i++)
+		bufPtr = parseNumber(goNextWord(bufPtr, bufEnd, false), bufEnd, vec[i]);
 
     vec[0] = -vec[0]; // change handedness
 	return bufPtr;
@@ -549,13 +793,8 @@ const char* COBJMeshFileLoader::readVec3(const char* bufPtr, float vec[3], const
 //! Read 2d vector of floats
 const char* COBJMeshFileLoader::readUV(const char* bufPtr, float vec[2], const char* const bufEnd)
 {
-	const uint32_t WORD_BUFFER_LENGTH = 256;
-	char wordBuffer[WORD_BUFFER_LENGTH];
-
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	sscanf(wordBuffer,"%f",vec);
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	sscanf(wordBuffer,"%f",vec+1);
+	for (uint32_t i=0u; i<2u; i++)
+		bufPtr = parseNumber(goNextWord(bufPtr, bufEnd, false), bufEnd, vec[i]);
 
 	vec[1] = 1.f-vec[1]; // change handedness
 	return bufPtr;
@@ -599,18 +838,30 @@ const char* COBJMeshFileLoader::goNextWord(const char* buf, const char* const bu
 }
 
 
-//! Read until line break is reached and stop at the next non-space character
-const char* COBJMeshFileLoader::goNextLine(const char* buf, const char* const bufEnd)
+//! Scans 16 characters at a time, lines are mostly much longer than that
+const char* COBJMeshFileLoader::findLineEnd(const char* buf, const char* const bufEnd)
 {
-	// look for newline characters
-	while(buf != bufEnd)
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+	const __m128i newline = _mm_set1_epi8('\n');
+	const __m128i carriageReturn = _mm_set1_epi8('\r');
+	for (; bufEnd-buf>=16; buf+=16)
 	{
-		// found it, so leave
-		if (*buf=='\n' || *buf=='\r')
-			break;
-		++buf;
+		const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+		const uint32_t mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chars,newline),_mm_cmpeq_epi8(chars,carriageReturn)));
+		if (mask)
+			return buf+std::countr_zero(mask);
 	}
-	return goFirstWord(buf, bufEnd);
+#endif
+	while (buf != bufEnd && *buf!='\n' && *buf!='\r')
+		++buf;
+	return buf;
+}
+
+
+//! Read until line break is reached and stop at the next non-space character
+const char* COBJMeshFileLoader::goNextLine(const char* buf, const char* const bufEnd)
+{
+	return goFirstWord(findLineEnd(buf, bufEnd), bufEnd);
 }
 
 
@@ -624,13 +875,10 @@ uint32_t COBJMeshFileLoader::copyWord(char* outBuf, const char* const inBuf, uin
 		return 0;
 	}
 
+	// the mapped file isn't NUL terminated, so check for the end before every read
 	uint32_t i = 0;
-	while(inBuf[i])
-	{
-		if (core::isspace(inBuf[i]) || &(inBuf[i]) == bufEnd)
-			break;
+	while (inBuf+i != bufEnd && inBuf[i] && !core::isspace(inBuf[i]))
 		++i;
-	}
 
 	uint32_t length = core::min(i, outBufLength-1);
 	for (uint32_t j=0; j<length; ++j)
@@ -641,23 +889,6 @@ uint32_t COBJMeshFileLoader::copyWord(char* outBuf, const char* const inBuf, uin
 }
 
 
-std::string COBJMeshFileLoader::copyLine(const char* inBuf, const char* bufEnd)
-{
-	if (!inBuf)
-		return std::string();
-
-	const char* ptr = inBuf;
-	while (ptr<bufEnd)
-	{
-		if (*ptr=='\n' || *ptr=='\r')
-			break;
-		++ptr;
-	}
-	// we must avoid the +1 in case the array is used up
-	return std::string(inBuf, (uint32_t)(ptr-inBuf+((ptr < bufEnd) ? 1 : 0)));
-}
-
-
 const char* COBJMeshFileLoader::goAndCopyNextWord(char* outBuf, const char* inBuf, uint32_t outBufLength, const char* bufEnd)
 {
 	inBuf = goNextWord(inBuf, bufEnd, false);
@@ -666,72 +897,21 @@ const char* COBJMeshFileLoader::goAndCopyNextWord(char* outBuf, const char* inBu
 }
 
 
-bool COBJMeshFileLoader::retrieveVertexIndices(char* vertexData, int32_t* idx, const char* bufEnd, uint32_t vbsize, uint32_t vtsize, uint32_t vnsize)
+const char* COBJMeshFileLoader::readFaceCorner(const char* bufPtr, const char* const bufEnd, int32_t idx[3])
 {
-	char word[16] = "";
-	const char* p = goFirstWord(vertexData, bufEnd);
-	uint32_t idxType = 0;	// 0 = posIdx, 1 = texcoordIdx, 2 = normalIdx
-
-	uint32_t i = 0;
-	while ( p != bufEnd )
+	idx[0] = idx[1] = idx[2] = 0;
+	// `v`, `v/vt`, `v//vn` or `v/vt/vn`
+	for (uint32_t idxType=0u; idxType<3u; idxType++)
 	{
-		if ( ( core::isdigit(*p)) || (*p == '-') )
-		{
-			// build up the number
-			word[i++] = *p;
-		}
-		else if ( *p == '/' || *p == ' ' || *p == '\0' )
-		{
-			// number is completed. Convert and store it
-			word[i] = '\0';
-			// if no number was found index will become 0 and later on -1 by decrement
-			sscanf(word,"%d",idx+idxType);
-			if (idx[idxType]<0)
-			{
-				switch (idxType)
-				{
-					case 0:
-						idx[idxType] += vbsize;
-						break;
-					case 1:
-						idx[idxType] += vtsize;
-						break;
-					case 2:
-						idx[idxType] += vnsize;
-						break;
-				}
-			}
-			else
-				idx[idxType]-=1;
-
-			// reset the word
-			word[0] = '\0';
-			i = 0;
-
-			// go to the next kind of index type
-			if (*p == '/')
-			{
-				if ( ++idxType > 2 )
-				{
-					// error checking, shouldn't reach here unless file is wrong
-					idxType = 0;
-				}
-			}
-			else
-			{
-				// set all missing values to disable (=-1)
-				while (++idxType < 3)
-					idx[idxType]=-1;
-				++p;
-				break; // while
-			}
-		}
-
-		// go to the next char
-		++p;
+		bufPtr = parseNumber(bufPtr, bufEnd, idx[idxType]);
+		if (bufPtr==bufEnd || *bufPtr!='/')
+			break;
+		++bufPtr;
 	}
-
-	return true;
+	// skip anything malformed up to the next corner
+	while (bufPtr!=bufEnd && !core::isspace(*bufPtr))
+		++bufPtr;
+	return bufPtr;
 }
 
 std::string COBJMeshFileLoader::genKeyForMeshBuf(const SContext& _ctx, const std::string& _baseKey, const std::string& _mtlName, const std::string& _grpName) const
@@ -84,6 +84,10 @@ public:
         _file->read(succ, &firstChar, 0, sizeof(firstChar));
         return succ && (firstChar =='#' || firstChar =='v');
     }
+    inline bool isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger) const override
+    {
+        return !_header.empty() && (_header[0] =='#' || _header[0] =='v');
+    }
 
     virtual const char** getAssociatedFileExtensions() const override
     {
@@ -100,12 +104,12 @@ private:
 	const char* goFirstWord(const char* buf, const char* const bufEnd, bool acrossNewlines=true);
 	// returns a pointer to the first printable character after the first non-printable
 	const char* goNextWord(const char* buf, const char* const bufEnd, bool acrossNewlines=true);
+	// returns a pointer to the first line break, or `bufEnd` if there's none
+	static const char* findLineEnd(const char* buf, const char* const bufEnd);
 	// returns a pointer to the next printable character after the first line break
 	const char* goNextLine(const char* buf, const char* const bufEnd);
 	// copies the current word from the inBuf to the outBuf
 	uint32_t copyWord(char* outBuf, const char* inBuf, uint32_t outBufLength, const char* const pBufEnd);
-	// copies the current line from the inBuf to the outBuf
-	std::string copyLine(const char* inBuf, const char* const bufEnd);
 
 	// combination of goNextWord followed by copyWord
 	const char* goAndCopyNextWord(char* outBuf, const char* inBuf, uint32_t outBufLength, const char* const pBufEnd);
@@ -117,10 +121,9 @@ private:
 	//! Read boolean value represented as 'on' or 'off'
 	const char* readBool(const char* bufPtr, bool& tf, const char* const bufEnd);
 
-	// reads and convert to integer the vertex indices in a line of obj file's face statement
-	// -1 for the index if it doesn't exist
-	// indices are changed to 0-based index instead of 1-based from the obj file
-	bool retrieveVertexIndices(char* vertexData, int32_t* idx, const char* bufEnd, uint32_t vbsize, uint32_t vtsize, uint32_t vnsize);
+	// reads the `v/vt/vn` indices of a single corner of a face statement as they are in the file and returns a pointer past them
+	// 0 for the index if it doesn't exist, negative ones are relative to the attributes read so far
+	const char* readFaceCorner(const char* bufPtr, const char* const bufEnd, int32_t idx[3]);
 
     std::string genKeyForMeshBuf(const SContext& _ctx, const std::string& _baseKey, const std::string& _mtlName, const std::string& _grpName) const;
 
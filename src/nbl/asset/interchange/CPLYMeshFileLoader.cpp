@@ -7,8 +7,10 @@
 
 #ifdef _NBL_COMPILE_WITH_PLY_LOADER_
 
+#include <bit>
 #include <numeric>
 
+#include "nbl/core/execution.h"
 #include "nbl/asset/IAssetManager.h"
 #include "nbl/system/ISystem.h"
 #include "nbl/system/IFile.h"
@@ -28,6 +30,18 @@ CPLYMeshFileLoader::CPLYMeshFileLoader(IAssetManager* _am)
 CPLYMeshFileLoader::~CPLYMeshFileLoader() {}
 
 bool CPLYMeshFileLoader::isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const
+{
+    uint8_t buf[40];
+
+	system::IFile::success_t success;
+	_file->read(success, buf, 0, sizeof(buf));
+	if (!success)
+		return false;
+
+    return isALoadableFileFormat({buf,sizeof(buf)}, _file, logger);
+}
+
+bool CPLYMeshFileLoader::isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger) const
 {
     const char* headers[3]{
         "format ascii 1.0",
@@ -35,12 +49,11 @@ bool CPLYMeshFileLoader::isALoadableFileFormat(system::IFile* _file, const syste
         "format binary_big_endian 1.0"
     };
 
-    char buf[40];
-
-	system::IFile::success_t success;
-	_file->read(success, buf, 0, sizeof(buf));
-	if (!success)
-		return false;
+    // only the first line after the magic matters
+    char buf[41] = {};
+    if (_header.size() < sizeof(buf)-1u)
+        return false;
+    memcpy(buf, _header.data(), sizeof(buf)-1u);
 
     char* header = buf;
     if (strncmp(header, "ply", 3u) != 0)
@@ -58,6 +71,13 @@ bool CPLYMeshFileLoader::isALoadableFileFormat(system::IFile* _file, const syste
     return false;
 }
 
+std::span<const IAssetLoader::SFileMagic> CPLYMeshFileLoader::getFileMagics() const
+{
+    static constexpr uint8_t ply[] = { 'p', 'l', 'y' };
+    static constexpr SFileMagic magics[] = { {0u,ply} };
+    return magics;
+}
+
 void CPLYMeshFileLoader::initialize()
 {
 	IRenderpassIndependentPipelineLoader::initialize();
@@ -402,9 +422,17 @@ asset::SAssetBundle CPLYMeshFileLoader::loadAsset(system::IFile* _file, const as
 						}			
 					}
 
-					// loop through vertex properties
-					for (uint32_t j=0; j<ctx.ElementList[i]->Count; ++j)
-						hasNormals &= readVertex(ctx, plyVertexElement, attributes, j, _params);
+					if (ctx.IsBinaryFile && plyVertexElement.IsFixedWidth)
+					{
+						if (!readVerticesBinary(ctx, plyVertexElement, attributes, _params))
+							return {};
+					}
+					else
+					{
+						// loop through vertex properties
+						for (uint32_t j=0; j<ctx.ElementList[i]->Count; ++j)
+							hasNormals &= readVertex(ctx, plyVertexElement, attributes, j, _params);
+					}
 				}
 				else if (ctx.ElementList[i]->Name == "face")
 				{
@@ -627,6 +655,217 @@ bool CPLYMeshFileLoader::readVertex(SContext& _ctx, const SPLYElement& Element,
 }
 
 
+namespace
+{
+// PLY doesn't care about the host's endianness
+template<typename T>
+inline T loadProperty(const uint8_t* src, const bool swap)
+{
+	std::array<uint8_t,sizeof(T)> bytes;
+	memcpy(bytes.data(), src, sizeof(T));
+	if (swap)
+		std::reverse(bytes.begin(), bytes.end());
+	return std::bit_cast<T>(bytes);
+}
+
+// converts one property of `rowCount` rows into one component of a float attribute
+template<typename T>
+inline void gatherProperty(const uint8_t* src, const size_t rowSize, const uint32_t rowCount, float* dst, const uint32_t dstStride, const bool swap, const float scale)
+{
+	uint32_t i = 0u;
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+	// 4 rows at a time, byteswap and conversion to float done in one go
+	if constexpr (std::is_same_v<T,float> || std::is_same_v<T,int32_t>)
+	{
+		const __m128i swapMask = _mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+		const __m128 scaleV = _mm_set1_ps(scale);
+		for (; i+4u <= rowCount; i += 4u)
+		{
+			alignas(16) uint32_t lanes[4];
+			for (uint32_t k = 0u; k < 4u; ++k)
+				memcpy(lanes+k, src+(i+k)*rowSize, sizeof(uint32_t));
+			__m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(lanes));
+			if (swap)
+				v = _mm_shuffle_epi8(v, swapMask);
+
+			__m128 f;
+			if constexpr (std::is_same_v<T,float>)
+				f = _mm_castsi128_ps(v);
+			else
+				f = _mm_cvtepi32_ps(v);
+
+			alignas(16) float out[4];
+			_mm_store_ps(out, _mm_mul_ps(f, scaleV));
+			for (uint32_t k = 0u; k < 4u; ++k)
+				dst[(i+k)*dstStride] = out[k];
+		}
+	}
+#endif
+	for (; i < rowCount; ++i)
+		dst[i*dstStride] = float(loadProperty<T>(src+i*rowSize, swap))*scale;
+}
+}
+
+bool CPLYMeshFileLoader::readVerticesBinary(SContext& _ctx, const SPLYElement& Element, asset::SBufferBinding<asset::ICPUBuffer> outAttributes[4], const asset::IAssetLoader::SAssetLoadParams& _params)
+{
+	constexpr uint32_t ComponentCount[4] = { 3u, 4u, 2u, 3u };
+
+	// precompile which property of a row goes to which component, so the rows don't need any name lookups or per-value dispatch
+	struct SGatherOp
+	{
+		uint32_t srcOffset;
+		// EPLYPT_UNKNOWN fills the component with `scale` for attributes which don't have all of their components in the file
+		E_PLY_PROPERTY_TYPE type;
+		E_TYPE attribute;
+		uint8_t component;
+		// integer colors are unsigned and get normalized
+		bool unorm;
+		float scale;
+	};
+	core::vector<SGatherOp> plan;
+	uint32_t writtenComponents[4] = {};
+	{
+		const float xScale = _params.loaderFlags & E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES ? -1.f : 1.f;
+
+		uint32_t srcOffset = 0u;
+		for (const auto& property : Element.Properties)
+		{
+			SGatherOp op = { srcOffset, property.Type, ET_POS, 0u, false, 1.f };
+			srcOffset += property.size();
+
+			const auto& name = property.Name;
+			if (name == "x" || name == "y" || name == "z")
+			{
+				op.attribute = ET_POS;
+				op.component = name[0]-'x';
+				if (op.component == 0u)
+					op.scale = xScale;
+			}
+			else if (name == "nx" || name == "ny" || name == "nz")
+			{
+				op.attribute = ET_NORM;
+				op.component = name[1]-'x';
+				if (op.component == 0u)
+					op.scale = xScale;
+			}
+			// there isn't a single convention for the UV, some softwares like Blender or Assimp use "st" instead of "uv"
+			else if (name == "u" || name == "s" || name == "v" || name == "t")
+			{
+				op.attribute = ET_UV;
+				op.component = name == "u" || name == "s" ? 0u : 1u;
+			}
+			else if (name == "red" || name == "green" || name == "blue" || name == "alpha")
+			{
+				op.attribute = ET_COL;
+				op.component = name == "red" ? 0u : (name == "green" ? 1u : (name == "blue" ? 2u : 3u));
+				if (!property.isFloat())
+				{
+					op.unorm = true;
+					op.scale = 1.f/255.f;
+				}
+			}
+			else
+				continue;
+
+			if (!outAttributes[op.attribute].buffer)
+				continue;
+			writtenComponents[op.attribute] |= 0x1u<<op.component;
+			plan.push_back(op);
+		}
+
+		for (uint32_t attribute = 0u; attribute < 4u; ++attribute)
+		if (outAttributes[attribute].buffer)
+		for (uint8_t component = 0u; component < ComponentCount[attribute]; ++component)
+		if (!(writtenComponents[attribute] & (0x1u<<component)))
+			plan.push_back({ 0u, EPLYPT_UNKNOWN, static_cast<E_TYPE>(attribute), component, false, attribute == ET_COL && component == 3u ? 1.f : 0.f });
+	}
+
+	const size_t rowSize = Element.KnownSize;
+	const size_t byteSize = rowSize*Element.Count;
+	if (byteSize == 0ull)
+		return true;
+
+	// the rows are either already in the read-ahead window, in the mapping or get read in one go
+	auto* const file = _ctx.inner.mainFile;
+	const size_t fileOffset = _ctx.Stream->tell()+(_ctx.StartPointer-_ctx.Buffer);
+	if (fileOffset+byteSize > file->getSize())
+	{
+		_params.logger.log("PLY vertex data of %s is truncated", system::ILogger::ELL_ERROR, file->getFileName().string().c_str());
+		return false;
+	}
+	core::vector<uint8_t> fileContents;
+	const bool inWindow = size_t(_ctx.EndPointer-_ctx.StartPointer) >= byteSize;
+	const uint8_t* rows = reinterpret_cast<const uint8_t*>(inWindow ? _ctx.StartPointer : file->getMappedPointer());
+	if (!inWindow)
+	{
+		if (rows)
+			rows += fileOffset;
+		else
+		{
+			fileContents.resize(byteSize);
+			system::IFile::success_t success;
+			file->read(success, fileContents.data(), fileOffset, byteSize);
+			if (!success)
+				return false;
+			rows = fileContents.data();
+		}
+	}
+
+	constexpr uint32_t RowsPerBlock = 0x1u<<16u;
+	core::vector<uint32_t> blocks((Element.Count+RowsPerBlock-1u)/RowsPerBlock);
+	std::iota(blocks.begin(), blocks.end(), 0u);
+	core::for_each(core::execution::par, blocks.begin(), blocks.end(), [&](const uint32_t block) -> void
+		{
+			const uint32_t firstRow = block*RowsPerBlock;
+			const uint32_t rowCount = std::min(RowsPerBlock, Element.Count-firstRow);
+			const uint8_t* const src = rows+firstRow*rowSize;
+			for (const auto& op : plan)
+			{
+				const uint32_t dstStride = ComponentCount[op.attribute];
+				float* const dst = reinterpret_cast<float*>(outAttributes[op.attribute].buffer->getPointer())+firstRow*dstStride+op.component;
+				const uint8_t* const property = src+op.srcOffset;
+				switch (op.type)
+				{
+				case EPLYPT_INT8:
+					if (op.unorm)
+						gatherProperty<uint8_t>(property, rowSize, rowCount, dst, dstStride, _ctx.IsWrongEndian, op.scale);
+					else
+						gatherProperty<int8_t>(property, rowSize, rowCount, dst, dstStride, _ctx.IsWrongEndian, op.scale);
+					break;
+				case EPLYPT_INT16:
+					if (op.unorm)
+						gatherProperty<uint16_t>(property, rowSize, rowCount, dst, dstStride, _ctx.IsWrongEndian, op.scale);
+					else
+						gatherProperty<int16_t>(property, rowSize, rowCount, dst, dstStride, _ctx.IsWrongEndian, op.scale);
+					break;
+				case EPLYPT_INT32:
+					if (op.unorm)
+						gatherProperty<uint32_t>(property, rowSize, rowCount, dst, dstStride, _ctx.IsWrongEndian, op.scale);
+					else
+						gatherProperty<int32_t>(property, rowSize, rowCount, dst, dstStride, _ctx.IsWrongEndian, op.scale);
+					break;
+				case EPLYPT_FLOAT32:
+					gatherProperty<float>(property, rowSize, rowCount, dst, dstStride, _ctx.IsWrongEndian, op.scale);
+					break;
+				case EPLYPT_FLOAT64:
+					gatherProperty<double>(property, rowSize, rowCount, dst, dstStride, _ctx.IsWrongEndian, op.scale);
+					break;
+				default:
+					for (uint32_t i = 0u; i < rowCount; ++i)
+						dst[i*dstStride] = op.scale;
+					break;
+				}
+			}
+		}
+	);
+
+	if (inWindow)
+		_ctx.StartPointer += byteSize;
+	else
+		seekTo(_ctx, fileOffset+byteSize);
+	return true;
+}
+
 bool CPLYMeshFileLoader::readFace(SContext& _ctx, const SPLYElement& Element, core::vector<uint32_t>& _outIndices)
 {
 	if (!_ctx.IsBinaryFile)
@@ -708,15 +947,16 @@ bool CPLYMeshFileLoader::allocateBuffer(SContext& _ctx)
 	// Destroy the element list if it exists
 	_ctx.ElementList.clear();
 
-	if (!_ctx.Buffer)
-        _ctx.Buffer = _NBL_NEW_ARRAY(char, PLY_INPUT_BUFFER_SIZE);
+	seekTo(_ctx, 0ull);
+
+	return true;
+}
 
-	// not enough memory?
-	if (!_ctx.Buffer)
-		return false;
 
-	// blank memory
-	memset(_ctx.Buffer, 0, PLY_INPUT_BUFFER_SIZE);
+void CPLYMeshFileLoader::seekTo(SContext& _ctx, const size_t offset)
+{
+	_ctx.Stream = std::make_unique<system::CBufferedFileStream>(_ctx.inner.mainFile,offset,PLY_INPUT_BUFFER_SIZE);
+	_ctx.Buffer = reinterpret_cast<char*>(_ctx.Stream->data());
 
 	_ctx.StartPointer = _ctx.Buffer;
 	_ctx.EndPointer = _ctx.Buffer;
@@ -726,52 +966,24 @@ bool CPLYMeshFileLoader::allocateBuffer(SContext& _ctx)
 
 	// get data from the file
 	fillBuffer(_ctx);
-
-	return true;
 }
 
 
-// gets more data from the file. returns false on EOF
+// gets more data from the file, the next chunk is already being read in the background
 void CPLYMeshFileLoader::fillBuffer(SContext& _ctx)
 {
 	if (_ctx.EndOfFile)
 		return;
 
-	uint32_t length = (uint32_t)(_ctx.EndPointer - _ctx.StartPointer);
-	if (length && _ctx.StartPointer != _ctx.Buffer)
-	{
-		// copy the remaining data to the start of the buffer
-		memcpy(_ctx.Buffer, _ctx.StartPointer, length);
-	}
+	// the stream keeps everything from the start pointer onwards contiguous in front of the new data
+	_ctx.Stream->consume(_ctx.StartPointer - _ctx.Buffer);
+	_ctx.Stream->refill();
+	_ctx.EndOfFile = _ctx.Stream->eof();
+
 	// reset start position
+	_ctx.Buffer = reinterpret_cast<char*>(_ctx.Stream->data());
 	_ctx.StartPointer = _ctx.Buffer;
-	_ctx.EndPointer = _ctx.StartPointer + length;
-
-	if (_ctx.fileOffset >= _ctx.inner.mainFile->getSize() - 1) // TODO: check it
-	{
-		_ctx.EndOfFile = true;
-	}
-	else
-	{
-		// read data from the file
-		system::IFile::success_t success;
-		_ctx.inner.mainFile->read(success, _ctx.EndPointer, _ctx.fileOffset, PLY_INPUT_BUFFER_SIZE - length);
-		const size_t bytesRead = success.getBytesProcessed();
-
-		_ctx.fileOffset += bytesRead;
-		// increment the end pointer by the number of bytes read
-		_ctx.EndPointer += bytesRead;
-
-		// if we didn't completely fill the buffer
-		if (bytesRead != PLY_INPUT_BUFFER_SIZE - length)
-		{
-			// blank the rest of the memory
-			memset(_ctx.EndPointer, 0, _ctx.Buffer + PLY_INPUT_BUFFER_SIZE - _ctx.EndPointer);
-
-			// end of file
-			_ctx.EndOfFile = true;
-		}
-	}
+	_ctx.EndPointer = _ctx.StartPointer + _ctx.Stream->size();
 }
 
 
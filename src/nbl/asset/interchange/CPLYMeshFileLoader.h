@@ -6,6 +6,7 @@
 #define _NBL_ASSET_C_PLY_MESH_FILE_LOADER_H_INCLUDED_
 
 #include "nbl/core/declarations.h"
+#include "nbl/system/CBufferedFileStream.h"
 #include "nbl/asset/interchange/IAssetLoader.h"
 #include "nbl/asset/ICPUMeshBuffer.h"
 #include "nbl/asset/interchange/IRenderpassIndependentPipelineLoader.h"
@@ -14,8 +15,8 @@
 namespace nbl::asset
 {
 
-// input buffer must be at least twice as long as the longest line in the file
-#define PLY_INPUT_BUFFER_SIZE 51200 // file is loaded in 50k chunks
+// file is read ahead in 50k chunks
+#define PLY_INPUT_BUFFER_SIZE 51200
 
 enum E_PLY_PROPERTY_TYPE
 {
@@ -40,6 +41,8 @@ public:
 	CPLYMeshFileLoader(IAssetManager* _am);
 
     virtual bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const override;
+    virtual bool isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger) const override;
+    virtual std::span<const SFileMagic> getFileMagics() const override;
 
     virtual const char** getAssociatedFileExtensions() const override
     {
@@ -164,11 +167,6 @@ private:
     {
 		~SContext()
 		{
-			if (Buffer)
-			{
-				_NBL_DELETE_ARRAY(reinterpret_cast<uint8_t*>(Buffer), PLY_INPUT_BUFFER_SIZE);
-				Buffer = nullptr;
-			}
 			ElementList.clear();
 		}
 
@@ -178,14 +176,17 @@ private:
 
         core::vector<std::unique_ptr<SPLYElement>> ElementList;
 	
+		// reads ahead while we parse, `Buffer` points at its current window
+		std::unique_ptr<system::CBufferedFileStream> Stream;
 		char* Buffer = nullptr;
         bool IsBinaryFile = false, IsWrongEndian = false, EndOfFile = false;
         int32_t LineLength = 0, WordLength = 0;
 		char* StartPointer = nullptr, *EndPointer = nullptr, *LineEndPointer = nullptr;
-		size_t fileOffset = {};
     };
 
 	bool allocateBuffer(SContext& _ctx);
+	// restarts the read-ahead at `offset`, for after bulk reads which bypassed the stream
+	void seekTo(SContext& _ctx, const size_t offset);
 	char* getNextLine(SContext& _ctx);
 	char* getNextWord(SContext& _ctx);
 	void fillBuffer(SContext& _ctx);
@@ -193,6 +194,8 @@ private:
 
  	bool readVertex(SContext& _ctx, const SPLYElement &Element, asset::SBufferBinding<asset::ICPUBuffer> outAttributes[4], const uint32_t& currentVertexIndex, const IAssetLoader::SAssetLoadParams& _params);
 	bool readFace(SContext& _ctx, const SPLYElement &Element, core::vector<uint32_t>& _outIndices);
+	// converts all rows of a fixed width vertex element of a binary file at once, returns false if the file is truncated
+	bool readVerticesBinary(SContext& _ctx, const SPLYElement& Element, asset::SBufferBinding<asset::ICPUBuffer> outAttributes[4], const IAssetLoader::SAssetLoadParams& _params);
 
 	void skipElement(SContext& _ctx, const SPLYElement &Element);
 	void skipProperty(SContext& _ctx, const SPLYProperty &Property);
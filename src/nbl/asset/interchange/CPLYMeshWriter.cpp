@@ -11,6 +11,8 @@
 #include "nbl/system/IFile.h"
 #include "nbl/asset/utils/CMeshManipulator.h"
 
+#include "SChunkedTextWriter.h"
+
 namespace nbl
 {
 namespace asset
@@ -212,241 +214,156 @@ bool CPLYMeshWriter::writeAsset(system::IFile* _file, const SAssetWriteParams& _
         faceCount = 0u;
     header += "end_header\n";
 
-    {
-        system::IFile::success_t success;
-        file->write(success, header.c_str(), context.fileOffset, header.size());
-        context.fileOffset += success.getBytesProcessed();
-    }
- 
+    bool success;
     if (flags & asset::EWF_BINARY)
-        writeBinary(rawCopyMeshBuffer, vertexCount, faceCount, idxT, indices, forceFaces, vaidToWrite, context);
+        success = writeBinary(rawCopyMeshBuffer, vertexCount, faceCount, idxT, indices, forceFaces, vaidToWrite, context, header);
     else
-        writeText(rawCopyMeshBuffer, vertexCount, faceCount, idxT, indices, forceFaces, vaidToWrite, context);
+        success = writeText(rawCopyMeshBuffer, vertexCount, faceCount, idxT, indices, forceFaces, vaidToWrite, context, header);
 
     _NBL_ALIGNED_FREE(const_cast<void*>(indices));
 
-	return true;
+	return success;
+}
+
+namespace impl
+{
+// faces without an index buffer are just consecutive vertices
+template<typename I>
+static inline I getFaceIndex(const void* _indices, bool _forceFaces, size_t _ix)
+{
+    return _forceFaces ? I(_ix) : reinterpret_cast<const I*>(_indices)[_ix];
+}
+
+static constexpr size_t VerticesPerBlock = 0x1ull<<16ull;
 }
 
-void CPLYMeshWriter::writeBinary(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCount, size_t _fcCount, asset::E_INDEX_TYPE _idxType, void* const _indices, bool _forceFaces, const bool _vaidToWrite[4], SContext& context) const
+bool CPLYMeshWriter::writeBinary(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCount, size_t _fcCount, asset::E_INDEX_TYPE _idxType, void* const _indices, bool _forceFaces, const bool _vaidToWrite[4], SContext& context, const std::string& header) const
 {
     const size_t colCpa = asset::getFormatChannelCount(_mbuf->getAttribFormat(1));
+    const size_t cpa[4] = { 3u, colCpa, 2u, 3u };
 
 	bool flipVectors = (!(context.writeContext.params.flags & E_WRITER_FLAGS::EWF_MESH_IS_RIGHT_HANDED)) ? true : false;
 
     auto mbCopy = createCopyMBuffNormalizedReplacedWithTrueInt(_mbuf);
-    for (size_t i = 0u; i < _vtxCount; ++i)
-    {
-        core::vectorSIMDf f;
-        uint32_t ui[4];
-        if (_vaidToWrite[0])
-        {
-            writeAttribBinary(context, mbCopy.get(), 0, i, 3u, flipVectors);
-        }
-        if (_vaidToWrite[1])
-        {
-            writeAttribBinary(context, mbCopy.get(), 1, i, colCpa);
-        }
-        if (_vaidToWrite[2])
-        {
-            writeAttribBinary(context, mbCopy.get(), 2, i, 2u);
-        }
-        if (_vaidToWrite[3])
-        {
-            writeAttribBinary(context, mbCopy.get(), 3, i, 3u, flipVectors);
-        }
-    }
+
+    // everything has a fixed size, so the whole file gets encoded in memory and written with a single write
+    size_t vertexSize = 0u;
+    for (uint32_t vaid = 0u; vaid < 4u; ++vaid)
+    if (_vaidToWrite[vaid])
+        vertexSize += getAttribBinarySize(mbCopy->getAttribFormat(vaid), cpa[vaid]);
 
     constexpr uint8_t listSize = 3u;
-    void* indices = _indices;
-    if (_forceFaces)
-    {
-        indices = _NBL_ALIGNED_MALLOC((_idxType == asset::EIT_32BIT ? 4 : 2) * listSize * _fcCount,_NBL_SIMD_ALIGNMENT);
-        if (_idxType == asset::EIT_16BIT)
-        {
-            for (uint16_t i = 0u; i < _fcCount; ++i)
-                ((uint16_t*)indices)[i] = i;
-        }
-        else
-        {
-            for (uint32_t i = 0u; i < _fcCount; ++i)
-                ((uint32_t*)indices)[i] = i;
-        }
-    }
-    if (_idxType == asset::EIT_32BIT)
-    {
-        uint32_t* ind = (uint32_t*)indices;
-        for (size_t i = 0u; i < _fcCount; ++i)
-        {
-            {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, &listSize, context.fileOffset, sizeof(listSize));
-                context.fileOffset += success.getBytesProcessed();
-            }
+    const size_t indexSize = _idxType == asset::EIT_32BIT ? 4u : 2u;
+    const size_t faceSize = sizeof(listSize) + listSize * indexSize;
 
-            {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, ind, context.fileOffset, listSize * 4);
-                context.fileOffset += success.getBytesProcessed();
-            }
+    core::vector<uint8_t> output(header.size() + _vtxCount * vertexSize + _fcCount * faceSize);
+    memcpy(output.data(), header.data(), header.size());
+    uint8_t* const vertices = output.data() + header.size();
+    uint8_t* const faces = vertices + _vtxCount * vertexSize;
 
-            ind += listSize;
-        }
-    }
-    else
-    {
-        uint16_t* ind = (uint16_t*)indices;
-        for (size_t i = 0u; i < _fcCount; ++i)
+    core::vector<size_t> blocks((std::max(_vtxCount, _fcCount) + impl::VerticesPerBlock - 1u) / impl::VerticesPerBlock);
+    std::iota(blocks.begin(), blocks.end(), 0u);
+    core::for_each(core::execution::par, blocks.begin(), blocks.end(), [&](const size_t block) -> void
         {
+            const size_t first = block * impl::VerticesPerBlock;
+            for (size_t i = first; i < std::min(first + impl::VerticesPerBlock, _vtxCount); ++i)
             {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, &listSize, context.fileOffset, sizeof(listSize));
-                context.fileOffset += success.getBytesProcessed();
+                uint8_t* dst = vertices + i * vertexSize;
+                for (uint32_t vaid = 0u; vaid < 4u; ++vaid)
+                if (_vaidToWrite[vaid])
+                    dst = writeAttribBinary(dst, mbCopy.get(), vaid, i, cpa[vaid], flipVectors && (vaid == 0u || vaid == 3u));
             }
 
+            for (size_t i = first; i < std::min(first + impl::VerticesPerBlock, _fcCount); ++i)
             {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, ind, context.fileOffset, listSize * 2);
-                context.fileOffset += success.getBytesProcessed();
+                uint8_t* dst = faces + i * faceSize;
+                *(dst++) = listSize;
+                for (uint32_t k = 0u; k < listSize; ++k)
+                {
+                    if (_idxType == asset::EIT_32BIT)
+                    {
+                        const uint32_t index = impl::getFaceIndex<uint32_t>(_indices, _forceFaces, listSize * i + k);
+                        memcpy(dst, &index, sizeof(index));
+                    }
+                    else
+                    {
+                        const uint16_t index = impl::getFaceIndex<uint16_t>(_indices, _forceFaces, listSize * i + k);
+                        memcpy(dst, &index, sizeof(index));
+                    }
+                    dst += indexSize;
+                }
             }
-            
-            ind += listSize;
         }
-    }
+    );
 
-    if (_forceFaces)
-        _NBL_ALIGNED_FREE(indices);
+    system::IFile::success_t success;
+    context.writeContext.outputFile->write(success, output.data(), context.fileOffset, output.size());
+    context.fileOffset += success.getBytesProcessed();
+    return bool(success);
 }
 
-void CPLYMeshWriter::writeText(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCount, size_t _fcCount, asset::E_INDEX_TYPE _idxType, void* const _indices, bool _forceFaces, const bool _vaidToWrite[4], SContext& context) const
+bool CPLYMeshWriter::writeText(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCount, size_t _fcCount, asset::E_INDEX_TYPE _idxType, void* const _indices, bool _forceFaces, const bool _vaidToWrite[4], SContext& context, const std::string& header) const
 {
     auto mbCopy = createCopyMBuffNormalizedReplacedWithTrueInt(_mbuf);
 
-    auto writefunc = [&context, &mbCopy, this](uint32_t _vaid, size_t _ix, size_t _cpa)
-    {
-		bool flipVerteciesAndNormals = false;
-		if (!(context.writeContext.params.flags & E_WRITER_FLAGS::EWF_MESH_IS_RIGHT_HANDED))
-			if(_vaid == 0u || _vaid == 3u)
-				flipVerteciesAndNormals = true;
-
-        uint32_t ui[4];
-        core::vectorSIMDf f;
-        const asset::E_FORMAT t = mbCopy->getAttribFormat(_vaid);
-        if (asset::isScaledFormat(t) || asset::isIntegerFormat(t))
-        {
-            mbCopy->getAttribute(ui, _vaid, _ix);
-            if (!asset::isSignedFormat(t))
-                writeVectorAsText(context, ui, _cpa, flipVerteciesAndNormals);
-            else
-            {
-                int32_t ii[4];
-                memcpy(ii, ui, 4*4);
-                writeVectorAsText(context, ii, _cpa, flipVerteciesAndNormals);
-            }
-        }
-        else
-        {
-            mbCopy->getAttribute(f, _vaid, _ix);
-            writeVectorAsText(context, f.pointer, _cpa, flipVerteciesAndNormals);
-        }
-    };
-
+    const bool flipVectors = !(context.writeContext.params.flags & E_WRITER_FLAGS::EWF_MESH_IS_RIGHT_HANDED);
     const size_t colCpa = asset::getFormatChannelCount(_mbuf->getAttribFormat(1));
+    const size_t cpa[4] = { 3u, colCpa, 2u, 3u };
 
-    for (size_t i = 0u; i < _vtxCount; ++i)
-    {
-        core::vectorSIMDf f;
-        uint32_t ui[4];
-        if (_vaidToWrite[0])
-        {
-            writefunc(0, i, 3u);
-        }
-        if (_vaidToWrite[1])
-        {
-            writefunc(1, i, colCpa);
-        }
-        if (_vaidToWrite[2])
-        {
-            writefunc(2, i, 2u);
-        }
-        if (_vaidToWrite[3])
-        {
-            writefunc(3, i, 3u);
-        }
-
-        {
-            system::IFile::success_t success;
-            context.writeContext.outputFile->write(success, "\n", context.fileOffset, 1);
-            context.fileOffset += success.getBytesProcessed();
-        }
-    }
+    auto* const file = context.writeContext.outputFile;
+    if (!SChunkedTextWriter::write(file, context.fileOffset, header))
+        return false;
 
-    const char* listSize = "3 ";
-    void* indices = _indices;
-    if (_forceFaces)
-    {
-        indices = _NBL_ALIGNED_MALLOC((_idxType == asset::EIT_32BIT ? 4 : 2) * 3 * _fcCount,_NBL_SIMD_ALIGNMENT);
-        if (_idxType == asset::EIT_16BIT)
-        {
-            for (uint16_t i = 0u; i < _fcCount; ++i)
-                ((uint16_t*)indices)[i] = i;
-        }
-        else
-        {
-            for (uint32_t i = 0u; i < _fcCount; ++i)
-                ((uint32_t*)indices)[i] = i;
-        }
-    }
-    if (_idxType == asset::EIT_32BIT)
-    {
-        uint32_t* ind = (uint32_t*)indices;
-        for (size_t i = 0u; i < _fcCount; ++i)
+    const bool verticesWritten = SChunkedTextWriter::write(file, context.fileOffset, _vtxCount, [&](std::string& out, const size_t first, const size_t last) -> void
         {
+            for (size_t i = first; i < last; ++i)
             {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, listSize, context.fileOffset, 2);
-                context.fileOffset += success.getBytesProcessed();
+                for (uint32_t vaid = 0u; vaid < 4u; ++vaid)
+                if (_vaidToWrite[vaid])
+                    writeAttribText(out, mbCopy.get(), vaid, i, cpa[vaid], flipVectors && (vaid == 0u || vaid == 3u));
+                out += '\n';
             }
-
-            writeVectorAsText(context, ind, 3);
-
-            {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, "\n", context.fileOffset, 1);
-                context.fileOffset += success.getBytesProcessed();
-            }
-
-            ind += 3;
         }
-    }
-    else
-    {
-        uint16_t* ind = (uint16_t*)indices;
-        for (size_t i = 0u; i < _fcCount; ++i)
-        {
-            {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, listSize, context.fileOffset, 2);
-                context.fileOffset += success.getBytesProcessed();
-            }
-
-            writeVectorAsText(context, ind, 3);
+    );
+    if (!verticesWritten)
+        return false;
 
+    return SChunkedTextWriter::write(file, context.fileOffset, _fcCount, [&](std::string& out, const size_t first, const size_t last) -> void
+        {
+            for (size_t i = first; i < last; ++i)
             {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, "\n", context.fileOffset, 1);
-                context.fileOffset += success.getBytesProcessed();
+                out += "3 ";
+                for (uint32_t k = 0u; k < 3u; ++k)
+                {
+                    if (_idxType == asset::EIT_32BIT)
+                        SChunkedTextWriter::append(out, impl::getFaceIndex<uint32_t>(_indices, _forceFaces, 3u * i + k));
+                    else
+                        SChunkedTextWriter::append(out, impl::getFaceIndex<uint16_t>(_indices, _forceFaces, 3u * i + k));
+                    out += ' ';
+                }
+                out += '\n';
             }
-
-            ind += 3;
         }
-    }
+    );
+}
 
-    if (_forceFaces)
-        _NBL_ALIGNED_FREE(indices);
+size_t CPLYMeshWriter::getAttribBinarySize(asset::E_FORMAT _t, size_t _cpa)
+{
+    if (asset::isScaledFormat(_t) || asset::isIntegerFormat(_t))
+    {
+        const uint32_t bytesPerCh = asset::getTexelOrBlockBytesize(_t)/asset::getFormatChannelCount(_t);
+        if (bytesPerCh == 1u || _t == asset::EF_A2B10G10R10_UINT_PACK32 || _t == asset::EF_A2B10G10R10_SINT_PACK32 || _t == asset::EF_A2B10G10R10_SSCALED_PACK32 || _t == asset::EF_A2B10G10R10_USCALED_PACK32)
+            return _cpa;
+        else if (bytesPerCh == 2u)
+            return 2u * _cpa;
+        else if (bytesPerCh == 4u)
+            return 4u * _cpa;
+        return 0u;
+    }
+    return 4u * _cpa;
 }
 
-void CPLYMeshWriter::writeAttribBinary(SContext& context, asset::ICPUMeshBuffer* _mbuf, uint32_t _vaid, size_t _ix, size_t _cpa, bool flipAttribute) const
+uint8_t* CPLYMeshWriter::writeAttribBinary(uint8_t* _dst, asset::ICPUMeshBuffer* _mbuf, uint32_t _vaid, size_t _ix, size_t _cpa, bool flipAttribute)
 {
     uint32_t ui[4];
     core::vectorSIMDf f;
@@ -461,35 +378,22 @@ void CPLYMeshWriter::writeAttribBinary(SContext& context, asset::ICPUMeshBuffer*
         const uint32_t bytesPerCh = asset::getTexelOrBlockBytesize(t)/asset::getFormatChannelCount(t);
         if (bytesPerCh == 1u || t == asset::EF_A2B10G10R10_UINT_PACK32 || t == asset::EF_A2B10G10R10_SINT_PACK32 || t == asset::EF_A2B10G10R10_SSCALED_PACK32 || t == asset::EF_A2B10G10R10_USCALED_PACK32)
         {
-            uint8_t a[4];
             for (uint32_t k = 0u; k < _cpa; ++k)
-                a[k] = ui[k];
-
-            {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, a, context.fileOffset, _cpa);
-                context.fileOffset += success.getBytesProcessed();
-            }
+                *(_dst++) = ui[k];
         }
         else if (bytesPerCh == 2u)
         {
-            uint16_t a[4];
             for (uint32_t k = 0u; k < _cpa; ++k)
-                a[k] = ui[k];
-
             {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, a, context.fileOffset, 2 * _cpa);
-                context.fileOffset += success.getBytesProcessed();
+                const uint16_t a = ui[k];
+                memcpy(_dst, &a, sizeof(a));
+                _dst += sizeof(a);
             }
         }
         else if (bytesPerCh == 4u)
         {
-            {
-                system::IFile::success_t success;
-                context.writeContext.outputFile->write(success, ui, context.fileOffset, 4 * _cpa);
-                context.fileOffset += success.getBytesProcessed();
-            }
+            memcpy(_dst, ui, 4 * _cpa);
+            _dst += 4 * _cpa;
         }
     }
     else
@@ -498,10 +402,39 @@ void CPLYMeshWriter::writeAttribBinary(SContext& context, asset::ICPUMeshBuffer*
         if (flipAttribute)
             f[0] = -f[0];
 
+        memcpy(_dst, f.pointer, 4 * _cpa);
+        _dst += 4 * _cpa;
+    }
+    return _dst;
+}
+
+void CPLYMeshWriter::writeAttribText(std::string& _out, asset::ICPUMeshBuffer* _mbuf, uint32_t _vaid, size_t _ix, size_t _cpa, bool flipAttribute)
+{
+    const asset::E_FORMAT t = _mbuf->getAttribFormat(_vaid);
+    if (asset::isScaledFormat(t) || asset::isIntegerFormat(t))
+    {
+        uint32_t ui[4];
+        _mbuf->getAttribute(ui, _vaid, _ix);
+        for (size_t k = 0u; k < _cpa; ++k)
+        {
+            if (asset::isSignedFormat(t))
+            {
+                const int32_t value = static_cast<int32_t>(ui[k]);
+                SChunkedTextWriter::append(_out, flipAttribute && k == 0u ? -value : value);
+            }
+            else
+                SChunkedTextWriter::append(_out, ui[k]);
+            _out += ' ';
+        }
+    }
+    else
+    {
+        core::vectorSIMDf f;
+        _mbuf->getAttribute(f, _vaid, _ix);
+        for (size_t k = 0u; k < _cpa; ++k)
         {
-            system::IFile::success_t success;
-            context.writeContext.outputFile->write(success, f.pointer, context.fileOffset, 4 * _cpa);
-            context.fileOffset += success.getBytesProcessed();
+            SChunkedTextWriter::append(_out, flipAttribute && k == 0u ? -f[k] : f[k], std::chars_format::fixed, 6);
+            _out += ' ';
         }
     }
 }
@@ -6,8 +6,6 @@
 #ifndef __NBL_ASSET_PLY_MESH_WRITER_H_INCLUDED__
 #define __NBL_ASSET_PLY_MESH_WRITER_H_INCLUDED__
 
-#include <iomanip>
-
 #include "nbl/asset/ICPUMeshBuffer.h"
 #include "nbl/asset/interchange/IAssetWriter.h"
 
@@ -45,38 +43,19 @@ class CPLYMeshWriter : public asset::IAssetWriter
             size_t fileOffset = 0;
         };
 
-        void writeBinary(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCount, size_t _fcCount, asset::E_INDEX_TYPE _idxType, void* const _indices, bool _forceFaces, const bool _vaidToWrite[4], SContext& context) const;
-        void writeText(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCount, size_t _fcCount, asset::E_INDEX_TYPE _idxType, void* const _indices, bool _forceFaces, const bool _vaidToWrite[4], SContext& context) const;
+        bool writeBinary(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCount, size_t _fcCount, asset::E_INDEX_TYPE _idxType, void* const _indices, bool _forceFaces, const bool _vaidToWrite[4], SContext& context, const std::string& header) const;
+        bool writeText(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCount, size_t _fcCount, asset::E_INDEX_TYPE _idxType, void* const _indices, bool _forceFaces, const bool _vaidToWrite[4], SContext& context, const std::string& header) const;
 
-        void writeAttribBinary(SContext& context, asset::ICPUMeshBuffer* _mbuf, uint32_t _vaid, size_t _ix, size_t _cpa, bool flipAttribute = false) const;
+        //! Bytes `writeAttribBinary` produces for one vertex
+        static size_t getAttribBinarySize(asset::E_FORMAT _t, size_t _cpa);
+        //! Returns the pointer past the written attribute
+        static uint8_t* writeAttribBinary(uint8_t* _dst, asset::ICPUMeshBuffer* _mbuf, uint32_t _vaid, size_t _ix, size_t _cpa, bool flipAttribute = false);
+        static void writeAttribText(std::string& _out, asset::ICPUMeshBuffer* _mbuf, uint32_t _vaid, size_t _ix, size_t _cpa, bool flipAttribute = false);
 
         //! Creates new mesh buffer with the same attribute buffers mapped but with normalized types changed to corresponding true integer types.
         static core::smart_refctd_ptr<asset::ICPUMeshBuffer> createCopyMBuffNormalizedReplacedWithTrueInt(const asset::ICPUMeshBuffer* _mbuf);
 
         static std::string getTypeString(asset::E_FORMAT _t);
-
-        template<typename T>
-        void writeVectorAsText(SContext& context, const T* _vec, size_t _elementsToWrite, bool flipVectors = false) const
-        {
-			constexpr size_t xID = 0u;
-            std::stringstream ss;
-            ss << std::fixed;
-			bool currentFlipOnVariable = false;
-			for (size_t i = 0u; i < _elementsToWrite; ++i)
-			{
-				if (flipVectors && i == xID)
-					currentFlipOnVariable = true;
-				else
-					currentFlipOnVariable = false;
-
-					ss << std::setprecision(6) << _vec[i] * (currentFlipOnVariable ? -1 : 1) << " ";
-			}
-            auto str = ss.str();
-
-            system::IFile::success_t succ;
-            context.writeContext.outputFile->write(succ, str.c_str(), context.fileOffset, str.size());
-            context.fileOffset += succ.getBytesProcessed();
-        }
 };
 
 } // end namespace
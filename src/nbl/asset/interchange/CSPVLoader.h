@@ -23,6 +23,18 @@ class CSPVLoader final : public asset::IAssetLoader
 			_file->read(success, &magicNumber, 0, sizeof magicNumber);
 			return success && magicNumber==SPV_MAGIC_NUMBER;
 		}
+		inline bool isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger) const override
+		{
+			return getFileMagics()[0].matches(_header);
+		}
+
+		inline std::span<const SFileMagic> getFileMagics() const override
+		{
+			// `SPV_MAGIC_NUMBER` as little endian bytes
+			static constexpr uint8_t magicBytes[] = { 0x03, 0x02, 0x23, 0x07 };
+			static constexpr SFileMagic magics[] = { {0u,magicBytes} };
+			return magics;
+		}
 
 		const char** getAssociatedFileExtensions() const override
 		{
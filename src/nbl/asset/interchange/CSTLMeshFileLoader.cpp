@@ -15,6 +15,10 @@
 #include "nbl/system/ISystem.h"
 #include "nbl/system/IFile.h"
 
+#include "nbl/core/execution.h"
+
+#include <numeric>
+
 using namespace nbl;
 using namespace nbl::asset;
 
@@ -23,6 +27,11 @@ constexpr auto COLOR_ATTRIBUTE = 1;
 constexpr auto UV_ATTRIBUTE = 2;
 constexpr auto NORMAL_ATTRIBUTE = 3;
 
+// binary STL is an 80 byte header, a triangle count and then 50 byte triangles
+constexpr size_t BinaryHeaderSize = 80ull;
+constexpr size_t BinaryTriangleSize = 50ull;
+constexpr size_t BinaryAttribOffset = 48ull;
+
 CSTLMeshFileLoader::CSTLMeshFileLoader(asset::IAssetManager* _m_assetMgr)
 	: IRenderpassIndependentPipelineLoader(_m_assetMgr), m_assetMgr(_m_assetMgr)
 {
@@ -156,41 +165,127 @@ SAssetBundle CSTLMeshFileLoader::loadAsset(system::IFile* _file, const IAssetLoa
 	meshbuffer->setPositionAttributeIx(POSITION_ATTRIBUTE);
 	meshbuffer->setNormalAttributeIx(NORMAL_ATTRIBUTE);
 
+	using quant_normal_t = CQuantNormalCache::value_type_t<EF_A2B10G10R10_SNORM_PACK32>;
+
+	core::smart_refctd_ptr<ICPUBuffer> vertexBuf;
+	size_t vertexCount = 0ull;
+
+	// binary files are recognised by their size, some exporters start the header with "solid" too
+	uint32_t triangleCount = 0u;
 	bool binary = false;
+	if (filesize >= BinaryHeaderSize+sizeof(triangleCount))
+	{
+		system::IFile::success_t success;
+		context.inner.mainFile->read(success, &triangleCount, BinaryHeaderSize, sizeof(triangleCount));
+		if (!success)
+			return {};
+		binary = filesize == BinaryHeaderSize+sizeof(triangleCount)+BinaryTriangleSize*size_t(triangleCount);
+	}
+
 	std::string token;
-	if (getNextToken(&context, token) != "solid")
-		binary = hasColor = true;
+	if (!binary && getNextToken(&context, token) != "solid")
+	{
+		_params.logger.log("STL: %s is neither a valid ASCII nor a valid binary STL", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
+		return {};
+	}
 
-	core::vector<core::vectorSIMDf> positions, normals;
-	core::vector<uint32_t> colors;
 	if (binary)
 	{
-		if (_file->getSize() < 80)
-			return {};
+		// the triangles are fixed size records, so they get converted straight into the interleaved vertex buffer
+		const size_t trianglesOffset = BinaryHeaderSize+sizeof(triangleCount);
+		const size_t trianglesSize = BinaryTriangleSize*size_t(triangleCount);
+
+		core::vector<uint8_t> fileContents;
+		const uint8_t* triangles = reinterpret_cast<const uint8_t*>(_file->getMappedPointer());
+		if (triangles)
+			triangles += trianglesOffset;
+		else
+		{
+			fileContents.resize(trianglesSize);
+			system::IFile::success_t success;
+			_file->read(success, fileContents.data(), trianglesOffset, trianglesSize);
+			if (!success)
+				return {};
+			triangles = fileContents.data();
+		}
 
-		constexpr size_t headerOffset = 80; 
-		context.fileOffset = headerOffset; //! skip header
+		// assuming VisCam/SolidView non-standard trick to store color in 2 bytes of extra attribute, only if every triangle has one
+		hasColor = true;
+		for (uint32_t i = 0u; hasColor && i < triangleCount; ++i)
+		{
+			uint16_t attrib;
+			memcpy(&attrib, triangles+BinaryTriangleSize*i+BinaryAttribOffset, sizeof(attrib));
+			hasColor = attrib & 0x8000u;
+		}
 
-		uint32_t vertexCount = 0u;
+		vertexCount = 3ull*triangleCount;
+		const size_t vtxSize = hasColor ? (3 * sizeof(float) + 4 + 4) : (3 * sizeof(float) + 4);
+		vertexBuf = asset::ICPUBuffer::create({ vtxSize * vertexCount });
+		uint8_t* const vertexData = reinterpret_cast<uint8_t*>(vertexBuf->getPointer());
 
-		system::IFile::success_t success;
-		context.inner.mainFile->read(success, &vertexCount, context.fileOffset, sizeof(vertexCount));
-		if (!success)
-			return {};
-		context.fileOffset += sizeof(vertexCount);
+		// X is always flipped on the way in, right handed meshes flip it back
+		const float xSign = _params.loaderFlags & E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES ? 1.f : -1.f;
 
-		positions.reserve(3 * vertexCount);
-		normals.reserve(vertexCount);
-		colors.reserve(vertexCount);
+		// the quantization cache isn't thread-safe, so normals get quantized after the parallel part
+		core::vector<core::vectorSIMDf> normals(triangleCount);
+		constexpr uint32_t TrianglesPerBlock = 0x1u<<14u;
+		core::vector<uint32_t> blocks((triangleCount+TrianglesPerBlock-1u)/TrianglesPerBlock);
+		std::iota(blocks.begin(), blocks.end(), 0u);
+		core::for_each(core::execution::par, blocks.begin(), blocks.end(), [&](const uint32_t block) -> void
+			{
+				const uint32_t end = std::min(block*TrianglesPerBlock+TrianglesPerBlock, triangleCount);
+				for (uint32_t i = block*TrianglesPerBlock; i < end; ++i)
+				{
+					const uint8_t* const src = triangles+BinaryTriangleSize*i;
+					// normal followed by the 3 corners
+					float raw[12];
+					memcpy(raw, src, sizeof(raw));
+					const core::vectorSIMDf sign(xSign, 1.f, 1.f, 1.f);
+
+					core::vectorSIMDf p[3];
+					for (uint32_t j = 0u; j < 3u; ++j)
+						p[j] = core::vectorSIMDf(raw[3u*j+3u], raw[3u*j+4u], raw[3u*j+5u])*sign;
+
+					const core::vectorSIMDf n(raw[0], raw[1], raw[2]);
+					if ((n == core::vectorSIMDf()).all())
+						normals[i] = core::plane3dSIMDf(p[2], p[1], p[0]).getNormal();
+					else
+						normals[i] = core::normalize(n*sign);
+
+					uint32_t color = 0u;
+					if (hasColor)
+					{
+						uint16_t attrib;
+						memcpy(&attrib, src+BinaryAttribOffset, sizeof(attrib));
+						const void* srcColor[1]{ &attrib };
+						convertColor<EF_A1R5G5B5_UNORM_PACK16, EF_B8G8R8A8_UNORM>(srcColor, &color, 0u, 0u);
+					}
+
+					for (uint32_t j = 0u; j < 3u; ++j) // seems like in STL format vertices are ordered in clockwise manner...
+					{
+						uint8_t* ptr = vertexData + (3ull*i+j) * vtxSize;
+						memcpy(ptr, p[2u - j].pointer, 3 * 4);
+						if (hasColor)
+							memcpy(ptr + 16, &color, 4);
+					}
+				}
+			}
+		);
+
+		for (uint32_t i = 0u; i < triangleCount; ++i)
+		{
+			const quant_normal_t normal = quantNormalCache->quantize<EF_A2B10G10R10_SNORM_PACK32>(normals[i]);
+			for (uint32_t j = 0u; j < 3u; ++j)
+				*reinterpret_cast<quant_normal_t*>(vertexData + (3ull*i+j) * vtxSize + 12) = normal;
+		}
 	}
 	else
+	{
 		goNextLine(&context); // skip header
 
-	uint16_t attrib = 0u;
-	token.reserve(32);
-	while (context.fileOffset < filesize) // TODO: check it
-	{
-		if (!binary)
+		core::vector<core::vectorSIMDf> positions, normals;
+		token.reserve(32);
+		while (context.fileOffset < filesize) // TODO: check it
 		{
 			if (getNextToken(&context, token) != "facet")
 			{
@@ -199,97 +294,61 @@ SAssetBundle CSTLMeshFileLoader::loadAsset(system::IFile* _file, const IAssetLoa
 				return {};
 			}
 			if (getNextToken(&context, token) != "normal")
-			{
 				return {};
-			}
-		}
 
-		{
-			core::vectorSIMDf n;
-			getNextVector(&context, n, binary);
-			if(_params.loaderFlags & E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES)
-				performActionBasedOnOrientationSystem<float>(n.x, [](float& varToFlip) {varToFlip = -varToFlip;});
-			normals.push_back(core::normalize(n));
-		}
+			{
+				core::vectorSIMDf n;
+				getNextVector(&context, n, binary);
+				if(_params.loaderFlags & E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES)
+					performActionBasedOnOrientationSystem<float>(n.x, [](float& varToFlip) {varToFlip = -varToFlip;});
+				normals.push_back(core::normalize(n));
+			}
 
-		if (!binary)
-		{
 			if (getNextToken(&context, token) != "outer" || getNextToken(&context, token) != "loop")
 				return {};
-		}
 
-		{
-			core::vectorSIMDf p[3];
-			for (uint32_t i = 0u; i < 3u; ++i)
 			{
-				if (!binary)
+				core::vectorSIMDf p[3];
+				for (uint32_t i = 0u; i < 3u; ++i)
 				{
 					if (getNextToken(&context, token) != "vertex")
 						return {};
+					getNextVector(&context, p[i], binary);
+					if (_params.loaderFlags & E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES)
+						performActionBasedOnOrientationSystem<float>(p[i].x, [](float& varToFlip){varToFlip = -varToFlip; });
 				}
-				getNextVector(&context, p[i], binary);
-				if (_params.loaderFlags & E_LOADER_PARAMETER_FLAGS::ELPF_RIGHT_HANDED_MESHES)
-					performActionBasedOnOrientationSystem<float>(p[i].x, [](float& varToFlip){varToFlip = -varToFlip; });
+				for (uint32_t i = 0u; i < 3u; ++i) // seems like in STL format vertices are ordered in clockwise manner...
+					positions.push_back(p[2u - i]);
 			}
-			for (uint32_t i = 0u; i < 3u; ++i) // seems like in STL format vertices are ordered in clockwise manner...
-				positions.push_back(p[2u - i]);
-		}
 
-		if (!binary)
-		{
 			if (getNextToken(&context, token) != "endloop" || getNextToken(&context, token) != "endfacet")
 				return {};
-		}
-		else
-		{
-			system::IFile::success_t success;
-			context.inner.mainFile->read(success, &attrib, context.fileOffset, sizeof(attrib));
-			if (!success)
-				return {};
-			context.fileOffset += sizeof(attrib);
-		}
-
-		if (hasColor && (attrib & 0x8000u)) // assuming VisCam/SolidView non-standard trick to store color in 2 bytes of extra attribute
-		{
-			const void* srcColor[1]{ &attrib };
-			uint32_t color{};
-			convertColor<EF_A1R5G5B5_UNORM_PACK16, EF_B8G8R8A8_UNORM>(srcColor, &color, 0u, 0u);
-			colors.push_back(color);
-		}
-		else
-		{
-			hasColor = false;
-			colors.clear();
-		}
-
-		if ((normals.back() == core::vectorSIMDf()).all())
-		{
-			normals.back().set(
-				core::plane3dSIMDf(
-					*(positions.rbegin() + 2),
-					*(positions.rbegin() + 1),
-					*(positions.rbegin() + 0)).getNormal()
-			);
-		}
-	} // end while (_file->getPos() < filesize)
-
-	const size_t vtxSize = hasColor ? (3 * sizeof(float) + 4 + 4) : (3 * sizeof(float) + 4);
-	auto vertexBuf = asset::ICPUBuffer::create({ vtxSize * positions.size() });
 
-	using quant_normal_t = CQuantNormalCache::value_type_t<EF_A2B10G10R10_SNORM_PACK32>;
+			if ((normals.back() == core::vectorSIMDf()).all())
+			{
+				normals.back().set(
+					core::plane3dSIMDf(
+						*(positions.rbegin() + 2),
+						*(positions.rbegin() + 1),
+						*(positions.rbegin() + 0)).getNormal()
+				);
+			}
+		} // end while (_file->getPos() < filesize)
 
-	quant_normal_t normal;
-	for (size_t i = 0u; i < positions.size(); ++i)
-	{
-		if (i % 3 == 0)
-			normal = quantNormalCache->quantize<EF_A2B10G10R10_SNORM_PACK32>(normals[i / 3]);
-		uint8_t* ptr = (reinterpret_cast<uint8_t*>(vertexBuf->getPointer())) + i * vtxSize;
-		memcpy(ptr, positions[i].pointer, 3 * 4);
+		vertexCount = positions.size();
+		const size_t vtxSize = 3 * sizeof(float) + 4;
+		vertexBuf = asset::ICPUBuffer::create({ vtxSize * vertexCount });
 
-		*reinterpret_cast<quant_normal_t*>(ptr + 12) = normal;
+		quant_normal_t normal;
+		for (size_t i = 0u; i < positions.size(); ++i)
+		{
+			if (i % 3 == 0)
+				normal = quantNormalCache->quantize<EF_A2B10G10R10_SNORM_PACK32>(normals[i / 3]);
+			uint8_t* ptr = (reinterpret_cast<uint8_t*>(vertexBuf->getPointer())) + i * vtxSize;
+			memcpy(ptr, positions[i].pointer, 3 * 4);
 
-		if (hasColor)
-			memcpy(ptr + 16, colors.data() + i / 3, 4);
+			*reinterpret_cast<quant_normal_t*>(ptr + 12) = normal;
+		}
 	}
 
 	const IAssetLoader::SAssetLoadContext fakeContext(IAssetLoader::SAssetLoadParams{}, nullptr);
@@ -306,7 +365,7 @@ SAssetBundle CSTLMeshFileLoader::loadAsset(system::IFile* _file, const IAssetLoa
 	meta->placeMeta(0u, mbPipeline.get());
 
 	meshbuffer->setPipeline(std::move(mbPipeline));
-	meshbuffer->setIndexCount(positions.size());
+	meshbuffer->setIndexCount(vertexCount);
 	meshbuffer->setIndexType(asset::EIT_UNKNOWN);
 
 	meshbuffer->setVertexBufferBinding({ 0ul, vertexBuf }, 0);
@@ -348,6 +407,27 @@ bool CSTLMeshFileLoader::isALoadableFileFormat(system::IFile* _file, const syste
 	}
 }
 
+bool CSTLMeshFileLoader::isALoadableFileFormat(const std::span<const uint8_t> _header, system::IFile* _file, const system::logger_opt_ptr logger) const
+{
+	if (!_file || _header.size() <= 6u)
+		return false;
+
+	if (strncmp(reinterpret_cast<const char*>(_header.data()), "solid ", 6u) == 0)
+		return true;
+	else
+	{
+		// the header holds at least 84 bytes whenever the file does
+		if (_header.size() < 84u)
+			return false;
+
+		uint32_t triangleCount;
+		memcpy(&triangleCount, _header.data() + 80u, sizeof(triangleCount));
+
+		constexpr size_t STL_TRI_SZ = 50u;
+		return _file->getSize() == (STL_TRI_SZ * triangleCount + 84u);
+	}
+}
+
 //! Read 3d vector of floats
 void CSTLMeshFileLoader::getNextVector(SContext* context, core::vectorSIMDf& vec, bool binary) const
 {
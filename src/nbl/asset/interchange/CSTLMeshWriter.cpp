@@ -6,6 +6,7 @@
 #include "nbl/system/IFile.h"
 
 #include "CSTLMeshWriter.h"
+#include "SChunkedTextWriter.h"
 #include "SColor.h"
 
 using namespace nbl;
@@ -63,412 +64,191 @@ bool CSTLMeshWriter::writeAsset(system::IFile* _file, const SAssetWriteParams& _
 
 namespace
 {
-template <class I>
-inline void writeFacesBinary(const asset::ICPUMeshBuffer* buffer, const bool& noIndices, system::IFile* file, uint32_t _colorVaid, IAssetWriter::SAssetWriteContext* context, size_t* fileOffset)
-{
-	auto& inputParams = buffer->getPipeline()->getCachedCreationParams().vertexInput;
-	bool hasColor = inputParams.enabledAttribFlags & core::createBitmask({ COLOR_ATTRIBUTE });
-    const asset::E_FORMAT colorType = static_cast<asset::E_FORMAT>(hasColor ? inputParams.attributes[COLOR_ATTRIBUTE].format : asset::EF_UNKNOWN);
-
-    const uint32_t indexCount = buffer->getIndexCount();
-    for (uint32_t j = 0u; j < indexCount; j += 3u)
-    {
-        I idx[3];
-        for (uint32_t i = 0u; i < 3u; ++i)
-        {
-            if (noIndices)
-                idx[i] = j + i;
-            else
-                idx[i] = ((I*)buffer->getIndices())[j + i];
-        }
-
-        core::vectorSIMDf v[3];
-        for (uint32_t i = 0u; i < 3u; ++i)
-            v[i] = buffer->getPosition(idx[i]);
-
-        uint16_t color = 0u;
-        if (hasColor)
-        {
-            if (asset::isIntegerFormat(colorType))
-            {
-                uint32_t res[4];
-                for (uint32_t i = 0u; i < 3u; ++i)
-                {
-                    uint32_t d[4];
-                    buffer->getAttribute(d, _colorVaid, idx[i]);
-                    res[0] += d[0]; res[1] += d[1]; res[2] += d[2];
-                }
-                color = video::RGB16(res[0]/3, res[1]/3, res[2]/3);
-            }
-            else
-            {
-                core::vectorSIMDf res;
-                for (uint32_t i = 0u; i < 3u; ++i)
-                {
-                    core::vectorSIMDf d;
-                    buffer->getAttribute(d, _colorVaid, idx[i]);
-                    res += d;
-                }
-                res /= 3.f;
-                color = video::RGB16(res.X, res.Y, res.Z);
-            }
-        }
-
-		core::vectorSIMDf normal = core::plane3dSIMDf(v[0], v[1], v[2]).getNormal();
-		core::vectorSIMDf vertex1 = v[2];
-		core::vectorSIMDf vertex2 = v[1];
-		core::vectorSIMDf vertex3 = v[0];
-
-		auto flipVectors = [&]()
-		{
-			vertex1.X = -vertex1.X;
-			vertex2.X = -vertex2.X;
-			vertex3.X = -vertex3.X;
-			normal = core::plane3dSIMDf(vertex1, vertex2, vertex3).getNormal();
-		};
-
-		if (!(context->params.flags & E_WRITER_FLAGS::EWF_MESH_IS_RIGHT_HANDED))
-			flipVectors();
-
-		{
-			system::IFile::success_t success;;
-			file->write(success, &normal, *fileOffset, 12);
-	
-			*fileOffset += success.getBytesProcessed();
-		}
-
-		{
-			system::IFile::success_t success;;
-			file->write(success, &vertex1, *fileOffset, 12);
-	
-			*fileOffset += success.getBytesProcessed();
-		}
-
-		{
-			system::IFile::success_t success;;
-			file->write(success, &vertex2, *fileOffset, 12);
-	
-			*fileOffset += success.getBytesProcessed();
-		}
-
-		{
-			system::IFile::success_t success;;
-			file->write(success, &vertex3, *fileOffset, 12);
-	
-			*fileOffset += success.getBytesProcessed();
-		}
-
-		{
-			system::IFile::success_t success;;
-			file->write(success, &color, *fileOffset, 2); // saving color using non-standard VisCAM/SolidView trick
-	
-			*fileOffset += success.getBytesProcessed();
-		}
-    }
-}
-}
+// binary STL is an 80 byte header, a triangle count and then 50 byte triangles
+constexpr size_t BinaryHeaderSize = 80u;
+constexpr size_t BinaryTriangleSize = 50u;
+constexpr size_t FacesPerBlock = 0x1u<<15u;
 
-bool CSTLMeshWriter::writeMeshBinary(const asset::ICPUMesh* mesh, SContext* context)
+// reverses the winding and handedness the same way for both formats
+inline void getFace(const asset::ICPUMeshBuffer* buffer, const uint32_t idx[3], const bool flip, core::vectorSIMDf& normal, core::vectorSIMDf vertices[3])
 {
-	// write STL MESH header
-    const char headerTxt[] = "Irrlicht-baw Engine";
-    constexpr size_t HEADER_SIZE = 80u;
-
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, headerTxt, context->fileOffset, sizeof(headerTxt));
-
-		context->fileOffset += success.getBytesProcessed();
-	}
-
-	const std::string name = context->writeContext.outputFile->getFileName().filename().replace_extension().string(); // TODO: check it
-	const int32_t sizeleft = HEADER_SIZE - sizeof(headerTxt) - name.size();
-
-	if (sizeleft < 0)
+	for (uint32_t i = 0u; i < 3u; ++i)
 	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, name.c_str(), context->fileOffset, HEADER_SIZE - sizeof(headerTxt));
-
-		context->fileOffset += success.getBytesProcessed();
+		vertices[i] = buffer->getPosition(idx[2u - i]);
+		if (flip)
+			vertices[i].X = -vertices[i].X;
 	}
-	else
-	{
-		const char buf[80] = {0};
-
-		{
-			system::IFile::success_t success;;
-			context->writeContext.outputFile->write(success, name.c_str(), context->fileOffset, name.size());
-	
-			context->fileOffset += success.getBytesProcessed();
-		}
-
-		{
-			system::IFile::success_t success;;
-			context->writeContext.outputFile->write(success, buf, context->fileOffset, sizeleft);
-	
-			context->fileOffset += success.getBytesProcessed();
-		}
-	}
-
-	uint32_t facenum = 0;
-	for (auto& mb : mesh->getMeshBuffers())
-		facenum += mb->getIndexCount()/3;
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, &facenum, context->fileOffset, sizeof(facenum));
-
-		context->fileOffset += success.getBytesProcessed();
-	}
-	// write mesh buffers
+	normal = core::plane3dSIMDf(vertices[0], vertices[1], vertices[2]).getNormal();
+}
 
-	for (auto& buffer : mesh->getMeshBuffers())
-	if (buffer)
+inline void getFaceIndices(const asset::ICPUMeshBuffer* buffer, const asset::E_INDEX_TYPE type, const uint32_t face, uint32_t idx[3])
+{
+	for (uint32_t i = 0u; i < 3u; ++i)
 	{
-        asset::E_INDEX_TYPE type = buffer->getIndexType();
-		if (!buffer->getIndexBufferBinding().buffer)
-            type = asset::EIT_UNKNOWN;
-
-		if (type== asset::EIT_16BIT)
-            writeFacesBinary<uint16_t>(buffer, false, context->writeContext.outputFile, COLOR_ATTRIBUTE, &context->writeContext, &context->fileOffset);
-		else if (type== asset::EIT_32BIT)
-            writeFacesBinary<uint32_t>(buffer, false, context->writeContext.outputFile, COLOR_ATTRIBUTE, &context->writeContext, &context->fileOffset);
+		const uint32_t j = 3u * face + i;
+		if (type == asset::EIT_16BIT)
+			idx[i] = reinterpret_cast<const uint16_t*>(buffer->getIndices())[j];
+		else if (type == asset::EIT_32BIT)
+			idx[i] = reinterpret_cast<const uint32_t*>(buffer->getIndices())[j];
 		else
-            writeFacesBinary<uint16_t>(buffer, true, context->writeContext.outputFile, COLOR_ATTRIBUTE, &context->writeContext, &context->fileOffset); //template param doesn't matter if there's no indices
+			idx[i] = j;
 	}
-	return true;
 }
 
-bool CSTLMeshWriter::writeMeshASCII(const asset::ICPUMesh* mesh, SContext* context)
+inline asset::E_INDEX_TYPE getIndexType(const asset::ICPUMeshBuffer* buffer)
 {
-	// write STL MESH header
-    const char headerTxt[] = "Irrlicht-baw Engine ";
-
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, "solid ", context->fileOffset, 6);
-
-		context->fileOffset += success.getBytesProcessed();
-	}
-
-
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, headerTxt, context->fileOffset, sizeof(headerTxt) - 1);
-
-		context->fileOffset += success.getBytesProcessed();
-	}
-
-	const std::string name = context->writeContext.outputFile->getFileName().filename().replace_extension().string();
-
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, name.c_str(), context->fileOffset, name.size());
-
-		context->fileOffset += success.getBytesProcessed();
-	}
-
+	return buffer->getIndexBufferBinding().buffer ? buffer->getIndexType() : asset::EIT_UNKNOWN;
+}
 
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, "\n", context->fileOffset, 1);
+inline void writeFaceBinary(const asset::ICPUMeshBuffer* buffer, const asset::E_INDEX_TYPE type, const uint32_t face, const bool flip, uint8_t* dst)
+{
+	auto& inputParams = buffer->getPipeline()->getCachedCreationParams().vertexInput;
+	const bool hasColor = inputParams.enabledAttribFlags & core::createBitmask({ COLOR_ATTRIBUTE });
+	const asset::E_FORMAT colorType = static_cast<asset::E_FORMAT>(hasColor ? inputParams.attributes[COLOR_ATTRIBUTE].format : asset::EF_UNKNOWN);
 
-		context->fileOffset += success.getBytesProcessed();
-	}
+	uint32_t idx[3];
+	getFaceIndices(buffer, type, face, idx);
 
-	// write mesh buffers
-	for (auto& buffer : mesh->getMeshBuffers())
-	if (buffer)
+	uint16_t color = 0u;
+	if (hasColor)
 	{
-        asset::E_INDEX_TYPE type = buffer->getIndexType();
-		if (!buffer->getIndexBufferBinding().buffer)
-            type = asset::EIT_UNKNOWN;
-		const uint32_t indexCount = buffer->getIndexCount();
-		if (type==asset::EIT_16BIT)
+		if (asset::isIntegerFormat(colorType))
 		{
-            //os::Printer::log("Writing mesh with 16bit indices");
-            for (uint32_t j=0; j<indexCount; j+=3)
-            {
-                writeFaceText(
-                    buffer->getPosition(((uint16_t*)buffer->getIndices())[j]),
-                    buffer->getPosition(((uint16_t*)buffer->getIndices())[j+1]),
-                    buffer->getPosition(((uint16_t*)buffer->getIndices())[j+2]),
-					context
-                );
-            }
-		}
-		else if (type==asset::EIT_32BIT)
-		{
-            //os::Printer::log("Writing mesh with 32bit indices");
-            for (uint32_t j=0; j<indexCount; j+=3)
-            {
-                writeFaceText(
-                    buffer->getPosition(((uint32_t*)buffer->getIndices())[j]),
-                    buffer->getPosition(((uint32_t*)buffer->getIndices())[j+1]),
-                    buffer->getPosition(((uint32_t*)buffer->getIndices())[j+2]),
-					context
-                );
-            }
+			uint32_t res[4] = {};
+			for (uint32_t i = 0u; i < 3u; ++i)
+			{
+				uint32_t d[4];
+				buffer->getAttribute(d, COLOR_ATTRIBUTE, idx[i]);
+				res[0] += d[0]; res[1] += d[1]; res[2] += d[2];
+			}
+			color = video::RGB16(res[0]/3, res[1]/3, res[2]/3);
 		}
 		else
-        {
-            //os::Printer::log("Writing mesh with no indices");
-            for (uint32_t j=0; j<indexCount; j+=3)
-            {
-                writeFaceText(
-                    buffer->getPosition(j),
-                    buffer->getPosition(j+1ul),
-                    buffer->getPosition(j+2ul),
-					context
-                );
-            }
-        }
-
 		{
-			system::IFile::success_t success;;
-			context->writeContext.outputFile->write(success, "\n", context->fileOffset, 1);
-	
-			context->fileOffset += success.getBytesProcessed();
+			core::vectorSIMDf res;
+			for (uint32_t i = 0u; i < 3u; ++i)
+			{
+				core::vectorSIMDf d;
+				buffer->getAttribute(d, COLOR_ATTRIBUTE, idx[i]);
+				res += d;
+			}
+			res /= 3.f;
+			color = video::RGB16(res.X, res.Y, res.Z);
 		}
 	}
 
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, "endsolid ", context->fileOffset, 9);
-
-		context->fileOffset += success.getBytesProcessed();
-	}
-
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, headerTxt, context->fileOffset, sizeof(headerTxt) - 1);
+	core::vectorSIMDf normal, vertices[3];
+	getFace(buffer, idx, flip, normal, vertices);
 
-		context->fileOffset += success.getBytesProcessed();
-	}
-
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, name.c_str(), context->fileOffset, name.size());
-
-		context->fileOffset += success.getBytesProcessed();
-	}
-
-	return true;
+	memcpy(dst, normal.pointer, 12);
+	for (uint32_t i = 0u; i < 3u; ++i)
+		memcpy(dst + 12u * (i + 1u), vertices[i].pointer, 12);
+	memcpy(dst + 48, &color, 2); // saving color using non-standard VisCAM/SolidView trick
 }
 
-void CSTLMeshWriter::getVectorAsStringLine(const core::vectorSIMDf& v, std::string& s) const
+inline void appendVectorLine(std::string& out, const core::vectorSIMDf& v)
 {
-    std::ostringstream tmp;
-    tmp << v.X << " " << v.Y << " " << v.Z << "\n";
-    s = std::string(tmp.str().c_str());
-}
-
-void CSTLMeshWriter::writeFaceText(
-		const core::vectorSIMDf& v1,
-		const core::vectorSIMDf& v2,
-		const core::vectorSIMDf& v3,
-		SContext* context)
-{
-	core::vectorSIMDf vertex1 = v3;
-	core::vectorSIMDf vertex2 = v2;
-	core::vectorSIMDf vertex3 = v1;
-	core::vectorSIMDf normal = core::plane3dSIMDf(vertex1, vertex2, vertex3).getNormal();
-	std::string tmp;
-
-	auto flipVectors = [&]()
+	for (uint32_t i = 0u; i < 3u; ++i)
 	{
-		vertex1.X = -vertex1.X;
-		vertex2.X = -vertex2.X;
-		vertex3.X = -vertex3.X;
-		normal = core::plane3dSIMDf(vertex1, vertex2, vertex3).getNormal();
-	};
-	
-	if (!(context->writeContext.params.flags & E_WRITER_FLAGS::EWF_MESH_IS_RIGHT_HANDED))
-		flipVectors();
-	
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, "facet normal ", context->fileOffset, 13);
-
-		context->fileOffset += success.getBytesProcessed();
+		SChunkedTextWriter::append(out, v[i]);
+		out += i < 2u ? ' ' : '\n';
 	}
+}
 
-	getVectorAsStringLine(normal, tmp);
-
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, tmp.c_str(), context->fileOffset, tmp.size());
-
-		context->fileOffset += success.getBytesProcessed();
-	}
-
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, "  outer loop\n", context->fileOffset, 13);
-
-		context->fileOffset += success.getBytesProcessed();
-	}
-
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, "    vertex ", context->fileOffset, 11);
-
-		context->fileOffset += success.getBytesProcessed();
-	}
+inline void writeFaceText(const asset::ICPUMeshBuffer* buffer, const asset::E_INDEX_TYPE type, const uint32_t face, const bool flip, std::string& out)
+{
+	uint32_t idx[3];
+	getFaceIndices(buffer, type, face, idx);
 
-	getVectorAsStringLine(vertex1, tmp);
+	core::vectorSIMDf normal, vertices[3];
+	getFace(buffer, idx, flip, normal, vertices);
 
+	out += "facet normal ";
+	appendVectorLine(out, normal);
+	out += "  outer loop\n";
+	for (uint32_t i = 0u; i < 3u; ++i)
 	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, tmp.c_str(), context->fileOffset, tmp.size());
-
-		context->fileOffset += success.getBytesProcessed();
+		out += "    vertex ";
+		appendVectorLine(out, vertices[i]);
 	}
+	out += "  endloop\n";
+	out += "endfacet\n";
+}
+}
 
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, "    vertex ", context->fileOffset, 11);
-
-		context->fileOffset += success.getBytesProcessed();
-	}
+bool CSTLMeshWriter::writeMeshBinary(const asset::ICPUMesh* mesh, SContext* context)
+{
+	const bool flip = !(context->writeContext.params.flags & E_WRITER_FLAGS::EWF_MESH_IS_RIGHT_HANDED);
 
-	getVectorAsStringLine(vertex2, tmp);
+	uint32_t facenum = 0;
+	for (auto& mb : mesh->getMeshBuffers())
+		facenum += mb->getIndexCount()/3;
 
+	// the size is known upfront, so the whole file gets encoded in memory and written with a single write
+	core::vector<uint8_t> output(BinaryHeaderSize + sizeof(facenum) + BinaryTriangleSize * facenum, 0u);
 	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, tmp.c_str(), context->fileOffset, tmp.size());
+		// write STL MESH header
+		const char headerTxt[] = "Irrlicht-baw Engine";
+		memcpy(output.data(), headerTxt, sizeof(headerTxt));
 
-		context->fileOffset += success.getBytesProcessed();
+		const std::string name = context->writeContext.outputFile->getFileName().filename().replace_extension().string(); // TODO: check it
+		memcpy(output.data() + sizeof(headerTxt), name.data(), std::min(name.size(), BinaryHeaderSize - sizeof(headerTxt)));
 	}
+	memcpy(output.data() + BinaryHeaderSize, &facenum, sizeof(facenum));
 
+	// write mesh buffers
+	uint8_t* triangles = output.data() + BinaryHeaderSize + sizeof(facenum);
+	for (auto& buffer : mesh->getMeshBuffers())
+	if (buffer)
 	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, "    vertex ", context->fileOffset, 11);
-
-		context->fileOffset += success.getBytesProcessed();
-	}
-
-	getVectorAsStringLine(vertex3, tmp);
+		const asset::E_INDEX_TYPE type = getIndexType(buffer);
+		const uint32_t faceCount = buffer->getIndexCount()/3;
+
+		core::vector<uint32_t> blocks((faceCount + FacesPerBlock - 1u) / FacesPerBlock);
+		std::iota(blocks.begin(), blocks.end(), 0u);
+		core::for_each(core::execution::par, blocks.begin(), blocks.end(), [&](const uint32_t block) -> void
+			{
+				const uint32_t first = block * FacesPerBlock;
+				for (uint32_t face = first; face < std::min<uint32_t>(first + FacesPerBlock, faceCount); ++face)
+					writeFaceBinary(buffer, type, face, flip, triangles + BinaryTriangleSize * face);
+			}
+		);
+		triangles += BinaryTriangleSize * faceCount;
+	}
+
+	system::IFile::success_t success;
+	context->writeContext.outputFile->write(success, output.data(), context->fileOffset, output.size());
+	context->fileOffset += success.getBytesProcessed();
+	return bool(success);
+}
 
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, tmp.c_str(), context->fileOffset, tmp.size());
+bool CSTLMeshWriter::writeMeshASCII(const asset::ICPUMesh* mesh, SContext* context)
+{
+	const bool flip = !(context->writeContext.params.flags & E_WRITER_FLAGS::EWF_MESH_IS_RIGHT_HANDED);
+	auto* const file = context->writeContext.outputFile;
 
-		context->fileOffset += success.getBytesProcessed();
-	}
+	// write STL MESH header
+	const std::string headerTxt = "Irrlicht-baw Engine ";
+	const std::string name = file->getFileName().filename().replace_extension().string();
+	if (!SChunkedTextWriter::write(file, context->fileOffset, "solid " + headerTxt + name + "\n"))
+		return false;
 
+	// write mesh buffers
+	for (auto& buffer : mesh->getMeshBuffers())
+	if (buffer)
 	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, "  endloop\n", context->fileOffset, 10);
-
-		context->fileOffset += success.getBytesProcessed();
+		const asset::E_INDEX_TYPE type = getIndexType(buffer);
+		const bool facesWritten = SChunkedTextWriter::write(file, context->fileOffset, buffer->getIndexCount()/3, [&](std::string& out, const size_t first, const size_t last) -> void
+			{
+				for (size_t face = first; face < last; ++face)
+					writeFaceText(buffer, type, face, flip, out);
+			}
+		);
+		if (!facesWritten || !SChunkedTextWriter::write(file, context->fileOffset, "\n"))
+			return false;
 	}
 
-	{
-		system::IFile::success_t success;;
-		context->writeContext.outputFile->write(success, "endfacet\n", context->fileOffset, 9);
-
-		context->fileOffset += success.getBytesProcessed();
-	}
+	return SChunkedTextWriter::write(file, context->fileOffset, "endsolid " + headerTxt + name);
 }
 
 #endif
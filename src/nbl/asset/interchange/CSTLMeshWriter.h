@@ -50,13 +50,6 @@ class CSTLMeshWriter : public asset::IAssetWriter
 
         // write text format
         bool writeMeshASCII(const asset::ICPUMesh* mesh, SContext* context);
-
-        // create vector output with line end into string
-        void getVectorAsStringLine(const core::vectorSIMDf& v, std::string& s) const;
-
-        // write face information to file
-        void writeFaceText(const core::vectorSIMDf& v1,
-            const core::vectorSIMDf& v2, const core::vectorSIMDf& v3, SContext* context);
 };
 
 } // end namespace
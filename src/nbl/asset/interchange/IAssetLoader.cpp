@@ -6,6 +6,8 @@
 
 #include "nbl/asset/IAssetManager.h"
 
+#include <thread>
+
 using namespace nbl;
 using namespace asset;
 
@@ -45,6 +47,48 @@ SAssetBundle IAssetLoader::interm_getAssetInHierarchy(IAssetManager* _mgr, const
     return _mgr->getAssetInHierarchy(_filename, _params, _hierarchyLevel, _override);
 }
 
+void IAssetLoader::interm_getAssetsInHierarchyAsync(IAssetManager* _mgr, std::span<system::ISystem::future_t<SAssetBundle>> _bundles, std::span<const std::string> _filenames, const IAssetLoader::SAssetLoadParams& _params, uint32_t _hierarchyLevel, IAssetLoader::IAssetLoaderOverride* _override)
+{
+    _mgr->getAssetsInHierarchyAsync(_bundles, _filenames, _params, _hierarchyLevel, _override);
+}
+
+SAssetBundle IAssetLoader::interm_waitForAssetInHierarchy(IAssetManager* _mgr, system::ISystem::future_t<SAssetBundle>& _bundle, const std::string& _filename, const IAssetLoader::SAssetLoadParams& _params, uint32_t _hierarchyLevel, IAssetLoader::IAssetLoaderOverride* _override)
+{
+    return _mgr->waitForAssetInHierarchy(_bundle, _filename, _params, _hierarchyLevel, _override);
+}
+
+core::vector<SAssetBundle> IAssetLoader::interm_getAssetsInHierarchy(IAssetManager* _mgr, std::span<const SSubAssetLoad> _loads, const IAssetLoader::SAssetLoadParams& _params, IAssetLoader::IAssetLoaderOverride* _override)
+{
+    core::vector<SAssetBundle> retval(_loads.size());
+    // a default of a few per hardware thread keeps the workers busy without flooding their queues
+    const size_t window = _params.maxSubAssetLoadConcurrency ? _params.maxSubAssetLoadConcurrency : size_t(std::max(std::thread::hardware_concurrency(), 1u)) * 4ull;
+    if (window < 2ull || _loads.size() < 2ull)
+    {
+        for (size_t i = 0ull; i < _loads.size(); i++)
+            retval[i] = interm_getAssetInHierarchy(_mgr, _loads[i].filename, _params, _loads[i].hierarchyLevel, _override);
+        return retval;
+    }
+
+    // keep `window` loads in flight, starting the next one whenever we're done waiting for the oldest
+    core::vector<system::ISystem::future_t<SAssetBundle>> pending(_loads.size());
+    size_t started = 0ull;
+    auto startNext = [&]() -> void
+    {
+        const auto& load = _loads[started];
+        _mgr->getAssetsInHierarchyAsync({&pending[started],1}, {&load.filename,1}, _params, load.hierarchyLevel, _override);
+        started++;
+    };
+    while (started < std::min(window, _loads.size()))
+        startNext();
+    for (size_t i = 0ull; i < _loads.size(); i++)
+    {
+        retval[i] = _mgr->waitForAssetInHierarchy(pending[i], _loads[i].filename, _params, _loads[i].hierarchyLevel, _override);
+        if (started < _loads.size())
+            startNext();
+    }
+    return retval;
+}
+
 SAssetBundle IAssetLoader::interm_getAssetInHierarchyWithAllContent(IAssetManager* _mgr, const std::string& _filename, const IAssetLoader::SAssetLoadParams& _params, uint32_t _hierarchyLevel, IAssetLoader::IAssetLoaderOverride* _override)
 {
 	auto firstLoad = interm_getAssetInHierarchy(_mgr,_filename,_params,_hierarchyLevel,_override);
@@ -0,0 +1,80 @@
+#ifndef _NBL_ASSET_S_CHUNKED_TEXT_WRITER_H_INCLUDED_
+#define _NBL_ASSET_S_CHUNKED_TEXT_WRITER_H_INCLUDED_
+
+#include "nbl/core/execution.h"
+#include "nbl/system/IFile.h"
+
+#include <charconv>
+#include <numeric>
+#include <thread>
+
+namespace nbl::asset
+{
+
+//! Shared by the text mesh writers, formats items in parallel blocks and writes them out with one large write per wave of blocks
+/*
+	Only a wave of blocks is held in memory at once, so exporting huge meshes doesn't need the whole file's text up front.
+*/
+struct SChunkedTextWriter
+{
+	static inline constexpr size_t ItemsPerBlock = 0x1ull<<15ull;
+
+	//! `format(std::string& out, const size_t first, const size_t last)` appends the text of items `[first,last)`, returns false if a write failed
+	template<typename F>
+	static inline bool write(system::IFile* file, size_t& fileOffset, const size_t itemCount, F&& format)
+	{
+		const size_t blockCount = (itemCount+ItemsPerBlock-1ull)/ItemsPerBlock;
+		const size_t waveSize = std::min<size_t>(std::max(std::thread::hardware_concurrency(),1u)*4ull,blockCount);
+
+		core::vector<std::string> texts(waveSize);
+		core::vector<size_t> blocks(waveSize);
+		std::string joined;
+		for (size_t firstBlock=0ull; firstBlock<blockCount; firstBlock+=waveSize)
+		{
+			blocks.resize(std::min(waveSize,blockCount-firstBlock));
+			std::iota(blocks.begin(),blocks.end(),firstBlock);
+			core::for_each(core::execution::par,blocks.begin(),blocks.end(),[&](const size_t block) -> void
+				{
+					auto& text = texts[block-firstBlock];
+					text.clear();
+					format(text,block*ItemsPerBlock,std::min(block*ItemsPerBlock+ItemsPerBlock,itemCount));
+				}
+			);
+
+			joined.clear();
+			for (size_t i=0ull; i<blocks.size(); i++)
+				joined += texts[i];
+			if (!write(file,fileOffset,joined))
+				return false;
+		}
+		return true;
+	}
+
+	static inline bool write(system::IFile* file, size_t& fileOffset, const std::string_view text)
+	{
+		if (text.empty())
+			return true;
+		system::IFile::success_t success;
+		file->write(success,text.data(),fileOffset,text.size());
+		fileOffset += success.getBytesProcessed();
+		return bool(success);
+	}
+
+	//! `std::to_chars` into the end of `out`, floats get formatted with `fmt` and `precision` like printf's `%f` or `%g` would
+	template<typename T>
+	static inline void append(std::string& out, const T value, const std::chars_format fmt=std::chars_format::general, const int precision=6)
+	{
+		// enough for any `%f` formatted float
+		char tmp[64];
+		std::to_chars_result result;
+		if constexpr (std::is_floating_point_v<T>)
+			result = std::to_chars(tmp,tmp+sizeof(tmp),value,fmt,precision);
+		else
+			result = std::to_chars(tmp,tmp+sizeof(tmp),value);
+		out.append(tmp,result.ptr);
+	}
+};
+
+}
+
+#endif
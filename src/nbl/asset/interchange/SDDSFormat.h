@@ -0,0 +1,270 @@
+#ifndef _NBL_ASSET_S_DDS_FORMAT_H_INCLUDED_
+#define _NBL_ASSET_S_DDS_FORMAT_H_INCLUDED_
+
+#include "nbl/asset/ICPUImageView.h"
+
+namespace nbl::asset
+{
+
+//! Header of DirectDraw Surface files, optionally extended by a DX10 header holding a DXGI format, all little endian
+/*
+	After the headers come the array elements (every face of every cube for cubemaps) one after another,
+	each holding its whole mip chain largest first. Rows, slices and mips are tightly packed.
+*/
+struct SDDSFormat
+{
+	static inline constexpr uint8_t Magic[4] = { 'D','D','S',' ' };
+
+	struct SPixelFormat
+	{
+		uint32_t size;
+		uint32_t flags;
+		uint32_t fourCC;
+		uint32_t rgbBitCount;
+		uint32_t rBitMask;
+		uint32_t gBitMask;
+		uint32_t bBitMask;
+		uint32_t aBitMask;
+	};
+	//! follows the magic
+	struct SHeader
+	{
+		uint32_t size;
+		uint32_t flags;
+		uint32_t height;
+		uint32_t width;
+		uint32_t pitchOrLinearSize;
+		uint32_t depth;
+		uint32_t mipMapCount;
+		uint32_t reserved1[11];
+		SPixelFormat pixelFormat;
+		uint32_t caps;
+		uint32_t caps2;
+		uint32_t caps3;
+		uint32_t caps4;
+		uint32_t reserved2;
+	};
+	static_assert(sizeof(SHeader)==124u);
+	//! follows `SHeader` when its pixel format's FourCC is "DX10"
+	struct SHeaderDXT10
+	{
+		uint32_t dxgiFormat;
+		uint32_t resourceDimension;
+		uint32_t miscFlag;
+		uint32_t arraySize;
+		uint32_t miscFlags2;
+	};
+	static_assert(sizeof(SHeaderDXT10)==20u);
+
+	enum E_HEADER_FLAGS : uint32_t
+	{
+		EHF_MIPMAPCOUNT = 0x20000u,
+		EHF_DEPTH = 0x800000u
+	};
+	enum E_PIXEL_FORMAT_FLAGS : uint32_t
+	{
+		EPFF_ALPHAPIXELS = 0x1u,
+		EPFF_ALPHA = 0x2u,
+		EPFF_FOURCC = 0x4u,
+		EPFF_RGB = 0x40u,
+		EPFF_LUMINANCE = 0x20000u,
+		EPFF_BUMPDUDV = 0x80000u
+	};
+	enum E_CAPS2 : uint32_t
+	{
+		EC2_CUBEMAP = 0x200u,
+		EC2_CUBEMAP_ALLFACES = 0xFC00u,
+		EC2_VOLUME = 0x200000u
+	};
+	enum E_RESOURCE_DIMENSION : uint32_t
+	{
+		ERD_TEXTURE1D = 2u,
+		ERD_TEXTURE2D = 3u,
+		ERD_TEXTURE3D = 4u
+	};
+	//! in `SHeaderDXT10::miscFlag`, `arraySize` then counts cubes and not faces
+	static inline constexpr uint32_t MiscTextureCube = 0x4u;
+
+	static inline constexpr uint32_t makeFourCC(const char a, const char b, const char c, const char d)
+	{
+		return uint32_t(uint8_t(a))|(uint32_t(uint8_t(b))<<8u)|(uint32_t(uint8_t(c))<<16u)|(uint32_t(uint8_t(d))<<24u);
+	}
+
+	using format_t = std::pair<E_FORMAT,ICPUImageView::SComponentMapping>;
+
+	//! Formats without an `E_FORMAT` equivalent (e.g. X8 padded ones) are emulated with a swizzle, `EF_UNKNOWN` for the rest
+	static inline format_t getFormat(const uint32_t dxgiFormat)
+	{
+		using mapping_t = ICPUImageView::SComponentMapping;
+		constexpr mapping_t Identity = {};
+		constexpr mapping_t NoAlpha = {mapping_t::ES_R,mapping_t::ES_G,mapping_t::ES_B,mapping_t::ES_ONE};
+		constexpr mapping_t AlphaOnly = {mapping_t::ES_ZERO,mapping_t::ES_ZERO,mapping_t::ES_ZERO,mapping_t::ES_R};
+		switch (dxgiFormat)
+		{
+			case 2u: return {EF_R32G32B32A32_SFLOAT,Identity};
+			case 3u: return {EF_R32G32B32A32_UINT,Identity};
+			case 4u: return {EF_R32G32B32A32_SINT,Identity};
+			case 6u: return {EF_R32G32B32_SFLOAT,Identity};
+			case 7u: return {EF_R32G32B32_UINT,Identity};
+			case 8u: return {EF_R32G32B32_SINT,Identity};
+			case 10u: return {EF_R16G16B16A16_SFLOAT,Identity};
+			case 11u: return {EF_R16G16B16A16_UNORM,Identity};
+			case 12u: return {EF_R16G16B16A16_UINT,Identity};
+			case 13u: return {EF_R16G16B16A16_SNORM,Identity};
+			case 14u: return {EF_R16G16B16A16_SINT,Identity};
+			case 16u: return {EF_R32G32_SFLOAT,Identity};
+			case 17u: return {EF_R32G32_UINT,Identity};
+			case 18u: return {EF_R32G32_SINT,Identity};
+			// DXGI names channels from the least significant bit, Vulkan's packed formats from the most
+			case 24u: return {EF_A2B10G10R10_UNORM_PACK32,Identity};
+			case 25u: return {EF_A2B10G10R10_UINT_PACK32,Identity};
+			case 26u: return {EF_B10G11R11_UFLOAT_PACK32,Identity};
+			case 28u: return {EF_R8G8B8A8_UNORM,Identity};
+			case 29u: return {EF_R8G8B8A8_SRGB,Identity};
+			case 30u: return {EF_R8G8B8A8_UINT,Identity};
+			case 31u: return {EF_R8G8B8A8_SNORM,Identity};
+			case 32u: return {EF_R8G8B8A8_SINT,Identity};
+			case 34u: return {EF_R16G16_SFLOAT,Identity};
+			case 35u: return {EF_R16G16_UNORM,Identity};
+			case 36u: return {EF_R16G16_UINT,Identity};
+			case 37u: return {EF_R16G16_SNORM,Identity};
+			case 38u: return {EF_R16G16_SINT,Identity};
+			case 41u: return {EF_R32_SFLOAT,Identity};
+			case 42u: return {EF_R32_UINT,Identity};
+			case 43u: return {EF_R32_SINT,Identity};
+			case 49u: return {EF_R8G8_UNORM,Identity};
+			case 50u: return {EF_R8G8_UINT,Identity};
+			case 51u: return {EF_R8G8_SNORM,Identity};
+			case 52u: return {EF_R8G8_SINT,Identity};
+			case 54u: return {EF_R16_SFLOAT,Identity};
+			case 56u: return {EF_R16_UNORM,Identity};
+			case 57u: return {EF_R16_UINT,Identity};
+			case 58u: return {EF_R16_SNORM,Identity};
+			case 59u: return {EF_R16_SINT,Identity};
+			case 61u: return {EF_R8_UNORM,Identity};
+			case 62u: return {EF_R8_UINT,Identity};
+			case 63u: return {EF_R8_SNORM,Identity};
+			case 64u: return {EF_R8_SINT,Identity};
+			case 65u: return {EF_R8_UNORM,AlphaOnly};
+			case 67u: return {EF_E5B9G9R9_UFLOAT_PACK32,Identity};
+			case 71u: return {EF_BC1_RGBA_UNORM_BLOCK,Identity};
+			case 72u: return {EF_BC1_RGBA_SRGB_BLOCK,Identity};
+			case 74u: return {EF_BC2_UNORM_BLOCK,Identity};
+			case 75u: return {EF_BC2_SRGB_BLOCK,Identity};
+			case 77u: return {EF_BC3_UNORM_BLOCK,Identity};
+			case 78u: return {EF_BC3_SRGB_BLOCK,Identity};
+			case 80u: return {EF_BC4_UNORM_BLOCK,Identity};
+			case 81u: return {EF_BC4_SNORM_BLOCK,Identity};
+			case 83u: return {EF_BC5_UNORM_BLOCK,Identity};
+			case 84u: return {EF_BC5_SNORM_BLOCK,Identity};
+			case 85u: return {EF_R5G6B5_UNORM_PACK16,Identity};
+			case 86u: return {EF_A1R5G5B5_UNORM_PACK16,Identity};
+			case 87u: return {EF_B8G8R8A8_UNORM,Identity};
+			case 88u: return {EF_B8G8R8A8_UNORM,NoAlpha};
+			case 91u: return {EF_B8G8R8A8_SRGB,Identity};
+			case 93u: return {EF_B8G8R8A8_SRGB,NoAlpha};
+			case 95u: return {EF_BC6H_UFLOAT_BLOCK,Identity};
+			case 96u: return {EF_BC6H_SFLOAT_BLOCK,Identity};
+			case 98u: return {EF_BC7_UNORM_BLOCK,Identity};
+			case 99u: return {EF_BC7_SRGB_BLOCK,Identity};
+			default: break;
+		}
+		return {EF_UNKNOWN,Identity};
+	}
+
+	//! Files written without a DX10 header describe their format with a FourCC or D3D9 style channel masks
+	static inline format_t getFormat(const SPixelFormat& pf)
+	{
+		using mapping_t = ICPUImageView::SComponentMapping;
+		constexpr mapping_t Identity = {};
+		constexpr mapping_t NoAlpha = {mapping_t::ES_R,mapping_t::ES_G,mapping_t::ES_B,mapping_t::ES_ONE};
+		constexpr mapping_t Luminance = {mapping_t::ES_R,mapping_t::ES_R,mapping_t::ES_R,mapping_t::ES_ONE};
+		constexpr mapping_t LuminanceAlpha = {mapping_t::ES_R,mapping_t::ES_R,mapping_t::ES_R,mapping_t::ES_G};
+		constexpr mapping_t AlphaOnly = {mapping_t::ES_ZERO,mapping_t::ES_ZERO,mapping_t::ES_ZERO,mapping_t::ES_R};
+
+		if (pf.flags&EPFF_FOURCC)
+		switch (pf.fourCC)
+		{
+			case makeFourCC('D','X','T','1'): return {EF_BC1_RGBA_UNORM_BLOCK,Identity};
+			case makeFourCC('D','X','T','2'): [[fallthrough]];
+			case makeFourCC('D','X','T','3'): return {EF_BC2_UNORM_BLOCK,Identity};
+			case makeFourCC('D','X','T','4'): [[fallthrough]];
+			case makeFourCC('D','X','T','5'): return {EF_BC3_UNORM_BLOCK,Identity};
+			case makeFourCC('A','T','I','1'): [[fallthrough]];
+			case makeFourCC('B','C','4','U'): return {EF_BC4_UNORM_BLOCK,Identity};
+			case makeFourCC('B','C','4','S'): return {EF_BC4_SNORM_BLOCK,Identity};
+			case makeFourCC('A','T','I','2'): [[fallthrough]];
+			case makeFourCC('B','C','5','U'): return {EF_BC5_UNORM_BLOCK,Identity};
+			case makeFourCC('B','C','5','S'): return {EF_BC5_SNORM_BLOCK,Identity};
+			// D3DFORMAT enum values stored as the FourCC
+			case 36u: return {EF_R16G16B16A16_UNORM,Identity};
+			case 110u: return {EF_R16G16B16A16_SNORM,Identity};
+			case 111u: return {EF_R16_SFLOAT,Identity};
+			case 112u: return {EF_R16G16_SFLOAT,Identity};
+			case 113u: return {EF_R16G16B16A16_SFLOAT,Identity};
+			case 114u: return {EF_R32_SFLOAT,Identity};
+			case 115u: return {EF_R32G32_SFLOAT,Identity};
+			case 116u: return {EF_R32G32B32A32_SFLOAT,Identity};
+			default: return {EF_UNKNOWN,Identity};
+		}
+
+		const uint32_t aMask = pf.flags&(EPFF_ALPHAPIXELS|EPFF_ALPHA|EPFF_BUMPDUDV) ? pf.aBitMask:0u;
+		auto masksAre = [&pf,aMask](const uint32_t bits, const uint32_t r, const uint32_t g, const uint32_t b, const uint32_t a) -> bool
+		{
+			return pf.rgbBitCount==bits && pf.rBitMask==r && pf.gBitMask==g && pf.bBitMask==b && aMask==a;
+		};
+		if (pf.flags&EPFF_RGB)
+		{
+			if (masksAre(32u,0xffu,0xff00u,0xff0000u,0xff000000u))
+				return {EF_R8G8B8A8_UNORM,Identity};
+			if (masksAre(32u,0xffu,0xff00u,0xff0000u,0u))
+				return {EF_R8G8B8A8_UNORM,NoAlpha};
+			if (masksAre(32u,0xff0000u,0xff00u,0xffu,0xff000000u))
+				return {EF_B8G8R8A8_UNORM,Identity};
+			if (masksAre(32u,0xff0000u,0xff00u,0xffu,0u))
+				return {EF_B8G8R8A8_UNORM,NoAlpha};
+			if (masksAre(32u,0x3ffu,0xffc00u,0x3ff00000u,0xc0000000u))
+				return {EF_A2B10G10R10_UNORM_PACK32,Identity};
+			if (masksAre(32u,0xffffu,0xffff0000u,0u,0u))
+				return {EF_R16G16_UNORM,Identity};
+			if (masksAre(32u,0xffffffffu,0u,0u,0u))
+				return {EF_R32_SFLOAT,Identity};
+			if (masksAre(24u,0xff0000u,0xff00u,0xffu,0u))
+				return {EF_B8G8R8_UNORM,Identity};
+			if (masksAre(16u,0xf800u,0x7e0u,0x1fu,0u))
+				return {EF_R5G6B5_UNORM_PACK16,Identity};
+			if (masksAre(16u,0x7c00u,0x3e0u,0x1fu,0x8000u))
+				return {EF_A1R5G5B5_UNORM_PACK16,Identity};
+			if (masksAre(16u,0x7c00u,0x3e0u,0x1fu,0u))
+				return {EF_A1R5G5B5_UNORM_PACK16,NoAlpha};
+		}
+		else if (pf.flags&EPFF_LUMINANCE)
+		{
+			if (masksAre(8u,0xffu,0u,0u,0u))
+				return {EF_R8_UNORM,Luminance};
+			if (masksAre(16u,0xffffu,0u,0u,0u))
+				return {EF_R16_UNORM,Luminance};
+			if (masksAre(16u,0xffu,0u,0u,0xff00u))
+				return {EF_R8G8_UNORM,LuminanceAlpha};
+		}
+		else if (pf.flags&EPFF_ALPHA)
+		{
+			if (pf.rgbBitCount==8u)
+				return {EF_R8_UNORM,AlphaOnly};
+		}
+		else if (pf.flags&EPFF_BUMPDUDV)
+		{
+			if (masksAre(16u,0xffu,0xff00u,0u,0u))
+				return {EF_R8G8_SNORM,Identity};
+			if (masksAre(32u,0xffu,0xff00u,0xff0000u,0xff000000u))
+				return {EF_R8G8B8A8_SNORM,Identity};
+			if (masksAre(32u,0xffffu,0xffff0000u,0u,0u))
+				return {EF_R16G16_SNORM,Identity};
+		}
+		return {EF_UNKNOWN,Identity};
+	}
+};
+
+}
+
+#endif
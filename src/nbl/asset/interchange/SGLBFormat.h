@@ -0,0 +1,104 @@
+#ifndef _NBL_ASSET_S_GLB_FORMAT_H_INCLUDED_
+#define _NBL_ASSET_S_GLB_FORMAT_H_INCLUDED_
+
+#include "nbl/system/IFile.h"
+
+namespace nbl::asset
+{
+
+//! Binary glTF container shared by `CGLTFLoader` and `CGLTFWriter`
+/*
+	A 12 byte header followed by a JSON chunk and an optional BIN chunk, all little endian.
+	Chunks are padded to 4 bytes (JSON with spaces, BIN with zeroes) and the padding counts towards their length.
+	The BIN chunk holds the contents of the first buffer, which then has no `uri`.
+*/
+struct SGLBFormat
+{
+	static inline constexpr uint32_t Magic = 0x46546C67u; // "glTF"
+	static inline constexpr uint32_t Version = 2u;
+	static inline constexpr uint32_t ChunkAlignment = 4u;
+
+	enum E_CHUNK_TYPE : uint32_t
+	{
+		ECT_JSON = 0x4E4F534Au,
+		ECT_BIN = 0x004E4942u
+	};
+
+	struct SHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		//! of the whole file, including the header
+		uint32_t length;
+	};
+	static_assert(sizeof(SHeader)==12u);
+
+	struct SChunkHeader
+	{
+		uint32_t length;
+		E_CHUNK_TYPE type;
+	};
+	static_assert(sizeof(SChunkHeader)==8u);
+
+	//! Where the chunks are within a .glb file, sizes of 0 mean the chunk is absent
+	struct SLayout
+	{
+		uint64_t jsonOffset = 0ull;
+		uint64_t jsonSize = 0ull;
+		uint64_t binOffset = 0ull;
+		uint64_t binSize = 0ull;
+	};
+	//! Returns false if the file is not a valid .glb, only reads the chunk headers
+	static inline bool readLayout(system::IFile* file, SLayout& layout)
+	{
+		const size_t fileSize = file->getSize();
+		SHeader header;
+		{
+			system::IFile::success_t success;
+			file->read(success,&header,0ull,sizeof(header));
+			if (!success || header.magic!=Magic || header.version!=Version || header.length>fileSize)
+				return false;
+		}
+
+		uint64_t offset = sizeof(SHeader);
+		auto readChunkHeader = [&](SChunkHeader& chunk)->bool
+		{
+			if (offset+sizeof(SChunkHeader)>header.length)
+				return false;
+			system::IFile::success_t success;
+			file->read(success,&chunk,offset,sizeof(chunk));
+			if (!success)
+				return false;
+			offset += sizeof(SChunkHeader);
+			return offset+chunk.length<=header.length;
+		};
+
+		// every chunk has to start and end on a `ChunkAlignment` boundary, the BIN chunk's contents get aliased as buffers with that alignment
+		// the JSON chunk must come first
+		SChunkHeader chunk;
+		if (!readChunkHeader(chunk) || chunk.type!=ECT_JSON || chunk.length%ChunkAlignment)
+			return false;
+		layout.jsonOffset = offset;
+		layout.jsonSize = chunk.length;
+		offset += chunk.length;
+
+		// chunks of unknown types must be skipped
+		while (readChunkHeader(chunk))
+		{
+			if (chunk.length%ChunkAlignment)
+				return false;
+			if (chunk.type==ECT_BIN)
+			{
+				layout.binOffset = offset;
+				layout.binSize = chunk.length;
+				break;
+			}
+			offset += chunk.length;
+		}
+		return true;
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef _NBL_ASSET_S_KTX2_FORMAT_H_INCLUDED_
+#define _NBL_ASSET_S_KTX2_FORMAT_H_INCLUDED_
+
+#include "nbl/asset/format/EFormat.h"
+
+namespace nbl::asset
+{
+
+//! Header and level index of the Khronos KTX 2.0 container, all little endian
+/*
+	The header is followed by one level index entry per mip level, largest first, each giving where the level's data sits in the file.
+	A level holds all its layers, faces and depth slices tightly packed (no row padding unlike KTX 1.1) in layer, face, slice order,
+	which is exactly the layer order of a cube (array) `IImage`. With supercompression each level is compressed separately.
+*/
+struct SKTX2Format
+{
+	static inline constexpr uint8_t Identifier[12] = { 0xABu,'K','T','X',' ','2','0',0xBBu,'\r','\n',0x1Au,'\n' };
+
+	struct SHeader
+	{
+		uint8_t identifier[12];
+		uint32_t vkFormat;
+		uint32_t typeSize;
+		uint32_t pixelWidth;
+		uint32_t pixelHeight;
+		uint32_t pixelDepth;
+		uint32_t layerCount;
+		uint32_t faceCount;
+		uint32_t levelCount;
+		uint32_t supercompressionScheme;
+		// index
+		uint32_t dfdByteOffset;
+		uint32_t dfdByteLength;
+		uint32_t kvdByteOffset;
+		uint32_t kvdByteLength;
+		uint64_t sgdByteOffset;
+		uint64_t sgdByteLength;
+	};
+	static_assert(sizeof(SHeader)==80u);
+
+	struct SLevelIndexEntry
+	{
+		uint64_t byteOffset;
+		uint64_t byteLength;
+		uint64_t uncompressedByteLength;
+	};
+	static_assert(sizeof(SLevelIndexEntry)==24u);
+
+	enum E_SUPERCOMPRESSION_SCHEME : uint32_t
+	{
+		ESS_NONE = 0u,
+		//! needs the global data of a Basis Universal transcoder
+		ESS_BASIS_LZ = 1u,
+		ESS_ZSTD = 2u,
+		ESS_ZLIB = 3u
+	};
+
+	//! `EF_UNKNOWN` for VK_FORMAT_UNDEFINED (Basis Universal payloads), depth/stencil formats (not textures) and formats `E_FORMAT` lacks
+	/*
+		`E_FORMAT` follows `VkFormat`'s order in runs, it just has the depth formats moved to the front and ASTC before ETC2/EAC.
+	*/
+	static inline E_FORMAT getFormat(const uint32_t vkFormat)
+	{
+		auto inRun = [vkFormat](const uint32_t firstVk, const E_FORMAT first, const E_FORMAT last) -> bool
+		{
+			return vkFormat>=firstVk && vkFormat-firstVk<=uint32_t(last-first);
+		};
+		// VK_FORMAT_R4G4_UNORM_PACK8 to VK_FORMAT_E5B9G9R9_UFLOAT_PACK32
+		if (inRun(1u,EF_R4G4_UNORM_PACK8,EF_E5B9G9R9_UFLOAT_PACK32))
+			return static_cast<E_FORMAT>(EF_R4G4_UNORM_PACK8+vkFormat-1u);
+		// VK_FORMAT_BC1_RGB_UNORM_BLOCK to VK_FORMAT_BC7_SRGB_BLOCK
+		if (inRun(131u,EF_BC1_RGB_UNORM_BLOCK,EF_BC7_SRGB_BLOCK))
+			return static_cast<E_FORMAT>(EF_BC1_RGB_UNORM_BLOCK+vkFormat-131u);
+		// VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK to VK_FORMAT_EAC_R11G11_SNORM_BLOCK
+		if (inRun(147u,EF_ETC2_R8G8B8_UNORM_BLOCK,EF_EAC_R11G11_SNORM_BLOCK))
+			return static_cast<E_FORMAT>(EF_ETC2_R8G8B8_UNORM_BLOCK+vkFormat-147u);
+		// VK_FORMAT_ASTC_4x4_UNORM_BLOCK to VK_FORMAT_ASTC_12x12_SRGB_BLOCK
+		if (inRun(157u,EF_ASTC_4x4_UNORM_BLOCK,EF_ASTC_12x12_SRGB_BLOCK))
+			return static_cast<E_FORMAT>(EF_ASTC_4x4_UNORM_BLOCK+vkFormat-157u);
+		// VK_FORMAT_PVRTC1_2BPP_UNORM_BLOCK_IMG to VK_FORMAT_PVRTC2_4BPP_SRGB_BLOCK_IMG
+		if (inRun(1000054000u,EF_PVRTC1_2BPP_UNORM_BLOCK_IMG,EF_PVRTC2_4BPP_SRGB_BLOCK_IMG))
+			return static_cast<E_FORMAT>(EF_PVRTC1_2BPP_UNORM_BLOCK_IMG+vkFormat-1000054000u);
+		return EF_UNKNOWN;
+	}
+};
+
+}
+
+#endif
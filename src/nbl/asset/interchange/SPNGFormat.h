@@ -0,0 +1,81 @@
+#ifndef _NBL_ASSET_S_PNG_FORMAT_H_INCLUDED_
+#define _NBL_ASSET_S_PNG_FORMAT_H_INCLUDED_
+
+#include "nbl/core/declarations.h"
+
+#include <cstdlib>
+
+namespace nbl::asset
+{
+
+//! Chunk layout and row filters of PNG, shared by the libpng-free paths of `CImageLoaderPng` and `CImageWriterPNG`
+/*
+	After the signature come chunks of a big endian length, a 4 character type, the data and a CRC32 of the type and data.
+	The IDAT chunks concatenated form one zlib stream, in which every row is preceded by a byte selecting the filter that
+	predicts the row's bytes from the byte `bpp` to the left and the one above, both read as zero outside the image.
+*/
+struct SPNGFormat
+{
+	static inline constexpr uint8_t Signature[8] = { 0x89u,'P','N','G','\r','\n',0x1au,'\n' };
+	//! length, type and CRC
+	static inline constexpr uint32_t ChunkOverhead = 12u;
+	static inline constexpr uint32_t IHDRSize = 13u;
+
+	enum E_CHUNK_TYPE : uint32_t
+	{
+		ECT_IHDR = 0x49484452u,
+		ECT_PLTE = 0x504C5445u,
+		ECT_tRNS = 0x74524E53u,
+		ECT_gAMA = 0x67414D41u,
+		ECT_sRGB = 0x73524742u,
+		ECT_IDAT = 0x49444154u,
+		ECT_IEND = 0x49454E44u
+	};
+	//! bit 5 of the first letter is clear for chunks a decoder must understand
+	static inline constexpr bool isCritical(const uint32_t type) {return !(type&0x20000000u);}
+
+	enum class E_COLOR_TYPE : uint8_t
+	{
+		GRAY = 0u,
+		RGB = 2u,
+		PALETTE = 3u,
+		GRAY_ALPHA = 4u,
+		RGBA = 6u
+	};
+	enum class E_FILTER : uint8_t
+	{
+		NONE,
+		SUB,
+		UP,
+		AVERAGE,
+		PAETH,
+		COUNT
+	};
+
+	static inline uint32_t readBE(const uint8_t* src)
+	{
+		return (uint32_t(src[0])<<24u)|(uint32_t(src[1])<<16u)|(uint32_t(src[2])<<8u)|uint32_t(src[3]);
+	}
+	static inline void writeBE(uint8_t* dst, const uint32_t value)
+	{
+		dst[0] = value>>24u;
+		dst[1] = value>>16u;
+		dst[2] = value>>8u;
+		dst[3] = value;
+	}
+
+	//! Of `a` to the left, `b` above and `c` above-left picks the one closest to `a+b-c`, ties favour `a` over `b` over `c`
+	static inline uint8_t paethPredictor(const uint8_t a, const uint8_t b, const uint8_t c)
+	{
+		const int32_t pa = std::abs(int32_t(b)-int32_t(c));
+		const int32_t pb = std::abs(int32_t(a)-int32_t(c));
+		const int32_t pc = std::abs(int32_t(a)+int32_t(b)-2*int32_t(c));
+		if (pa<=pb && pa<=pc)
+			return a;
+		return pb<=pc ? b:c;
+	}
+};
+
+}
+
+#endif
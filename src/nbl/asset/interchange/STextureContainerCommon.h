@@ -0,0 +1,147 @@
+#ifndef _NBL_ASSET_S_TEXTURE_CONTAINER_COMMON_H_INCLUDED_
+#define _NBL_ASSET_S_TEXTURE_CONTAINER_COMMON_H_INCLUDED_
+
+#include "nbl/core/execution.h"
+#include "nbl/asset/ICPUImageView.h"
+#include "nbl/system/CMappedFileMemoryResource.h"
+
+#include "CImageHasher.h"
+
+namespace nbl::asset
+{
+
+//! Shared by `CImageLoaderKTX2` and `CImageLoaderDDS`, whose files already store the texel blocks in the layout `IImage::SBufferCopy` regions can describe
+/*
+	So instead of copying every subresource out of the file, the image's buffer is the file itself (its mapping if there is one,
+	one read of it otherwise) and the regions get the offsets of the subresources within the file.
+*/
+struct STextureContainerCommon
+{
+	//! Aliases the mapping of `file` as a buffer's storage when possible, otherwise reads the whole file into a new buffer
+	static inline core::smart_refctd_ptr<ICPUBuffer> getWholeFileBuffer(system::IFile* file)
+	{
+		const size_t fileSize = file->getSize();
+		if (auto memoryResource=system::CMappedFileMemoryResource::create(core::smart_refctd_ptr<system::IFile>(file)))
+		if (void* data=memoryResource->getRegion(0ull,fileSize,system::CMappedFileMemoryResource::E_ACCESS_PATTERN::SEQUENTIAL))
+		{
+			const size_t alignment = memoryResource->getAlignment(0ull);
+			if (auto buffer=ICPUBuffer::create({{fileSize},data,std::move(memoryResource),alignment},core::adopt_memory))
+				return buffer;
+		}
+
+		auto buffer = ICPUBuffer::create({fileSize});
+		if (!buffer)
+			return nullptr;
+		system::IFile::success_t success;
+		file->read(success,buffer->getPointer(),0ull,fileSize);
+		if (!success)
+			return nullptr;
+		return buffer;
+	}
+
+	//! Sizes and offsets come straight from the file, so the loaders sum them up with these, false means it would have wrapped around
+	static inline bool checkedAdd(size_t& out, const size_t a, const size_t b)
+	{
+		if (a>std::numeric_limits<size_t>::max()-b)
+			return false;
+		out = a+b;
+		return true;
+	}
+	static inline bool checkedMul(size_t& out, const size_t a, const size_t b)
+	{
+		if (b && a>std::numeric_limits<size_t>::max()/b)
+			return false;
+		out = a*b;
+		return true;
+	}
+
+	//! Bytes taken by one layer of a region, there's no padding between rows or slices, only to be used on extents `getByteSize` accepted
+	static inline size_t getLayerByteSize(const E_FORMAT format, const VkExtent3D& extent)
+	{
+		const auto blockDims = asset::getBlockDimensions(format);
+		size_t blocks = (size_t(extent.width)+blockDims.x-1u)/blockDims.x;
+		blocks *= (size_t(extent.height)+blockDims.y-1u)/blockDims.y;
+		blocks *= (size_t(extent.depth)+blockDims.z-1u)/blockDims.z;
+		return blocks*asset::getTexelOrBlockBytesize(format);
+	}
+	//! `getLayerByteSize` times `layerCount`, false instead if that doesn't fit a `size_t`
+	static inline bool getByteSize(const E_FORMAT format, const VkExtent3D& extent, const uint32_t layerCount, size_t& out)
+	{
+		const auto blockDims = asset::getBlockDimensions(format);
+		size_t size = asset::getTexelOrBlockBytesize(format);
+		return checkedMul(size,size,(size_t(extent.width)+blockDims.x-1u)/blockDims.x) &&
+			checkedMul(size,size,(size_t(extent.height)+blockDims.y-1u)/blockDims.y) &&
+			checkedMul(size,size,(size_t(extent.depth)+blockDims.z-1u)/blockDims.z) &&
+			checkedMul(out,size,layerCount);
+	}
+
+	//! True if every layer of every region lies within the buffer, to be checked before `ICPUImage::setBufferAndRegions` asserts on a malformed file
+	static inline bool regionsFitBuffer(const E_FORMAT format, const size_t bufferSize, const std::span<const IImage::SBufferCopy> regions)
+	{
+		for (const auto& region : regions)
+		{
+			size_t regionSize;
+			if (!getByteSize(format,region.imageExtent,region.imageSubresource.layerCount,regionSize))
+				return false;
+			if (region.bufferOffset>bufferSize || regionSize>bufferSize-region.bufferOffset)
+				return false;
+		}
+		return true;
+	}
+
+	//! Same content hash `CImageHasher::hashSeq` gives when fed layer by layer, but the layers are hashed in parallel
+	static inline void setContentHash(ICPUImage* image)
+	{
+		const auto& params = image->getCreationParameters();
+		const auto format = params.format;
+		auto* const data = reinterpret_cast<uint8_t*>(image->getBuffer()->getPointer());
+		const auto regions = image->getRegions();
+
+		struct SLayer
+		{
+			uint8_t* data;
+			size_t size;
+			uint32_t mipLevel, layer;
+		};
+		core::vector<SLayer> layers;
+		for (const auto& region : regions)
+		{
+			const size_t layerSize = getLayerByteSize(format,region.imageExtent);
+			for (uint32_t l=0u; l<region.imageSubresource.layerCount; l++)
+				layers.push_back({data+region.bufferOffset+l*layerSize,layerSize,region.imageSubresource.mipLevel,region.imageSubresource.baseArrayLayer+l});
+		}
+
+		CImageHasher contentHasher(params);
+		core::for_each(core::execution::par,layers.begin(),layers.end(),[&contentHasher](const SLayer& layer) -> void
+			{
+				contentHasher.partialHash(layer.mipLevel,layer.layer,layer.data,layer.size);
+			}
+		);
+		for (uint32_t mipLevel=0u; mipLevel<params.mipLevels; mipLevel++)
+		for (uint32_t layer=0u; layer<params.arrayLayers; layer++)
+			contentHasher.hashSeq(mipLevel,layer);
+		image->setContentHash(contentHasher.finalizeSeq());
+	}
+
+	static inline core::smart_refctd_ptr<ICPUImageView> createImageView(core::smart_refctd_ptr<ICPUImage>&& image, const IImageView<ICPUImage>::E_TYPE viewType, const ICPUImageView::SComponentMapping& components)
+	{
+		const auto& imageParams = image->getCreationParameters();
+
+		ICPUImageView::SCreationParams viewParams = {};
+		viewParams.format = imageParams.format;
+		viewParams.viewType = viewType;
+		viewParams.components = components;
+		viewParams.flags = static_cast<ICPUImageView::E_CREATE_FLAGS>(0u);
+		viewParams.subresourceRange.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT;
+		viewParams.subresourceRange.baseArrayLayer = 0u;
+		viewParams.subresourceRange.baseMipLevel = 0u;
+		viewParams.subresourceRange.layerCount = imageParams.arrayLayers;
+		viewParams.subresourceRange.levelCount = imageParams.mipLevels;
+		viewParams.image = std::move(image);
+		return ICPUImageView::create(std::move(viewParams));
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,195 @@
+#include "nbl/system/CArchiveLoaderNPK.h"
+
+#include "nbl/system/CFileView.h"
+
+#include "nbl/core/hash/xxHash256.h"
+
+#include <lz4/lib/lz4.h>
+
+#include "nbl/system/threadLocalDecompressor.h"
+
+
+using namespace nbl;
+using namespace nbl::system;
+
+
+//! Stored entries alias the mapped pack, compressed ones own their decompressed copy, either way the pack stays mapped while the file lives
+class CArchiveLoaderNPK::CArchive::CEntryFile final : public IFileView
+{
+	public:
+		inline CEntryFile(core::smart_refctd_ptr<IFile>&& pack, path&& _name, const time_point_t _initialModified, void* data, const size_t size, core::vector<std::byte>&& decompressed, const uint64_t (&contentHash)[4])
+			: IFileView(std::move(_name),IFileBase::ECF_READ|IFileBase::ECF_MAPPABLE,_initialModified,data,size), m_pack(std::move(pack)), m_decompressed(std::move(decompressed)),
+			m_contentHash(contentHash[0],contentHash[1],contentHash[2],contentHash[3])
+		{
+		}
+
+		inline std::optional<hlsl::uint64_t4> getPrecomputedHash() const override {return m_contentHash;}
+
+	protected:
+		~CEntryFile() = default;
+
+		const core::smart_refctd_ptr<IFile> m_pack;
+		const core::vector<std::byte> m_decompressed;
+		const hlsl::uint64_t4 m_contentHash;
+};
+
+
+CArchiveLoaderNPK::CArchive::CArchive(core::smart_refctd_ptr<IFile>&& _file, system::logger_opt_smart_ptr&& logger, const std::span<const SNablaPackFormat::SIndexEntry> index, const std::string_view names)
+	: IFileArchive(path(_file->getFileName()),std::move(logger)), m_file(std::move(_file)), m_index(index), m_names(names)
+{
+}
+
+IFileArchive::SFileList::SEntry CArchiveLoaderNPK::CArchive::makeListEntry(const SNablaPackFormat::SIndexEntry& entry) const
+{
+	SFileList::SEntry retval;
+	retval.pathRelativeToArchive = getName(entry);
+	retval.size = entry.size;
+	retval.offset = entry.offset;
+	retval.ID = static_cast<uint32_t>(std::distance(m_index.data(),&entry));
+	retval.allocatorType = entry.codec==SNablaPackFormat::E_CODEC::NONE ? EAT_NULL:EAT_MALLOC;
+	return retval;
+}
+
+IFileArchive::SFileList CArchiveLoaderNPK::CArchive::listAssets() const
+{
+	std::call_once(m_listBuilt,[this]()->void
+		{
+			auto items = std::make_shared<core::vector<SFileList::SEntry>>();
+			items->reserve(m_index.size());
+			for (const auto& entry : m_index)
+				items->push_back(makeListEntry(entry));
+			setItemList(items);
+		}
+	);
+	return IFileArchive::listAssets();
+}
+
+const IFileArchive::SFileList::found_t CArchiveLoaderNPK::CArchive::getItemFromPath(const system::path& pathRelativeToArchive) const
+{
+	const auto genericPath = pathRelativeToArchive.generic_string();
+	const uint64_t pathHash = SNablaPackFormat::hashPath(genericPath);
+	auto it = std::lower_bound(m_index.begin(),m_index.end(),pathHash,[](const SNablaPackFormat::SIndexEntry& entry, const uint64_t hash)->bool{return entry.pathHash<hash;});
+	// colliding hashes are sorted by name, just walk them
+	for (; it!=m_index.end() && it->pathHash==pathHash; it++)
+	if (getName(*it)==genericPath)
+	{
+		// the found entry needs backing storage, but we don't want to build the whole list for it
+		auto storage = std::make_shared<core::vector<SFileList::SEntry>>(1u,makeListEntry(*it));
+		const auto* entry = storage->data();
+		return SFileList::found_t(std::move(storage),entry);
+	}
+	return {};
+}
+
+core::smart_refctd_ptr<IFile> CArchiveLoaderNPK::CArchive::getFile_impl(const SFileList::found_t& found, const core::bitflag<IFileBase::E_CREATE_FLAGS> flags, const std::string_view& password)
+{
+	const auto& entry = m_index[found->ID];
+	// subtract-form so crafted 64 bit fields can't wrap around, and stored entries get exposed as `size` bytes of the mapping
+	const size_t fileSize = m_file->getSize();
+	if (entry.offset>fileSize || entry.compressedSize>fileSize-entry.offset || (entry.codec==SNablaPackFormat::E_CODEC::NONE && entry.size!=entry.compressedSize))
+	{
+		m_logger.log("Entry %s points outside of the pack, the pack is corrupt.",ILogger::ELL_ERROR,found->pathRelativeToArchive.string().c_str());
+		return nullptr;
+	}
+	const std::byte* const src = reinterpret_cast<const std::byte*>(m_file->getMappedPointer())+entry.offset;
+
+	void* data = nullptr;
+	core::vector<std::byte> decompressed;
+	switch (entry.codec)
+	{
+		case SNablaPackFormat::E_CODEC::NONE:
+			data = const_cast<std::byte*>(src);
+			break;
+		case SNablaPackFormat::E_CODEC::LZ4:
+		{
+			decompressed.resize(entry.size);
+			const int decompressedSize = LZ4_decompress_safe(reinterpret_cast<const char*>(src),reinterpret_cast<char*>(decompressed.data()),static_cast<int>(entry.compressedSize),static_cast<int>(entry.size));
+			if (decompressedSize<0 || static_cast<uint64_t>(decompressedSize)!=entry.size)
+			{
+				m_logger.log("Error decompressing %s",ILogger::ELL_ERROR,found->pathRelativeToArchive.string().c_str());
+				return nullptr;
+			}
+			data = decompressed.data();
+			break;
+		}
+		case SNablaPackFormat::E_CODEC::DEFLATE:
+		{
+		#ifdef _NBL_COMPILE_WITH_LIBDEFLATE_
+			decompressed.resize(entry.size);
+			auto* decompressor = impl::getThreadLocalDecompressor();
+			if (!decompressor || libdeflate_deflate_decompress(decompressor,src,entry.compressedSize,decompressed.data(),entry.size,nullptr)!=LIBDEFLATE_SUCCESS)
+			{
+				m_logger.log("Error decompressing %s",ILogger::ELL_ERROR,found->pathRelativeToArchive.string().c_str());
+				return nullptr;
+			}
+			data = decompressed.data();
+			break;
+		#else
+			m_logger.log("libdeflate not supported. File %s cannot be read.",ILogger::ELL_ERROR,found->pathRelativeToArchive.string().c_str());
+			return nullptr;
+		#endif
+		}
+		default:
+			m_logger.log("File %s has unsupported compression method.",ILogger::ELL_ERROR,found->pathRelativeToArchive.string().c_str());
+			return nullptr;
+	}
+
+#ifdef _NBL_DEBUG
+	{
+		uint64_t contentHash[4];
+		core::XXHash_256(data,entry.size,contentHash);
+		if (memcmp(contentHash,entry.contentHash,sizeof(contentHash)))
+			m_logger.log("Content hash mismatch for %s, the pack is corrupt.",ILogger::ELL_ERROR,found->pathRelativeToArchive.string().c_str());
+	}
+#endif
+
+	return core::make_smart_refctd_ptr<CEntryFile>(
+		core::smart_refctd_ptr(m_file),getDefaultAbsolutePath()/found->pathRelativeToArchive,m_file->getLastWriteTime(),
+		data,entry.size,std::move(decompressed),entry.contentHash
+	);
+}
+
+
+bool CArchiveLoaderNPK::isALoadableFileFormat(IFile* file) const
+{
+	SNablaPackFormat::SHeader header;
+	IFile::success_t success;
+	file->read(success,&header,0ull,sizeof(header));
+	if (!success)
+		return false;
+	return header.magic==SNablaPackFormat::Magic && header.version==SNablaPackFormat::Version;
+}
+
+core::smart_refctd_ptr<IFileArchive> CArchiveLoaderNPK::createArchive_impl(core::smart_refctd_ptr<system::IFile>&& file, const std::string_view& password) const
+{
+	if (!file || !(file->getFlags()&IFileBase::ECF_MAPPABLE))
+		return nullptr;
+
+	const auto* const base = reinterpret_cast<const uint8_t*>(file->getMappedPointer());
+	const size_t fileSize = file->getSize();
+	if (!base || fileSize<sizeof(SNablaPackFormat::SHeader))
+		return nullptr;
+
+	SNablaPackFormat::SHeader header;
+	memcpy(&header,base,sizeof(header));
+	if (header.magic!=SNablaPackFormat::Magic)
+		return nullptr;
+	if (header.version!=SNablaPackFormat::Version)
+	{
+		m_logger.log("Nabla pack %s has version %d, only %d is supported.",ILogger::ELL_ERROR,file->getFileName().string().c_str(),header.version,SNablaPackFormat::Version);
+		return nullptr;
+	}
+
+	// only the header gets validated here, the index is used in-place
+	const uint64_t indexSize = uint64_t(header.entryCount)*sizeof(SNablaPackFormat::SIndexEntry);
+	if (header.entryCount>fileSize/sizeof(SNablaPackFormat::SIndexEntry) || header.indexOffset%alignof(SNablaPackFormat::SIndexEntry) ||
+		header.indexOffset>fileSize || indexSize>fileSize-header.indexOffset || header.namesOffset>fileSize || header.namesSize>fileSize-header.namesOffset)
+	{
+		m_logger.log("Nabla pack %s has a corrupt header.",ILogger::ELL_ERROR,file->getFileName().string().c_str());
+		return nullptr;
+	}
+	const std::span<const SNablaPackFormat::SIndexEntry> index(reinterpret_cast<const SNablaPackFormat::SIndexEntry*>(base+header.indexOffset),header.entryCount);
+	const std::string_view names(reinterpret_cast<const char*>(base+header.namesOffset),header.namesSize);
+
+	return core::make_smart_refctd_ptr<CArchive>(std::move(file),core::smart_refctd_ptr(m_logger.get()),index,names);
+}
@@ -0,0 +1,65 @@
+#ifndef _NBL_SYSTEM_C_ARCHIVE_LOADER_NPK_H_INCLUDED_
+#define _NBL_SYSTEM_C_ARCHIVE_LOADER_NPK_H_INCLUDED_
+
+
+#include "nbl/system/IFileArchive.h"
+#include "nbl/system/SNablaPackFormat.h"
+
+#include <mutex>
+
+
+namespace nbl::system
+{
+
+//! Loads Nabla packs written by `CNablaPackWriter`, see `SNablaPackFormat` for the layout
+class CArchiveLoaderNPK final : public IArchiveLoader
+{
+	public:
+		class CArchive final : public IFileArchive
+		{
+			public:
+				CArchive(core::smart_refctd_ptr<IFile>&& _file, system::logger_opt_smart_ptr&& logger, const std::span<const SNablaPackFormat::SIndexEntry> index, const std::string_view names);
+
+				//! Only gets built on first use, opening files goes through the hash index and never needs it
+				SFileList listAssets() const override;
+				using IFileArchive::listAssets;
+
+			protected:
+				const SFileList::found_t getItemFromPath(const system::path& pathRelativeToArchive) const override;
+				core::smart_refctd_ptr<IFile> getFile_impl(const SFileList::found_t& found, const core::bitflag<IFileBase::E_CREATE_FLAGS> flags, const std::string_view& password) override;
+
+			private:
+				class CEntryFile;
+
+				inline std::string_view getName(const SNablaPackFormat::SIndexEntry& entry) const
+				{
+					// a corrupt index shouldn't let us read outside the names blob
+					if (uint64_t(entry.nameOffset)+entry.nameLength>m_names.size())
+						return {};
+					return m_names.substr(entry.nameOffset,entry.nameLength);
+				}
+				SFileList::SEntry makeListEntry(const SNablaPackFormat::SIndexEntry& entry) const;
+
+				core::smart_refctd_ptr<IFile> m_file;
+				// both point into the mapped `m_file`
+				const std::span<const SNablaPackFormat::SIndexEntry> m_index;
+				const std::string_view m_names;
+				mutable std::once_flag m_listBuilt;
+		};
+
+		CArchiveLoaderNPK(system::logger_opt_smart_ptr&& logger) : IArchiveLoader(std::move(logger)) {}
+
+		bool isALoadableFileFormat(IFile* file) const override;
+
+		inline const char** getAssociatedFileExtensions() const override
+		{
+			static const char* ext[]{ "npk", nullptr };
+			return ext;
+		}
+
+	private:
+		core::smart_refctd_ptr<IFileArchive> createArchive_impl(core::smart_refctd_ptr<system::IFile>&& file, const std::string_view& password) const override;
+};
+
+}
+#endif
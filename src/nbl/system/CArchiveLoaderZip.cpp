@@ -9,6 +9,10 @@
 
 #include <bzip2/bzlib.h>
 
+#include "nbl/system/threadLocalDecompressor.h"
+
+#include <mutex>
+
 
 #include "nbl/nblpack.h"
 struct SZIPFileCentralDirFileHeader
@@ -93,6 +97,7 @@ using namespace nbl;
 using namespace nbl::system;
 
 
+
 core::smart_refctd_ptr<IFileArchive> CArchiveLoaderZip::createArchive_impl(core::smart_refctd_ptr<system::IFile>&& file, const std::string_view& password) const
 {
 	if (!file)
@@ -205,18 +210,14 @@ core::smart_refctd_ptr<IFileArchive> CArchiveLoaderZip::createArchive_impl(core:
 			const size_t itemOffset = offset;
 			
 			offset += header.DataDescriptor.CompressedSize;
-			// read CRC
+			// read CRC and uncompressed size in one go
 			{
+				const IFile::SReadRange trailer[2] = {
+					{&header.DataDescriptor.CRC32,offset,sizeof(header.DataDescriptor.CRC32)},
+					{&header.DataDescriptor.UncompressedSize,offset+sizeof(header.DataDescriptor.CRC32),sizeof(header.DataDescriptor.UncompressedSize)}
+				};
 				IFile::success_t success;
-				file->read(success,&header.DataDescriptor.CRC32,offset,sizeof(header.DataDescriptor.CRC32));
-				if (!success)
-					return nullptr;
-				offset += success.getBytesToProcess();
-			}
-			// read uncompressed size
-			{
-				IFile::success_t success;
-				file->read(success,&header.DataDescriptor.UncompressedSize,offset,sizeof(header.DataDescriptor.UncompressedSize));
+				file->readBatch(success,trailer);
 				if (!success)
 					return nullptr;
 				offset += success.getBytesToProcess();
@@ -367,6 +368,273 @@ bool CFileArchiveZip::scanCentralDirectoryHeader(size_t& offset)
 }
 #endif
 
+//! Read-only view of a raw deflate stream which only inflates what gets read.
+// Access points (bit position in the compressed data + the preceding 32kb window) get recorded at deflate block boundaries
+// as the stream is inflated forward, so a later `read` at a random offset only needs to inflate from the closest one.
+// Partially read chunks are kept in a small LRU so that parsers nibbling at a file don't inflate the same bytes over and over.
+class CArchiveLoaderZip::CInflatingFile final : public IFile
+{
+	public:
+		constexpr static inline size_t ChunkSize = 64ull<<10ull;
+		constexpr static inline uint32_t MaxCachedChunks = 8u;
+		constexpr static inline size_t SeekPointSpacing = 1ull<<20ull;
+		constexpr static inline size_t WindowSize = 32ull<<10ull;
+
+		inline CInflatingFile(core::smart_refctd_ptr<IFile>&& archiveFile, path&& _name, const time_point_t _initialModified, const size_t compressedOffset, const size_t compressedSize, const size_t uncompressedSize)
+			: IFile(std::move(_name),ECF_READ,_initialModified), m_archiveFile(std::move(archiveFile)),
+			m_compressed(reinterpret_cast<const uint8_t*>(m_archiveFile->getMappedPointer())+compressedOffset), m_compressedSize(compressedSize), m_size(uncompressedSize)
+		{
+		}
+
+		inline size_t getSize() const override {return m_size;}
+
+	protected:
+		~CInflatingFile()
+		{
+		#ifdef _NBL_COMPILE_WITH_ZLIB_
+			if (m_cursor.valid)
+				inflateEnd(&m_cursor.stream);
+		#endif
+		}
+
+		inline void* getMappedPointer_impl() override {return nullptr;}
+		inline const void* getMappedPointer_impl() const override {return nullptr;}
+
+		void unmappedRead(ISystem::future_t<size_t>& fut, void* buffer, size_t offset, size_t sizeToRead) override;
+
+	private:
+	#ifdef _NBL_COMPILE_WITH_ZLIB_
+		struct SSeekPoint
+		{
+			size_t uncompressedOffset;
+			size_t compressedOffset;
+			// bits of the byte before `compressedOffset` which still belong to the next block
+			uint8_t bits;
+			uint8_t window[WindowSize];
+		};
+		struct SCachedChunk
+		{
+			size_t index = ~0ull;
+			uint64_t lastUse = 0ull;
+			core::vector<uint8_t> data;
+		};
+
+		bool resetCursor(const SSeekPoint* from);
+		// inflates `[begin,end)` into `dst`, resuming the previous inflate if nothing closer is known
+		bool inflateRange(const size_t begin, const size_t end, uint8_t* dst);
+		const uint8_t* getChunk(const size_t chunkIx);
+	#endif
+
+		const core::smart_refctd_ptr<IFile> m_archiveFile;
+		const uint8_t* const m_compressed;
+		const size_t m_compressedSize;
+		const size_t m_size;
+
+		std::mutex m_mutex;
+	#ifdef _NBL_COMPILE_WITH_ZLIB_
+		struct
+		{
+			z_stream stream;
+			size_t uncompressedOffset = 0ull;
+			bool valid = false;
+			uint8_t window[WindowSize];
+		} m_cursor;
+		core::vector<std::unique_ptr<SSeekPoint>> m_seekPoints;
+		std::array<SCachedChunk,MaxCachedChunks> m_chunks;
+		uint64_t m_useCounter = 0ull;
+	#endif
+};
+
+void CArchiveLoaderZip::CInflatingFile::unmappedRead(ISystem::future_t<size_t>& fut, void* buffer, size_t offset, size_t sizeToRead)
+{
+#ifdef _NBL_COMPILE_WITH_ZLIB_
+	if (offset>=m_size)
+	{
+		set_result(fut,0ull);
+		return;
+	}
+	sizeToRead = std::min(sizeToRead,m_size-offset);
+
+	std::unique_lock lock(m_mutex);
+	auto* const out = reinterpret_cast<uint8_t*>(buffer);
+	const size_t end = offset+sizeToRead;
+	size_t bytesRead = 0ull;
+	for (size_t chunkIx=offset/ChunkSize; offset+bytesRead<end; chunkIx++)
+	{
+		const size_t chunkBegin = chunkIx*ChunkSize;
+		const size_t chunkEnd = std::min(chunkBegin+ChunkSize,m_size);
+		const size_t pieceBegin = offset+bytesRead;
+		const size_t pieceEnd = std::min(end,chunkEnd);
+		// whole chunks go straight into the caller's memory, no point caching what they already have
+		if (pieceBegin==chunkBegin && pieceEnd==chunkEnd)
+		{
+			if (!inflateRange(chunkBegin,chunkEnd,out+bytesRead))
+				break;
+		}
+		else
+		{
+			const uint8_t* chunk = getChunk(chunkIx);
+			if (!chunk)
+				break;
+			memcpy(out+bytesRead,chunk+(pieceBegin-chunkBegin),pieceEnd-pieceBegin);
+		}
+		bytesRead += pieceEnd-pieceBegin;
+	}
+	lock.unlock();
+	set_result(fut,bytesRead);
+#else
+	set_result(fut,0ull);
+#endif
+}
+
+#ifdef _NBL_COMPILE_WITH_ZLIB_
+bool CArchiveLoaderZip::CInflatingFile::resetCursor(const SSeekPoint* from)
+{
+	auto& strm = m_cursor.stream;
+	if (m_cursor.valid)
+		inflateEnd(&strm);
+	m_cursor.valid = false;
+
+	memset(&strm,0,sizeof(strm));
+	// raw deflate, no zlib header
+	if (inflateInit2(&strm,-MAX_WBITS)!=Z_OK)
+		return false;
+	size_t compressedOffset = 0ull;
+	m_cursor.uncompressedOffset = 0ull;
+	if (from)
+	{
+		compressedOffset = from->compressedOffset;
+		m_cursor.uncompressedOffset = from->uncompressedOffset;
+		if (from->bits && inflatePrime(&strm,from->bits,m_compressed[compressedOffset-1ull]>>(8u-from->bits))!=Z_OK)
+			return false;
+	}
+	strm.next_in = const_cast<Bytef*>(m_compressed+compressedOffset);
+	strm.avail_in = static_cast<uInt>(m_compressedSize-compressedOffset);
+	if (from && inflateSetDictionary(&strm,from->window,WindowSize)!=Z_OK)
+		return false;
+	strm.avail_out = 0u;
+	m_cursor.valid = true;
+	return true;
+}
+
+bool CArchiveLoaderZip::CInflatingFile::inflateRange(const size_t begin, const size_t end, uint8_t* dst)
+{
+	// closest known access point, the cursor itself counts if its between that and `begin`
+	const SSeekPoint* closest = nullptr;
+	{
+		auto found = std::upper_bound(m_seekPoints.begin(),m_seekPoints.end(),begin,[](const size_t offset, const auto& point)->bool{return offset<point->uncompressedOffset;});
+		if (found!=m_seekPoints.begin())
+			closest = (--found)->get();
+	}
+	const bool cursorUsable = m_cursor.valid && m_cursor.uncompressedOffset<=begin && (!closest || closest->uncompressedOffset<=m_cursor.uncompressedOffset);
+	if (!cursorUsable && !resetCursor(closest))
+		return false;
+
+	auto& strm = m_cursor.stream;
+	size_t& pos = m_cursor.uncompressedOffset;
+	while (pos<end)
+	{
+		// output goes through the window so we always have the last 32kb for the next access point
+		if (strm.avail_out==0u)
+		{
+			strm.next_out = m_cursor.window;
+			strm.avail_out = WindowSize;
+		}
+		const uint8_t* const produced = strm.next_out;
+		const uInt availIn = strm.avail_in;
+		const int err = inflate(&strm,Z_BLOCK);
+		const size_t producedCount = strm.next_out-produced;
+		const bool stalled = err==Z_OK && producedCount==0ull && availIn==strm.avail_in;
+		if ((err!=Z_OK && err!=Z_STREAM_END) || stalled)
+		{
+			inflateEnd(&strm);
+			m_cursor.valid = false;
+			return false;
+		}
+
+		// copy out whatever overlaps the requested range
+		const size_t copyBegin = std::max(pos,begin);
+		const size_t copyEnd = std::min(pos+producedCount,end);
+		if (copyBegin<copyEnd)
+			memcpy(dst+(copyBegin-begin),produced+(copyBegin-pos),copyEnd-copyBegin);
+		pos += producedCount;
+
+		if (err==Z_STREAM_END)
+		{
+			// never resume a finished stream
+			inflateEnd(&strm);
+			m_cursor.valid = false;
+			return pos>=end;
+		}
+
+		// at a block boundary which isn't the last block, record a new access point if we've gone far enough past the last one
+		if ((strm.data_type&128) && !(strm.data_type&64))
+		{
+			const size_t lastIndexed = m_seekPoints.empty() ? 0ull:m_seekPoints.back()->uncompressedOffset;
+			if (pos>=lastIndexed+SeekPointSpacing)
+			{
+				auto& point = m_seekPoints.emplace_back(std::make_unique<SSeekPoint>());
+				point->uncompressedOffset = pos;
+				point->compressedOffset = reinterpret_cast<const uint8_t*>(strm.next_in)-m_compressed;
+				point->bits = strm.data_type&7;
+				// unroll the circular window so it ends at `pos`
+				const size_t left = strm.avail_out;
+				if (left)
+					memcpy(point->window,m_cursor.window+WindowSize-left,left);
+				if (left<WindowSize)
+					memcpy(point->window+left,m_cursor.window,WindowSize-left);
+			}
+		}
+	}
+	return true;
+}
+
+const uint8_t* CArchiveLoaderZip::CInflatingFile::getChunk(const size_t chunkIx)
+{
+	m_useCounter++;
+	SCachedChunk* victim = m_chunks.data();
+	for (auto& chunk : m_chunks)
+	{
+		if (chunk.index==chunkIx)
+		{
+			chunk.lastUse = m_useCounter;
+			return chunk.data.data();
+		}
+		if (chunk.lastUse<victim->lastUse)
+			victim = &chunk;
+	}
+
+	const size_t chunkBegin = chunkIx*ChunkSize;
+	const size_t chunkEnd = std::min(chunkBegin+ChunkSize,m_size);
+	victim->data.resize(ChunkSize);
+	victim->index = ~0ull;
+	victim->lastUse = 0ull;
+	if (!inflateRange(chunkBegin,chunkEnd,victim->data.data()))
+		return nullptr;
+	victim->index = chunkIx;
+	victim->lastUse = m_useCounter;
+	return victim->data.data();
+}
+#endif
+
+core::smart_refctd_ptr<IFile> CArchiveLoaderZip::CArchive::getFile_impl(const SFileList::found_t& found, const core::bitflag<IFile::E_CREATE_FLAGS> flags, const std::string_view& password)
+{
+#ifdef _NBL_COMPILE_WITH_ZLIB_
+	const auto& header = m_itemsMetadata[found->ID];
+	// anything encrypted or not deflated still gets decompressed in full by `getFileBuffer`, same for small entries where it doesn't pay off
+	const bool streamable = header.CompressionMethod==8 && !(header.GeneralBitFlag&ZIP_FILE_ENCRYPTED) && found->size>=MinStreamedEntrySize;
+	if (streamable && m_file->getMappedPointer())
+	{
+		assert(!flags.hasFlags(IFile::ECF_WRITE));
+		return core::make_smart_refctd_ptr<CInflatingFile>(
+			core::smart_refctd_ptr(m_file),getDefaultAbsolutePath()/found->pathRelativeToArchive,m_file->getLastWriteTime(),
+			found->offset,header.DataDescriptor.CompressedSize,found->size
+		);
+	}
+#endif
+	return CFileArchive::getFile_impl(found,flags,password);
+}
+
 CFileArchive::file_buffer_t CArchiveLoaderZip::CArchive::getFileBuffer(const IFileArchive::SFileList::found_t& item)
 {
 	const auto& header = m_itemsMetadata[item->ID];
@@ -506,6 +774,19 @@ CFileArchive::file_buffer_t CArchiveLoaderZip::CArchive::getFileBuffer(const IFi
 			break;
 		case 8:
 		{
+		#ifdef _NBL_COMPILE_WITH_LIBDEFLATE_
+			// we know the uncompressed size, so the whole entry can be inflated in one go which is a lot faster than zlib
+			if (auto* decompressor=impl::getThreadLocalDecompressor())
+			{
+				const auto result = libdeflate_deflate_decompress(decompressor,decrypted ? decrypted:mmapPtr,decryptedSize,decompressed,item->size,nullptr);
+				if (result==LIBDEFLATE_SUCCESS)
+				{
+					retval.buffer = decompressed;
+					break;
+				}
+			}
+			// the sizes in the header could be lying, let zlib have a go
+		#endif
 		#ifdef _NBL_COMPILE_WITH_ZLIB_
 			// Setup the inflate stream.
 			z_stream stream;
@@ -45,6 +45,10 @@ class CArchiveLoaderZip final : public IArchiveLoader
 					m_file(std::move(_file)), m_itemsMetadata(std::move(_itemsMetadata)), m_password("")
 				{}
 
+			protected:
+				// deflated entries get streamed instead of inflated upfront
+				core::smart_refctd_ptr<IFile> getFile_impl(const SFileList::found_t& found, const core::bitflag<IFile::E_CREATE_FLAGS> flags, const std::string_view& password) override;
+
 			private:
 				file_buffer_t getFileBuffer(const IFileArchive::SFileList::found_t& item) override;
 
@@ -53,6 +57,9 @@ class CArchiveLoaderZip final : public IArchiveLoader
 				const std::string m_password; // TODO password
 		};
 
+		//! Entries at least this large which are plainly deflated (no encryption) get decompressed lazily on `read`
+		constexpr static inline size_t MinStreamedEntrySize = 256ull<<10ull;
+
 		CArchiveLoaderZip(system::logger_opt_smart_ptr&& logger) : IArchiveLoader(std::move(logger)) {}
 
 		inline bool isALoadableFileFormat(IFile* file) const override
@@ -74,6 +81,8 @@ class CArchiveLoaderZip final : public IArchiveLoader
 		}
 
 	private:
+		class CInflatingFile;
+
 		core::smart_refctd_ptr<IFileArchive> createArchive_impl(core::smart_refctd_ptr<system::IFile>&& file, const std::string_view& password) const override;
 };
 
@@ -6,6 +6,8 @@ using namespace nbl::system;
 #include <unistd.h>
 #include <sys/mman.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <climits>
 
 CFilePOSIX::CFilePOSIX(
 	core::smart_refctd_ptr<ISystem>&& sys,
@@ -26,15 +28,44 @@ CFilePOSIX::~CFilePOSIX()
 	close(m_native);
 }
 
+// positional I/O never touches the shared file offset, so the same file can be serviced by many I/O workers at once
 size_t CFilePOSIX::asyncRead(void* buffer, size_t offset, size_t sizeToRead)
 {
-	lseek(m_native, offset, SEEK_SET);
-	return ::read(m_native, buffer, sizeToRead);
+	const ssize_t bytesRead = ::pread(m_native,buffer,sizeToRead,offset);
+	return bytesRead>0 ? static_cast<size_t>(bytesRead):0ull;
+}
+
+size_t CFilePOSIX::asyncReadv(const std::span<const SReadRange> ranges)
+{
+	size_t bytesRead = 0ull;
+	// ranges which follow each other back-to-back in the file get serviced by a single `preadv`
+	iovec iov[IOV_MAX];
+	for (auto it=ranges.begin(); it!=ranges.end();)
+	{
+		const size_t runOffset = it->offset;
+		size_t runSize = 0ull;
+		int iovCount = 0;
+		do
+		{
+			iov[iovCount].iov_base = it->buffer;
+			iov[iovCount++].iov_len = it->size;
+			runSize += (it++)->size;
+		} while (it!=ranges.end() && it->offset==runOffset+runSize && iovCount<IOV_MAX);
+
+		ssize_t runBytesRead;
+		if (iovCount>1)
+			runBytesRead = ::preadv(m_native,iov,iovCount,runOffset);
+		else
+			runBytesRead = ::pread(m_native,iov[0].iov_base,iov[0].iov_len,runOffset);
+		if (runBytesRead>0)
+			bytesRead += static_cast<size_t>(runBytesRead);
+	}
+	return bytesRead;
 }
 
 size_t CFilePOSIX::asyncWrite(const void* buffer, size_t offset, size_t sizeToWrite)
 {
-	lseek(m_native, offset, SEEK_SET);
-	return ::write(m_native, buffer, sizeToWrite);
+	const ssize_t bytesWritten = ::pwrite(m_native,buffer,sizeToWrite,offset);
+	return bytesWritten>0 ? static_cast<size_t>(bytesWritten):0ull;
 }
 #endif
\ No newline at end of file
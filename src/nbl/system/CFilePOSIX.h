@@ -29,10 +29,9 @@ class CFilePOSIX : public ISystemFile
 		//
 		size_t asyncRead(void* buffer, size_t offset, size_t sizeToRead) override;
 		size_t asyncWrite(const void* buffer, size_t offset, size_t sizeToWrite) override;
+		size_t asyncReadv(const std::span<const SReadRange> ranges) override;
 
 	private:
-		void seek(const size_t bytesFromBeginningOfFile);
-
 		const size_t m_size; // this is wrong!
 		const native_file_handle_t m_native;
 };
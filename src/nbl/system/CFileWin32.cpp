@@ -55,25 +55,27 @@ inline size_t CFileWin32::getSize() const
 	return (size_t(hi)<<32ull)|lo;
 }
 
+// passing the offset through an OVERLAPPED on a synchronous handle makes the I/O positional, so we don't race on the file pointer
+static inline OVERLAPPED makePositionalOverlapped(const size_t offset)
+{
+	OVERLAPPED overlapped = {};
+	overlapped.Offset = LODWORD(offset);
+	overlapped.OffsetHigh = HIDWORD(offset);
+	return overlapped;
+}
+
 size_t CFileWin32::asyncRead(void* buffer, size_t offset, size_t sizeToRead)
 {
-	seek(offset);
-	DWORD numOfBytesRead;
-	ReadFile(m_native, buffer, sizeToRead, &numOfBytesRead, nullptr);
+	OVERLAPPED overlapped = makePositionalOverlapped(offset);
+	DWORD numOfBytesRead = 0;
+	ReadFile(m_native, buffer, sizeToRead, &numOfBytesRead, &overlapped);
 	return numOfBytesRead;
 }
 size_t CFileWin32::asyncWrite(const void* buffer, size_t offset, size_t sizeToWrite)
 {
-	seek(offset);
-	DWORD numOfBytesWritten;
-	WriteFile(m_native, buffer, sizeToWrite, &numOfBytesWritten, nullptr);
+	OVERLAPPED overlapped = makePositionalOverlapped(offset);
+	DWORD numOfBytesWritten = 0;
+	WriteFile(m_native, buffer, sizeToWrite, &numOfBytesWritten, &overlapped);
 	return numOfBytesWritten;
 }
-
-
-void CFileWin32::seek(size_t position)
-{
-	LONG hiDword = HIDWORD(position);
-	SetFilePointer(m_native,position,&hiDword,FILE_BEGIN);
-}
 #endif
\ No newline at end of file
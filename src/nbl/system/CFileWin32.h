@@ -32,8 +32,6 @@ class CFileWin32 : public ISystemFile
 		size_t asyncWrite(const void* buffer, size_t offset, size_t sizeToWrite) override;
 
 	private:
-		void seek(const size_t bytesFromBeginningOfFile);
-
 		HANDLE m_native;
 		HANDLE m_fileMappingObj;
 };
@@ -0,0 +1,68 @@
+#include "nbl/system/CMappedFileMemoryResource.h"
+
+using namespace nbl;
+using namespace nbl::system;
+
+#if defined(_NBL_PLATFORM_LINUX_) || defined(_NBL_PLATFORM_ANDROID_)
+#include <sys/mman.h>
+#include <unistd.h>
+#elif defined(_NBL_PLATFORM_WINDOWS_)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+core::smart_refctd_ptr<CMappedFileMemoryResource> CMappedFileMemoryResource::create(core::smart_refctd_ptr<IFile>&& file)
+{
+	if (!file)
+		return nullptr;
+	const auto flags = core::bitflag(file->getFlags());
+	if (!flags.hasFlags(IFile::ECF_COPY_ON_WRITE) && !flags.hasFlags(IFile::ECF_WRITE))
+		return nullptr;
+	// the const overload is the one which hands out read-only mappings
+	const IFile* constFile = file.get();
+	auto* mapping = reinterpret_cast<std::byte*>(const_cast<void*>(constFile->getMappedPointer()));
+	if (!mapping)
+		return nullptr;
+	return core::smart_refctd_ptr<CMappedFileMemoryResource>(new CMappedFileMemoryResource(std::move(file),mapping),core::dont_grab);
+}
+
+void* CMappedFileMemoryResource::getRegion(const size_t offset, const size_t size, const E_ACCESS_PATTERN pattern) const
+{
+	if (offset+size>m_file->getSize() || offset+size<offset)
+		return nullptr;
+
+	std::byte* const region = m_mapping+offset;
+	if (pattern!=E_ACCESS_PATTERN::NORMAL && size)
+	{
+	#if defined(_NBL_PLATFORM_LINUX_) || defined(_NBL_PLATFORM_ANDROID_)
+		// advice has to start on a page boundary
+		const size_t pageSize = sysconf(_SC_PAGESIZE);
+		const size_t alignedOffset = offset&~(pageSize-1ull);
+		int advice = POSIX_MADV_NORMAL;
+		switch (pattern)
+		{
+			case E_ACCESS_PATTERN::SEQUENTIAL:
+				advice = POSIX_MADV_SEQUENTIAL;
+				break;
+			case E_ACCESS_PATTERN::RANDOM:
+				advice = POSIX_MADV_RANDOM;
+				break;
+			case E_ACCESS_PATTERN::WILL_NEED:
+				advice = POSIX_MADV_WILLNEED;
+				break;
+			default:
+				break;
+		}
+		// its just a hint, failure is not an error
+		posix_madvise(m_mapping+alignedOffset,offset+size-alignedOffset,advice);
+	#elif defined(_NBL_PLATFORM_WINDOWS_)
+		// Windows only has an equivalent of `WILLNEED`
+		if (pattern==E_ACCESS_PATTERN::WILL_NEED)
+		{
+			WIN32_MEMORY_RANGE_ENTRY range = {region,size};
+			PrefetchVirtualMemory(GetCurrentProcess(),1,&range,0);
+		}
+	#endif
+	}
+	return region;
+}
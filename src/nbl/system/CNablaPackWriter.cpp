@@ -0,0 +1,217 @@
+#include "nbl/system/CNablaPackWriter.h"
+
+#include "nbl/core/execution.h"
+#include "nbl/core/hash/xxHash256.h"
+
+#include <lz4/lib/lz4.h>
+#include <lz4/lib/lz4hc.h>
+
+#ifdef _NBL_COMPILE_WITH_LIBDEFLATE_
+#include <libdeflate.h>
+#endif
+
+#include <numeric>
+
+
+using namespace nbl;
+using namespace nbl::system;
+
+
+bool CNablaPackWriter::addEntry(const path& pathRelativeToPack, core::smart_refctd_ptr<IFile>&& file, const E_CODEC codec)
+{
+	if (!file || !(file->getFlags()&IFileBase::ECF_READ))
+		return false;
+	switch (codec)
+	{
+		case E_CODEC::NONE:
+		case E_CODEC::LZ4:
+	#ifdef _NBL_COMPILE_WITH_LIBDEFLATE_
+		case E_CODEC::DEFLATE:
+	#endif
+			break;
+		default:
+			return false;
+	}
+	// duplicates only get caught in `write`, once everything is sorted
+	m_entries.push_back({pathRelativeToPack.generic_string(),std::move(file),codec});
+	return true;
+}
+
+bool CNablaPackWriter::write(IFile* output, const system::logger_opt_ptr logger) const
+{
+	if (!output || !(output->getFlags()&IFileBase::ECF_WRITE))
+		return false;
+	if (m_entries.size()>std::numeric_limits<uint32_t>::max())
+	{
+		logger.log("Too many entries for a single Nabla pack.",ILogger::ELL_ERROR);
+		return false;
+	}
+
+	struct SPrepared
+	{
+		SNablaPackFormat::SIndexEntry index = {};
+		// either the compressed contents, or a copy of uncompressed ones if the source file was not mappable
+		core::vector<std::byte> storage;
+		const std::byte* data = nullptr;
+	};
+	core::vector<SPrepared> prepared(m_entries.size());
+	std::atomic_bool failed = false;
+	core::for_each(core::execution::par,prepared.begin(),prepared.end(),[&](SPrepared& out)->void
+		{
+			const auto& entry = m_entries[std::distance(prepared.data(),&out)];
+			const size_t size = entry.file->getSize();
+
+			const std::byte* contents = reinterpret_cast<const std::byte*>(entry.file->getMappedPointer());
+			core::vector<std::byte> readBack;
+			if (!contents)
+			{
+				readBack.resize(size);
+				IFile::success_t success;
+				entry.file->read(success,readBack.data(),0ull,size);
+				if (!success)
+				{
+					logger.log("Failed to read %s",ILogger::ELL_ERROR,entry.file->getFileName().string().c_str());
+					failed = true;
+					return;
+				}
+				contents = readBack.data();
+			}
+
+			out.index.pathHash = SNablaPackFormat::hashPath(entry.genericPath);
+			out.index.size = size;
+			core::XXHash_256(contents,size,out.index.contentHash);
+
+			size_t compressedSize = 0ull;
+			switch (entry.codec)
+			{
+				case E_CODEC::LZ4:
+					if (size<=LZ4_MAX_INPUT_SIZE)
+					{
+						out.storage.resize(LZ4_compressBound(static_cast<int>(size)));
+						compressedSize = LZ4_compress_HC(reinterpret_cast<const char*>(contents),reinterpret_cast<char*>(out.storage.data()),static_cast<int>(size),static_cast<int>(out.storage.size()),LZ4HC_CLEVEL_DEFAULT);
+					}
+					break;
+			#ifdef _NBL_COMPILE_WITH_LIBDEFLATE_
+				case E_CODEC::DEFLATE:
+				{
+					// packing is offline, so we can afford a high level
+					thread_local std::unique_ptr<libdeflate_compressor,decltype(&libdeflate_free_compressor)> compressor(libdeflate_alloc_compressor(9),&libdeflate_free_compressor);
+					if (compressor)
+					{
+						out.storage.resize(libdeflate_deflate_compress_bound(compressor.get(),size));
+						compressedSize = libdeflate_deflate_compress(compressor.get(),contents,size,out.storage.data(),out.storage.size());
+					}
+					break;
+				}
+			#endif
+				default:
+					break;
+			}
+
+			// store whatever didn't compress, or compress well enough
+			if (compressedSize==0ull || compressedSize>=size)
+			{
+				out.index.codec = E_CODEC::NONE;
+				out.index.compressedSize = size;
+				if (readBack.empty())
+				{
+					out.storage.clear();
+					out.data = contents;
+				}
+				else
+				{
+					out.storage = std::move(readBack);
+					out.data = out.storage.data();
+				}
+			}
+			else
+			{
+				out.index.codec = entry.codec;
+				out.index.compressedSize = compressedSize;
+				out.storage.resize(compressedSize);
+				out.data = out.storage.data();
+			}
+		}
+	);
+	if (failed)
+		return false;
+
+	// the index is sorted by hash then by name, so a lookup is a binary search on the mapped index
+	core::vector<uint32_t> order(m_entries.size());
+	std::iota(order.begin(),order.end(),0u);
+	std::sort(order.begin(),order.end(),[&](const uint32_t lhs, const uint32_t rhs)->bool
+		{
+			const auto lhsHash = prepared[lhs].index.pathHash;
+			const auto rhsHash = prepared[rhs].index.pathHash;
+			if (lhsHash!=rhsHash)
+				return lhsHash<rhsHash;
+			return m_entries[lhs].genericPath<m_entries[rhs].genericPath;
+		}
+	);
+	for (size_t i=1ull; i<order.size(); i++)
+	if (m_entries[order[i-1ull]].genericPath==m_entries[order[i]].genericPath)
+	{
+		logger.log("Path %s was added to the Nabla pack more than once.",ILogger::ELL_ERROR,m_entries[order[i]].genericPath.c_str());
+		return false;
+	}
+
+	// layout
+	SNablaPackFormat::SHeader header = {};
+	header.entryCount = static_cast<uint32_t>(order.size());
+	header.indexOffset = sizeof(SNablaPackFormat::SHeader);
+	header.namesOffset = header.indexOffset+order.size()*sizeof(SNablaPackFormat::SIndexEntry);
+	for (const auto& entry : m_entries)
+	{
+		if (entry.genericPath.size()>std::numeric_limits<uint16_t>::max())
+		{
+			logger.log("Path %s is too long for a Nabla pack.",ILogger::ELL_ERROR,entry.genericPath.c_str());
+			return false;
+		}
+		header.namesSize += entry.genericPath.size();
+	}
+	if (header.namesSize>std::numeric_limits<uint32_t>::max())
+	{
+		logger.log("Paths are too long for a single Nabla pack.",ILogger::ELL_ERROR);
+		return false;
+	}
+
+	// header, index and names go out in one write
+	core::vector<std::byte> head(header.namesOffset+header.namesSize);
+	{
+		auto* const index = reinterpret_cast<SNablaPackFormat::SIndexEntry*>(head.data()+header.indexOffset);
+		char* const names = reinterpret_cast<char*>(head.data()+header.namesOffset);
+		uint64_t dataOffset = core::roundUp<uint64_t>(head.size(),SNablaPackFormat::EntryAlignment);
+		uint32_t nameOffset = 0u;
+		for (uint32_t i=0u; i<order.size(); i++)
+		{
+			const auto& path = m_entries[order[i]].genericPath;
+			auto& entry = prepared[order[i]].index;
+			entry.nameOffset = nameOffset;
+			entry.nameLength = static_cast<uint16_t>(path.size());
+			memcpy(names+nameOffset,path.data(),path.size());
+			nameOffset += entry.nameLength;
+			// empty entries don't get any space, otherwise trailing ones could point past the end of the file
+			entry.offset = entry.compressedSize ? dataOffset:0ull;
+			if (entry.compressedSize)
+				dataOffset = core::roundUp<uint64_t>(dataOffset+entry.compressedSize,SNablaPackFormat::EntryAlignment);
+			index[i] = entry;
+		}
+		memcpy(head.data(),&header,sizeof(header));
+	}
+	{
+		IFile::success_t success;
+		output->write(success,head.data(),0ull,head.size());
+		if (!success)
+			return false;
+	}
+	// the gaps between entries are left as holes
+	for (const auto& entry : prepared)
+	if (entry.index.compressedSize)
+	{
+		IFile::success_t success;
+		output->write(success,entry.data,entry.index.offset,entry.index.compressedSize);
+		if (!success)
+			return false;
+	}
+	return true;
+}
@@ -68,7 +68,8 @@ core::smart_refctd_ptr<ISystemFile> CSystemWin32::CCaller::createFile(const std:
         For now it equals the size of a file so it'll work fine for archive reading, but if we try to
         write outside those boungs, things will go bad.
         */
-        _fileMappingObj = CreateFileMappingA(_native,nullptr,writeAccess ? PAGE_READWRITE:PAGE_READONLY, 0, 0, filename.string().c_str());
+        const bool copyOnWrite = flags.hasFlags(IFile::ECF_COPY_ON_WRITE);
+        _fileMappingObj = CreateFileMappingA(_native,nullptr,writeAccess ? PAGE_READWRITE:(copyOnWrite ? PAGE_WRITECOPY:PAGE_READONLY), 0, 0, filename.string().c_str());
         if (!_fileMappingObj)
         {
             CloseHandle(_native);
@@ -80,7 +81,7 @@ core::smart_refctd_ptr<ISystemFile> CSystemWin32::CCaller::createFile(const std:
         switch (flags.value&IFile::ECF_READ_WRITE)
         {
             case IFile::ECF_READ:
-                _mappedPtr = MapViewOfFile(_fileMappingObj,FILE_MAP_READ,0,0,size);
+                _mappedPtr = MapViewOfFile(_fileMappingObj,copyOnWrite ? FILE_MAP_COPY:FILE_MAP_READ,0,0,size);
                 break;
             case IFile::ECF_WRITE:
                 _mappedPtr = MapViewOfFile(_fileMappingObj,FILE_MAP_WRITE,0,0,size);
@@ -101,4 +102,34 @@ core::smart_refctd_ptr<ISystemFile> CSystemWin32::CCaller::createFile(const std:
     }
     return core::make_smart_refctd_ptr<CFileWin32>(core::smart_refctd_ptr<ISystem>(m_system),path(filename),flags,_mappedPtr,_native,_fileMappingObj);
 }
+
+size_t CSystemWin32::CCaller::prefetch(const std::filesystem::path& filename, const size_t size)
+{
+    if (size==0ull)
+        return 0ull;
+    HANDLE _native = CreateFileA(filename.string().c_str(),FILE_GENERIC_READ,FILE_SHARE_READ,nullptr,OPEN_EXISTING,FILE_FLAG_SEQUENTIAL_SCAN,nullptr);
+    if (_native==INVALID_HANDLE_VALUE)
+        return 0ull;
+    size_t retval = 0ull;
+    // pages brought in for a view stay in the standby list after we unmap, so that's our page cache
+    if (HANDLE _fileMappingObj=CreateFileMappingA(_native,nullptr,PAGE_READONLY,0,0,nullptr))
+    {
+        if (void* _mappedPtr=MapViewOfFile(_fileMappingObj,FILE_MAP_READ,0,0,size))
+        {
+            // issue one big asynchronous read, then touch every page so we only report readiness once its all resident
+            WIN32_MEMORY_RANGE_ENTRY range = {_mappedPtr,size};
+            PrefetchVirtualMemory(GetCurrentProcess(),1,&range,0);
+            SYSTEM_INFO sysInfo;
+            GetSystemInfo(&sysInfo);
+            const volatile uint8_t* bytes = reinterpret_cast<const volatile uint8_t*>(_mappedPtr);
+            for (size_t offset=0ull; offset<size; offset+=sysInfo.dwPageSize)
+                bytes[offset];
+            retval = size;
+            UnmapViewOfFile(_mappedPtr);
+        }
+        CloseHandle(_fileMappingObj);
+    }
+    CloseHandle(_native);
+    return retval;
+}
 #endif
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include "nbl/system/IFile.h"
 
+#include "nbl/core/execution.h"
+
 using namespace nbl;
 using namespace nbl::system;
 
@@ -46,6 +48,19 @@ IFileArchive::SFileList IFileArchive::listAssets(path pathRelativeToArchive) con
 }
 
 
+core::vector<core::smart_refctd_ptr<IFile>> IFileArchive::prefetchEntries(const std::span<const path> pathsRelativeToArchive, const std::string_view& password)
+{
+	core::vector<core::smart_refctd_ptr<IFile>> retval(pathsRelativeToArchive.size());
+	// `getFile_impl` is already safe to call concurrently, so every worker just inflates whatever entry it picks up
+	core::for_each(core::execution::par,retval.begin(),retval.end(),[&](core::smart_refctd_ptr<IFile>& file)->void
+		{
+			file = getFile(pathsRelativeToArchive[std::distance(retval.data(),&file)],IFileBase::ECF_READ,password);
+		}
+	);
+	return retval;
+}
+
+
 core::smart_refctd_ptr<IFileArchive> IArchiveLoader::createArchive(core::smart_refctd_ptr<IFile>&& file, const std::string_view& password) const
 {
 	if (!(file->getFlags()&IFile::ECF_READ))
@@ -10,15 +10,22 @@
 
 #include "nbl/system/CArchiveLoaderZip.h"
 #include "nbl/system/CArchiveLoaderTar.h"
+#include "nbl/system/CArchiveLoaderNPK.h"
 #include "nbl/system/CMountDirectoryArchive.h"
 
 using namespace nbl;
 using namespace nbl::system;
 
-ISystem::ISystem(core::smart_refctd_ptr<ISystem::ICaller>&& caller) : m_dispatcher(std::move(caller))
+ISystem::ISystem(core::smart_refctd_ptr<ISystem::ICaller>&& caller) : m_dispatcher(core::smart_refctd_ptr(caller))
 {
+    const uint32_t ioWorkerCount = caller->getIOWorkerCount();
+    m_ioWorkers.reserve(ioWorkerCount);
+    for (uint32_t i=0u; i<ioWorkerCount; i++)
+        m_ioWorkers.push_back(std::make_unique<CAsyncQueue>(core::smart_refctd_ptr(caller)));
+
     addArchiveLoader(core::make_smart_refctd_ptr<CArchiveLoaderZip>(nullptr));
     addArchiveLoader(core::make_smart_refctd_ptr<CArchiveLoaderTar>(nullptr));
+    addArchiveLoader(core::make_smart_refctd_ptr<CArchiveLoaderNPK>(nullptr));
     
     #ifdef NBL_EMBED_BUILTIN_RESOURCES
     mount(core::make_smart_refctd_ptr<nbl::builtin::CArchive>(nullptr));
@@ -228,6 +235,43 @@ void ISystem::createFile(future_t<core::smart_refctd_ptr<IFile>>& future, std::f
     m_dispatcher.request(&future,params);
 }
 
+void ISystem::prefetch(std::span<future_t<size_t>> readiness, std::span<const path> files, const size_t byteBudget)
+{
+    assert(readiness.size()>=files.size());
+    size_t budgetLeft = byteBudget;
+    for (size_t i=0ull; i<files.size(); i++)
+    {
+        auto& future = readiness[i];
+        // archive contents come from the mapping of the archive itself
+        std::error_code ec;
+        const auto filename = std::filesystem::absolute(files[i],ec).generic_string();
+        if (ec || filename.size()>=MAX_FILENAME_LENGTH || findFileInArchive(filename).archive)
+        {
+            future.set_result(0ull);
+            continue;
+        }
+        const size_t size = std::filesystem::file_size(filename,ec);
+        if (ec)
+        {
+            future.set_result(0ull);
+            continue;
+        }
+        // out of budget, skip this file and all the ones after it
+        if (size>budgetLeft)
+        {
+            for (size_t j=i; j<files.size(); j++)
+                readiness[j].set_result(0ull);
+            break;
+        }
+        budgetLeft -= size;
+
+        SRequestParams_PREFETCH params;
+        strcpy(params.filename,filename.c_str());
+        params.size = size;
+        requestIO(&future,params);
+    }
+}
+
 core::smart_refctd_ptr<IFileArchive> ISystem::openFileArchive(core::smart_refctd_ptr<IFile>&& file, const std::string_view& password)
 {
     // the file backing the archive needs to be readable
@@ -265,11 +309,7 @@ ISystem::FoundArchiveFile ISystem::findFileInArchive(const system::path& absolut
         for (auto& archive : archives)
         {
             const auto relative = std::filesystem::relative(absolutePath,path);
-            const auto items = static_cast<IFileArchive::SFileList::range_t>(archive.second->listAssets());
-
-            const IFileArchive::SFileList::SEntry itemToFind = { relative };
-            auto found = std::lower_bound(items.begin(), items.end(), itemToFind);
-            if (found!=items.end() && found->pathRelativeToArchive==relative)
+            if (archive.second->exists(relative))
                 return {archive.second.get(),relative};
         }
         path = path.parent_path();
@@ -289,10 +329,57 @@ void ISystem::SRequestParams_CREATE_FILE::operator()(core::StorageTrivializer<re
 {
     retval->construct(_caller->createFile(filename,flags));
 }
+void ISystem::SRequestParams_PREFETCH::operator()(core::StorageTrivializer<retval_t>* retval, ICaller* _caller)
+{
+    retval->construct(_caller->prefetch(filename,size));
+}
 void ISystem::SRequestParams_READ::operator()(core::StorageTrivializer<retval_t>* retval, ICaller* _caller)
 {
     retval->construct(file->asyncRead(buffer,offset,size));
 }
+void ISystem::SRequestParams_READV::operator()(core::StorageTrivializer<retval_t>* retval, ICaller* _caller)
+{
+    retval->construct(file->asyncReadv({ranges,count}));
+}
+void ISystem::SRequestParams_READ_BATCH::operator()(core::StorageTrivializer<retval_t>* retval, ICaller* _caller)
+{
+    // sort without touching the user's array
+    core::vector<const IFileBase::SReadRange*> sorted(count);
+    for (size_t i=0ull; i<count; i++)
+        sorted[i] = ranges+i;
+    std::sort(sorted.begin(),sorted.end(),[](const IFileBase::SReadRange* lhs, const IFileBase::SReadRange* rhs)->bool{return lhs->offset<rhs->offset;});
+
+    size_t bytesRead = 0ull;
+    core::vector<std::byte> staging;
+    for (auto it=sorted.begin(); it!=sorted.end();)
+    {
+        const auto runBegin = it;
+        const size_t runOffset = (*it)->offset;
+        size_t runEnd = runOffset+(*it)->size;
+        while (++it!=sorted.end() && (*it)->offset<=runEnd+MaxCoalescingGap)
+            runEnd = std::max(runEnd,(*it)->offset+(*it)->size);
+
+        // nothing to coalesce, read straight into the destination
+        if (std::distance(runBegin,it)==1)
+        {
+            bytesRead += file->asyncRead((*runBegin)->buffer,runOffset,(*runBegin)->size);
+            continue;
+        }
+
+        staging.resize(runEnd-runOffset);
+        const size_t runBytesRead = file->asyncRead(staging.data(),runOffset,staging.size());
+        for (auto range=runBegin; range!=it; range++)
+        {
+            const size_t stagingOffset = (*range)->offset-runOffset;
+            if (stagingOffset>=runBytesRead)
+                continue;
+            const size_t size = std::min((*range)->size,runBytesRead-stagingOffset);
+            memcpy((*range)->buffer,staging.data()+stagingOffset,size);
+            bytesRead += size;
+        }
+    }
+    retval->construct(bytesRead);
+}
 void ISystem::SRequestParams_WRITE::operator()(core::StorageTrivializer<retval_t>* retval, ICaller* _caller)
 {
     retval->construct(file->asyncWrite(buffer,offset,size));
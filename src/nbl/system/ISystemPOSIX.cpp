@@ -11,6 +11,7 @@ using namespace nbl::system;
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 core::smart_refctd_ptr<ISystemFile> ISystemPOSIX::CCaller::createFile(const std::filesystem::path& filename, const core::bitflag<IFile::E_CREATE_FLAGS> flags)
 {	
@@ -65,7 +66,9 @@ core::smart_refctd_ptr<ISystemFile> ISystemPOSIX::CCaller::createFile(const std:
 	void* _mappedPtr = nullptr;
 	if (flags.value & IFile::ECF_MAPPABLE)
 	{
-		const int mappingFlags = ((flags.value&IFile::ECF_READ) ? PROT_READ:0)|(writeAccess ? PROT_WRITE:0);
+		// being MAP_PRIVATE, writes through a copy-on-write mapping never reach the file
+		const bool copyOnWrite = flags.hasFlags(IFile::ECF_COPY_ON_WRITE);
+		const int mappingFlags = ((flags.value&IFile::ECF_READ) ? PROT_READ:0)|(writeAccess||copyOnWrite ? PROT_WRITE:0);
 		_mappedPtr = mmap((caddr_t)0, _size, mappingFlags, MAP_PRIVATE, _native, 0);
 		if (_mappedPtr==MAP_FAILED)
 		{
@@ -76,4 +79,24 @@ core::smart_refctd_ptr<ISystemFile> ISystemPOSIX::CCaller::createFile(const std:
 
 	return core::make_smart_refctd_ptr<CFilePOSIX>(core::smart_refctd_ptr<ISystem>(m_system),path(filename),flags,_mappedPtr,_size,_native);
 }
+
+size_t ISystemPOSIX::CCaller::prefetch(const std::filesystem::path& filename, const size_t size)
+{
+	const int fd = open(filename.string().c_str(),O_RDONLY|O_LARGEFILE);
+	if (fd<0)
+		return 0ull;
+	size_t retval = 0ull;
+	// only schedules asynchronous readahead of the whole range, neither call waits for the data to land in the page cache,
+	// on Linux `readahead` just makes the kernel start the reads right away instead of whenever it feels like acting on the hint
+	if (posix_fadvise(fd,0,size,POSIX_FADV_WILLNEED)==0)
+	{
+		retval = size;
+	#ifdef _NBL_PLATFORM_LINUX_
+		if (readahead(fd,0,size)!=0)
+			retval = 0ull;
+	#endif
+	}
+	close(fd);
+	return retval;
+}
 #endif
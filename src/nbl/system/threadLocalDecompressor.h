@@ -0,0 +1,27 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef _NBL_SYSTEM_THREAD_LOCAL_DECOMPRESSOR_H_INCLUDED_
+#define _NBL_SYSTEM_THREAD_LOCAL_DECOMPRESSOR_H_INCLUDED_
+
+// private to the engine sources which inflate with libdeflate (archive loaders, PNG and KTX2 loaders), relies on the compile config already being included
+#ifdef _NBL_COMPILE_WITH_LIBDEFLATE_
+#include <libdeflate.h>
+
+#include <memory>
+
+namespace nbl::system::impl
+{
+
+//! Allocating a decompressor isn't free and they can't be shared between threads, so every thread keeps one around, nullptr if the allocation failed
+inline libdeflate_decompressor* getThreadLocalDecompressor()
+{
+	thread_local std::unique_ptr<libdeflate_decompressor,decltype(&libdeflate_free_decompressor)> decompressor(libdeflate_alloc_decompressor(),&libdeflate_free_decompressor);
+	return decompressor.get();
+}
+
+}
+#endif
+
+#endif
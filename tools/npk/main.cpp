@@ -0,0 +1,107 @@
+#include "nabla.h"
+#include "nbl/system/IApplicationFramework.h"
+#include "nbl/system/CNablaPackWriter.h"
+
+#include <iostream>
+#include <filesystem>
+
+using namespace nbl;
+using namespace nbl::system;
+using namespace nbl::core;
+
+//! Packs a directory into a Nabla pack: `npk [-codec none|lz4|deflate] <input directory> <output.npk>`
+class NablaPacker final : public system::IApplicationFramework
+{
+	using base_t = system::IApplicationFramework;
+
+public:
+	using base_t::base_t;
+
+	bool onAppInitialized(smart_refctd_ptr<ISystem>&& system) override
+	{
+		if (argv.size()<3)
+		{
+			std::cerr << "Usage: npk [-codec none|lz4|deflate] <input directory> <output.npk>" << std::endl;
+			return false;
+		}
+
+		m_system = system ? std::move(system):IApplicationFramework::createSystem();
+		if (!m_system)
+			return false;
+		m_logger = make_smart_refctd_ptr<CStdoutLogger>(ILogger::DefaultLogMask());
+
+		auto codec = CNablaPackWriter::E_CODEC::LZ4;
+		for (size_t i=1; i+2<argv.size(); i++)
+		if (argv[i]=="-codec")
+		{
+			const auto& name = argv[++i];
+			if (name=="none")
+				codec = CNablaPackWriter::E_CODEC::NONE;
+			else if (name=="lz4")
+				codec = CNablaPackWriter::E_CODEC::LZ4;
+			else if (name=="deflate")
+				codec = CNablaPackWriter::E_CODEC::DEFLATE;
+			else
+			{
+				m_logger->log("Unknown codec %s",ILogger::ELL_ERROR,name.c_str());
+				return false;
+			}
+		}
+
+		const path inputDirectory = argv[argv.size()-2];
+		const path outputPath = argv.back();
+		if (!std::filesystem::is_directory(inputDirectory))
+		{
+			m_logger->log("%s is not a directory",ILogger::ELL_ERROR,inputDirectory.string().c_str());
+			return false;
+		}
+
+		CNablaPackWriter writer;
+		for (const auto& dirEntry : std::filesystem::recursive_directory_iterator(inputDirectory))
+		{
+			if (!dirEntry.is_regular_file())
+				continue;
+
+			// prefer a mapping, but empty files can't be mapped and the writer reads whatever isn't
+			smart_refctd_ptr<IFile> file;
+			for (const auto flags : {bitflag(IFileBase::ECF_READ)|IFileBase::ECF_MAPPABLE,bitflag(IFileBase::ECF_READ)})
+			{
+				ISystem::future_t<smart_refctd_ptr<IFile>> future;
+				m_system->createFile(future,dirEntry.path(),flags);
+				if (auto lock=future.acquire(); lock && lock->get())
+				{
+					file = *lock;
+					break;
+				}
+			}
+			if (!file || !writer.addEntry(std::filesystem::relative(dirEntry.path(),inputDirectory),std::move(file),codec))
+			{
+				m_logger->log("Failed to add %s",ILogger::ELL_ERROR,dirEntry.path().string().c_str());
+				return false;
+			}
+		}
+
+		ISystem::future_t<smart_refctd_ptr<IFile>> future;
+		m_system->createFile(future,outputPath,IFileBase::ECF_WRITE);
+		smart_refctd_ptr<IFile> output;
+		if (auto lock=future.acquire(); lock && lock->get())
+			output = *lock;
+		if (!writer.write(output.get(),m_logger.get()))
+		{
+			m_logger->log("Failed to write %s",ILogger::ELL_ERROR,outputPath.string().c_str());
+			return false;
+		}
+		m_logger->log("Packed %d files into %s",ILogger::ELL_INFO,static_cast<uint32_t>(writer.getEntryCount()),outputPath.string().c_str());
+		return true;
+	}
+
+	void workLoopBody() override {}
+
+	bool keepRunning() override { return false; }
+
+private:
+	smart_refctd_ptr<ISystem> m_system;
+	smart_refctd_ptr<ILogger> m_logger;
+};
+
+NBL_MAIN_FUNC(NablaPacker)